@@ -0,0 +1,89 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#include "pch.h"
+
+using namespace winrt;
+using namespace winrt::DynamicRefreshRateTool;
+
+FrameHistoryBuffer::FrameHistoryBuffer(size_t maxSnapshotSize) :
+	m_maxSnapshotSize(maxSnapshotSize)
+{
+	// Twice the snapshot size, rounded up to a power of two, leaves a snapshot plenty of time to
+	// copy its samples before the writer wraps around to them.
+	m_capacity = 1;
+	while (m_capacity < maxSnapshotSize * 2)
+	{
+		m_capacity *= 2;
+	}
+
+	m_slots = std::make_unique<Slot[]>(m_capacity);
+}
+
+void FrameHistoryBuffer::Push(int64_t tick, int64_t deltaTicks)
+{
+	// Only this thread writes the counts, so it can read them without ordering.
+	const uint64_t index = m_publishedCount.load(std::memory_order_relaxed);
+
+	// Announce the overwrite before touching the slot, so a reader that sees the new values also
+	// sees the new write count and discards what it read.
+	m_writeCount.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot& slot = m_slots[index & (m_capacity - 1)];
+	slot.tick.store(tick, std::memory_order_relaxed);
+	slot.deltaTicks.store(deltaTicks, std::memory_order_relaxed);
+
+	m_publishedCount.store(index + 1, std::memory_order_release);
+}
+
+uint64_t FrameHistoryBuffer::GetCount() const
+{
+	return m_publishedCount.load(std::memory_order_acquire);
+}
+
+bool FrameHistoryBuffer::TryGetLatest(Sample& sample) const
+{
+	const uint64_t publishedCount = m_publishedCount.load(std::memory_order_acquire);
+	if (publishedCount == 0)
+	{
+		return false;
+	}
+
+	// The newest sample can only be overwritten after the writer laps the whole ring, so the
+	// check below practically never fails.
+	ReadSlot(publishedCount - 1, sample);
+	return sample.index + m_capacity >= GetWriteCountAfterRead();
+}
+
+std::vector<FrameHistoryBuffer::Sample> FrameHistoryBuffer::Snapshot() const
+{
+	return Snapshot([](const Sample&) { return true; });
+}
+
+void FrameHistoryBuffer::ReadSlot(uint64_t index, Sample& sample) const
+{
+	const Slot& slot = m_slots[index & (m_capacity - 1)];
+	sample.index = index;
+	sample.tick = slot.tick.load(std::memory_order_relaxed);
+	sample.deltaTicks = slot.deltaTicks.load(std::memory_order_relaxed);
+}
+
+uint64_t FrameHistoryBuffer::GetWriteCountAfterRead() const
+{
+	// Pairs with the release fence in Push: if a slot read saw an overwrite, this load sees the
+	// write count that announced it.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return m_writeCount.load(std::memory_order_relaxed);
+}
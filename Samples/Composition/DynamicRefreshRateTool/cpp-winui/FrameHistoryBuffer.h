@@ -0,0 +1,113 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+#include "pch.h"
+
+namespace winrt::DynamicRefreshRateTool {
+
+	/**
+	 * Fixed-size, lock-free ring buffer of frame samples with one writer and any number of readers.
+	 * The writer never waits for readers, and a snapshot is wait-free: it copies the samples it wants
+	 * and then drops any the writer may have overwritten during the copy, instead of retrying.
+	 */
+	class FrameHistoryBuffer {
+	public:
+		// Snapshots hold at most maxSnapshotSize samples. The ring holds more than that, so a
+		// snapshot taken while the writer keeps going loses no samples in practice.
+		explicit FrameHistoryBuffer(size_t maxSnapshotSize);
+
+		FrameHistoryBuffer(const FrameHistoryBuffer&) = delete;
+		FrameHistoryBuffer& operator=(const FrameHistoryBuffer&) = delete;
+
+		struct Sample {
+			// Position of the sample in the sequence of all samples pushed so far.
+			uint64_t index;
+			// QPC tick at which the frame started.
+			int64_t tick;
+			// Number of QPC ticks the frame lasted.
+			int64_t deltaTicks;
+		};
+
+		// Append a sample. Must only be called from the single writer thread.
+		void Push(int64_t tick, int64_t deltaTicks);
+
+		// Number of samples pushed so far.
+		uint64_t GetCount() const;
+
+		// Get the newest sample. Returns false if there is none yet.
+		bool TryGetLatest(Sample& sample) const;
+
+		// Copy the newest samples, oldest first. Walking back from the newest sample, each sample is
+		// included while includeSample(sample) returns true, up to the snapshot size limit.
+		template <typename Predicate>
+		std::vector<Sample> Snapshot(Predicate&& includeSample) const;
+
+		// Copy up to the snapshot size limit of the newest samples, oldest first.
+		std::vector<Sample> Snapshot() const;
+
+	private:
+		struct Slot {
+			std::atomic<int64_t> tick{ 0 };
+			std::atomic<int64_t> deltaTicks{ 0 };
+		};
+
+		// Copy the sample at index into sample, without checking whether it was overwritten.
+		void ReadSlot(uint64_t index, Sample& sample) const;
+
+		// Count of samples the writer may have started overwriting, read after a copy.
+		uint64_t GetWriteCountAfterRead() const;
+
+		std::unique_ptr<Slot[]> m_slots;
+		size_t m_capacity = 0;
+		size_t m_maxSnapshotSize = 0;
+
+		// Number of samples the writer has started writing; bumped before a slot is overwritten.
+		std::atomic<uint64_t> m_writeCount{ 0 };
+		// Number of samples fully written and visible to readers.
+		std::atomic<uint64_t> m_publishedCount{ 0 };
+	};
+
+	template <typename Predicate>
+	std::vector<FrameHistoryBuffer::Sample> FrameHistoryBuffer::Snapshot(Predicate&& includeSample) const
+	{
+		const uint64_t publishedCount = m_publishedCount.load(std::memory_order_acquire);
+		const uint64_t available = (std::min)(publishedCount, static_cast<uint64_t>(m_maxSnapshotSize));
+
+		std::vector<Sample> res;
+		res.reserve(static_cast<size_t>((std::min)(available, static_cast<uint64_t>(1024))));
+		for (uint64_t i = 0; i < available; i++)
+		{
+			Sample sample;
+			ReadSlot(publishedCount - 1 - i, sample);
+			if (!includeSample(sample))
+			{
+				break;
+			}
+			res.push_back(sample);
+		}
+
+		// Samples the writer got around to overwriting while they were copied may be torn. They
+		// are the oldest ones copied, so drop them from the end.
+		const uint64_t writeCount = GetWriteCountAfterRead();
+		while (!res.empty() && res.back().index + m_capacity < writeCount)
+		{
+			res.pop_back();
+		}
+
+		std::reverse(res.begin(), res.end());
+
+		return res;
+	}
+}
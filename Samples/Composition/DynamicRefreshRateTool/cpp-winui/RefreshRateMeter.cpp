@@ -35,24 +35,26 @@ RefreshRateMeter::~RefreshRateMeter()
 
 float RefreshRateMeter::GetCurrentRefreshRate() const
 {
-	if (m_deltaHistory.empty())
+	FrameHistoryBuffer::Sample latest;
+	if (!m_history.TryGetLatest(latest))
 	{
 		// If there is no history yet - return default 60 FPS.
 		return 60.0;
 	}
 
-	return static_cast<float>(m_frequency) / m_deltaHistory.back().second;
+	return static_cast<float>(m_frequency) / latest.deltaTicks;
 }
 
 int64_t RefreshRateMeter::GetLastFrameDeltaTicks() const
 {
-	if (m_deltaHistory.empty())
+	FrameHistoryBuffer::Sample latest;
+	if (!m_history.TryGetLatest(latest))
 	{
 		// If there is no history yet - return default 1/60 delta.
 		return m_frequency / 60;
 	}
 
-	return m_deltaHistory.back().second;
+	return latest.deltaTicks;
 }
 
 int64_t RefreshRateMeter::GetFrequency() const
@@ -75,16 +77,28 @@ RefreshRateMeter& RefreshRateMeter::Instance()
 
 std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetRecentHistory(int64_t offsetTicks, int64_t historyLengthTicks, int aggregationSize, int keepEach) const
 {
-	if (m_deltaHistory.empty())
+	// Copy just the frames the requested range can touch: back to the offset, over the history
+	// length, and the frames before it that are averaged into its first data points.
+	int64_t copiedTotal = 0;
+	int extraFrames = aggregationSize - 1;
+	auto history = m_history.Snapshot([&](const FrameHistoryBuffer::Sample& sample)
+		{
+			if (copiedTotal <= offsetTicks + historyLengthTicks)
+			{
+				copiedTotal += sample.deltaTicks;
+				return true;
+			}
+			return extraFrames-- > 0;
+		});
+
+	if (history.empty())
 	{
 		return {};
 	}
 
-	std::lock_guard<std::mutex> guard(m_mutex);
-
-	int lastFrameIndex = static_cast<int>(m_deltaHistory.size()) - 1;
-	for (int64_t accumulatedTotal = 0; lastFrameIndex >= 0 && accumulatedTotal + m_deltaHistory[lastFrameIndex].second <= offsetTicks; lastFrameIndex--) {
-		accumulatedTotal += m_deltaHistory[lastFrameIndex].second;
+	int lastFrameIndex = static_cast<int>(history.size()) - 1;
+	for (int64_t accumulatedTotal = 0; lastFrameIndex >= 0 && accumulatedTotal + history[lastFrameIndex].deltaTicks <= offsetTicks; lastFrameIndex--) {
+		accumulatedTotal += history[lastFrameIndex].deltaTicks;
 	}
 
 	if (lastFrameIndex < 0)
@@ -93,8 +107,8 @@ std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetRecentHistory(int6
 	}
 
 	int firstFrameIndex = lastFrameIndex;
-	for (int64_t accumulatedTotal = 0; firstFrameIndex >= 0 && accumulatedTotal + m_deltaHistory[firstFrameIndex].second <= historyLengthTicks; firstFrameIndex--) {
-		accumulatedTotal += m_deltaHistory[firstFrameIndex].second;
+	for (int64_t accumulatedTotal = 0; firstFrameIndex >= 0 && accumulatedTotal + history[firstFrameIndex].deltaTicks <= historyLengthTicks; firstFrameIndex--) {
+		accumulatedTotal += history[firstFrameIndex].deltaTicks;
 	}
 
 	if (firstFrameIndex < 0)
@@ -109,7 +123,7 @@ std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetRecentHistory(int6
 
 	for (int i = lastFrameIndex; i > lastFrameIndex - aggregationSize + 1 && i >= 0; i--)
 	{
-		aggregatedDelta += m_deltaHistory[i].second;
+		aggregatedDelta += history[i].deltaTicks;
 		aggregatedFramesNumber++;
 	}
 
@@ -117,17 +131,17 @@ std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetRecentHistory(int6
 	{
 		if (i - aggregationSize + 1 >= 0)
 		{
-			aggregatedDelta += m_deltaHistory[i - aggregationSize + 1].second;
+			aggregatedDelta += history[i - aggregationSize + 1].deltaTicks;
 			aggregatedFramesNumber++;
 		}
 
-		if ((m_currentFrame - (m_deltaHistory.size() - i - 1)) % keepEach == 0)
+		if (history[i].index % keepEach == 0)
 		{
 			float refreshRate = static_cast<float>(aggregatedFramesNumber * m_frequency) / aggregatedDelta;
-			res.push_back(DataPoint{ m_deltaHistory[i].first, aggregatedDelta, aggregatedFramesNumber, refreshRate });
+			res.push_back(DataPoint{ history[i].tick, aggregatedDelta, aggregatedFramesNumber, refreshRate });
 		}
 
-		aggregatedDelta -= m_deltaHistory[i].second;
+		aggregatedDelta -= history[i].deltaTicks;
 		aggregatedFramesNumber--;
 	}
 
@@ -138,15 +152,15 @@ std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetRecentHistory(int6
 
 std::vector<RefreshRateMeter::DataPoint> RefreshRateMeter::GetHistoryStartingFrom(int64_t startingFrom) const
 {
-	std::lock_guard<std::mutex> guard(m_mutex);
+	auto history = m_history.Snapshot([startingFrom](const FrameHistoryBuffer::Sample& sample) { return sample.tick > startingFrom; });
+
 	std::vector<DataPoint> res;
-	for (int i = (int)m_deltaHistory.size() - 1; i >= 0 && m_deltaHistory[i].first > startingFrom; i--)
+	res.reserve(history.size());
+	for (auto& sample : history)
 	{
-		res.push_back(DataPoint{ m_deltaHistory[i].first, m_deltaHistory[i].second, 1, static_cast<float>(m_frequency) / m_deltaHistory[i].second });
+		res.push_back(DataPoint{ sample.tick, sample.deltaTicks, 1, static_cast<float>(m_frequency) / sample.deltaTicks });
 	}
 
-	std::reverse(res.begin(), res.end());
-
 	return res;
 }
 
@@ -170,16 +184,9 @@ void RefreshRateMeter::RefreshRateTrackingThread()
 
 		if (prevTime.QuadPart != 0)
 		{
-			std::lock_guard<std::mutex> guard(m_mutex);
-			m_deltaHistory.push_back({ currentTime.QuadPart, currentTime.QuadPart - prevTime.QuadPart });
-
-			if (m_deltaHistory.size() > MAX_HISTORY_SIZE)
-			{
-				m_deltaHistory.pop_front();
-			}
+			m_history.Push(currentTime.QuadPart, currentTime.QuadPart - prevTime.QuadPart);
 		}
 
 		prevTime = currentTime;
-		m_currentFrame++;
 	}
 }
@@ -65,19 +65,17 @@ namespace winrt::DynamicRefreshRateTool {
 		void RefreshRateTrackingThread();
 
 		int64_t m_frequency = 0;
-		uint64_t m_currentFrame = 0;
 
 		// Up to 10 minutes of history at 60 fps rate
-		const size_t MAX_HISTORY_SIZE = 60 * 60 * 10;
-		// List of pairs (start frame QPC tick, frame duration QPC ticks) for the last ~10 minutes
-		std::deque<std::pair<int64_t, int64_t>> m_deltaHistory;
+		static constexpr size_t MAX_HISTORY_SIZE = 60 * 60 * 10;
+		// Samples (start frame QPC tick, frame duration QPC ticks) for the last ~10 minutes. Written
+		// only by the monitor thread, which never waits for the chart or logger reading it.
+		FrameHistoryBuffer m_history{ MAX_HISTORY_SIZE };
 
 		// Future that owns monitor thread.
 		std::future<void> m_monitorFuture;
 
 		// Flag to stop the monitor thread.
-		bool m_shouldStopFpsCalculation = false;
-
-		mutable std::mutex m_mutex;
+		std::atomic<bool> m_shouldStopFpsCalculation = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+// INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+// THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// Runs one writer pushing samples into a FrameHistoryBuffer, the way RefreshRateMeter's monitor
+// thread does, against concurrent readers taking snapshots the way the chart and the logger do.
+// Every sample's tick and delta are functions of its index, so a reader can tell a torn sample
+// (one whose tick and delta come from different pushes, or that was overwritten while it was
+// copied) from a good one. The test fails if a reader sees:
+//
+// * A torn sample, from a snapshot or from TryGetLatest.
+// * A lost sample: a gap in a snapshot's indices, or a snapshot missing samples that had been
+//   published when it was taken. Snapshots may drop their oldest samples when the writer laps the
+//   reader, which only a tiny ring or an unpaced writer can do, so those runs count the drops
+//   rather than fail on them.
+// * The count or the latest sample going backwards.
+//
+// Three runs:
+//
+// * A writer paced to a 1 kHz clock (well above any display's refresh rate), with the ring sized
+//   as RefreshRateMeter sizes it. No snapshot may drop anything.
+// * An unpaced writer, which wraps the ring many times.
+// * An unpaced writer on a ring of 16 slots, so readers are lapped constantly.
+
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+
+using namespace winrt::DynamicRefreshRateTool;
+
+namespace
+{
+	constexpr size_t c_historySize = 60 * 60 * 10; // RefreshRateMeter::MAX_HISTORY_SIZE
+	constexpr int c_readerCount = 4;
+
+	int64_t TickOf(uint64_t index)
+	{
+		return 1000 + static_cast<int64_t>(index) * 1000;
+	}
+
+	int64_t DeltaOf(uint64_t index)
+	{
+		return 1000 + static_cast<int64_t>(index % 97) * 13;
+	}
+
+	bool IsTorn(const FrameHistoryBuffer::Sample& sample)
+	{
+		return sample.tick != TickOf(sample.index) || sample.deltaTicks != DeltaOf(sample.index);
+	}
+
+	struct RunResult
+	{
+		uint64_t snapshots = 0;
+		uint64_t samplesChecked = 0;
+		uint64_t dropped = 0;
+		uint64_t torn = 0;
+		uint64_t lost = 0;
+		uint64_t backwards = 0;
+	};
+
+	// Takes snapshots until done is set. Even readers take the whole history, as the logger does,
+	// and odd ones take the samples newer than a recent tick, as the chart does. The odd readers
+	// also yield partway through each copy, so the writer overwrites samples while they're being
+	// copied even when there are fewer cores than threads.
+	void ReadUntilDone(const FrameHistoryBuffer& buffer, size_t snapshotSize, int reader, const std::atomic<bool>& done, RunResult& result)
+	{
+		uint64_t lastCount = 0;
+		uint64_t lastLatestIndex = 0;
+		while (!done.load())
+		{
+			const uint64_t countBefore = buffer.GetCount();
+			const int64_t startingFrom = TickOf(countBefore > 50 ? countBefore - 50 : 0);
+			auto snapshot = (reader % 2 == 0) ?
+				buffer.Snapshot() :
+				buffer.Snapshot([startingFrom](const FrameHistoryBuffer::Sample& sample)
+					{
+						if (sample.index % 4 == 0)
+						{
+							std::this_thread::yield();
+						}
+						return sample.tick > startingFrom;
+					});
+
+			for (size_t i = 0; i < snapshot.size(); i++)
+			{
+				result.torn += IsTorn(snapshot[i]) ? 1 : 0;
+				result.lost += (i > 0 && snapshot[i].index != snapshot[i - 1].index + 1) ? 1 : 0;
+			}
+
+			// The newest sample published before the snapshot must be in it.
+			if (!snapshot.empty() && snapshot.back().index + 1 < countBefore)
+			{
+				result.lost++;
+			}
+
+			// A whole-history snapshot is short only by what it dropped as possibly overwritten.
+			if (reader % 2 == 0)
+			{
+				const uint64_t expected = (std::min)(countBefore, static_cast<uint64_t>(snapshotSize));
+				if (snapshot.size() < expected)
+				{
+					result.dropped += expected - snapshot.size();
+				}
+			}
+
+			FrameHistoryBuffer::Sample latest;
+			if (buffer.TryGetLatest(latest))
+			{
+				result.torn += IsTorn(latest) ? 1 : 0;
+				result.backwards += (latest.index < lastLatestIndex) ? 1 : 0;
+				lastLatestIndex = latest.index;
+			}
+
+			const uint64_t count = buffer.GetCount();
+			result.backwards += (count < lastCount) ? 1 : 0;
+			lastCount = count;
+
+			result.snapshots++;
+			result.samplesChecked += snapshot.size();
+		}
+	}
+
+	bool Run(const char* name, size_t snapshotSize, uint64_t sampleCount, bool paced)
+	{
+		FrameHistoryBuffer buffer(snapshotSize);
+		std::atomic<bool> done{ false };
+		std::vector<RunResult> results(c_readerCount);
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < c_readerCount; i++)
+		{
+			readers.emplace_back([&, i]() { ReadUntilDone(buffer, snapshotSize, i, done, results[i]); });
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < sampleCount; i++)
+		{
+			if (paced)
+			{
+				std::this_thread::sleep_until(start + std::chrono::microseconds(1000 * i));
+			}
+			else if (i % 256 == 0)
+			{
+				// Let the readers in, in case they're waiting for this thread's core.
+				std::this_thread::yield();
+			}
+			buffer.Push(TickOf(i), DeltaOf(i));
+		}
+
+		done = true;
+		for (auto& reader : readers)
+		{
+			reader.join();
+		}
+
+		RunResult total;
+		for (auto& result : results)
+		{
+			total.snapshots += result.snapshots;
+			total.samplesChecked += result.samplesChecked;
+			total.dropped += result.dropped;
+			total.torn += result.torn;
+			total.lost += result.lost;
+			total.backwards += result.backwards;
+		}
+
+		// Once the writer has stopped, a snapshot holds exactly the newest samples.
+		auto tail = buffer.Snapshot();
+		const bool tailOk = tail.size() == (std::min)(sampleCount, static_cast<uint64_t>(snapshotSize)) &&
+			tail.back().index == sampleCount - 1 && tail.front().index == sampleCount - tail.size();
+
+		const bool passed = total.torn == 0 && total.lost == 0 && total.backwards == 0 && tailOk && (!paced || total.dropped == 0);
+		printf("%-10s %8zu %9llu %10llu %12llu %9llu %6llu %6llu %9llu  %s\n",
+			name, snapshotSize, static_cast<unsigned long long>(sampleCount),
+			static_cast<unsigned long long>(total.snapshots), static_cast<unsigned long long>(total.samplesChecked),
+			static_cast<unsigned long long>(total.dropped), static_cast<unsigned long long>(total.torn),
+			static_cast<unsigned long long>(total.lost), static_cast<unsigned long long>(total.backwards),
+			passed ? "ok" : (tailOk ? "FAILED" : "FAILED (tail)"));
+		return passed;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// --quick runs for less time, for use as a test.
+	const bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+	const uint64_t pacedSamples = quick ? 1'000 : 3'000;
+	const uint64_t unpacedSamples = quick ? 50'000 : 1'000'000;
+
+	printf("One writer, %d readers\n\n", c_readerCount);
+	printf("%-10s %8s %9s %10s %12s %9s %6s %6s %9s\n", "Run", "Snapshot", "Samples", "Snapshots", "Checked", "Dropped", "Torn", "Lost", "Backwards");
+
+	bool passed = true;
+	passed &= Run("1 kHz", c_historySize, pacedSamples, true);
+	passed &= Run("Unpaced", c_historySize, unpacedSamples, false);
+	passed &= Run("Tiny ring", 8, unpacedSamples, false);
+
+	return passed ? 0 : 1;
+}
@@ -64,8 +64,10 @@
 #include <time.h>
 #include <deque>
 #include <mutex>
+#include <atomic>
 
 #include "RefreshRateLogger.h"
+#include "FrameHistoryBuffer.h"
 #include "RefreshRateMeter.h"
 
 #include <dxgi1_6.h>
@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "AtlasAllocator.h"
+
+AtlasAllocator::AtlasAllocator(uint32_t pageSize, uint32_t padding, size_t maxEmptyPages) noexcept :
+    m_pageSize(pageSize),
+    m_padding(padding),
+    m_maxEmptyPages(maxEmptyPages)
+{
+}
+
+bool AtlasAllocator::TryAllocate(uint32_t width, uint32_t height, _Out_ Allocation* allocation)
+{
+    *allocation = {};
+
+    auto paddedWidth = width + (2 * m_padding);
+    auto paddedHeight = height + (2 * m_padding);
+    if (paddedWidth > m_pageSize || paddedHeight > m_pageSize)
+    {
+        return false;
+    }
+
+    uint32_t x = 0;
+    uint32_t y = 0;
+    bool isNewPage = false;
+    size_t index = 0;
+    for (; index < m_pages.size(); index++)
+    {
+        auto& page = m_pages[index];
+        if (!page.isReleased && page.packer.TryAllocate(paddedWidth, paddedHeight, &x, &y))
+        {
+            break;
+        }
+    }
+
+    if (index == m_pages.size())
+    {
+        // No page has room, so start a new one, in the first released slot if there is one.
+        index = std::find_if(m_pages.begin(), m_pages.end(), [](auto const& page) { return page.isReleased; }) - m_pages.begin();
+        if (index == m_pages.size())
+        {
+            m_pages.emplace_back();
+        }
+
+        auto& page = m_pages[index];
+        page.packer.Reset(m_pageSize, m_pageSize);
+        page.isReleased = false;
+        page.packer.TryAllocate(paddedWidth, paddedHeight, &x, &y);
+        isNewPage = true;
+    }
+
+    auto& page = m_pages[index];
+    if (page.allocationCount++ == 0 && !isNewPage)
+    {
+        m_emptyPageCount--;
+    }
+
+    allocation->page = index;
+    allocation->updateRect = {
+        static_cast<LONG>(x),
+        static_cast<LONG>(y),
+        static_cast<LONG>(x + paddedWidth),
+        static_cast<LONG>(y + paddedHeight) };
+    allocation->rect = {
+        static_cast<LONG>(x + m_padding),
+        static_cast<LONG>(y + m_padding),
+        static_cast<LONG>(x + m_padding + width),
+        static_cast<LONG>(y + m_padding + height) };
+
+    m_statistics.allocations++;
+    return true;
+}
+
+bool AtlasAllocator::Free(size_t page) noexcept
+{
+    auto& freedPage = m_pages[page];
+    if (--freedPage.allocationCount != 0)
+    {
+        return false;
+    }
+
+    m_statistics.pageResets++;
+    if (m_emptyPageCount < m_maxEmptyPages)
+    {
+        freedPage.packer.Reset(m_pageSize, m_pageSize);
+        m_emptyPageCount++;
+        return false;
+    }
+
+    freedPage.isReleased = true;
+    m_statistics.pagesReleased++;
+    return true;
+}
+
+void AtlasAllocator::Clear() noexcept
+{
+    m_pages.clear();
+    m_emptyPageCount = 0;
+}
+
+size_t AtlasAllocator::LivePageCount() const noexcept
+{
+    return std::count_if(m_pages.begin(), m_pages.end(), [](auto const& page) { return !page.isReleased; });
+}
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+#include "SkylinePacker.h"
+
+// Hands out rectangles of fixed-size square atlas pages, with a skyline packer per page. It only
+// does the bookkeeping: the owner keeps a surface for each page, creating it when a rectangle is
+// allocated in a page that has none, and releasing it when Free says so.
+//
+// - Each rectangle has empty padding around it, so that filtering never samples a neighboring
+//   rectangle. The padding is part of the rectangle's update rect, which the owner must clear
+//   whenever it draws the rectangle, since the pixels there may be left over from rectangles that
+//   were freed.
+// - A page is reset once none of its rectangles are in use. Up to maxEmptyPages empty pages keep
+//   their surfaces for reuse. Beyond that, an emptied page is released, and its slot is reused
+//   for the next new page.
+//
+// This class has no Direct2D or composition dependencies, so it can be tested on its own.
+class AtlasAllocator
+{
+public:
+    struct Allocation
+    {
+        size_t page;
+
+        // The allocated rectangle, in pixels within the page.
+        RECT rect;
+
+        // The allocated rectangle with its padding.
+        RECT updateRect;
+    };
+
+    // Counts of what the allocator has done, for diagnostics.
+    struct Statistics
+    {
+        uint32_t allocations = 0;
+        uint32_t pageResets = 0;
+        uint32_t pagesReleased = 0;
+    };
+
+    AtlasAllocator(uint32_t pageSize, uint32_t padding, size_t maxEmptyPages) noexcept;
+
+    // Returns false if the rectangle doesn't fit in a page. The page may be new, or reuse the slot
+    // of a released page.
+    bool TryAllocate(uint32_t width, uint32_t height, _Out_ Allocation* allocation);
+
+    // Returns true if the page is now empty and released, so its surface should be released too.
+    bool Free(size_t page) noexcept;
+
+    // Releases every page, for when the surfaces have been lost.
+    void Clear() noexcept;
+
+    // The number of page slots, including released ones. A page index is always less than this.
+    size_t PageCount() const noexcept { return m_pages.size(); }
+
+    // The number of pages that aren't released, and so have surfaces.
+    size_t LivePageCount() const noexcept;
+
+    Statistics const& GetStatistics() const noexcept { return m_statistics; }
+
+private:
+    struct Page
+    {
+        SkylinePacker packer;
+        uint32_t allocationCount = 0;
+        bool isReleased = false;
+    };
+
+    uint32_t m_pageSize;
+    uint32_t m_padding;
+    size_t m_maxEmptyPages;
+
+    std::vector<Page> m_pages;
+
+    // The number of pages that aren't released but have no allocations.
+    size_t m_emptyPageCount = 0;
+
+    Statistics m_statistics;
+};
@@ -57,6 +57,7 @@ void AutomationFragment::AddChildToEnd(
 
     // Finally add the child.
     m_children.push_back(child);
+    m_childIndex.emplace(child.as<::IUnknown>().get(), std::prev(m_children.end()));
 }
 
 void AutomationFragment::RemoveChild(
@@ -70,15 +71,10 @@ void AutomationFragment::RemoveChild(
         return;
     }
 
-    auto iterator = std::find_if(
-        m_children.begin(), m_children.end(), [&child](auto const& childEntry)
-    {
-        // See if we find a matching child entry in our children.
-        return (childEntry.as<::IUnknown>().get() == child.as<::IUnknown>().get());
-    });
+    auto indexEntry = m_childIndex.find(child.as<::IUnknown>().get());
 
     // We cannot remove a child that isn't ours.
-    winrt::check_bool(m_children.end() != iterator);
+    winrt::check_bool(m_childIndex.end() != indexEntry);
 
     // Remove us from the parent relationship with the child.
     child->Parent(nullptr);
@@ -98,7 +94,8 @@ void AutomationFragment::RemoveChild(
     child->NextSibling(nullptr);
 
     // Finally, remove the child.
-    m_children.erase(iterator);
+    m_children.erase(indexEntry->second);
+    m_childIndex.erase(indexEntry);
 }
 
 void AutomationFragment::RemoveAllChildren()
@@ -115,6 +112,7 @@ void AutomationFragment::RemoveAllChildren()
 
     // Remove all the children.
     m_children.clear();
+    m_childIndex.clear();
 }
 
 HRESULT __stdcall AutomationFragment::Navigate(
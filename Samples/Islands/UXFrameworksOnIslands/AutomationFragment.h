@@ -70,7 +70,10 @@ private:
     winrt::weak_ref<AutomationBase> m_parent{ nullptr };
     winrt::weak_ref<AutomationBase> m_previousSibling{ nullptr };
     winrt::weak_ref<AutomationBase> m_nextSibling{ nullptr };
-    std::vector<winrt::com_ptr<AutomationFragment>> m_children{};
+    // Children in order, with an index from each child's identity to its position so that a
+    // child can be removed without searching its siblings.
+    std::list<winrt::com_ptr<AutomationFragment>> m_children{};
+    std::unordered_map<::IUnknown const*, std::list<winrt::com_ptr<AutomationFragment>>::iterator> m_childIndex{};
     std::vector<winrt::com_ptr<AutomationFragment>> m_embeddedFragments{};
 };
 
@@ -66,17 +66,14 @@ winrt::com_ptr<::IRawElementProviderFragment> AutomationTree::GetFragmentFromPoi
         return nullptr;
     }
 
-    auto it = std::find_if(m_peers.begin(), m_peers.end(), [&visualHit](std::shared_ptr<AutomationPeer> const& peer)
-    {
-        return peer->VisualNode() == visualHit;
-    });
+    auto it = m_peers.find(visualHit.get());
 
     if (m_peers.end() != it)
     {
         // A peer was found for the visual that was hit.
         // Check if the peer would like to forward the request to an external child (i.e. a different frame of content).
         // If not, the peer will return itself.
-        return (*it)->ForwardFragmentFromPointInScreenCoordinatesRequest(x, y);
+        return it->second->ForwardFragmentFromPointInScreenCoordinatesRequest(x, y);
     }
 
     // No peer was found for the visual that was hit, but we know we are in the frame's bounds, so return the frame's fragment root.
@@ -170,7 +167,16 @@ void AutomationTree::AddPeer(
     _In_ std::shared_ptr<AutomationPeer> const& peer)
 {
     std::unique_lock lock{ m_mutex };
-    m_peers.push_back(peer);
+    m_peers.try_emplace(peer->VisualNode().get(), peer);
+}
+
+std::shared_ptr<AutomationPeer> AutomationTree::FindPeer(
+    _In_ VisualTreeNode const* visual) const
+{
+    std::unique_lock lock{ m_mutex };
+
+    auto it = m_peers.find(visual);
+    return (m_peers.end() != it) ? it->second : nullptr;
 }
 
 void AutomationTree::SetFrameHost(
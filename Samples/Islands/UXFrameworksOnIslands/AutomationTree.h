@@ -58,8 +58,13 @@ struct AutomationTree : std::enable_shared_from_this<AutomationTree>,
         _In_ std::wstring_view const& name,
         _In_ long const& uiaControlTypeId);
 
+    // Peers live as long as the tree: none of the frames remove content once it's built.
     void AddPeer(_In_ std::shared_ptr<AutomationPeer> const& peer);
 
+    // Returns the peer added for the visual, or nullptr. This is the lookup a fragment-from-point
+    // request does for the visual it hit.
+    [[nodiscard]] std::shared_ptr<AutomationPeer> FindPeer(_In_ VisualTreeNode const* visual) const;
+
     void SetFrameHost(_In_ IFrameHost const* const frameHost) noexcept;
 
 private:
@@ -78,7 +83,9 @@ private:
     std::unique_ptr<AutomationHelpers::AutomationCallbackRevoker> m_fragmentRootCallbackRevoker{ nullptr };
     std::unique_ptr<AutomationHelpers::AutomationCallbackRevoker> m_externalParentCallbackRevoker{ nullptr };
 
-    std::vector<std::shared_ptr<AutomationPeer>> m_peers;
+    // Peers indexed by their visual, so a hit-tested visual finds its peer without a search.
+    // A visual has at most one peer; the first one added for it is kept.
+    std::unordered_map<VisualTreeNode const*, std::shared_ptr<AutomationPeer>> m_peers;
 
     ContentIslandAutomationProviderRequested_revoker m_contentIslandAutomationProviderRequestedRevoker{};
 };
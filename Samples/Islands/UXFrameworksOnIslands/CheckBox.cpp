@@ -30,7 +30,7 @@ CheckBox<T>::CheckBox(
         std::wstring&& text,
         std::shared_ptr<SettingCollection> const& settings,
         SettingId id) :
-    SettingChangedHandler(settings),
+    SettingChangedHandler(settings, SettingMaskOf(id)),
     m_containerVisual(output.GetCompositor().CreateContainerVisual()),
     m_emptyCheckBox(output, L"", GetEmptyCheckBoxTextLayout(), m_containerVisual),
     m_filledCheckBox(output, L"", GetFilledCheckBoxTextLayout(), m_containerVisual),
@@ -82,14 +82,12 @@ void CheckBox<T>::IsChecked(bool value)
 }
 
 template<class T>
-void CheckBox<T>::OnSettingChanged(SettingId id)
+void CheckBox<T>::OnSettingsChanged(SettingMask /*changedSettings*/)
 {
-    if (id == m_settingId)
-    {
-        bool isChecked = IsChecked();
-        m_emptyCheckBox.IsVisible(!isChecked);
-        m_filledCheckBox.IsVisible(isChecked);
-    }
+    // Only subscribed to this check box's setting.
+    bool isChecked = IsChecked();
+    m_emptyCheckBox.IsVisible(!isChecked);
+    m_filledCheckBox.IsVisible(isChecked);
 }
 
 // Explicit template instantiation.
@@ -47,7 +47,7 @@ public:
     }
 
 private:
-    void OnSettingChanged(SettingId id) override;
+    void OnSettingsChanged(SettingMask changedSettings) override;
 
     ContainerVisual m_containerVisual;
     TextVisual<T> m_emptyCheckBox;
@@ -5,22 +5,6 @@
 #include "Output.h"
 #include "TextRenderer.h"
 
-inline winrt::CompositionDrawingSurface CreateCompositionDrawingSurface(winrt::CompositionGraphicsDevice const& device, winrt::Size pixelSize)
-{
-    return device.CreateDrawingSurface(
-        pixelSize,
-        winrt::Microsoft::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        winrt::Microsoft::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
-}
-
-inline winrt::WUC::CompositionDrawingSurface CreateCompositionDrawingSurface(winrt::WUC::CompositionGraphicsDevice const& device, winrt::Size pixelSize)
-{
-    return device.CreateDrawingSurface(
-        pixelSize,
-        winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        winrt::Windows::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
-}
-
 template <class T>
 D2DSprite<T>::D2DSprite(Output<T> const& output, ContainerVisual const& containerVisual) :
     OutputResource<T>(output.GetResourceList()),
@@ -29,6 +13,9 @@ D2DSprite<T>::D2DSprite(Output<T> const& output, ContainerVisual const& containe
 {
     IsPixelSnappingEnabled(!output.GetSetting(Setting_DisablePixelSnapping));
     m_containerVisual.Children().InsertAtTop(m_spriteVisual);
+
+    // Render the new sprite in the next flush.
+    this->MarkDirty();
 }
 
 template<class T>
@@ -64,15 +51,23 @@ void D2DSprite<T>::EnsureInitialized(Output<T> const& output)
         // This invalidates the drawing surface if the size changes.
         InitializePixelBounds(output);
 
-        // Create the drawing surface if it doesn't already exist.
-        if (m_drawingSurface == nullptr)
+        // Get a drawing surface if we don't already have one.
+        if (!m_surfaceAllocation)
         {
-            // Create a CompositionDrawingSurface sized to the pixel bounds.
-            m_drawingSurface = CreateCompositionDrawingSurface(output.GetCompositionGraphicsDevice(), GetPixelSize());
-
-            // Create a surface brush and assign it to the visual.
+            // Allocate a rectangle the size of the pixel bounds. This may be part of a shared
+            // atlas surface, or a surface that's larger than the sprite.
+            m_surfaceAllocation = output.GetSurfacePool()->Allocate(output, GetPixelSize());
+
+            // Create a surface brush and assign it to the visual. The brush draws the surface
+            // unscaled, offset so the allocated rectangle is at the visual's origin, and the
+            // visual's size clips off the rest.
+            auto& rect = m_surfaceAllocation.GetRect();
             auto surfaceBrush = output.GetCompositor().CreateSurfaceBrush();
-            surfaceBrush.Surface(m_drawingSurface);
+            surfaceBrush.Surface(m_surfaceAllocation.GetSurface());
+            surfaceBrush.Stretch(decltype(surfaceBrush.Stretch())::None);
+            surfaceBrush.HorizontalAlignmentRatio(0.0f);
+            surfaceBrush.VerticalAlignmentRatio(0.0f);
+            surfaceBrush.Offset({ -static_cast<float>(rect.left), -static_cast<float>(rect.top) });
             m_spriteVisual.Brush(surfaceBrush);
 
             m_surfaceGeneration++;
@@ -102,61 +97,58 @@ void D2DSprite<T>::EnsureInitialized(Output<T> const& output)
 template<class T>
 void D2DSprite<T>::InvalidateSurface()
 {
-    // Indicate that the content needs to be re-rendered.
+    // Indicate that the content needs to be re-rendered and measured.
     m_isContentValid = false;
+    m_arePixelBoundsValid = false;
 
-    // Indicate that the drawing surface and brush need to be re-created.
-    m_drawingSurface = nullptr;
+    // Indicate that the drawing surface and brush need to be re-created. The surface is returned
+    // to the pool for reuse.
+    m_surfaceAllocation.Reset();
     m_spriteVisual.Brush(nullptr);
+
+    this->MarkDirty();
 }
 
 template<class T>
 void D2DSprite<T>::InvalidateContent()
 {
-    // Indicate that the content needs to be re-rendered.
+    // Indicate that the content needs to be re-rendered, by the next flush.
     m_isContentValid = false;
+    this->MarkDirty();
 }
 
 template<class T>
-void D2DSprite<T>::OnSettingChanged(Output<T> const& output, SettingId id)
+void D2DSprite<T>::OnSettingsChanged(Output<T> const& output, SettingMask changedSettings)
 {
-    switch (id)
+    constexpr auto contentSettings = SettingMaskOf(Setting_ShowSpriteBounds) | SettingMaskOf(Setting_ShowSpriteGeneration);
+    constexpr auto pixelSnappingSettings = SettingMaskOf(Setting_DisablePixelSnapping);
+
+    if ((changedSettings & pixelSnappingSettings) != 0)
     {
-    case Setting_DisablePixelSnapping:
         IsPixelSnappingEnabled(!output.GetSetting(Setting_DisablePixelSnapping));
-        break;
-
-    case Setting_ShowSpriteBounds:
-    case Setting_ShowSpriteGeneration:
-        InvalidateContent();
-        break;
+    }
 
-    default:
+    // Any other setting needs the surface re-created, which also re-renders the content.
+    if ((changedSettings & ~(contentSettings | pixelSnappingSettings)) != 0)
+    {
         InvalidateSurface();
     }
+    else if ((changedSettings & contentSettings) != 0)
+    {
+        InvalidateContent();
+    }
 
-    EnsureInitialized(output);
+    // Any invalidation marked the sprite dirty, so it's re-rendered when the frame flushes the
+    // resource list, rather than here.
 }
 
 template<class T>
 Matrix2x2 D2DSprite<T>::ComputeRasterTransform(Output<T> const& output) const
 {
-    // Compute the aggregate transform (ignoring translation) from the placement visual
-    // to the root coordinate space of the island.
-    auto matrix = winrt::Windows::Foundation::Numerics::float4x4::identity();
-    for (auto visual = GetVisual(); visual != nullptr; visual = visual.Parent())
-    {
-        // Compute a local transform from the visual's properties, ignoring translation.
-        auto visualTransform = winrt::Windows::Foundation::Numerics::make_float4x4_scale(
-            visual.Scale());
-        visualTransform *= winrt::Windows::Foundation::Numerics::make_float4x4_from_axis_angle(
-            visual.RotationAxis(),
-            visual.RotationAngle());
-        visualTransform *= visual.TransformMatrix();
-
-        // Multiply by the aggregate transform so far.
-        matrix *= visualTransform;
-    }
+    // Get the aggregate transform (ignoring translation) from the placement visual
+    // to the root coordinate space of the island. The cache shares the ancestors'
+    // transforms between sprites, so they're computed once per layout pass.
+    auto matrix = output.GetRasterTransformCache().GetWorldTransform(GetVisual());
 
     // Flatten to a 2x2 matrix (2D without displacement).
     auto result = Matrix2x2(matrix);
@@ -174,8 +166,38 @@ Matrix2x2 D2DSprite<T>::ComputeRasterTransform(Output<T> const& output) const
 }
 
 template <class T>
-D2D1_RECT_F D2DSprite<T>::GetPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform)
+D2D1_RECT_F D2DSprite<T>::GetPixelBounds(Output<T> const& output, Matrix2x2 const& rasterTransform)
+{
+    D2D1_RECT_F contentBounds;
+    if (TryGetContentBounds(output, /*out*/ contentBounds))
+    {
+        output.GetSpriteBoundsStatistics().analyticBounds++;
+
+        if (contentBounds.right <= contentBounds.left || contentBounds.bottom <= contentBounds.top)
+        {
+            // No content.
+            return {};
+        }
+
+        // Grayscale and ClearType antialiasing may touch a pixel beyond the transformed bounds.
+        constexpr float antialiasMargin = 1.0f;
+        auto pixelBounds = rasterTransform.TransformBounds(contentBounds);
+        return {
+            pixelBounds.left - antialiasMargin,
+            pixelBounds.top - antialiasMargin,
+            pixelBounds.right + antialiasMargin,
+            pixelBounds.bottom + antialiasMargin
+        };
+    }
+
+    return RenderPixelBounds(output, rasterTransform.ToD2D());
+}
+
+template <class T>
+D2D1_RECT_F D2DSprite<T>::RenderPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform)
 {
+    output.GetSpriteBoundsStatistics().boundsRenders++;
+
     // Create a command list and set it as the device context target.
     ID2D1DeviceContext5* deviceContext = output.GetDXDevice().GetDeviceContext().get();
     winrt::com_ptr<ID2D1CommandList> commandList;
@@ -206,12 +228,18 @@ D2D1_RECT_F D2DSprite<T>::GetPixelBounds(Output<T> const& output, D2D1::Matrix3x
 template<class T>
 void D2DSprite<T>::InitializePixelBounds(Output<T> const& output)
 {
+    // Reuse the bounds if nothing they depend on has changed.
+    if (m_arePixelBoundsValid && m_pixelBoundsTransform == m_rasterTransform)
+    {
+        output.GetSpriteBoundsStatistics().cachedBounds++;
+        return;
+    }
+
     auto oldPixelSize = GetPixelSize();
 
     // Get the bounding box of the content in device units, taking into
     // account the raster transform.
-    auto transform = m_rasterTransform.ToD2D();
-    m_pixelBounds = GetPixelBounds(output, transform);
+    m_pixelBounds = GetPixelBounds(output, m_rasterTransform);
 
     // Round to pixel boundaries.
     m_pixelBounds.left = floorf(m_pixelBounds.left);
@@ -224,6 +252,9 @@ void D2DSprite<T>::InitializePixelBounds(Output<T> const& output)
     {
         InvalidateSurface();
     }
+
+    m_pixelBoundsTransform = m_rasterTransform;
+    m_arePixelBoundsValid = true;
 }
 
 template<class T>
@@ -265,21 +296,30 @@ void D2DSprite<T>::SetSpriteSizeAndTransform()
 template<class T>
 void D2DSprite<T>::RenderToDrawingSurface(Output<T> const& output)
 {
-    auto drawingSurfaceInterop = m_drawingSurface.as<ICompositionDrawingSurfaceInterop>();
+    auto drawingSurfaceInterop = m_surfaceAllocation.GetSurface().template as<ICompositionDrawingSurfaceInterop>();
 
-    // Get a device context that's bound to the drawing surface.
+    // Get a device context that's bound to the update rectangle of the drawing surface, which is
+    // the allocated rectangle plus padding.
+    auto& rect = m_surfaceAllocation.GetRect();
+    auto& updateRect = m_surfaceAllocation.GetUpdateRect();
     winrt::com_ptr<ID2D1DeviceContext> deviceContext;
     POINT pixelOffset;
     winrt::check_hresult(drawingSurfaceInterop->BeginDraw(
-        nullptr,
+        &updateRect,
         __uuidof(decltype(*deviceContext)),
         /*out*/ deviceContext.put_void(),
         /*out*/ &pixelOffset));
 
-    // BeginDraw allocated a rectangle for this drawing surface in an atlas texture.
-    // Clip to the bounds of this rectangle.
-    const D2D_POINT_2F atlasOffset{ static_cast<float>(pixelOffset.x), static_cast<float>(pixelOffset.y) };
+    // The padding may hold pixels of sprites that were drawn there before, which filtering at
+    // the edges of this sprite would pick up, so clear the whole update rectangle.
     deviceContext->SetUnitMode(D2D1_UNIT_MODE_PIXELS);
+    deviceContext->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+
+    // BeginDraw allocated a rectangle for this drawing surface in an atlas texture.
+    // Clip to the bounds of the allocated rectangle within it.
+    const D2D_POINT_2F atlasOffset{
+        static_cast<float>(pixelOffset.x + rect.left - updateRect.left),
+        static_cast<float>(pixelOffset.y + rect.top - updateRect.top) };
     deviceContext->SetTransform(D2D1::Matrix3x2F::Translation(atlasOffset.x, atlasOffset.y));
     auto pixelSize = GetPixelSize();
     deviceContext->PushAxisAlignedClip({ 0, 0, pixelSize.Width, pixelSize.Height }, D2D1_ANTIALIAS_MODE_ALIASED);
@@ -5,6 +5,7 @@
 #include "OutputResource.h"
 #include "TemplateHelpers.h"
 #include "Matrix2x2.h"
+#include "SurfacePool.h"
 
 // Base class for objects that render to a SpriteVisual using Direct2D.
 // This class derives from OutputResource so the content can be re-rendered
@@ -25,10 +26,26 @@ public:
     // OutputResource methods.
     void ReleaseDeviceDependentResources(Output<T> const& output) override;
     void EnsureInitialized(Output<T> const& output) override;
-    void OnSettingChanged(Output<T> const& output, SettingId id) override;
+    void OnSettingsChanged(Output<T> const& output, SettingMask changedSettings) override;
 
+    // Visible sprites are re-rendered first. This is called for every dirty sprite on each
+    // flush, so it uses the cached visibility rather than asking the sprite visual.
+    bool ShouldFlushFirst() const override
+    {
+        return m_isVisible;
+    }
+
+    // Indicates the content must be re-rendered. If its extent may also have changed, call
+    // InvalidatePixelBounds as well.
     void InvalidateContent();
-    
+
+    // Indicates the bounding box of the content must be recomputed.
+    void InvalidatePixelBounds() noexcept
+    {
+        m_arePixelBoundsValid = false;
+        this->MarkDirty();
+    }
+
     // Gets the container visual, which is used for layout. The sprite visual is
     // positioned at an offset from this.
     auto& GetVisual() const noexcept
@@ -36,15 +53,20 @@ public:
         return m_containerVisual;
     }
 
-    // Getter and setter for the IsVisible property of the underlying sprite visual.
-    bool IsVisible() const
+    // Getter and setter for the IsVisible property of the underlying sprite visual. The value is
+    // cached, since the sprite visual is only changed through the setter.
+    bool IsVisible() const noexcept
     {
-        return m_spriteVisual.IsVisible();
+        return m_isVisible;
     }
 
     void IsVisible(bool value)
     {
-        m_spriteVisual.IsVisible(value);
+        if (value != m_isVisible)
+        {
+            m_spriteVisual.IsVisible(value);
+            m_isVisible = value;
+        }
     }
 
     // Getter and setter for the the IsPixelSnappingEnabled property of the underlying sprite visual.
@@ -69,9 +91,17 @@ public:
 protected:
 
     // Gets the bounding box of the content in pixels relative to origin of the container visual.
-    // The default implementation computes the bounding box by rendering the content to a command
-    // list. A derived implementation may override this method if the bounds are easily computed.
-    virtual D2D1_RECT_F GetPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform);
+    // The default implementation transforms the bounds from TryGetContentBounds if it succeeds, and
+    // otherwise renders the content to a command list and measures that.
+    virtual D2D1_RECT_F GetPixelBounds(Output<T> const& output, Matrix2x2 const& rasterTransform);
+
+    // A derived class may implement this method to supply a conservative bounding box of the
+    // content in DIPs, relative to the origin of the container visual, without rendering it.
+    // Antialiasing is allowed for by the caller. Returns false if the bounds aren't known.
+    virtual bool TryGetContentBounds(Output<T> const& /*output*/, D2D1_RECT_F& /*bounds*/)
+    {
+        return false;
+    }
 
     // A derived class must implement this method to render the content.
     virtual void RenderContent(Output<T> const& output, ID2D1DeviceContext5* deviceContext) = 0;
@@ -84,6 +114,7 @@ private:
 
     void InvalidateSurface();
     void InitializePixelBounds(Output<T> const& output);
+    D2D1_RECT_F RenderPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform);
     void SetSpriteSizeAndTransform();
     void RenderToDrawingSurface(Output<T> const& output);
     Matrix2x2 ComputeRasterTransform(Output<T> const& output) const;
@@ -92,13 +123,19 @@ private:
 
     ContainerVisual m_containerVisual = nullptr;
     SpriteVisual m_spriteVisual = nullptr;
-    CompositionDrawingSurface m_drawingSurface{ nullptr };
+    bool m_isVisible = true;
+    typename SurfacePool<T>::Allocation m_surfaceAllocation;
     bool m_isContentValid = false;
     uint32_t m_surfaceGeneration = 0;
     uint32_t m_renderGeneration = 0;
 
     Matrix2x2 m_rasterTransform;
     D2D1_RECT_F m_pixelBounds = {};
+
+    // The pixel bounds are cached until the content is changed or the raster transform differs
+    // from the one they were computed with.
+    Matrix2x2 m_pixelBoundsTransform;
+    bool m_arePixelBoundsValid = false;
 };
 
 using LiftedD2DSprite = D2DSprite<winrt::Compositor>;
@@ -6,20 +6,32 @@
 #include "FocusManager.h"
 #include "VisualTreeNode.h"
 
+namespace
+{
+    // Navigation hosts are compared by COM identity, which is the IUnknown pointer. The item
+    // holds a reference, so the pointer stays valid while it is in the list.
+    const void* IdentityOf(const winrt::InputFocusNavigationHost& navigationHost)
+    {
+        return winrt::get_abi(navigationHost.as<winrt::Windows::Foundation::IUnknown>());
+    }
+}
+
 void FocusList::AddVisual(const std::shared_ptr<VisualTreeNode>& visualNode)
 {
-    m_itemList.emplace_back(FocusListItem{ visualNode });
+    m_itemList.emplace_back();
+    SetItem(m_itemList.size() - 1, FocusListItem{ visualNode });
     visualNode->OwningFocusList(weak_from_this());
 }
 
 void FocusList::AddPlaceholder()
 {
     m_itemList.emplace_back(FocusListItem{});
+    StructureChanged();
 }
 
 void FocusList::SetChildFocusList(const std::shared_ptr<FocusList>& childList, int index)
 {
-    m_itemList[index].m_value = childList;
+    SetItem(index, FocusListItem{ childList });
 
     childList->m_parentList = weak_from_this();
 
@@ -33,7 +45,7 @@ void FocusList::SetChildSiteLink(const winrt::ChildSiteLink& link, int index)
 {
     auto navigationHost = winrt::InputFocusNavigationHost::GetForSiteLink(link);
 
-    m_itemList[index].m_value = navigationHost;
+    SetItem(index, FocusListItem{ navigationHost });
 
     if (m_managerWeak != nullptr)
     {
@@ -63,18 +75,71 @@ void FocusList::SetManager(FocusManager* manager)
 
 size_t FocusList::IndexOf(const std::shared_ptr<VisualTreeNode>& node) const
 {
-    auto iter = std::find(m_itemList.begin(), m_itemList.end(), node);
-    return std::distance(m_itemList.begin(), iter);
+    return IndexOfKey(node.get());
 }
 
 size_t FocusList::IndexOf(const std::shared_ptr<FocusList>& list) const
 {
-    auto iter = std::find(m_itemList.begin(), m_itemList.end(), list);
-    return std::distance(m_itemList.begin(), iter);
+    return IndexOfKey(list.get());
 }
 
 size_t FocusList::IndexOf(const winrt::InputFocusNavigationHost& navigationHost) const
 {
-    auto iter = std::find(m_itemList.begin(), m_itemList.end(), navigationHost);
-    return std::distance(m_itemList.begin(), iter);
+    return IndexOfKey(IdentityOf(navigationHost));
+}
+
+void FocusList::SetItem(size_t index, FocusListItem&& item)
+{
+    if (auto oldKey = IndexKey(m_itemList[index]))
+    {
+        auto iter = m_itemIndices.find(oldKey);
+        if (iter != m_itemIndices.end() && iter->second == index)
+        {
+            m_itemIndices.erase(iter);
+        }
+    }
+
+    m_itemList[index] = std::move(item);
+
+    // If an item is added more than once, keep the first index, as a search would have found.
+    if (auto newKey = IndexKey(m_itemList[index]))
+    {
+        m_itemIndices.emplace(newKey, index);
+    }
+
+    StructureChanged();
+}
+
+void FocusList::StructureChanged()
+{
+    m_structureVersion++;
+    for (auto parent = GetParent(); parent != nullptr; parent = parent->GetParent())
+    {
+        parent->m_structureVersion++;
+    }
+}
+
+/*static*/
+const void* FocusList::IndexKey(const FocusListItem& item)
+{
+    if (item.IsVisual())
+    {
+        return item.GetVisual().get();
+    }
+    else if (item.IsChildList())
+    {
+        return item.GetChildList().get();
+    }
+    else if (item.IsFocusNavigation())
+    {
+        return IdentityOf(item.GetFocusNavigation());
+    }
+
+    return nullptr;
+}
+
+size_t FocusList::IndexOfKey(const void* key) const
+{
+    auto iter = m_itemIndices.find(key);
+    return (iter != m_itemIndices.end()) ? iter->second : m_itemList.size();
 }
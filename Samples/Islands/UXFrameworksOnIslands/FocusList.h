@@ -72,12 +72,35 @@ public:
     size_t Size() const { return m_itemList.size(); }
     std::shared_ptr<FocusList> GetParent() const { return m_parentList.lock(); }
 
+    // Changes whenever an item is added to or replaced in this list or any list below it, so that
+    // the flattened tab order of a tree can tell when it needs to be rebuilt.
+    uint32_t StructureVersion() const noexcept { return m_structureVersion; }
+
+    // These return Size() if the item isn't in the list.
     size_t IndexOf(const std::shared_ptr<VisualTreeNode>& node) const;
     size_t IndexOf(const std::shared_ptr<FocusList>& list) const;
     size_t IndexOf(const winrt::InputFocusNavigationHost& navigationHost) const;
 
 private:
+    // Replaces the item at an index, keeping the reverse index up to date.
+    void SetItem(size_t index, FocusListItem&& item);
+
+    // Returns the key of an item in the reverse index, or nullptr for a placeholder.
+    static const void* IndexKey(const FocusListItem& item);
+
+    size_t IndexOfKey(const void* key) const;
+
+    // Bumps the structure version of this list and its ancestors.
+    void StructureChanged();
+
     std::vector<FocusListItem> m_itemList{};
+
+    // Maps each item in m_itemList (by its node, list, or navigation host pointer) to its index,
+    // so that looking up the focused item doesn't need to search the list.
+    std::unordered_map<const void*, size_t> m_itemIndices{};
+
+    uint32_t m_structureVersion{ 0 };
+
     std::weak_ptr<FocusList> m_parentList{};
     FocusManager* m_managerWeak{ nullptr };
 };
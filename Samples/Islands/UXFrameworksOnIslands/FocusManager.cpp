@@ -193,66 +193,105 @@ void FocusManager::NavigateWorker(
     }
 }
 
-/*static*/
 std::shared_ptr<FocusList> FocusManager::TryResolveNavigateTarget(
     const std::shared_ptr<FocusList>& currentList,
     size_t currentIndex,
     bool forward,
     size_t* outNewIndex)
 {
-    // A valid target for navigation is either a visual or a focus navigation host.
-    // These operations need to be applied to find a valid target:
-    // - If the index given is outside of the bounds ("falling off the end"), we need to navigate up
-    //   to the parent list.
-    // - If the index given is a child list, we need to navigate into that child list.
-    // - If the index given is an empty placeholder, we need to skip it.
+    // A valid target for navigation is either a visual or a focus navigation host. The tab order
+    // already has child lists expanded in place and empty placeholders skipped, so the target is
+    // just the next (or previous) tab stop from the current position.
     //
-    // If navigation ends up going off the end of the root list, then there is no valid target and
+    // If navigation ends up going off the end of the tab order, then there is no valid target and
     // will return nullptr.
 
-    std::shared_ptr<FocusList> nextList = currentList;
-    size_t nextIndex = currentIndex;
+    EnsureTabOrder();
 
-    while (nextList != nullptr)
+    auto slotsIter = m_tabOrderSlots.find(currentList.get());
+    if (slotsIter == m_tabOrderSlots.end() || slotsIter->second.list.lock() != currentList)
     {
-        if (nextIndex >= 0 && nextIndex < nextList->Size())
+        // The list isn't connected to this manager's tree.
+        return nullptr;
+    }
+
+    const auto& slots = slotsIter->second.positions;
+    size_t lastSlot = slots.size() - 1;
+
+    size_t position = 0;
+    if (forward)
+    {
+        // The first tab stop at or after the current item.
+        position = slots[std::min(currentIndex, lastSlot)];
+        if (position >= m_tabOrder.size())
         {
-            // We're in bounds.
-            auto& item = (*nextList)[nextIndex];
-            if (item.IsChildList())
-            {
-                // Try the child list next.
-                nextList = item.GetChildList();
-                nextIndex = forward ? 0 : nextList->Size() - 1;
-            }
-            else if (item.IsVisual() || item.IsFocusNavigation())
-            {
-                // Found a valid target.
-                break;
-            }
-            else
-            {
-                // Empty placeholder, skip it.
-                nextIndex += forward ? 1 : -1;
-            }
+            return nullptr;
         }
-        else
+    }
+    else
+    {
+        // The last tab stop at or before the current item. If the index has gone below zero it
+        // wraps around, and adding one brings it back to the first slot.
+        size_t slotAfter = slots[std::min(currentIndex + 1, lastSlot)];
+        if (slotAfter == 0)
         {
-            // Out of bounds.
-            // Go up to the parent and increment.
-            auto parent = nextList->GetParent();
-            if (parent != nullptr)
-            {
-                nextIndex = parent->IndexOf(nextList);
-                nextIndex += forward ? 1 : -1;
-            }
+            return nullptr;
+        }
 
-            nextList = parent;
+        position = slotAfter - 1;
+    }
+
+    const auto& tabStop = m_tabOrder[position];
+    *outNewIndex = tabStop.index;
+    return tabStop.list.lock();
+}
+
+void FocusManager::EnsureTabOrder()
+{
+    // Navigation can leave this manager's root list for the lists of parent frames, so the tab
+    // order covers the whole connected tree.
+    auto rootList = m_rootList;
+    while (auto parent = rootList->GetParent())
+    {
+        rootList = parent;
+    }
+
+    auto version = rootList->StructureVersion();
+    if (m_tabOrderRoot.lock() == rootList && m_tabOrderVersion == version)
+    {
+        return;
+    }
+
+    m_tabOrder.clear();
+    m_tabOrderSlots.clear();
+    AppendToTabOrder(rootList);
+
+    m_tabOrderRoot = rootList;
+    m_tabOrderVersion = version;
+}
+
+void FocusManager::AppendToTabOrder(const std::shared_ptr<FocusList>& list)
+{
+    auto& slots = m_tabOrderSlots[list.get()];
+    slots.list = list;
+    slots.positions.resize(list->Size() + 1);
+
+    for (size_t index = 0; index < list->Size(); index++)
+    {
+        slots.positions[index] = m_tabOrder.size();
+
+        auto& item = (*list)[index];
+        if (item.IsChildList())
+        {
+            AppendToTabOrder(item.GetChildList());
+        }
+        else if (item.IsVisual() || item.IsFocusNavigation())
+        {
+            m_tabOrder.push_back({ list, index });
         }
     }
 
-    *outNewIndex = nextIndex;
-    return nextList;
+    slots.positions[list->Size()] = m_tabOrder.size();
 }
 
 void FocusManager::DepartImpl(
@@ -47,6 +47,22 @@ public:
         size_t index);
 
 private:
+    // A visual or focus navigation host that focus can move to.
+    struct TabStop
+    {
+        std::weak_ptr<FocusList> list;
+        size_t index;
+    };
+
+    // For a list in the tab order, the position in m_tabOrder of the first tab stop at or after
+    // each of its items. The extra last entry is the position of the first tab stop after the whole
+    // list.
+    struct TabOrderSlots
+    {
+        std::weak_ptr<FocusList> list;
+        std::vector<size_t> positions;
+    };
+
     const FocusListItem& CurrentItem() const { return (*m_focusedList)[m_focusedIndex]; }
 
     // The actual navigation implementation. This moves focus to a specific index in a specific list.
@@ -58,15 +74,19 @@ private:
         size_t currentIndex,
         bool forward);
 
-    // This helper does the walk through the tree of FocusLists to find a valid target.
+    // This helper finds a valid target by looking up the flattened tab order of the tree of
+    // FocusLists, rather than walking it.
     // If no target is found it will return nullptr.
     // 'currentIndex' does not need to be in bounds.
-    static std::shared_ptr<FocusList> TryResolveNavigateTarget(
+    std::shared_ptr<FocusList> TryResolveNavigateTarget(
         const std::shared_ptr<FocusList>& currentList,
         size_t currentIndex,
         bool forward,
         size_t* outNewIndex);
 
+    void EnsureTabOrder();
+    void AppendToTabOrder(const std::shared_ptr<FocusList>& list);
+
     // Depart focus to the parent frame / focus host of the focus manager.
     void DepartImpl(bool forward);
 
@@ -76,6 +96,18 @@ private:
     std::shared_ptr<FocusList> m_focusedList{};
     size_t m_focusedIndex{ 0 };
 
+    // Every tab stop in the tree, in the order that forward navigation visits them.
+    std::vector<TabStop> m_tabOrder{};
+
+    // The slots of each list in the tab order, looked up by address. The weak reference tells a
+    // list in the tree apart from a later one that reuses its address.
+    std::unordered_map<const FocusList*, TabOrderSlots> m_tabOrderSlots{};
+
+    // The root of the tree that the tab order was built from, and its FocusList::StructureVersion()
+    // at the time.
+    std::weak_ptr<FocusList> m_tabOrderRoot{};
+    std::optional<uint32_t> m_tabOrderVersion{};
+
     // Only one of these two will be valid depending on how the focus manager was initialized.
     winrt::InputFocusController m_focusController{ nullptr };
     IFocusHost* m_focusHost{ nullptr };
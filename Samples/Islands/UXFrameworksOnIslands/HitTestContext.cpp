@@ -34,7 +34,7 @@ void HitTestContext::RunHitTest(
             if (auto& callback = currentNode->HitTestCallback())
             {
                 std::optional<winrt::Point> localPoint = TryConvertToLocalPoint(
-                    currentNode->Transform4x4(),
+                    currentNode->InverseTransform4x4(),
                     point);
                 if (localPoint.has_value())
                 {
@@ -96,18 +96,16 @@ bool HitTestContext::ForwardToCrossTree(
 
 /*static*/
 std::optional<winrt::Point> HitTestContext::TryConvertToLocalPoint(
-    const winrt::float4x4& localToRootTransform,
+    const std::optional<winrt::float4x4>& rootToLocalTransform,
     const winrt::Point& point)
 {
-    winrt::float4x4 rootToLocalTransform;
-    bool success = winrt::invert(localToRootTransform, &rootToLocalTransform);
-    if (!success)
+    // The node caches its inverse transform whenever the transform changes, so there's no need to
+    // invert it here.
+    if (!rootToLocalTransform.has_value())
     {
         return std::nullopt;
     }
 
-    winrt::float2 rootPoint = winrt::float2{ point.X, point.Y };
-    winrt::float2 localPoint = winrt::transform(rootPoint, rootToLocalTransform);
-
+    auto localPoint = winrt::transform(winrt::float2{ point.X, point.Y }, *rootToLocalTransform);
     return winrt::Point{ localPoint.x, localPoint.y };
 }
@@ -30,7 +30,7 @@ private:
 
     // Returns nullopt if a conversion can't be done - for example the transform isn't invertible.
     static std::optional<winrt::Point> TryConvertToLocalPoint(
-        const winrt::float4x4& localToRootTransform,
+        const std::optional<winrt::float4x4>& rootToLocalTransform,
         const winrt::Point& point);
 
     winrt::Point m_point;
@@ -0,0 +1,260 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "HitTestIndex.h"
+
+namespace
+{
+    // Number of nodes stored in a single leaf of the bounding volume hierarchy.
+    constexpr uint32_t c_maxLeafSize = 4;
+
+    // Capacity of the traversal stack that HitTest keeps on the machine stack. A traversal never
+    // holds more than one entry per level plus one, and median splits keep the depth of the
+    // hierarchy near log2 of the node count, so this is only exceeded by a hierarchy deeper than
+    // any that Build can produce.
+    constexpr uint32_t c_fixedStackSize = 64;
+
+    // Bounds are computed by transforming the corners forward, while hit testing transforms the
+    // point backward through the inverse. Pad the bounds so that rounding differences between the
+    // two never cause the hierarchy to reject a point that the inverse transform would accept.
+    float BoundsTolerance(float value) noexcept
+    {
+        return std::max(0.01f, std::fabs(value) * 1e-4f);
+    }
+
+    bool ContainsPoint(
+        float left, float top, float right, float bottom,
+        const winrt::float2& point) noexcept
+    {
+        return point.x >= left && point.x <= right && point.y >= top && point.y <= bottom;
+    }
+}
+
+void HitTestIndex::Build(std::vector<Entry>&& entries)
+{
+    m_entries = std::move(entries);
+    m_primitives.clear();
+    m_bvhNodes.clear();
+    m_depth = 0;
+
+    for (uint32_t index = 0; index < m_entries.size(); index++)
+    {
+        auto& entry = m_entries[index];
+
+        // A node can only be hit within the bounds of all of its ancestors, so clip its bounds to
+        // its parent's. The parent comes earlier in pre-order, so it has already been clipped.
+        if (entry.parentIndex >= 0)
+        {
+            const auto& parentBounds = m_entries[entry.parentIndex].bounds;
+            auto left = std::max(entry.bounds.X, parentBounds.X);
+            auto top = std::max(entry.bounds.Y, parentBounds.Y);
+            auto right = std::min(entry.bounds.X + entry.bounds.Width, parentBounds.X + parentBounds.Width);
+            auto bottom = std::min(entry.bounds.Y + entry.bounds.Height, parentBounds.Y + parentBounds.Height);
+            entry.bounds = winrt::Rect{ left, top, right - left, bottom - top };
+        }
+
+        // Nodes that can never be hit are left out of the hierarchy, but are still kept in
+        // m_entries so that their descendants can be checked against them.
+        if (entry.isInvertible && entry.size.x > 0.0f && entry.size.y > 0.0f &&
+            entry.bounds.Width >= 0.0f && entry.bounds.Height >= 0.0f)
+        {
+            m_primitives.push_back(index);
+        }
+    }
+
+    if (!m_primitives.empty())
+    {
+        m_bvhNodes.reserve(2 * (m_primitives.size() / c_maxLeafSize + 1));
+        m_bvhNodes.push_back({});
+        BuildNode(0, 0, static_cast<uint32_t>(m_primitives.size()), 0);
+        WINRT_ASSERT(m_depth < c_fixedStackSize);
+    }
+}
+
+void HitTestIndex::Clear() noexcept
+{
+    m_entries.clear();
+    m_primitives.clear();
+    m_bvhNodes.clear();
+    m_depth = 0;
+}
+
+std::shared_ptr<VisualTreeNode> HitTestIndex::HitTest(const winrt::Point& point) const
+{
+    auto rootPoint = winrt::float2{ point.X, point.Y };
+
+    // If the subtree root isn't hit, then nothing under it can be either.
+    if (m_bvhNodes.empty() || !IsHit(0, rootPoint))
+    {
+        return nullptr;
+    }
+
+    // Search for the last node in pre-order that is hit, along with all of its ancestors, since
+    // that is the topmost one. Each hierarchy node records the largest pre-order index beneath it,
+    // so the search visits the later subtree first and skips anything that can't beat the best
+    // hit so far. Each step pops one hierarchy node and pushes at most two, so the stack never
+    // holds more than one entry per level plus one.
+    int bestIndex = -1;
+    std::array<uint32_t, c_fixedStackSize> fixedStack;
+    std::vector<uint32_t> heapStack;
+    auto stack = fixedStack.data();
+    if (m_depth + 1 > c_fixedStackSize)
+    {
+        heapStack.resize(m_depth + 1);
+        stack = heapStack.data();
+    }
+
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const auto& bvhNode = m_bvhNodes[stack[--stackSize]];
+        if (static_cast<int>(bvhNode.maxIndex) <= bestIndex ||
+            !ContainsPoint(bvhNode.left, bvhNode.top, bvhNode.right, bvhNode.bottom, rootPoint))
+        {
+            continue;
+        }
+
+        if (bvhNode.count == 0)
+        {
+            const auto& first = m_bvhNodes[bvhNode.first];
+            const auto& second = m_bvhNodes[bvhNode.first + 1];
+            bool firstIsLater = first.maxIndex > second.maxIndex;
+            stack[stackSize++] = firstIsLater ? bvhNode.first + 1 : bvhNode.first;
+            stack[stackSize++] = firstIsLater ? bvhNode.first : bvhNode.first + 1;
+            continue;
+        }
+
+        // Leaves are sorted by descending pre-order index, so the first hit is the best one.
+        for (uint32_t i = bvhNode.first; i < bvhNode.first + bvhNode.count; i++)
+        {
+            auto index = static_cast<int>(m_primitives[i]);
+            if (index <= bestIndex)
+            {
+                break;
+            }
+
+            const auto& bounds = m_entries[index].bounds;
+            auto left = bounds.X - BoundsTolerance(bounds.X);
+            auto top = bounds.Y - BoundsTolerance(bounds.Y);
+            auto right = bounds.X + bounds.Width + BoundsTolerance(bounds.X + bounds.Width);
+            auto bottom = bounds.Y + bounds.Height + BoundsTolerance(bounds.Y + bounds.Height);
+            if (ContainsPoint(left, top, right, bottom, rootPoint) && IsHit(index, rootPoint))
+            {
+                bestIndex = index;
+                break;
+            }
+        }
+    }
+
+    return (bestIndex >= 0) ? m_entries[bestIndex].node.lock() : nullptr;
+}
+
+void HitTestIndex::BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth)
+{
+    m_depth = std::max(m_depth, depth);
+
+    BvhNode bvhNode{
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest(),
+        begin,
+        end - begin,
+        0 };
+
+    auto centerLeft = std::numeric_limits<float>::max();
+    auto centerTop = std::numeric_limits<float>::max();
+    auto centerRight = std::numeric_limits<float>::lowest();
+    auto centerBottom = std::numeric_limits<float>::lowest();
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bvhNode.maxIndex = std::max(bvhNode.maxIndex, m_primitives[i]);
+
+        const auto& bounds = m_entries[m_primitives[i]].bounds;
+        auto right = bounds.X + bounds.Width;
+        auto bottom = bounds.Y + bounds.Height;
+
+        bvhNode.left = std::min(bvhNode.left, bounds.X - BoundsTolerance(bounds.X));
+        bvhNode.top = std::min(bvhNode.top, bounds.Y - BoundsTolerance(bounds.Y));
+        bvhNode.right = std::max(bvhNode.right, right + BoundsTolerance(right));
+        bvhNode.bottom = std::max(bvhNode.bottom, bottom + BoundsTolerance(bottom));
+
+        auto centerX = bounds.X + (bounds.Width / 2.0f);
+        auto centerY = bounds.Y + (bounds.Height / 2.0f);
+        centerLeft = std::min(centerLeft, centerX);
+        centerTop = std::min(centerTop, centerY);
+        centerRight = std::max(centerRight, centerX);
+        centerBottom = std::max(centerBottom, centerY);
+    }
+
+    if (end - begin > c_maxLeafSize)
+    {
+        // Split at the median along the axis where the node centers are most spread out.
+        bool splitOnX = (centerRight - centerLeft) >= (centerBottom - centerTop);
+        auto middle = begin + ((end - begin) / 2);
+        std::nth_element(
+            m_primitives.begin() + begin,
+            m_primitives.begin() + middle,
+            m_primitives.begin() + end,
+            [this, splitOnX](uint32_t lhs, uint32_t rhs)
+            {
+                const auto& a = m_entries[lhs].bounds;
+                const auto& b = m_entries[rhs].bounds;
+                return splitOnX ?
+                    (a.X + (a.Width / 2.0f)) < (b.X + (b.Width / 2.0f)) :
+                    (a.Y + (a.Height / 2.0f)) < (b.Y + (b.Height / 2.0f));
+            });
+
+        auto firstChild = static_cast<uint32_t>(m_bvhNodes.size());
+        m_bvhNodes.push_back({});
+        m_bvhNodes.push_back({});
+
+        bvhNode.first = firstChild;
+        bvhNode.count = 0;
+        m_bvhNodes[nodeIndex] = bvhNode;
+
+        BuildNode(firstChild, begin, middle, depth + 1);
+        BuildNode(firstChild + 1, middle, end, depth + 1);
+        return;
+    }
+
+    std::sort(
+        m_primitives.begin() + begin,
+        m_primitives.begin() + end,
+        std::greater<uint32_t>());
+
+    m_bvhNodes[nodeIndex] = bvhNode;
+}
+
+bool HitTestIndex::ContainsLocalPoint(const Entry& entry, const winrt::float2& point) const noexcept
+{
+    if (!entry.isInvertible)
+    {
+        // For now, hit testing is not supported if the transform is not invertible.
+        return false;
+    }
+
+    auto localPoint = winrt::transform(point, entry.inverseTransform);
+    return !(localPoint.x < 0.0f || localPoint.x >= entry.size.x ||
+        localPoint.y < 0.0f || localPoint.y >= entry.size.y);
+}
+
+bool HitTestIndex::IsHit(int index, const winrt::float2& point) const noexcept
+{
+    // A node is only hit if the point is also within the bounds of each of its ancestors.
+    while (index >= 0)
+    {
+        const auto& entry = m_entries[index];
+        if (!ContainsLocalPoint(entry, point))
+        {
+            return false;
+        }
+
+        index = entry.parentIndex;
+    }
+
+    return true;
+}
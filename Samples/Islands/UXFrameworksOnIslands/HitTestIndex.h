@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+struct VisualTreeNode;
+
+// A flattened snapshot of a VisualTreeNode subtree that answers hit tests without visiting every
+// node. Nodes are stored in pre-order (children in z-order), and a bounding volume hierarchy is
+// built over their bounds in tree root coordinates.
+//
+// A hit test searches the hierarchy for the last node in pre-order whose bounds contain the point,
+// confirming each candidate (and its ancestors) against the cached inverse transforms. This finds
+// the same node as a recursive walk of the children in reverse z-order.
+class HitTestIndex
+{
+public:
+    struct Entry
+    {
+        std::weak_ptr<VisualTreeNode> node{};
+        winrt::float4x4 inverseTransform{ winrt::float4x4::identity() };
+        winrt::float2 size{ 0.0f, 0.0f };
+        winrt::Rect bounds{};
+        int parentIndex{ -1 };
+        bool isInvertible{ true };
+    };
+
+    // Replaces the contents of the index. The entries must be in pre-order, and each entry's
+    // parentIndex must refer to an earlier entry (or be -1 for the subtree root).
+    void Build(std::vector<Entry>&& entries);
+
+    void Clear() noexcept;
+
+    std::shared_ptr<VisualTreeNode> HitTest(const winrt::Point& point) const;
+
+    size_t Size() const noexcept { return m_entries.size(); }
+
+private:
+    struct BvhNode
+    {
+        float left;
+        float top;
+        float right;
+        float bottom;
+
+        // For leaves, the range [first, first + count) of m_primitives. For interior nodes,
+        // count is 0 and the children are at first and first + 1 in m_bvhNodes.
+        uint32_t first;
+        uint32_t count;
+
+        // The largest index into m_entries of any node beneath this one.
+        uint32_t maxIndex;
+    };
+
+    void BuildNode(uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth);
+
+    bool ContainsLocalPoint(const Entry& entry, const winrt::float2& point) const noexcept;
+    bool IsHit(int index, const winrt::float2& point) const noexcept;
+
+    std::vector<Entry> m_entries{};
+    std::vector<uint32_t> m_primitives{};
+    std::vector<BvhNode> m_bvhNodes{};
+
+    // The number of levels in m_bvhNodes below the root, which bounds the traversal stack.
+    uint32_t m_depth{ 0 };
+};
@@ -9,7 +9,7 @@ LiftedFrame::LiftedFrame(const winrt::Compositor& compositor, const std::shared_
 {
     auto rootVisual = compositor.CreateContainerVisual();
     rootVisual.RelativeSizeAdjustment({1.0f, 1.0f});
-    m_rootVisualTreeNode = VisualTreeNode::Create(rootVisual.as<::IUnknown>());
+    m_rootVisualTreeNode = VisualTreeNode::Create(rootVisual.as<::IUnknown>(), VisualTreeNodePool::Create());
     m_island = winrt::ContentIsland::Create(rootVisual);
     m_automationTree = AutomationTree::Create(this, L"LiftedFrame", UIA_PaneControlTypeId);
 
@@ -37,14 +37,20 @@ LiftedFrame::LiftedFrame(const winrt::Compositor& compositor, const std::shared_
     HandleContentLayout();
 }
 
-void LiftedFrame::OnSettingChanged(SettingId id)
+void LiftedFrame::OnSettingsChanged(SettingMask changedSettings)
 {
-    GetOutput().GetResourceList()->OnSettingChanged(GetOutput(), id);
+    GetOutput().GetResourceList()->OnSettingsChanged(GetOutput(), changedSettings);
 
-    if (id == Setting_DisablePixelSnapping || id == Setting_ShowPopupVisual)
+    // These settings also change layout, so they need a layout pass. Either way, only the
+    // resources the change invalidated are initialized.
+    if ((changedSettings & (SettingMaskOf(Setting_DisablePixelSnapping) | SettingMaskOf(Setting_ShowPopupVisual))) != 0)
     {
         HandleContentLayout();
     }
+    else
+    {
+        GetOutput().GetResourceList()->FlushDirty(GetOutput());
+    }
 }
 
 winrt::ChildSiteLink LiftedFrame::ConnectChildFrame(
@@ -94,10 +100,14 @@ winrt::DesktopPopupSiteBridge LiftedFrame::ConnectPopupFrame(
 
 void LiftedFrame::HandleContentLayout()
 {
-    GetOutput().GetResourceList()->EnsureInitialized(GetOutput());
+    GetOutput().BeginFrame();
+    GetOutput().GetResourceList()->FlushDirty(GetOutput());
+    GetOutput().EndFrame();
     
+    // Layout may have changed the visuals directly. Their geometry is recomputed when it is next
+    // read or hit tested, once for all of the changes.
     m_rootVisualTreeNode->Size(m_island.ActualSize());
-    m_rootVisualTreeNode->ComputeSizeAndTransform();
+    m_rootVisualTreeNode->MarkSizeAndTransformDirty();
 }
 
 void LiftedFrame::OnPreTranslateDirectMessage(
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 struct Matrix2x2
 {
     Matrix2x2(float m11, float m12, float m21, float m22) noexcept :
@@ -62,6 +64,23 @@ struct Matrix2x2
         return Matrix2x2(matrix);
     }
 
+    // Computes the axis-aligned bounds of a rectangle after it has been transformed.
+    D2D1_RECT_F TransformBounds(D2D1_RECT_F const& rect) const noexcept
+    {
+        // Each output coordinate is a sum of one term per input coordinate, so its extremes come
+        // from the smaller and larger of each term.
+        float x1 = rect.left * m11, x2 = rect.right * m11;
+        float x3 = rect.top * m21, x4 = rect.bottom * m21;
+        float y1 = rect.left * m12, y2 = rect.right * m12;
+        float y3 = rect.top * m22, y4 = rect.bottom * m22;
+        return {
+            std::min(x1, x2) + std::min(x3, x4),
+            std::min(y1, y2) + std::min(y3, y4),
+            std::max(x1, x2) + std::max(x3, x4),
+            std::max(y1, y2) + std::max(y3, y4)
+        };
+    }
+
     bool operator==(Matrix2x2 const& rhs) const noexcept
     {
         return m11 == rhs.m11 && m12 == rhs.m12 && m21 == rhs.m21 && m22 == rhs.m22;
@@ -7,7 +7,8 @@ template<class T>
 Output<T>::Output(T const& compositor, std::shared_ptr<SettingCollection> const& settings) :
     m_compositor(compositor),
     m_settings(settings),
-    m_compositionDevice(m_resourceList, m_dxDevice.GetD2DDevice().get(), compositor)
+    m_compositionDevice(m_resourceList, m_dxDevice.GetD2DDevice().get(), compositor),
+    m_surfacePool(std::make_shared<SurfacePool<T>>(m_resourceList))
 {
     RegisterForDeviceLost();
 }
@@ -21,7 +22,35 @@ Output<T>::~Output()
 template<class T>
 void Output<T>::SetRasterizationTransform(Matrix2x2 const& value)
 {
-    m_rasterizationTransform = value;
+    // Every sprite's raster transform includes this one, so they all need to be initialized again.
+    if (value != m_rasterizationTransform)
+    {
+        m_rasterizationTransform = value;
+        m_resourceList->MarkAllDirty();
+    }
+}
+
+template<class T>
+void Output<T>::BeginFrame()
+{
+    m_spriteBoundsStatistics = {};
+    m_rasterTransformCache.Invalidate();
+}
+
+template<class T>
+void Output<T>::EndFrame() const
+{
+    if (!IsDebuggerPresent())
+    {
+        return;
+    }
+
+    auto& bounds = m_spriteBoundsStatistics;
+    auto& transforms = m_rasterTransformCache.GetStatistics();
+    wchar_t message[160];
+    swprintf_s(message, L"Sprite bounds: %u rendered, %u analytic, %u cached. Raster transforms: %u visuals computed, %u cache hits\n",
+        bounds.boundsRenders, bounds.analyticBounds, bounds.cachedBounds, transforms.visualsComputed, transforms.cacheHits);
+    OutputDebugStringW(message);
 }
 
 template<class T>
@@ -6,6 +6,8 @@
 #include "DXDevice.h"
 #include "CompositionDeviceResource.h"
 #include "Matrix2x2.h"
+#include "SurfacePool.h"
+#include "RasterTransformCache.h"
 
 // Encapsulates objects used to render output for a particular island.
 // Use the LiftedOutputResource typedef for lifted islands.
@@ -27,10 +29,34 @@ public:
     auto& GetCompositor() const noexcept { return m_compositor; }
     auto& GetDXDevice() const noexcept { return m_dxDevice; }
     auto& GetCompositionGraphicsDevice() const noexcept { return m_compositionDevice.GetCompositionGraphicsDevice(); }
+    auto& GetSurfacePool() const noexcept { return m_surfacePool; }
 
     auto& GetRasterizationTransform() const noexcept { return m_rasterizationTransform; }
+    // Setting a different transform marks every resource dirty.
     void SetRasterizationTransform(Matrix2x2 const& value);
 
+    // Counts of how sprites got their pixel bounds since the last call to BeginFrame, for
+    // diagnostics. Sprites are only given a const Output, so the counts are mutable.
+    struct SpriteBoundsStatistics
+    {
+        uint32_t boundsRenders = 0;  // Content rendered to a command list to measure it
+        uint32_t analyticBounds = 0; // Computed from the sprite's own metrics
+        uint32_t cachedBounds = 0;   // Reused because neither the content nor the transform changed
+    };
+
+    auto& GetSpriteBoundsStatistics() const noexcept { return m_spriteBoundsStatistics; }
+
+    // Transforms from visuals to the root of the island, shared by all of the output's sprites.
+    auto& GetRasterTransformCache() const noexcept { return m_rasterTransformCache; }
+
+    // Called at the start of each layout pass. Layout may change any visual's transform, so this
+    // invalidates the raster transform cache.
+    void BeginFrame();
+
+    // Called at the end of each layout pass, once the dirty resources have been flushed. If a
+    // debugger is attached, this writes the frame's statistics to it.
+    void EndFrame() const;
+
 private:
     winrt::fire_and_forget RegisterForDeviceLost();
     void UnregisterFromDeviceLost();
@@ -41,9 +67,15 @@ private:
     DXDevice m_dxDevice;
     CompositionDeviceResource<T> m_compositionDevice;
 
+    // Created after the composition device, so it's notified of device loss after every sprite
+    // has returned its surface, but before the composition device.
+    std::shared_ptr<SurfacePool<T>> m_surfacePool;
+
     winrt::com_ptr<ID3D11Device4> m_registeredDevice;
     wil::unique_event m_deviceRemovedEventHandle{ wil::EventOptions::ManualReset };
     DWORD m_deviceRemovedEventRegistrationCookie = 0;
 
     Matrix2x2 m_rasterizationTransform;
+    mutable SpriteBoundsStatistics m_spriteBoundsStatistics;
+    mutable RasterTransformCache<T> m_rasterTransformCache;
 };
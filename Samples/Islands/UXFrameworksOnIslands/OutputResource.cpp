@@ -16,20 +16,112 @@ void OutputResourceList<T>::ReleaseDeviceDependentResources(Output<T> const& out
 template<class T>
 void OutputResourceList<T>::EnsureInitialized(Output<T> const& output)
 {
-    // Iterate in order of creation.
+    // Iterate in order of creation. This also takes each resource out of the dirty queue.
     for (auto* p = m_first; p != nullptr; p = p->m_next)
     {
-        p->EnsureInitialized(output);
+        InitializeResource(output, p);
+    }
+}
+
+template<class T>
+void OutputResourceList<T>::FlushDirty(Output<T> const& output)
+{
+    // Move the dirty resources that should go first, such as visible sprites, to the front of the
+    // queue, keeping their order. ShouldFlushFirst doesn't change the queue, so the walk can keep
+    // its next link.
+    OutputResource<T>* lastFirst = nullptr;
+    for (auto* p = m_firstDirty; p != nullptr;)
+    {
+        auto* next = p->m_nextDirty;
+        if (p->ShouldFlushFirst())
+        {
+            RemoveDirty(p);
+            InsertDirty(p, lastFirst);
+            lastFirst = p;
+        }
+        p = next;
+    }
+
+    // Then initialize from the head of the queue. A resource's initialization can mark others
+    // dirty or destroy them, so read the head again each time rather than keeping a link into the
+    // queue. Resources marked dirty during the flush are initialized by it.
+    while (m_firstDirty != nullptr)
+    {
+        InitializeResource(output, m_firstDirty);
+    }
+}
+
+template<class T>
+void OutputResourceList<T>::MarkAllDirty() noexcept
+{
+    // Iterate in order of creation. Resources that are already dirty keep their place.
+    for (auto* p = m_first; p != nullptr; p = p->m_next)
+    {
+        p->MarkDirty();
+    }
+}
+
+template<class T>
+void OutputResourceList<T>::InitializeResource(Output<T> const& output, OutputResource<T>* resource)
+{
+    RemoveDirty(resource);
+
+    // Initialization can nest, if a resource's EnsureInitialized leads to the list being
+    // initialized or flushed again, so restore the outer resource afterwards.
+    auto* previous = m_initializing;
+    m_initializing = resource;
+    auto restoreInitializing = wil::scope_exit([&] { m_initializing = previous; });
+    resource->EnsureInitialized(output);
+}
+
+template<class T>
+void OutputResourceList<T>::InsertDirty(OutputResource<T>* resource, OutputResource<T>* after) noexcept
+{
+    // Insert after the given resource, or at the front of the queue if it's null.
+    resource->m_prevDirty = after;
+    resource->m_nextDirty = after != nullptr ? after->m_nextDirty : m_firstDirty;
+
+    OutputResource<T>*& forwardLink = after != nullptr ? after->m_nextDirty : m_firstDirty;
+    forwardLink = resource;
+
+    OutputResource<T>*& backLink = resource->m_nextDirty != nullptr ?
+        resource->m_nextDirty->m_prevDirty :
+        m_lastDirty;
+    backLink = resource;
+
+    resource->m_isDirty = true;
+}
+
+template<class T>
+void OutputResourceList<T>::RemoveDirty(OutputResource<T>* resource) noexcept
+{
+    if (!resource->m_isDirty)
+    {
+        return;
     }
+
+    OutputResource<T>*& forwardLink = resource->m_prevDirty != nullptr ?
+        resource->m_prevDirty->m_nextDirty :
+        m_firstDirty;
+    forwardLink = resource->m_nextDirty;
+
+    OutputResource<T>*& backLink = resource->m_nextDirty != nullptr ?
+        resource->m_nextDirty->m_prevDirty :
+        m_lastDirty;
+    backLink = resource->m_prevDirty;
+
+    resource->m_prevDirty = nullptr;
+    resource->m_nextDirty = nullptr;
+    resource->m_isDirty = false;
 }
 
 template<class T>
-void OutputResourceList<T>::OnSettingChanged(Output<T> const& output, SettingId id)
+void OutputResourceList<T>::OnSettingsChanged(Output<T> const& output, SettingMask changedSettings)
 {
     // Iterate in order of creation.
     for (auto* p = m_first; p != nullptr; p = p->m_next)
     {
-        p->OnSettingChanged(output, id);
+        p->OnSettingsChanged(output, changedSettings);
     }
 }
 
@@ -67,6 +159,21 @@ OutputResource<T>::~OutputResource()
         m_next->m_prev :
         m_resourceList->m_last;
     backLink = m_prev;
+
+    m_resourceList->RemoveDirty(this);
+}
+
+template<class T>
+void OutputResource<T>::MarkDirty() noexcept
+{
+    // Already queued, or being initialized right now.
+    if (m_isDirty || m_resourceList->m_initializing == this)
+    {
+        return;
+    }
+
+    // Append to the dirty queue.
+    m_resourceList->InsertDirty(this, m_resourceList->m_lastDirty);
 }
 
 // Explicit template instantiation.
@@ -23,6 +23,10 @@ using SystemOutputResource = OutputResource<winrt::WUC::Compositor>;
 //       affect the lifetime of the objects in the list. It merely keeps track of the objects
 //       that do exist. Each OutputResource adds itself to the list in its constructor and
 //       removes itself from the list in its destructor.
+//
+// The list also keeps a queue of dirty resources: those that have called MarkDirty since they
+// were last initialized, including new ones. FlushDirty initializes only those, so neither a
+// change to one resource nor a layout pass costs a walk over all of them.
 template <class T>
 class OutputResourceList
 {
@@ -31,17 +35,44 @@ public:
     // Invokes ReleaseDeviceDependentResources on each OutputResource in reverse order of creation.
     void ReleaseDeviceDependentResources(Output<T> const& output);
 
-    // Invokes EnsureInitialized on each OutputResource in order of creation.
+    // Invokes EnsureInitialized on each OutputResource in order of creation. This is needed when
+    // the device has been recreated.
     void EnsureInitialized(Output<T> const& output);
 
-    // Invokes OnSettingChanged on each OutputResource in order of creation.
-    void OnSettingChanged(Output<T> const& output, SettingId id);
+    // Invokes EnsureInitialized on each dirty OutputResource. Those that return true from
+    // ShouldFlushFirst are initialized first; otherwise resources are initialized in the order
+    // they were marked dirty. Resources marked dirty by another's initialization, or destroyed
+    // by it, are handled by the same flush.
+    void FlushDirty(Output<T> const& output);
+
+    // Marks every OutputResource dirty, for changes that every resource may depend on but that
+    // none of them can see, such as the output's rasterization transform.
+    void MarkAllDirty() noexcept;
+
+    // Invokes OnSettingsChanged on each OutputResource in order of creation.
+    void OnSettingsChanged(Output<T> const& output, SettingMask changedSettings);
+
+    bool HasDirtyResources() const noexcept
+    {
+        return m_firstDirty != nullptr;
+    }
 
 private:
     friend class OutputResource<T>;
 
+    void InitializeResource(Output<T> const& output, OutputResource<T>* resource);
+    void InsertDirty(OutputResource<T>* resource, OutputResource<T>* after) noexcept;
+    void RemoveDirty(OutputResource<T>* resource) noexcept;
+
     OutputResource<T>* m_first = nullptr;
     OutputResource<T>* m_last = nullptr;
+
+    OutputResource<T>* m_firstDirty = nullptr;
+    OutputResource<T>* m_lastDirty = nullptr;
+
+    // The resource whose EnsureInitialized is running. Invalidation it does to itself while
+    // initializing doesn't make it dirty again.
+    OutputResource<T>* m_initializing = nullptr;
 };
 
 // OutputResource is the base class for objects that own device-dependent resources or that
@@ -50,7 +81,8 @@ template<class T>
 class OutputResource
 {
 public:
-    // The ctor adds OutputResource to the OutputResourceList.
+    // The ctor adds OutputResource to the OutputResourceList. It isn't dirty until it calls
+    // MarkDirty.
     OutputResource(std::shared_ptr<OutputResourceList<T>> const& resourceList) noexcept;
 
     // The dtor removes the OutputResource from the OutputResourceList.
@@ -72,15 +104,30 @@ public:
     {
     }
 
-    virtual void OnSettingChanged(Output<T> const&, SettingId)
+    virtual void OnSettingsChanged(Output<T> const&, SettingMask)
     {
     }
 
+    // Dirty resources that return true are initialized before the rest when the list is flushed.
+    virtual bool ShouldFlushFirst() const
+    {
+        return false;
+    }
+
+protected:
+    // Adds the resource to the list's dirty queue, so it's initialized by the next flush.
+    void MarkDirty() noexcept;
+
 private:
     friend class OutputResourceList<T>;
     std::shared_ptr<OutputResourceList<T>> m_resourceList;
     OutputResource<T>* m_prev = nullptr;
     OutputResource<T>* m_next = nullptr;
+
+    // Links in the dirty queue, valid while m_isDirty is true.
+    OutputResource<T>* m_prevDirty = nullptr;
+    OutputResource<T>* m_nextDirty = nullptr;
+    bool m_isDirty = false;
 };
 using LiftedOutputResourceList = OutputResourceList<winrt::Compositor>;
 using SystemOutputResourceList = OutputResourceList<winrt::WUC::Compositor>;
@@ -95,9 +95,6 @@ void PopupFrame::OnClick(
 
     // Create our 10x10 blue square
     auto blueVisual = compositor.CreateSpriteVisual();
-    auto blueVisualNode = VisualTreeNode::Create(blueVisual.as<::IUnknown>());
-    m_clickSquareRoot->AddChild(blueVisualNode);
-
     blueVisual.Size({10.0f, 10.0f});
 
     // Color it blue
@@ -113,6 +110,10 @@ void PopupFrame::OnClick(
     {
         blueVisual.Offset({point.Position().X - 5.0f, point.Position().Y - 5.0f, 0.0});
     }
+
+    // Add it once it is positioned, so that its node's geometry is computed from its final place.
+    auto blueVisualNode = VisualTreeNode::Create(blueVisual.as<::IUnknown>());
+    m_clickSquareRoot->AddChild(blueVisualNode);
 }
 
 void PopupFrame::OnKeyPress(
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "RasterTransformCache.h"
+
+template<class T>
+winrt::Windows::Foundation::Numerics::float4x4 RasterTransformCache<T>::GetWorldTransform(ContainerVisual const& visual)
+{
+    using namespace winrt::Windows::Foundation::Numerics;
+
+    // Walk up from the visual until we reach one with a current entry, or the root.
+    auto matrix = float4x4::identity();
+    m_uncachedVisuals.clear();
+    for (auto current = visual; current != nullptr; current = current.Parent())
+    {
+        auto it = m_entries.find(winrt::get_abi(current));
+        if (it != m_entries.end() && it->second.generation == m_generation)
+        {
+            matrix = it->second.transform;
+            m_statistics.cacheHits++;
+            break;
+        }
+
+        m_uncachedVisuals.push_back(current);
+    }
+
+    // Compute the visuals we passed from the top down. Each one's aggregate transform is its local
+    // transform followed by its parent's aggregate transform.
+    for (auto it = m_uncachedVisuals.rbegin(); it != m_uncachedVisuals.rend(); ++it)
+    {
+        auto& current = *it;
+
+        // Compute a local transform from the visual's properties.
+        auto visualTransform = make_float4x4_scale(current.Scale());
+        visualTransform *= make_float4x4_from_axis_angle(current.RotationAxis(), current.RotationAngle());
+        visualTransform *= current.TransformMatrix();
+
+        matrix = visualTransform * matrix;
+
+        auto& entry = m_entries[winrt::get_abi(current)];
+        if (entry.visual == nullptr)
+        {
+            entry.visual = current;
+        }
+        entry.transform = matrix;
+        entry.generation = m_generation;
+        m_statistics.visualsComputed++;
+    }
+
+    m_uncachedVisuals.clear();
+    return matrix;
+}
+
+template<class T>
+void RasterTransformCache<T>::Invalidate()
+{
+    // Discard entries for visuals that weren't used, such as ones that have been removed, so the
+    // cache doesn't grow without bound.
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        it = it->second.generation != m_generation ? m_entries.erase(it) : std::next(it);
+    }
+
+    m_generation++;
+    m_statistics = {};
+}
+
+// Explicit template instantiation.
+template class RasterTransformCache<winrt::Compositor>;
+template class RasterTransformCache<winrt::WUC::Compositor>;
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+#include "TemplateHelpers.h"
+
+// Caches the aggregate transform from each container visual to the root of its visual tree, so
+// that sprites don't each walk all of their ancestors. A visual's entry is computed from its own
+// properties and its parent's entry, so sibling sprites share their ancestors' entries and each
+// visual's properties are read at most once per generation.
+//
+// The compositor doesn't report property changes, so the owner must call Invalidate after any
+// visual's scale, rotation or transform matrix changes, or after a visual is reparented. Output
+// does this at the start of each layout pass. Each entry holds a reference to its visual until an
+// Invalidate finds it unused, so a removed visual lives at most one layout pass longer.
+template<class T>
+class RasterTransformCache
+{
+public:
+    using ContainerVisual = typename CompositorTypes<T>::ContainerVisual;
+
+    // Counts since the last call to Invalidate, for diagnostics.
+    struct Statistics
+    {
+        uint32_t visualsComputed = 0; // Visuals whose properties were read
+        uint32_t cacheHits = 0;       // Lookups answered by a cached entry
+    };
+
+    // Gets the aggregate transform from the visual's coordinate space to the root, computed from
+    // the Scale, RotationAxis, RotationAngle and TransformMatrix properties of the visual and its
+    // ancestors. Offsets aren't included.
+    winrt::Windows::Foundation::Numerics::float4x4 GetWorldTransform(ContainerVisual const& visual);
+
+    // Starts a new generation, so each entry is recomputed the next time it's used. Entries that
+    // weren't used during the generation that just ended are discarded.
+    void Invalidate();
+
+    Statistics const& GetStatistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+private:
+    struct Entry
+    {
+        // Holds a reference so the visual's address can't be reused by another visual while the
+        // entry exists.
+        ContainerVisual visual{ nullptr };
+        winrt::Windows::Foundation::Numerics::float4x4 transform;
+        uint32_t generation = 0;
+    };
+
+    // Entries keyed by the visual's ABI pointer.
+    std::unordered_map<void*, Entry> m_entries;
+
+    // Scratch list of visuals without a current entry, reused between lookups.
+    std::vector<ContainerVisual> m_uncachedVisuals;
+
+    uint32_t m_generation = 1;
+    Statistics m_statistics;
+};
+
+using LiftedRasterTransformCache = RasterTransformCache<winrt::Compositor>;
+using SystemRasterTransformCache = RasterTransformCache<winrt::WUC::Compositor>;
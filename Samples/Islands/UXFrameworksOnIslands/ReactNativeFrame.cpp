@@ -306,15 +306,16 @@ void ReactNativeFrame::AddClickSquare(const winrt::Point& point)
 
     // Create our 10x10 blue square
     auto blueVisual = compositor.CreateSpriteVisual();
-    auto blueVisualNode = VisualTreeNode::Create(blueVisual.as<::IUnknown>());
-    m_clickSquareRoot->AddChild(blueVisualNode);
-
     blueVisual.Size({10.0f, 10.0f});
 
     // Color it blue
     auto blue = winrt::Windows::UI::Colors::DarkBlue();
     blueVisual.Brush(compositor.CreateColorBrush(blue));
     blueVisual.Offset({point.X - 5.0f, point.Y - 5.0f, 0.0});
+
+    // Add it once it is positioned, so that its node's geometry is computed from its final place.
+    auto blueVisualNode = VisualTreeNode::Create(blueVisual.as<::IUnknown>());
+    m_clickSquareRoot->AddChild(blueVisualNode);
 }
 
 void ReactNativeFrame::ActivateForPointer(
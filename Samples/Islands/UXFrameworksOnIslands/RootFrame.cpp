@@ -386,12 +386,13 @@ void RootFrame::AddClickSquare(
 {
     auto compositor = m_clickSquareRoot->Visual().as<winrt::WUC::ContainerVisual>().Compositor();
 
-    // Create a 10x10 visual
+    // Create a 10x10 visual, and position it before adding it so that its node's geometry is
+    // computed from its final place.
     auto visual = compositor.CreateSpriteVisual();
-    auto visualNode = VisualTreeNode::Create(visual.as<::IUnknown>());
-    m_clickSquareRoot->AddChild(visualNode);
     visual.Size({ 10.0f, 10.0f });
     visual.Offset({ point.X - 5, point.Y - 5, 0.0f });
+    auto visualNode = VisualTreeNode::Create(visual.as<::IUnknown>());
+    m_clickSquareRoot->AddChild(visualNode);
 
     // Set the brush color based on isRightClick
     auto color = isRightClick ? winrt::Windows::UI::Colors::DeepPink() : winrt::Windows::UI::Colors::Orange();
@@ -509,6 +510,10 @@ void RootFrame::HandleContentLayout()
         {
             control->GetVisual().Scale({displayScale, displayScale, 1.0f});
         }
+
+        // The new scales change the raster transforms of the sprites under these visuals, which
+        // the sprites can't see for themselves.
+        GetOutput().GetResourceList()->MarkAllDirty();
     }
 
     // Create a helper object for setting visual positions.
@@ -526,7 +531,7 @@ void RootFrame::HandleContentLayout()
     // Use relative layout to position the ribbon content within the ribbon root.
     m_ribbonContentVisual.RelativeSizeAdjustment({1.0f, 1.0f});
     m_ribbonContentVisual.Size({ -(inset*2), -(inset*2) });
-    m_ribbonContentVisual.Offset({ inset, inset, 0.0f });
+    m_ribbonContentPeer->VisualNode()->VisualOffset({ inset, inset, 0.0f });
 
     // Position the check boxes within the ribbon.
     float checkBoxLeft = 100.0f * displayScale;
@@ -563,21 +568,22 @@ void RootFrame::HandleContentLayout()
 
     // Scale the left and right content visuals, so the child islands' rasterization scale
     // will include DPI scaling. The left visual's scale also includes zoom.
-    m_leftContentVisual.Scale({displayScale * m_zoomFactor, displayScale * m_zoomFactor, 1.0f});
-    m_rightContentVisual.Scale({displayScale, displayScale, 1.0f});
+    auto leftContentVisualNode = m_leftContentPeer->VisualNode();
+    auto rightContentVisualNode = m_rightContentPeer->VisualNode();
+    leftContentVisualNode->VisualScale({displayScale * m_zoomFactor, displayScale * m_zoomFactor, 1.0f});
+    rightContentVisualNode->VisualScale({displayScale, displayScale, 1.0f});
 
     // Divide both visuals' sizes by the display scale because the size is in pre-scaled units.
     m_leftContentVisual.Size(m_leftContentVisual.Size() / displayScale);
     m_rightContentVisual.Size(m_rightContentVisual.Size() / displayScale);
 
     // Set the left content visual's rotatoin angle.
-    m_leftContentVisual.RotationAngle(m_rotationAngle * m_rotationAngleUnit);
+    leftContentVisualNode->VisualRotationAngle(m_rotationAngle * m_rotationAngleUnit);
 
     SystemFrame::HandleContentLayout();
 
     if (m_leftChildSiteLink != nullptr)
     {
-        auto leftContentVisualNode = m_leftContentPeer->VisualNode();
         m_leftChildSiteLink.LocalToParentTransformMatrix(leftContentVisualNode->Transform4x4());
 
         m_leftChildSiteLink.ActualSize(leftContentVisualNode->Size());
@@ -585,7 +591,6 @@ void RootFrame::HandleContentLayout()
 
     if (m_rightChildSiteLink != nullptr)
     {
-        auto rightContentVisualNode = m_rightContentPeer->VisualNode();
         m_rightChildSiteLink.LocalToParentTransformMatrix(rightContentVisualNode->Transform4x4());
 
         m_rightChildSiteLink.ActualSize(rightContentVisualNode->Size());
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+#include <version>
+#if defined(__cpp_lib_bit_cast)
+#include <bit>
+#endif
+
+// Holds a small, trivially copyable value that is written by one thread at a time and read from
+// any thread without blocking. Readers never take a lock: they copy the value and retry if a write
+// happened while they were copying. Writers must be serialized by the caller (for example by
+// holding the owning object's mutex), and never wait on readers.
+//
+// The value is stored as an array of atomic words so that a reader racing with a writer may see a
+// torn copy (which it then discards), but never performs a data race.
+template<class T>
+class SeqLockValue
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLockValue requires a trivially copyable type");
+
+public:
+    explicit SeqLockValue(T const& value = T{}) noexcept
+    {
+        StoreWords(value);
+    }
+
+    // Disable move and copy.
+    SeqLockValue(SeqLockValue const&) = delete;
+    SeqLockValue& operator=(SeqLockValue const&) = delete;
+
+    T Load() const noexcept
+    {
+        while (true)
+        {
+            auto sequence = m_sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0)
+            {
+                // A write is in progress.
+                YieldProcessor();
+                continue;
+            }
+
+            std::array<uint32_t, c_wordCount> words;
+            for (size_t i = 0; i < c_wordCount; i++)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                return FromWords(words);
+            }
+        }
+    }
+
+    void Store(T const& value) noexcept
+    {
+        auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        StoreWords(value);
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t c_wordCount = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // T may have default member initializers, so it is built from its bytes rather than by
+    // copying into a default constructed value.
+    static T FromWords(std::array<uint32_t, c_wordCount> const& words) noexcept
+    {
+        std::array<std::byte, sizeof(T)> bytes;
+        memcpy(bytes.data(), words.data(), sizeof(T));
+
+#if defined(__cpp_lib_bit_cast)
+        return std::bit_cast<T>(bytes);
+#else
+        T value;
+        memcpy(static_cast<void*>(&value), bytes.data(), sizeof(T));
+        return value;
+#endif
+    }
+
+    void StoreWords(T const& value) noexcept
+    {
+        std::array<uint32_t, c_wordCount> words{};
+        memcpy(words.data(), &value, sizeof(T));
+
+        for (size_t i = 0; i < c_wordCount; i++)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<uint32_t> m_sequence{ 0 };
+    std::array<std::atomic<uint32_t>, c_wordCount> m_words{};
+};
@@ -9,37 +9,71 @@ void SettingCollection::SetSetting(SettingId id, bool value)
     {
         if (value)
         {
-            m_flags |= 1u << id;
+            m_flags |= SettingMaskOf(id);
         }
         else
         {
-            m_flags &= ~(1u << id);
+            m_flags &= ~SettingMaskOf(id);
         }
-        for (auto handler : m_handlers)
+
+        if (m_batchDepth == 0)
+        {
+            NotifyHandlers(SettingMaskOf(id));
+        }
+    }
+}
+
+void SettingCollection::BeginBatch() noexcept
+{
+    if (m_batchDepth++ == 0)
+    {
+        m_flagsAtBatchBegin = m_flags;
+    }
+}
+
+void SettingCollection::CommitBatch()
+{
+    if (--m_batchDepth == 0)
+    {
+        auto changedSettings = m_flags ^ m_flagsAtBatchBegin;
+        if (changedSettings != 0)
         {
-            handler->OnSettingChanged(id);
+            NotifyHandlers(changedSettings);
         }
     }
 }
 
-void SettingCollection::AddEventHandler(ISettingChangedHandler* handler)
+void SettingCollection::AddEventHandler(ISettingChangedHandler* handler, SettingMask settingsOfInterest)
 {
-    m_handlers.push_back(handler);
+    m_handlers.push_back({ handler, settingsOfInterest });
 }
 
 void SettingCollection::RemoveEventHandler(ISettingChangedHandler* handler)
 {
-    auto p = std::find(m_handlers.begin(), m_handlers.end(), handler);
+    auto p = std::find_if(m_handlers.begin(), m_handlers.end(),
+        [handler](auto const& entry) { return entry.handler == handler; });
     if (p != m_handlers.end())
     {
         m_handlers.erase(p);
     }
 }
 
-SettingChangedHandler::SettingChangedHandler(std::shared_ptr<SettingCollection> const& settings) :
+void SettingCollection::NotifyHandlers(SettingMask changedSettings)
+{
+    for (auto& entry : m_handlers)
+    {
+        auto relevantSettings = changedSettings & entry.settingsOfInterest;
+        if (relevantSettings != 0)
+        {
+            entry.handler->OnSettingsChanged(relevantSettings);
+        }
+    }
+}
+
+SettingChangedHandler::SettingChangedHandler(std::shared_ptr<SettingCollection> const& settings, SettingMask settingsOfInterest) :
     m_settings(settings)
 {
-    m_settings->AddEventHandler(this);
+    m_settings->AddEventHandler(this, settingsOfInterest);
 }
 
 SettingChangedHandler::~SettingChangedHandler()
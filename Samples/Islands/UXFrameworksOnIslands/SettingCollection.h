@@ -11,10 +11,21 @@ enum SettingId
     Setting_ShowPopupVisual
 };
 
+// A set of settings, with one bit per SettingId.
+using SettingMask = uint32_t;
+
+constexpr SettingMask c_allSettings = ~SettingMask{ 0 };
+
+constexpr SettingMask SettingMaskOf(SettingId id) noexcept
+{
+    return SettingMask{ 1 } << id;
+}
+
 class ISettingChangedHandler
 {
 public:
-    virtual void OnSettingChanged(SettingId id) = 0;
+    // Called with the settings that changed, limited to the ones the handler is interested in.
+    virtual void OnSettingsChanged(SettingMask changedSettings) = 0;
 };
 
 class SettingCollection final
@@ -25,20 +36,82 @@ public:
         return ((m_flags >> id) & 1) != 0;
     }
 
+    // Notifies the handlers interested in the setting if its value changes, unless a batch is in
+    // progress.
     void SetSetting(SettingId id, bool value);
 
-    void AddEventHandler(ISettingChangedHandler* handler);
+    // While a batch is in progress, changes are collected rather than sent. Committing the
+    // outermost batch notifies each handler once, with the mask of every setting it is interested
+    // in whose value differs from when the batch began. A setting that is changed and then changed
+    // back is not reported.
+    void BeginBatch() noexcept;
+    void CommitBatch();
+
+    // Begins a batch for the lifetime of the object. Call Commit to send the notifications. If the
+    // guard is destroyed first (for example while an exception unwinds), the batch is still
+    // committed, but an exception from a handler is dropped rather than thrown from the destructor.
+    class Batch final
+    {
+    public:
+        explicit Batch(SettingCollection& settings) noexcept : m_settings(settings)
+        {
+            m_settings.BeginBatch();
+        }
+
+        ~Batch()
+        {
+            if (!m_isCommitted)
+            {
+                try
+                {
+                    Commit();
+                }
+                catch (...) {}
+            }
+        }
+
+        void Commit()
+        {
+            if (!m_isCommitted)
+            {
+                m_isCommitted = true;
+                m_settings.CommitBatch();
+            }
+        }
+
+        // Not copyable.
+        Batch(Batch const&) = delete;
+        void operator=(Batch const&) = delete;
+
+    private:
+        SettingCollection& m_settings;
+        bool m_isCommitted = false;
+    };
+
+    // The handler is only notified of changes to the given settings.
+    void AddEventHandler(ISettingChangedHandler* handler, SettingMask settingsOfInterest = c_allSettings);
     void RemoveEventHandler(ISettingChangedHandler* handler);
 
 private:
-    uint32_t m_flags = 0;
-    std::vector<ISettingChangedHandler*> m_handlers;
+    struct HandlerEntry
+    {
+        ISettingChangedHandler* handler;
+        SettingMask settingsOfInterest;
+    };
+
+    void NotifyHandlers(SettingMask changedSettings);
+
+    SettingMask m_flags = 0;
+    std::vector<HandlerEntry> m_handlers;
+
+    uint32_t m_batchDepth = 0;
+    SettingMask m_flagsAtBatchBegin = 0;
 };
 
 class SettingChangedHandler : public ISettingChangedHandler
 {
 public:
-    SettingChangedHandler(std::shared_ptr<SettingCollection> const& settings);
+    SettingChangedHandler(std::shared_ptr<SettingCollection> const& settings, SettingMask settingsOfInterest = c_allSettings);
     ~SettingChangedHandler();
 
     auto& GetSettings() const noexcept { return m_settings; }
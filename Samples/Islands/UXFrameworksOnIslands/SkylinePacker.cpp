@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "SkylinePacker.h"
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+{
+    Reset(width, height);
+}
+
+void SkylinePacker::Reset(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+
+    m_skyline.clear();
+    m_skyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::TryAllocate(uint32_t width, uint32_t height, _Out_ uint32_t* x, _Out_ uint32_t* y)
+{
+    *x = 0;
+    *y = 0;
+
+    if (width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    // Find the position with the lowest bottom edge, breaking ties by the narrowest segment so
+    // that wide gaps are left for wide rectangles.
+    size_t bestIndex = m_skyline.size();
+    uint32_t bestBottom = UINT32_MAX;
+    uint32_t bestWidth = UINT32_MAX;
+    uint32_t bestY = 0;
+
+    for (size_t i = 0; i < m_skyline.size(); i++)
+    {
+        uint32_t fitY;
+        if (TryFit(i, width, height, &fitY))
+        {
+            uint32_t bottom = fitY + height;
+            if (bottom < bestBottom || (bottom == bestBottom && m_skyline[i].width < bestWidth))
+            {
+                bestIndex = i;
+                bestBottom = bottom;
+                bestWidth = m_skyline[i].width;
+                bestY = fitY;
+            }
+        }
+    }
+
+    if (bestIndex == m_skyline.size())
+    {
+        return false;
+    }
+
+    *x = m_skyline[bestIndex].x;
+    *y = bestY;
+    AddSegment(bestIndex, *x, bestBottom, width);
+    return true;
+}
+
+bool SkylinePacker::TryFit(size_t index, uint32_t width, uint32_t height, _Out_ uint32_t* y) const noexcept
+{
+    *y = 0;
+
+    if (m_skyline[index].x + width > m_width)
+    {
+        return false;
+    }
+
+    // The rectangle rests on the highest segment it spans.
+    uint32_t remainingWidth = width;
+    uint32_t fitY = 0;
+    for (size_t i = index; remainingWidth > 0; i++)
+    {
+        fitY = std::max(fitY, m_skyline[i].y);
+        if (fitY + height > m_height)
+        {
+            return false;
+        }
+
+        remainingWidth -= std::min(remainingWidth, m_skyline[i].width);
+    }
+
+    *y = fitY;
+    return true;
+}
+
+void SkylinePacker::AddSegment(size_t index, uint32_t x, uint32_t y, uint32_t width)
+{
+    m_skyline.insert(m_skyline.begin() + index, { x, y, width });
+
+    // Trim or remove the segments that are now covered by the new one.
+    uint32_t right = x + width;
+    size_t next = index + 1;
+    while (next < m_skyline.size() && m_skyline[next].x < right)
+    {
+        auto& segment = m_skyline[next];
+        uint32_t segmentRight = segment.x + segment.width;
+        if (segmentRight <= right)
+        {
+            m_skyline.erase(m_skyline.begin() + next);
+        }
+        else
+        {
+            segment.width = segmentRight - right;
+            segment.x = right;
+            break;
+        }
+    }
+
+    // Merge neighboring segments at the same height.
+    for (size_t i = 0; i + 1 < m_skyline.size();)
+    {
+        if (m_skyline[i].y == m_skyline[i + 1].y)
+        {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+// Packs rectangles into a fixed-size area using the skyline bottom-left heuristic. The packer
+// tracks the top edge ("skyline") of everything placed so far as a list of horizontal segments,
+// and places each new rectangle where its bottom edge would be lowest.
+//
+// Individual rectangles can't be freed. Callers reset the whole packer once everything placed in
+// it is no longer in use.
+//
+// This class has no Direct2D or composition dependencies, so it can be used for any atlas.
+class SkylinePacker
+{
+public:
+    SkylinePacker() noexcept = default;
+    SkylinePacker(uint32_t width, uint32_t height);
+
+    void Reset(uint32_t width, uint32_t height);
+
+    // Returns false if there's no room for the rectangle.
+    bool TryAllocate(uint32_t width, uint32_t height, _Out_ uint32_t* x, _Out_ uint32_t* y);
+
+    uint32_t Width() const noexcept { return m_width; }
+    uint32_t Height() const noexcept { return m_height; }
+
+private:
+    struct Segment
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    // Returns the lowest y at which a rectangle can start at segment index, or false if it doesn't fit.
+    bool TryFit(size_t index, uint32_t width, uint32_t height, _Out_ uint32_t* y) const noexcept;
+
+    void AddSegment(size_t index, uint32_t x, uint32_t y, uint32_t width);
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<Segment> m_skyline;
+};
@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "SurfacePool.h"
+#include "Output.h"
+
+namespace
+{
+    // Sprites no larger than this are packed into atlas pages.
+    constexpr uint32_t c_maxAtlasSpriteWidth = 256;
+    constexpr uint32_t c_maxAtlasSpriteHeight = 128;
+    constexpr uint32_t c_atlasPageSize = 1024;
+
+    // Empty space around each rectangle in an atlas page, so that filtering never samples a
+    // neighboring sprite. Whole surfaces have it to the right of and below the rectangle.
+    constexpr uint32_t c_atlasPadding = 1;
+
+    // The number of empty atlas pages to keep for reuse.
+    constexpr size_t c_maxEmptyAtlasPages = 1;
+
+    // Whole surfaces are rounded up to a multiple of this size.
+    constexpr uint32_t c_surfaceBucketSize = 64;
+
+    // The number of free surfaces to keep for each bucket.
+    constexpr size_t c_maxFreeSurfacesPerBucket = 4;
+
+    uint32_t RoundUpToBucket(uint32_t value) noexcept
+    {
+        return ((value + c_surfaceBucketSize - 1) / c_surfaceBucketSize) * c_surfaceBucketSize;
+    }
+
+    uint64_t BucketKey(uint32_t width, uint32_t height) noexcept
+    {
+        return (static_cast<uint64_t>(width) << 32) | height;
+    }
+
+    winrt::CompositionDrawingSurface CreateCompositionDrawingSurface(winrt::CompositionGraphicsDevice const& device, winrt::Size pixelSize)
+    {
+        return device.CreateDrawingSurface(
+            pixelSize,
+            winrt::Microsoft::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            winrt::Microsoft::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
+    }
+
+    winrt::WUC::CompositionDrawingSurface CreateCompositionDrawingSurface(winrt::WUC::CompositionGraphicsDevice const& device, winrt::Size pixelSize)
+    {
+        return device.CreateDrawingSurface(
+            pixelSize,
+            winrt::Windows::Graphics::DirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            winrt::Windows::Graphics::DirectX::DirectXAlphaMode::Premultiplied);
+    }
+}
+
+template<class T>
+typename SurfacePool<T>::Allocation& SurfacePool<T>::Allocation::operator=(Allocation&& other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+
+        m_pool = std::move(other.m_pool);
+        m_surface = std::move(other.m_surface);
+        m_rect = other.m_rect;
+        m_updateRect = other.m_updateRect;
+        m_atlasPage = other.m_atlasPage;
+        m_generation = other.m_generation;
+
+        other.m_surface = nullptr;
+        other.m_atlasPage = SIZE_MAX;
+    }
+
+    return *this;
+}
+
+template<class T>
+void SurfacePool<T>::Allocation::Reset() noexcept
+{
+    if (m_surface != nullptr)
+    {
+        if (auto pool = m_pool.lock())
+        {
+            pool->Free(*this);
+        }
+
+        m_pool.reset();
+        m_surface = nullptr;
+        m_atlasPage = SIZE_MAX;
+    }
+}
+
+template<class T>
+SurfacePool<T>::SurfacePool(std::shared_ptr<OutputResourceList<T>> const& resourceList) noexcept :
+    OutputResource<T>(resourceList),
+    m_atlas(c_atlasPageSize, c_atlasPadding, c_maxEmptyAtlasPages)
+{
+}
+
+template<class T>
+typename SurfacePool<T>::Allocation SurfacePool<T>::Allocate(Output<T> const& output, winrt::Size pixelSize)
+{
+    auto width = std::max(1u, static_cast<uint32_t>(pixelSize.Width));
+    auto height = std::max(1u, static_cast<uint32_t>(pixelSize.Height));
+
+    Allocation allocation;
+    allocation.m_pool = this->weak_from_this();
+    allocation.m_generation = m_generation;
+
+    if (width > c_maxAtlasSpriteWidth || height > c_maxAtlasSpriteHeight ||
+        !TryAllocateFromAtlas(output, width, height, allocation))
+    {
+        AllocateWholeSurface(output, width, height, allocation);
+    }
+
+    return allocation;
+}
+
+template<class T>
+void SurfacePool<T>::ReleaseDeviceDependentResources(Output<T> const&)
+{
+    // Surfaces created on the old device can't be reused. Any allocations that are still
+    // outstanding become stale, and are dropped rather than returned.
+    m_atlas.Clear();
+    m_atlasSurfaces.clear();
+    m_freeSurfaces.clear();
+    m_generation++;
+}
+
+template<class T>
+typename SurfacePool<T>::Statistics SurfacePool<T>::GetStatistics() const noexcept
+{
+    auto statistics = m_statistics;
+    statistics.atlas = m_atlas.GetStatistics();
+    return statistics;
+}
+
+template<class T>
+bool SurfacePool<T>::TryAllocateFromAtlas(Output<T> const& output, uint32_t width, uint32_t height, Allocation& allocation)
+{
+    AtlasAllocator::Allocation atlasAllocation;
+    if (!m_atlas.TryAllocate(width, height, &atlasAllocation))
+    {
+        return false;
+    }
+
+    // A new page, or one that was released, needs a surface.
+    m_atlasSurfaces.resize(m_atlas.PageCount(), nullptr);
+    auto& surface = m_atlasSurfaces[atlasAllocation.page];
+    if (surface == nullptr)
+    {
+        try
+        {
+            surface = CreateCompositionDrawingSurface(
+                output.GetCompositionGraphicsDevice(),
+                { static_cast<float>(c_atlasPageSize), static_cast<float>(c_atlasPageSize) });
+        }
+        catch (...)
+        {
+            m_atlas.Free(atlasAllocation.page);
+            throw;
+        }
+        m_statistics.surfacesCreated++;
+    }
+
+    allocation.m_surface = surface;
+    allocation.m_rect = atlasAllocation.rect;
+    allocation.m_updateRect = atlasAllocation.updateRect;
+    allocation.m_atlasPage = atlasAllocation.page;
+    return true;
+}
+
+template<class T>
+void SurfacePool<T>::AllocateWholeSurface(Output<T> const& output, uint32_t width, uint32_t height, Allocation& allocation)
+{
+    auto bucketWidth = RoundUpToBucket(width);
+    auto bucketHeight = RoundUpToBucket(height);
+
+    auto& freeSurfaces = m_freeSurfaces[BucketKey(bucketWidth, bucketHeight)];
+    if (!freeSurfaces.empty())
+    {
+        allocation.m_surface = std::move(freeSurfaces.back());
+        freeSurfaces.pop_back();
+        m_statistics.surfacesReused++;
+    }
+    else
+    {
+        allocation.m_surface = CreateCompositionDrawingSurface(
+            output.GetCompositionGraphicsDevice(),
+            { static_cast<float>(bucketWidth), static_cast<float>(bucketHeight) });
+        m_statistics.surfacesCreated++;
+    }
+
+    allocation.m_rect = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+
+    // The surface may be larger than the rectangle, and be left over from a larger sprite, so
+    // the padding to the right and below needs clearing too.
+    allocation.m_updateRect = {
+        0,
+        0,
+        static_cast<LONG>(std::min(width + c_atlasPadding, bucketWidth)),
+        static_cast<LONG>(std::min(height + c_atlasPadding, bucketHeight)) };
+}
+
+template<class T>
+void SurfacePool<T>::Free(Allocation& allocation) noexcept
+{
+    if (allocation.m_generation != m_generation)
+    {
+        return;
+    }
+
+    if (allocation.m_atlasPage != SIZE_MAX)
+    {
+        if (m_atlas.Free(allocation.m_atlasPage))
+        {
+            m_atlasSurfaces[allocation.m_atlasPage] = nullptr;
+        }
+
+        return;
+    }
+
+    try
+    {
+        auto size = allocation.m_surface.Size();
+        auto& freeSurfaces = m_freeSurfaces[BucketKey(static_cast<uint32_t>(size.Width), static_cast<uint32_t>(size.Height))];
+        if (freeSurfaces.size() < c_maxFreeSurfacesPerBucket)
+        {
+            freeSurfaces.push_back(std::move(allocation.m_surface));
+        }
+    }
+    catch (...)
+    {
+        // Not keeping the surface for reuse is harmless.
+    }
+}
+
+// Explicit template instantiation.
+template class SurfacePool<winrt::Compositor>;
+template class SurfacePool<winrt::WUC::Compositor>;
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+#include "AtlasAllocator.h"
+#include "OutputResource.h"
+#include "TemplateHelpers.h"
+
+// Hands out rectangles of composition drawing surfaces, so that sprites don't create a new
+// surface every time their size changes.
+//
+// - Small sprites (such as text labels and check boxes) share large atlas surfaces, whose
+//   rectangles are handed out by an AtlasAllocator. An atlas page is reset once none of its
+//   rectangles are in use, and its surface is released if enough other pages are already empty.
+// - Larger sprites get a whole surface, with the size rounded up to a bucket so that small size
+//   changes reuse the same surface. Freed surfaces are kept per bucket for reuse.
+//
+// The pool is an OutputResource so that it drops all of its surfaces when the device is lost.
+template<class T>
+class SurfacePool final : public OutputResource<T>, public std::enable_shared_from_this<SurfacePool<T>>
+{
+public:
+    using CompositionDrawingSurface = typename CompositorTypes<T>::CompositionDrawingSurface;
+
+    // A rectangle of a pooled surface. The rectangle is returned to the pool when the allocation
+    // is destroyed or reset.
+    class Allocation final
+    {
+    public:
+        Allocation() noexcept = default;
+        ~Allocation() { Reset(); }
+
+        Allocation(Allocation&& other) noexcept { *this = std::move(other); }
+        Allocation& operator=(Allocation&& other) noexcept;
+
+        // Not copyable.
+        Allocation(Allocation const&) = delete;
+        void operator=(Allocation const&) = delete;
+
+        void Reset() noexcept;
+
+        explicit operator bool() const noexcept { return m_surface != nullptr; }
+
+        auto& GetSurface() const noexcept { return m_surface; }
+
+        // The allocated rectangle, in pixels within the surface.
+        RECT const& GetRect() const noexcept { return m_rect; }
+
+        // The rectangle to draw, which contains the allocated rectangle. Anything outside the
+        // allocated rectangle is left over from earlier allocations, and must be cleared.
+        RECT const& GetUpdateRect() const noexcept { return m_updateRect; }
+
+    private:
+        friend class SurfacePool<T>;
+
+        std::weak_ptr<SurfacePool<T>> m_pool;
+        CompositionDrawingSurface m_surface{ nullptr };
+        RECT m_rect = {};
+        RECT m_updateRect = {};
+        size_t m_atlasPage = SIZE_MAX;
+        uint32_t m_generation = 0;
+    };
+
+    // Counts of what the pool has done, for diagnostics.
+    struct Statistics
+    {
+        uint32_t surfacesCreated = 0;
+        uint32_t surfacesReused = 0;
+        AtlasAllocator::Statistics atlas;
+    };
+
+    explicit SurfacePool(std::shared_ptr<OutputResourceList<T>> const& resourceList) noexcept;
+
+    Allocation Allocate(Output<T> const& output, winrt::Size pixelSize);
+
+    // OutputResource methods.
+    void ReleaseDeviceDependentResources(Output<T> const& output) override;
+
+    Statistics GetStatistics() const noexcept;
+
+private:
+    bool TryAllocateFromAtlas(Output<T> const& output, uint32_t width, uint32_t height, Allocation& allocation);
+    void AllocateWholeSurface(Output<T> const& output, uint32_t width, uint32_t height, Allocation& allocation);
+    void Free(Allocation& allocation) noexcept;
+
+    AtlasAllocator m_atlas;
+
+    // The surface of each atlas page, or nullptr for a released page.
+    std::vector<CompositionDrawingSurface> m_atlasSurfaces;
+
+    // Free whole surfaces, keyed by bucket width and height.
+    std::unordered_map<uint64_t, std::vector<CompositionDrawingSurface>> m_freeSurfaces;
+
+    // Incremented when the device is lost, so that older allocations aren't returned to the pool.
+    uint32_t m_generation = 0;
+
+    Statistics m_statistics;
+};
+
+using LiftedSurfacePool = SurfacePool<winrt::Compositor>;
+using SystemSurfacePool = SurfacePool<winrt::WUC::Compositor>;
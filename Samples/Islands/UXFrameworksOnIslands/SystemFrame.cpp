@@ -13,7 +13,7 @@ SystemFrame::SystemFrame(
     // Initialize our root visual and island
     auto rootVisual = systemCompositor.CreateContainerVisual();
     rootVisual.RelativeSizeAdjustment({ 1.0f, 1.0f });
-    m_rootVisualTreeNode = VisualTreeNode::Create(rootVisual.as<::IUnknown>());
+    m_rootVisualTreeNode = VisualTreeNode::Create(rootVisual.as<::IUnknown>(), VisualTreeNodePool::Create());
     m_island = winrt::ContentIsland::CreateForSystemVisual(queue, rootVisual);
     m_automationTree = AutomationTree::Create(this, L"SystemFrame", UIA_PaneControlTypeId);
 
@@ -41,14 +41,20 @@ SystemFrame::SystemFrame(
     HandleContentLayout();
 }
 
-void SystemFrame::OnSettingChanged(SettingId id)
+void SystemFrame::OnSettingsChanged(SettingMask changedSettings)
 {
-    GetOutput().GetResourceList()->OnSettingChanged(GetOutput(), id);
+    GetOutput().GetResourceList()->OnSettingsChanged(GetOutput(), changedSettings);
 
-    if (id == Setting_DisablePixelSnapping || id == Setting_ShowPopupVisual)
+    // These settings also change layout, so they need a layout pass. Either way, only the
+    // resources the change invalidated are initialized.
+    if ((changedSettings & (SettingMaskOf(Setting_DisablePixelSnapping) | SettingMaskOf(Setting_ShowPopupVisual))) != 0)
     {
         HandleContentLayout();
     }
+    else
+    {
+        GetOutput().GetResourceList()->FlushDirty(GetOutput());
+    }
 }
 
 winrt::ChildSiteLink SystemFrame::ConnectChildFrame(
@@ -77,8 +83,12 @@ winrt::ChildSiteLink SystemFrame::ConnectChildFrame(
 
 void SystemFrame::HandleContentLayout()
 {
-    GetOutput().GetResourceList()->EnsureInitialized(GetOutput());
+    GetOutput().BeginFrame();
+    GetOutput().GetResourceList()->FlushDirty(GetOutput());
+    GetOutput().EndFrame();
     
+    // Layout may have changed the visuals directly. Their geometry is recomputed when it is next
+    // read or hit tested, once for all of the changes.
     m_rootVisualTreeNode->Size(m_island.ActualSize());
-    m_rootVisualTreeNode->ComputeSizeAndTransform();
+    m_rootVisualTreeNode->MarkSizeAndTransformDirty();
 }
@@ -67,7 +67,7 @@ protected:
     std::shared_ptr<FocusList> m_focusList{};
 
 private:
-    void OnSettingChanged(SettingId id) override;
+    void OnSettingsChanged(SettingMask changedSettings) override;
 
     SystemOutput m_output;
     winrt::ContentIsland m_island = nullptr;
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Simulates the atlas pages of SurfacePool: sprites of random sizes are allocated and freed in
+// waves, and each allocation is "drawn" into a simulated page of pixels the way D2DSprite draws it
+// (clearing the whole update rectangle, then filling the allocated rectangle with the sprite). After
+// every wave it checks that:
+//
+// * Every live sprite's pixels, and the one pixel border around them that filtering samples, hold
+//   only the sprite itself or transparent pixels, never another sprite.
+// * No more than the allowed number of empty pages keep their surfaces.
+//
+// It also counts how many of those pixels would have held another sprite, or the garbage a new
+// surface starts with, if only the allocated rectangle were drawn, leaving the padding as it was.
+
+#include "precomp.h"
+#include "AtlasAllocator.h"
+
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr uint32_t c_pageSize = 1024;
+    constexpr uint32_t c_padding = 1;
+    constexpr size_t c_maxEmptyPages = 1;
+
+    constexpr uint32_t c_transparent = 0;
+
+    struct Sprite
+    {
+        uint32_t id;
+        AtlasAllocator::Allocation allocation;
+    };
+
+    // The pixels of each page, holding the id of the sprite drawn there, and whether each page has
+    // a surface.
+    struct SimulatedSurfaces
+    {
+        std::vector<std::vector<uint32_t>> pages;
+
+        std::vector<uint32_t>& Page(size_t page)
+        {
+            if (pages.size() <= page)
+            {
+                pages.resize(page + 1);
+            }
+
+            // A new surface starts out with garbage, not transparent pixels.
+            if (pages[page].empty())
+            {
+                pages[page].assign(static_cast<size_t>(c_pageSize) * c_pageSize, UINT32_MAX);
+            }
+            return pages[page];
+        }
+
+        void Fill(size_t page, RECT const& rect, uint32_t value)
+        {
+            auto& pixels = Page(page);
+            for (auto y = rect.top; y < rect.bottom; y++)
+            {
+                std::fill(pixels.begin() + y * c_pageSize + rect.left, pixels.begin() + y * c_pageSize + rect.right, value);
+            }
+        }
+    };
+
+    // Returns the number of pixels within one pixel of the sprite that belong to something else.
+    size_t CountForeignPixels(SimulatedSurfaces& surfaces, Sprite const& sprite)
+    {
+        auto& rect = sprite.allocation.rect;
+        auto& pixels = surfaces.Page(sprite.allocation.page);
+
+        size_t foreignPixels = 0;
+        for (auto y = std::max<LONG>(rect.top - 1, 0); y < std::min<LONG>(rect.bottom + 1, c_pageSize); y++)
+        {
+            for (auto x = std::max<LONG>(rect.left - 1, 0); x < std::min<LONG>(rect.right + 1, c_pageSize); x++)
+            {
+                bool isInside = (x >= rect.left && x < rect.right && y >= rect.top && y < rect.bottom);
+                auto pixel = pixels[y * c_pageSize + x];
+                if (isInside ? (pixel != sprite.id) : (pixel != c_transparent && pixel != sprite.id))
+                {
+                    foreignPixels++;
+                }
+            }
+        }
+        return foreignPixels;
+    }
+
+    struct Results
+    {
+        size_t foreignPixels = 0;
+        size_t excessEmptyPages = 0;
+        size_t peakLivePages = 0;
+        size_t livePagesAtEnd = 0;
+        AtlasAllocator::Statistics statistics;
+    };
+
+    Results Run(size_t waves, bool clearUpdateRect, std::mt19937& random)
+    {
+        std::uniform_int_distribution<uint32_t> width(1, 256);
+        std::uniform_int_distribution<uint32_t> height(1, 128);
+        std::uniform_int_distribution<size_t> waveSize(50, 400);
+
+        AtlasAllocator atlas(c_pageSize, c_padding, c_maxEmptyPages);
+        SimulatedSurfaces surfaces;
+        std::vector<Sprite> sprites;
+        uint32_t nextId = 1;
+        Results results;
+
+        for (size_t wave = 0; wave < waves; wave++)
+        {
+            // Allocate and draw a wave of sprites, like a frame laying out its content.
+            auto count = waveSize(random);
+            for (size_t i = 0; i < count; i++)
+            {
+                Sprite sprite{ nextId++, {} };
+                if (!atlas.TryAllocate(width(random), height(random), &sprite.allocation))
+                {
+                    return results;
+                }
+
+                if (clearUpdateRect)
+                {
+                    surfaces.Fill(sprite.allocation.page, sprite.allocation.updateRect, c_transparent);
+                }
+                surfaces.Fill(sprite.allocation.page, sprite.allocation.rect, sprite.id);
+                sprites.push_back(sprite);
+            }
+
+            results.peakLivePages = std::max(results.peakLivePages, atlas.LivePageCount());
+
+            for (auto& sprite : sprites)
+            {
+                results.foreignPixels += CountForeignPixels(surfaces, sprite);
+            }
+
+            // Free most of the sprites, like content being replaced or scrolled away. Every few
+            // waves, free all of them, so that whole pages empty out.
+            std::shuffle(sprites.begin(), sprites.end(), random);
+            auto keep = (wave % 4 == 3) ? 0 : sprites.size() / 4;
+            for (size_t i = keep; i < sprites.size(); i++)
+            {
+                if (atlas.Free(sprites[i].allocation.page))
+                {
+                    // The surface is released, and a new one will start out with garbage.
+                    surfaces.pages[sprites[i].allocation.page].clear();
+                }
+            }
+            sprites.resize(keep);
+
+            // Count the pages that are empty but still have surfaces.
+            std::vector<bool> isInUse(atlas.PageCount());
+            for (auto& sprite : sprites)
+            {
+                isInUse[sprite.allocation.page] = true;
+            }
+            auto inUseCount = static_cast<size_t>(std::count(isInUse.begin(), isInUse.end(), true));
+            auto emptyPages = atlas.LivePageCount() - inUseCount;
+            results.excessEmptyPages += (emptyPages > c_maxEmptyPages) ? emptyPages - c_maxEmptyPages : 0;
+        }
+
+        results.livePagesAtEnd = atlas.LivePageCount();
+        results.statistics = atlas.GetStatistics();
+        return results;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs fewer waves, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t waves = quick ? 40 : 400;
+
+    std::mt19937 random(42);
+    auto results = Run(waves, true, random);
+
+    random.seed(42);
+    auto unclearedResults = Run(waves, false, random);
+
+    std::cout << waves << " waves of sprites, " << results.statistics.allocations << " allocations\n\n";
+    std::cout << "Peak pages with surfaces:            " << results.peakLivePages << "\n";
+    std::cout << "Pages with surfaces at the end:      " << results.livePagesAtEnd << "\n";
+    std::cout << "Page resets:                         " << results.statistics.pageResets << "\n";
+    std::cout << "Pages released:                      " << results.statistics.pagesReleased << "\n";
+    std::cout << "Empty pages beyond the limit:        " << results.excessEmptyPages << "\n";
+    std::cout << "Foreign pixels at sprite edges:      " << results.foreignPixels << "\n";
+    std::cout << "  drawing only the allocated rect:   " << unclearedResults.foreignPixels << "\n";
+
+    bool passed = (results.statistics.allocations > 0) && (results.foreignPixels == 0) && (results.excessEmptyPages == 0);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures the two automation operations that used to search every sibling, on a tree of 5,000
+// peers (50 panels of 100 items, each item a system composition visual with its own peer, the
+// shape of a list or grid view):
+//
+// * Fragment from point: hit-testing the visual tree and finding the hit visual's peer, which
+//   AutomationTree does for every point a screen reader asks about. The peer is found through the
+//   tree's index, and through a search of every peer (what AutomationTree did before). The hit
+//   test is measured separately, since it's the same for both. Answering a real request also needs
+//   the frame's island to convert screen coordinates, which isn't measured.
+// * Child removal: removing every child of an AutomationFragment, in random order.
+//
+// It also checks that both lookups find the same peer for every point, and that the fragment's
+// children still navigate in order, with consistent sibling links, after half of them are removed.
+
+#include "precomp.h"
+#include "AutomationTree.h"
+
+#include <DispatcherQueue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr size_t c_itemsPerPanel = 100;
+    constexpr float c_itemSize = 20.0f;
+
+    struct Tree
+    {
+        std::shared_ptr<VisualTreeNode> root;
+        std::vector<std::shared_ptr<AutomationPeer>> peers;
+        std::vector<winrt::WUC::ContainerVisual> visuals;
+        winrt::float2 size;
+    };
+
+    // Panels side by side, each a column of items.
+    Tree BuildTree(winrt::WUC::Compositor const& compositor, AutomationTree& automationTree, size_t panelCount)
+    {
+        Tree tree;
+        tree.size = { panelCount * c_itemSize, c_itemsPerPanel * c_itemSize };
+        auto rootVisual = compositor.CreateContainerVisual();
+        rootVisual.Size(tree.size);
+        tree.root = VisualTreeNode::Create(rootVisual.as<::IUnknown>());
+        tree.root->Size(tree.size);
+        tree.visuals.push_back(rootVisual);
+
+        auto AddPeer = [&](std::shared_ptr<VisualTreeNode> const& parentNode, winrt::WUC::ContainerVisual const& visual)
+        {
+            auto node = VisualTreeNode::Create(visual.as<::IUnknown>());
+            parentNode->AddChild(node);
+            auto peer = automationTree.CreatePeer(node, L"Item", UIA_ListItemControlTypeId);
+            automationTree.AddPeer(peer);
+            tree.peers.push_back(peer);
+            tree.visuals.push_back(visual);
+            return node;
+        };
+
+        for (size_t i = 0; i < panelCount; i++)
+        {
+            auto panelVisual = compositor.CreateContainerVisual();
+            panelVisual.Size({ c_itemSize, tree.size.y });
+            panelVisual.Offset({ i * c_itemSize, 0.0f, 0.0f });
+            auto panelNode = AddPeer(tree.root, panelVisual);
+
+            for (size_t j = 0; j < c_itemsPerPanel; j++)
+            {
+                auto itemVisual = compositor.CreateContainerVisual();
+                itemVisual.Size({ c_itemSize, c_itemSize });
+                itemVisual.Offset({ 0.0f, j * c_itemSize, 0.0f });
+                AddPeer(panelNode, itemVisual);
+            }
+        }
+
+        tree.root->ComputeSizeAndTransform();
+        return tree;
+    }
+
+    // What AutomationTree did before it indexed its peers.
+    std::shared_ptr<AutomationPeer> SearchPeers(std::vector<std::shared_ptr<AutomationPeer>> const& peers, VisualTreeNode const* visual)
+    {
+        auto it = std::find_if(peers.begin(), peers.end(), [&](auto& peer) { return peer->VisualNode().get() == visual; });
+        return (peers.end() != it) ? *it : nullptr;
+    }
+
+    template<class TCallback>
+    double MeasureMicroseconds(TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+    // Navigates the fragment's children from first to last, and back, and checks they're the
+    // expected ones in order.
+    bool ChildrenMatch(AutomationHelpers::AutomationFragment& parent, std::vector<winrt::com_ptr<AutomationHelpers::AutomationFragment>> const& expected)
+    {
+        std::vector<::IUnknown*> forward;
+        winrt::com_ptr<::IRawElementProviderFragment> child;
+        winrt::check_hresult(parent.Navigate(NavigateDirection_FirstChild, child.put()));
+        while (child != nullptr)
+        {
+            forward.push_back(child.as<::IUnknown>().get());
+            winrt::com_ptr<::IRawElementProviderFragment> next;
+            winrt::check_hresult(child->Navigate(NavigateDirection_NextSibling, next.put()));
+            child = std::move(next);
+        }
+
+        std::vector<::IUnknown*> backward;
+        winrt::check_hresult(parent.Navigate(NavigateDirection_LastChild, child.put()));
+        while (child != nullptr)
+        {
+            backward.push_back(child.as<::IUnknown>().get());
+            winrt::com_ptr<::IRawElementProviderFragment> previous;
+            winrt::check_hresult(child->Navigate(NavigateDirection_PreviousSibling, previous.put()));
+            child = std::move(previous);
+        }
+        std::reverse(backward.begin(), backward.end());
+
+        if (forward.size() != expected.size() || forward != backward)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            if (forward[i] != expected[i].as<::IUnknown>().get())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick builds a smaller tree, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t panelCount = quick ? 5 : 50;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    // The peers and the index don't need the tree to be connected to a frame.
+    AutomationTree automationTree;
+    auto tree = BuildTree(compositor, automationTree, panelCount);
+    auto peerCount = tree.peers.size();
+
+    // Random points over the whole tree, and the visuals they hit.
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> x(0.0f, tree.size.x);
+    std::uniform_real_distribution<float> y(0.0f, tree.size.y);
+    std::vector<winrt::Point> points(1'000);
+    for (auto& point : points)
+    {
+        point = { x(random), y(random) };
+    }
+
+    std::vector<VisualTreeNode const*> hits(points.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        hits[i] = tree.root->HitTestInTreeRootCoordinates(points[i]).get();
+        mismatches += (automationTree.FindPeer(hits[i]) == SearchPeers(tree.peers, hits[i])) ? 0 : 1;
+    }
+
+    auto hitTest = MeasureMicroseconds([&]()
+        {
+            for (auto& point : points)
+            {
+                (void)tree.root->HitTestInTreeRootCoordinates(point);
+            }
+        }) / points.size();
+    auto indexed = MeasureMicroseconds([&]()
+        {
+            for (auto hit : hits)
+            {
+                (void)automationTree.FindPeer(hit);
+            }
+        }) / points.size();
+    auto searched = MeasureMicroseconds([&]()
+        {
+            for (auto hit : hits)
+            {
+                (void)SearchPeers(tree.peers, hit);
+            }
+        }) / points.size();
+
+    // Remove every child of a fragment in random order. Each pass adds them back first, which is
+    // measured separately and subtracted.
+    auto parent = winrt::make_self<AutomationHelpers::AutomationFragment>();
+    std::vector<winrt::com_ptr<AutomationHelpers::AutomationFragment>> children;
+    for (auto& peer : tree.peers)
+    {
+        children.push_back(peer->Fragment());
+    }
+    auto removalOrder = children;
+    std::shuffle(removalOrder.begin(), removalOrder.end(), random);
+
+    auto AddAll = [&]()
+        {
+            for (auto& child : children)
+            {
+                parent->AddChildToEnd(child);
+            }
+        };
+    auto adding = MeasureMicroseconds([&]()
+        {
+            AddAll();
+            parent->RemoveAllChildren();
+        });
+    auto addingAndRemoving = MeasureMicroseconds([&]()
+        {
+            AddAll();
+            for (auto& child : removalOrder)
+            {
+                parent->RemoveChild(child);
+            }
+        });
+    auto removal = std::max(addingAndRemoving - adding, 0.0) / children.size();
+
+    // Remove half of the children, and check what's left navigates in order.
+    AddAll();
+    std::vector<winrt::com_ptr<AutomationHelpers::AutomationFragment>> remaining;
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        if (i % 2 == 0)
+        {
+            parent->RemoveChild(children[i]);
+        }
+        else
+        {
+            remaining.push_back(children[i]);
+        }
+    }
+    bool childrenInOrder = ChildrenMatch(*parent, remaining);
+    parent->RemoveAllChildren();
+
+    std::cout << peerCount << " peers, microseconds per operation\n\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Hit test:                      " << std::setw(10) << hitTest << "\n";
+    std::cout << "Find peer, indexed:            " << std::setw(10) << indexed << "\n";
+    std::cout << "Find peer, searching peers:    " << std::setw(10) << searched << "\n";
+    std::cout << "Remove child, random order:    " << std::setw(10) << removal << "\n";
+    std::cout << "\nPeer mismatches: " << mismatches << ", children " << (childrenInOrder ? "in order" : "OUT OF ORDER") << " after removals\n";
+
+    return (mismatches == 0 && childrenInOrder) ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Checks that the pixel bounds D2DSprite computes for a TextVisual from its layout and overhang
+// metrics, without rendering it, contain the bounds of what the text actually draws. Each case
+// places a TextVisual in a container visual with some scale and rotation, and a rasterization
+// scale on the output, and initializes it. The sprite's bounds are read back from its sprite visual,
+// and compared with the world bounds of a command list that the same text layout is drawn into
+// with the same transform and antialiasing mode.
+//
+// It also checks, with the output's sprite bounds statistics, that the bounds were computed
+// analytically rather than by rendering, and that they're reused while nothing changes.
+
+#include "precomp.h"
+#include "Output.h"
+#include "TextRenderer.h"
+#include "TextVisual.h"
+
+#include <DispatcherQueue.h>
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    struct Case
+    {
+        wchar_t const* text;
+        float fontSize;
+        DWRITE_FONT_STYLE fontStyle;
+        winrt::float2 scale;
+        float rotationDegrees;
+        float rasterizationScale;
+        bool isOpaque;
+    };
+
+    // Text with ascenders, descenders and glyphs that overhang their advance (especially in
+    // italic), at scales and rotations that put the ink at fractional pixel positions.
+    const Case c_cases[] = {
+        { L"Hello, world", 14.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 0.0f, 1.0f, false },
+        { L"Hello, world", 14.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 0.0f, 1.0f, true },
+        { L"Wjgy|f\u00C5", 14.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 0.0f, 1.25f, false },
+        { L"Wjgy|f\u00C5", 14.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 0.0f, 1.5f, true },
+        { L"ffff jjjj", 24.0f, DWRITE_FONT_STYLE_ITALIC, { 1.0f, 1.0f }, 0.0f, 1.0f, false },
+        { L"ffff jjjj", 24.0f, DWRITE_FONT_STYLE_ITALIC, { 1.75f, 0.6f }, 0.0f, 1.0f, false },
+        { L"Rotated text", 16.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 30.0f, 1.0f, false },
+        { L"Rotated text", 16.0f, DWRITE_FONT_STYLE_ITALIC, { 1.3f, 1.3f }, -75.0f, 1.25f, false },
+        { L"Upside down", 12.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 180.0f, 2.0f, true },
+        { L"Multiple\nlines of\ntext", 14.0f, DWRITE_FONT_STYLE_NORMAL, { 1.0f, 1.0f }, 90.0f, 1.0f, false },
+    };
+
+    // The transform D2DSprite renders the content with: the container visual's scale and rotation
+    // (about the default z axis), followed by the rasterization scale.
+    Matrix2x2 ComputeRasterTransform(Case const& testCase)
+    {
+        auto transform = winrt::make_float4x4_scale(testCase.scale.x, testCase.scale.y, 1.0f) *
+            winrt::make_float4x4_from_axis_angle({ 0.0f, 0.0f, 1.0f }, testCase.rotationDegrees * 3.14159265f / 180.0f);
+        return Matrix2x2(transform) * Matrix2x2(testCase.rasterizationScale, 0.0f, 0.0f, testCase.rasterizationScale);
+    }
+
+    // Reads back the pixel bounds a sprite was given. The sprite visual is sized to the bounds, and
+    // its transform is the inverse of the raster transform translated by the bounds' top left.
+    D2D1_RECT_F GetSpritePixelBounds(SystemTextVisual const& textVisual)
+    {
+        auto spriteVisual = textVisual.GetVisual().Children().First().Current().as<winrt::WUC::SpriteVisual>();
+
+        winrt::float4x4 renderTransform;
+        if (!winrt::invert(spriteVisual.TransformMatrix(), &renderTransform))
+        {
+            return {};
+        }
+
+        auto left = -std::round(renderTransform.m41);
+        auto top = -std::round(renderTransform.m42);
+        auto size = spriteVisual.Size();
+        return { left, top, left + size.x, top + size.y };
+    }
+
+    // Draws the text layout into a command list the way TextVisual::RenderContent does, and returns
+    // the world bounds of what was drawn, in pixels.
+    D2D1_RECT_F RenderPixelBounds(SystemOutput const& output, IDWriteTextLayout* textLayout, Matrix2x2 const& rasterTransform, bool isOpaque)
+    {
+        auto& deviceContext = output.GetDXDevice().GetDeviceContext();
+        winrt::com_ptr<ID2D1CommandList> commandList;
+        winrt::check_hresult(deviceContext->CreateCommandList(commandList.put()));
+        deviceContext->SetTarget(commandList.get());
+        deviceContext->SetUnitMode(D2D1_UNIT_MODE_PIXELS);
+
+        winrt::com_ptr<ID2D1SolidColorBrush> brush;
+        winrt::check_hresult(deviceContext->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), brush.put()));
+
+        deviceContext->BeginDraw();
+        deviceContext->SetTransform(rasterTransform.ToD2D());
+        deviceContext->SetTextAntialiasMode(isOpaque ? D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE : D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+        deviceContext->DrawTextLayout({ 0.0f, 0.0f }, textLayout, brush.get());
+        deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+        winrt::check_hresult(deviceContext->EndDraw());
+        deviceContext->SetTarget(nullptr);
+
+        winrt::check_hresult(commandList->Close());
+        D2D1_RECT_F bounds;
+        winrt::check_hresult(deviceContext->GetImageWorldBounds(commandList.get(), &bounds));
+        return bounds;
+    }
+
+    float Area(D2D1_RECT_F const& rect)
+    {
+        return std::max(rect.right - rect.left, 0.0f) * std::max(rect.bottom - rect.top, 0.0f);
+    }
+
+    bool RunCase(SystemOutput& output, Case const& testCase)
+    {
+        auto textFormat = CreateTextFormat(L"Segoe UI", testCase.fontSize, DWRITE_FONT_WEIGHT_NORMAL, testCase.fontStyle);
+        auto textLayout = CreateTextLayout(testCase.text, textFormat.get());
+
+        auto rasterTransform = ComputeRasterTransform(testCase);
+        output.SetRasterizationTransform(Matrix2x2(testCase.rasterizationScale, 0.0f, 0.0f, testCase.rasterizationScale));
+
+        SystemTextVisual textVisual(output, testCase.text, textLayout);
+        textVisual.GetVisual().Scale({ testCase.scale.x, testCase.scale.y, 1.0f });
+        textVisual.GetVisual().RotationAngleInDegrees(testCase.rotationDegrees);
+        if (testCase.isOpaque)
+        {
+            textVisual.SetBackgroundColor(winrt::Windows::UI::Colors::White());
+        }
+
+        // Initializing the sprite computes the bounds, and initializing it again (as after a device
+        // change) reuses them.
+        output.BeginFrame();
+        output.GetResourceList()->EnsureInitialized(output);
+        auto first = output.GetSpriteBoundsStatistics();
+        output.BeginFrame();
+        output.GetResourceList()->EnsureInitialized(output);
+        auto second = output.GetSpriteBoundsStatistics();
+
+        auto analytic = GetSpritePixelBounds(textVisual);
+        auto recorded = RenderPixelBounds(output, textLayout.get(), rasterTransform, testCase.isOpaque);
+
+        bool contained =
+            analytic.left <= std::floor(recorded.left) && analytic.top <= std::floor(recorded.top) &&
+            analytic.right >= std::ceil(recorded.right) && analytic.bottom >= std::ceil(recorded.bottom);
+        bool isAnalytic = first.analyticBounds == 1 && first.boundsRenders == 0;
+        bool isCached = second.cachedBounds == 1 && second.analyticBounds == 0 && second.boundsRenders == 0;
+
+        std::wstring text = testCase.text;
+        std::replace(text.begin(), text.end(), L'\n', L' ');
+        std::wcout << std::left << std::setw(24) << text << std::right << std::fixed << std::setprecision(1)
+            << L"  [" << analytic.left << L", " << analytic.top << L", " << analytic.right << L", " << analytic.bottom << L"]"
+            << L"  [" << recorded.left << L", " << recorded.top << L", " << recorded.right << L", " << recorded.bottom << L"]"
+            << std::setprecision(2) << L"  " << (Area(analytic) / std::max(Area(recorded), 1.0f)) << L"x"
+            << (contained ? L"" : L"  NOT CONTAINED")
+            << (isAnalytic ? L"" : L"  NOT ANALYTIC")
+            << (isCached ? L"" : L"  NOT CACHED") << L"\n";
+
+        return contained && isAnalytic && isCached;
+    }
+}
+
+int main()
+{
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    SystemOutput output(compositor, std::make_shared<SettingCollection>());
+
+    std::wcout << L"Sprite pixel bounds computed from the text metrics [left, top, right, bottom], the bounds of\n"
+        L"the rendered text, and the ratio of their areas\n\n";
+
+    size_t failures = 0;
+    for (auto& testCase : c_cases)
+    {
+        failures += RunCase(output, testCase) ? 0 : 1;
+    }
+
+    if (failures != 0)
+    {
+        std::wcerr << failures << L" of " << std::size(c_cases) << L" cases failed.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures tabbing through 10,000 system composition visuals spread across nested FocusLists (a
+// root list of 10 lists of 10 lists of 100 visuals), in three situations:
+//
+// * Nothing changes between key presses, so every Tab is a lookup in the cached tab order.
+// * Another tree of focus lists, with its own FocusManager, gains an item before every Tab. That
+//   tree's structure version is separate, so this tree's tab order stays cached.
+// * This tree gains an item before every Tab, so the tab order is rebuilt every time (which is what
+//   happened for every tree when the structure version was shared by the whole process).
+//
+// It also checks that tabbing forward and then backward visits every visual in order.
+
+#include "precomp.h"
+#include "FocusManager.h"
+#include "VisualTreeNode.h"
+
+#include <DispatcherQueue.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    constexpr size_t c_listsPerLevel = 10;
+
+    struct FocusHost : IFocusHost
+    {
+        void EnsureWin32Focus() const override {}
+    };
+
+    struct Tree
+    {
+        std::shared_ptr<FocusList> root;
+        std::vector<std::shared_ptr<FocusList>> leafLists;
+        std::vector<winrt::WUC::ContainerVisual> visuals;
+    };
+
+    std::shared_ptr<FocusList> AddChildList(const std::shared_ptr<FocusList>& list)
+    {
+        auto childList = FocusList::Create();
+        list->AddPlaceholder();
+        list->SetChildFocusList(childList, static_cast<int>(list->Size() - 1));
+        return childList;
+    }
+
+    Tree BuildTree(const winrt::WUC::Compositor& compositor, size_t visualsPerList)
+    {
+        Tree tree;
+        tree.root = FocusList::Create();
+        for (size_t i = 0; i < c_listsPerLevel; i++)
+        {
+            auto middleList = AddChildList(tree.root);
+            for (size_t j = 0; j < c_listsPerLevel; j++)
+            {
+                auto leafList = AddChildList(middleList);
+                for (size_t k = 0; k < visualsPerList; k++)
+                {
+                    auto visual = compositor.CreateContainerVisual();
+                    visual.Size({ 10.0f, 10.0f });
+                    leafList->AddVisual(VisualTreeNode::Create(visual.as<::IUnknown>()));
+                    tree.visuals.push_back(visual);
+                }
+                tree.leafLists.push_back(leafList);
+            }
+        }
+        return tree;
+    }
+
+    // The focused visual is the one with a focus border.
+    bool HasFocus(const winrt::WUC::ContainerVisual& visual)
+    {
+        return visual.Children().Count() > 0;
+    }
+
+    // Tabs through the whole tree (which wraps around to the first visual at the end), calling
+    // beforeTab before each key press, and returns the average time per Tab in microseconds.
+    template<class TCallback>
+    double MeasureTabMicroseconds(FocusManager& manager, size_t visualCount, TCallback&& beforeTab)
+    {
+        manager.SetFocusToFirst();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < visualCount; i++)
+        {
+            beforeTab();
+            manager.NavigateForward();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / visualCount;
+    }
+
+    // Returns the number of Tab and Shift+Tab presses that focused the wrong visual.
+    size_t CountOutOfOrder(FocusManager& manager, const Tree& tree)
+    {
+        size_t outOfOrder = 0;
+        manager.SetFocusToFirst();
+        for (size_t i = 0; i < tree.visuals.size(); i++)
+        {
+            outOfOrder += HasFocus(tree.visuals[i]) ? 0 : 1;
+            if (i + 1 < tree.visuals.size())
+            {
+                manager.NavigateForward();
+            }
+        }
+        for (size_t i = tree.visuals.size() - 1; i > 0; i--)
+        {
+            manager.NavigateBackward();
+            outOfOrder += HasFocus(tree.visuals[i - 1]) ? 0 : 1;
+        }
+        return outOfOrder;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick builds a smaller tree, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t visualsPerList = quick ? 5 : 100;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    FocusHost focusHost;
+    auto tree = BuildTree(compositor, visualsPerList);
+    FocusManager manager{ tree.root };
+    manager.InitializeWithFocusHost(&focusHost);
+
+    auto otherTree = BuildTree(compositor, 1);
+    FocusManager otherManager{ otherTree.root };
+    otherManager.InitializeWithFocusHost(&focusHost);
+
+    auto visualCount = tree.visuals.size();
+    std::cout << "Tabbing through " << visualCount << " visuals in nested focus lists, microseconds per Tab\n\n";
+
+    auto outOfOrder = CountOutOfOrder(manager, tree);
+
+    auto unchanged = MeasureTabMicroseconds(manager, visualCount, []() {});
+    auto otherTreeChanging = MeasureTabMicroseconds(manager, visualCount, [&]() { otherTree.leafLists[0]->AddPlaceholder(); });
+    auto thisTreeChanging = MeasureTabMicroseconds(manager, visualCount, [&]() { tree.leafLists.back()->AddPlaceholder(); });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "No changes:                         " << std::setw(10) << unchanged << "\n";
+    std::cout << "Another tree changing before each:  " << std::setw(10) << otherTreeChanging << "\n";
+    std::cout << "This tree changing before each:     " << std::setw(10) << thisTreeChanging << "\n";
+    std::cout << "\nOut of order: " << outOfOrder << "\n";
+
+    return (outOfOrder == 0) ? 0 : 1;
+}
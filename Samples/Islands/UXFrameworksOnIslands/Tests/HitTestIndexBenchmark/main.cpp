@@ -0,0 +1,302 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Compares HitTestIndex against a recursive walk of the same tree in reverse z-order (the way
+// VisualTreeNode hit tested before the index existed) on synthetic trees, checking that both find
+// the same node for every point and reporting the time per hit test. The trees stand in for
+// VisualTreeNodes so that this builds without the composition APIs; VisualTreeNodeHitTestBenchmark
+// measures the same comparison through VisualTreeNode itself.
+
+#include "precomp.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+struct VisualTreeNode
+{
+    uint32_t id;
+};
+
+#include "HitTestIndex.h"
+
+namespace
+{
+    struct SyntheticNode
+    {
+        winrt::float4x4 transform;
+        winrt::float4x4 inverseTransform;
+        winrt::float2 size;
+        std::vector<uint32_t> children;
+    };
+
+    struct SyntheticTree
+    {
+        std::vector<SyntheticNode> nodes;
+        std::vector<std::shared_ptr<VisualTreeNode>> handles;
+    };
+
+    // Builds a tree whose nodes are placed at random offsets within their parents (so many of them
+    // are clipped by their parents), with a few scaled or rotated.
+    // Each node's parent is chosen from the most recent parentWindow nodes, so a small window
+    // gives a deep tree and a large one a wide tree.
+    SyntheticTree CreateTree(uint32_t nodeCount, uint32_t parentWindow, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        SyntheticTree tree;
+        tree.nodes.resize(nodeCount);
+        tree.nodes[0].transform = winrt::float4x4::identity();
+        tree.nodes[0].size = { 4000.0f, 4000.0f };
+
+        for (uint32_t i = 1; i < nodeCount; i++)
+        {
+            auto window = std::min(i, parentWindow);
+            auto parent = i - 1 - static_cast<uint32_t>(unit(random) * window) % window;
+            const auto& parentNode = tree.nodes[parent];
+
+            auto& node = tree.nodes[i];
+            node.size = { 20.0f + 580.0f * unit(random), 20.0f + 580.0f * unit(random) };
+
+            auto local = winrt::make_float4x4_translation(
+                unit(random) * parentNode.size.x, unit(random) * parentNode.size.y);
+            auto kind = unit(random);
+            if (kind < 0.05f)
+            {
+                local = winrt::make_float4x4_rotation_z((unit(random) - 0.5f) * 1.5f) * local;
+            }
+            else if (kind < 0.1f)
+            {
+                local = winrt::make_float4x4_scale(0.5f + unit(random), 0.5f + unit(random)) * local;
+            }
+
+            node.transform = local * parentNode.transform;
+            tree.nodes[parent].children.push_back(i);
+        }
+
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            auto& node = tree.nodes[i];
+            winrt::invert(node.transform, &node.inverseTransform);
+            tree.handles.push_back(std::make_shared<VisualTreeNode>(VisualTreeNode{ i }));
+        }
+
+        return tree;
+    }
+
+    // Builds a root with a 4x4 grid of panels, each holding a grid of equally sized items (like a
+    // list or grid view), which is the shape where a recursive walk visits the most siblings.
+    SyntheticTree CreateGridTree(uint32_t nodeCount)
+    {
+        constexpr uint32_t panelsPerSide = 4;
+        constexpr float panelSize = 1000.0f;
+        auto itemsPerPanel = (nodeCount - 1 - (panelsPerSide * panelsPerSide)) / (panelsPerSide * panelsPerSide);
+        auto itemsPerSide = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(itemsPerPanel))));
+        auto itemSize = panelSize / static_cast<float>(itemsPerSide);
+
+        SyntheticTree tree;
+        tree.nodes.push_back({ winrt::float4x4::identity(), {}, { 4000.0f, 4000.0f }, {} });
+        for (uint32_t panel = 0; panel < panelsPerSide * panelsPerSide; panel++)
+        {
+            auto panelIndex = static_cast<uint32_t>(tree.nodes.size());
+            tree.nodes[0].children.push_back(panelIndex);
+            tree.nodes.push_back({
+                winrt::make_float4x4_translation((panel % panelsPerSide) * panelSize, (panel / panelsPerSide) * panelSize),
+                {}, { panelSize, panelSize }, {} });
+
+            for (uint32_t item = 0; item < itemsPerPanel; item++)
+            {
+                tree.nodes[panelIndex].children.push_back(static_cast<uint32_t>(tree.nodes.size()));
+                auto local = winrt::make_float4x4_translation((item % itemsPerSide) * itemSize, (item / itemsPerSide) * itemSize);
+                tree.nodes.push_back({ local * tree.nodes[panelIndex].transform, {}, { itemSize, itemSize }, {} });
+            }
+        }
+
+        for (uint32_t i = 0; i < tree.nodes.size(); i++)
+        {
+            auto& node = tree.nodes[i];
+            winrt::invert(node.transform, &node.inverseTransform);
+            tree.handles.push_back(std::make_shared<VisualTreeNode>(VisualTreeNode{ i }));
+        }
+
+        return tree;
+    }
+
+    winrt::Rect TransformedBounds(const SyntheticNode& node)
+    {
+        std::array<winrt::float2, 4> corners{
+            winrt::transform({ 0.0f, 0.0f }, node.transform),
+            winrt::transform({ node.size.x, 0.0f }, node.transform),
+            winrt::transform({ 0.0f, node.size.y }, node.transform),
+            winrt::transform({ node.size.x, node.size.y }, node.transform) };
+
+        auto left = corners[0].x;
+        auto top = corners[0].y;
+        auto right = corners[0].x;
+        auto bottom = corners[0].y;
+        for (const auto& corner : corners)
+        {
+            left = std::min(left, corner.x);
+            top = std::min(top, corner.y);
+            right = std::max(right, corner.x);
+            bottom = std::max(bottom, corner.y);
+        }
+
+        return { left, top, right - left, bottom - top };
+    }
+
+    // Flattens the tree into pre-order entries, as VisualTreeNode::AppendToHitTestIndexInternal does
+    // for nodes that aren't pooled.
+    void AppendEntries(const SyntheticTree& tree, uint32_t index, int parentIndex, std::vector<HitTestIndex::Entry>& entries)
+    {
+        const auto& node = tree.nodes[index];
+        HitTestIndex::Entry entry;
+        entry.node = tree.handles[index];
+        entry.inverseTransform = node.inverseTransform;
+        entry.size = node.size;
+        entry.bounds = TransformedBounds(node);
+        entry.parentIndex = parentIndex;
+        entries.push_back(entry);
+
+        auto entryIndex = static_cast<int>(entries.size() - 1);
+        for (auto child : node.children)
+        {
+            AppendEntries(tree, child, entryIndex, entries);
+        }
+    }
+
+    int RecursiveHitTest(const SyntheticTree& tree, uint32_t index, const winrt::float2& point)
+    {
+        const auto& node = tree.nodes[index];
+        auto localPoint = winrt::transform(point, node.inverseTransform);
+        if (localPoint.x < 0.0f || localPoint.x >= node.size.x || localPoint.y < 0.0f || localPoint.y >= node.size.y)
+        {
+            return -1;
+        }
+
+        for (auto child = node.children.rbegin(); child != node.children.rend(); ++child)
+        {
+            auto hit = RecursiveHitTest(tree, *child, point);
+            if (hit >= 0)
+            {
+                return hit;
+            }
+        }
+
+        return static_cast<int>(index);
+    }
+
+    template<class TCallback>
+    double MeasureNanosecondsPerPoint(const std::vector<winrt::Point>& points, TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            for (const auto& point : points)
+            {
+                callback(point);
+            }
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * points.size());
+    }
+
+    bool RunCase(const char* name, SyntheticTree tree, size_t pointCount, std::mt19937& random)
+    {
+        auto nodeCount = static_cast<uint32_t>(tree.nodes.size());
+
+        std::vector<HitTestIndex::Entry> entries;
+        entries.reserve(nodeCount);
+        AppendEntries(tree, 0, -1, entries);
+
+        using Clock = std::chrono::steady_clock;
+        auto buildStart = Clock::now();
+        HitTestIndex index;
+        index.Build(std::move(entries));
+        auto buildMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+
+        std::uniform_real_distribution<float> coordinate(-100.0f, 4100.0f);
+        std::vector<winrt::Point> points(pointCount);
+        for (auto& point : points)
+        {
+            point = { coordinate(random), coordinate(random) };
+        }
+
+        size_t mismatches = 0;
+        size_t hits = 0;
+        for (const auto& point : points)
+        {
+            auto expected = RecursiveHitTest(tree, 0, { point.X, point.Y });
+            auto actual = index.HitTest(point);
+            auto actualId = actual ? static_cast<int>(actual->id) : -1;
+            hits += (expected >= 0) ? 1 : 0;
+            if (actualId != expected)
+            {
+                if (mismatches++ < 5)
+                {
+                    std::cerr << name << ": (" << point.X << ", " << point.Y << ") expected " << expected
+                        << " but the index returned " << actualId << "\n";
+                }
+            }
+        }
+
+        size_t checksum = 0;
+        auto indexNanoseconds = MeasureNanosecondsPerPoint(points, [&](const winrt::Point& point)
+            {
+                auto hit = index.HitTest(point);
+                checksum += hit ? hit->id : 0;
+            });
+        auto walkNanoseconds = MeasureNanosecondsPerPoint(points, [&](const winrt::Point& point)
+            {
+                checksum += static_cast<size_t>(RecursiveHitTest(tree, 0, { point.X, point.Y }) + 1);
+            });
+
+        std::cout << std::setw(8) << name << std::setw(9) << nodeCount << std::setw(11) << std::fixed << std::setprecision(2) << buildMilliseconds
+            << std::setw(12) << indexNanoseconds << std::setw(13) << walkNanoseconds << std::setw(9) << (walkNanoseconds / indexNanoseconds) << "x"
+            << std::setw(8) << (100 * hits / pointCount) << "%" << std::setw(12) << mismatches
+            << "  (checksum " << (checksum % 1000) << ")\n";
+
+        return mismatches == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs only the smaller trees, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+
+    std::mt19937 random(42);
+
+    std::cout << "Hit testing, nanoseconds per point\n\n";
+    std::cout << std::setw(8) << "Shape" << std::setw(9) << "Nodes" << std::setw(11) << "Build ms" << std::setw(12) << "Index" << std::setw(13) << "Recursive"
+        << std::setw(10) << "Speedup" << std::setw(9) << "Hits" << std::setw(12) << "Mismatches" << "\n";
+
+    bool passed = true;
+    for (uint32_t nodeCount : { 10'000u, 100'000u })
+    {
+        if (quick && nodeCount > 10'000u)
+        {
+            break;
+        }
+
+        size_t pointCount = quick ? 2'000 : 10'000;
+        passed &= RunCase("grid", CreateGridTree(nodeCount), pointCount, random);
+        passed &= RunCase("random", CreateTree(nodeCount, nodeCount, random), pointCount, random);
+        passed &= RunCase("deep", CreateTree(nodeCount, 64, random), pointCount, random);
+    }
+
+    if (!passed)
+    {
+        std::cerr << "The index and the recursive walk disagree.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures OutputResourceList::FlushDirty over 10,000 dirty sprites, half of them hidden, where
+// ShouldFlushFirst is asked of every dirty sprite to put the visible ones first:
+//
+// * D2DSprite, which answers from the visibility it caches in its IsVisible setter.
+// * The same sprite answering by reading IsVisible from its sprite visual, as D2DSprite did
+//   before, which is a call into the compositor per dirty sprite.
+//
+// Neither sprite renders anything when it's initialized, so the flush is only the queue walk and
+// the ShouldFlushFirst calls. It also checks that both flush every visible sprite before any hidden
+// one, in the order they were marked dirty, and that a flush carries on correctly when initializing
+// a sprite destroys the next dirty one and marks another dirty.
+
+#include "precomp.h"
+#include "D2DSprite.h"
+#include "Output.h"
+
+#include <DispatcherQueue.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    // A sprite that records the order it's initialized in, instead of rendering.
+    class IdleSprite : public SystemD2DSprite
+    {
+    public:
+        IdleSprite(SystemOutput const& output, std::vector<IdleSprite const*>& initialized) :
+            SystemD2DSprite(output),
+            m_initialized(initialized)
+        {
+        }
+
+        void EnsureInitialized(SystemOutput const&) override
+        {
+            m_initialized.push_back(this);
+            if (m_onInitialized)
+            {
+                m_onInitialized();
+            }
+        }
+
+        // Called each time the sprite is initialized, after it's recorded.
+        void OnInitialized(std::function<void()> callback)
+        {
+            m_onInitialized = std::move(callback);
+        }
+
+    protected:
+        void RenderContent(SystemOutput const&, ID2D1DeviceContext5*) override
+        {
+        }
+
+    private:
+        std::vector<IdleSprite const*>& m_initialized;
+        std::function<void()> m_onInitialized;
+    };
+
+    // Reads the sprite visual's visibility on every call.
+    class QueryingSprite final : public IdleSprite
+    {
+    public:
+        QueryingSprite(SystemOutput const& output, std::vector<IdleSprite const*>& initialized) :
+            IdleSprite(output, initialized),
+            m_spriteVisual(GetVisual().Children().First().Current().as<winrt::WUC::SpriteVisual>())
+        {
+        }
+
+        bool ShouldFlushFirst() const override
+        {
+            return m_spriteVisual.IsVisible();
+        }
+
+    private:
+        winrt::WUC::SpriteVisual m_spriteVisual;
+    };
+
+    template<class TCallback>
+    double MeasureMicroseconds(TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+    // Flushes a hidden sprite and three visible ones, marked dirty in that order, where initializing
+    // the first visible one destroys the second and marks a fourth dirty. The visible ones move
+    // ahead of the hidden one, and the one marked during the flush goes last.
+    bool CheckReentrantFlush(SystemOutput const& output)
+    {
+        std::vector<IdleSprite const*> initialized;
+        std::vector<std::unique_ptr<IdleSprite>> sprites;
+        for (size_t i = 0; i < 5; i++)
+        {
+            sprites.push_back(std::make_unique<IdleSprite>(output, initialized));
+        }
+        sprites[0]->IsVisible(false);
+
+        auto& resourceList = output.GetResourceList();
+        resourceList->FlushDirty(output);
+        initialized.clear();
+
+        sprites[1]->OnInitialized([&]()
+            {
+                sprites[2].reset();
+                sprites[4]->InvalidateContent();
+            });
+        for (size_t i = 0; i < 4; i++)
+        {
+            sprites[i]->InvalidateContent();
+        }
+        resourceList->FlushDirty(output);
+
+        return initialized == std::vector<IdleSprite const*>{ sprites[1].get(), sprites[3].get(), sprites[0].get(), sprites[4].get() } &&
+            !resourceList->HasDirtyResources();
+    }
+
+    // Creates the sprites, hides every other one, and measures marking them all dirty and flushing.
+    // Returns the time per flush, and whether the last flush went in the expected order.
+    template<class TSprite>
+    std::pair<double, bool> MeasureFlush(SystemOutput const& output, size_t spriteCount)
+    {
+        std::vector<IdleSprite const*> initialized;
+        std::vector<std::unique_ptr<TSprite>> sprites;
+        for (size_t i = 0; i < spriteCount; i++)
+        {
+            sprites.push_back(std::make_unique<TSprite>(output, initialized));
+            sprites.back()->IsVisible(i % 2 == 0);
+        }
+
+        auto& resourceList = output.GetResourceList();
+        resourceList->FlushDirty(output);
+
+        auto microseconds = MeasureMicroseconds([&]()
+            {
+                initialized.clear();
+                for (auto& sprite : sprites)
+                {
+                    sprite->InvalidateContent();
+                }
+                resourceList->FlushDirty(output);
+            });
+
+        // The visible (even) sprites in order, then the hidden (odd) ones in order.
+        bool inOrder = initialized.size() == spriteCount;
+        for (size_t i = 0; inOrder && i < spriteCount; i++)
+        {
+            auto expected = (i < (spriteCount + 1) / 2) ? i * 2 : (i - (spriteCount + 1) / 2) * 2 + 1;
+            inOrder = initialized[i] == sprites[expected].get();
+        }
+
+        return { microseconds, inOrder };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick flushes fewer sprites, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t spriteCount = quick ? 1'000 : 10'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    SystemOutput output(compositor, std::make_shared<SettingCollection>());
+
+    bool reentrantInOrder = CheckReentrantFlush(output);
+    auto [cached, cachedInOrder] = MeasureFlush<IdleSprite>(output, spriteCount);
+    auto [queried, queriedInOrder] = MeasureFlush<QueryingSprite>(output, spriteCount);
+
+    std::cout << "Flushing " << spriteCount << " dirty sprites, half of them hidden, microseconds per flush\n\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Cached visibility:        " << std::setw(10) << cached << (cachedInOrder ? "" : "  OUT OF ORDER") << "\n";
+    std::cout << "Sprite visual IsVisible:  " << std::setw(10) << queried << (queriedInOrder ? "" : "  OUT OF ORDER") << "\n";
+    std::cout << "Speedup:                  " << std::setw(10) << (queried / cached) << "x\n";
+    std::cout << "\nFlush that destroys and dirties sprites: " << (reentrantInOrder ? "in order" : "OUT OF ORDER") << "\n";
+
+    return (cachedInOrder && queriedInOrder && reentrantInOrder) ? 0 : 1;
+}
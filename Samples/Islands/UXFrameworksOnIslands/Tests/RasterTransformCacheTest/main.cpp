@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Checks RasterTransformCache against walking each visual's ancestors directly, on a tree of
+// system composition visuals with random scales, rotations and transform matrices:
+//
+// * Every visual's world transform matches the direct walk, and the statistics show each visual
+//   was read once, with every other lookup answered from the cache.
+// * After some visuals change and the cache is invalidated, the transforms reflect the change.
+// * Visuals that were looked up and then released, in the same generation as visuals created
+//   after them, don't lend their cached transforms to the new visuals (which may otherwise be
+//   created at the same addresses).
+
+#include "precomp.h"
+#include "RasterTransformCache.h"
+
+#include <DispatcherQueue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    using ContainerVisual = winrt::WUC::ContainerVisual;
+
+    winrt::float4x4 ComputeLocalTransform(ContainerVisual const& visual)
+    {
+        auto transform = winrt::make_float4x4_scale(visual.Scale());
+        transform *= winrt::make_float4x4_from_axis_angle(visual.RotationAxis(), visual.RotationAngle());
+        transform *= visual.TransformMatrix();
+        return transform;
+    }
+
+    // The aggregate transform to the root, computed without the cache.
+    winrt::float4x4 ComputeWorldTransform(ContainerVisual const& visual)
+    {
+        auto transform = winrt::float4x4::identity();
+        for (auto current = visual; current != nullptr; current = current.Parent())
+        {
+            transform = transform * ComputeLocalTransform(current);
+        }
+        return transform;
+    }
+
+    bool NearlyEqual(winrt::float4x4 const& lhs, winrt::float4x4 const& rhs)
+    {
+        auto l = &lhs.m11;
+        auto r = &rhs.m11;
+        for (size_t i = 0; i < 16; i++)
+        {
+            if (std::abs(l[i] - r[i]) > 1e-4f * std::max(1.0f, std::abs(r[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RandomizeTransform(ContainerVisual const& visual, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+        visual.Scale({ scale(random), scale(random), 1.0f });
+        visual.RotationAngle(angle(random));
+        if (random() % 4 == 0)
+        {
+            visual.TransformMatrix(winrt::make_float4x4_rotation_y(angle(random) / 4.0f));
+        }
+    }
+
+    // Builds a tree breadth first, with a random parent for each visual.
+    std::vector<ContainerVisual> BuildTree(winrt::WUC::Compositor const& compositor, size_t visualCount, std::mt19937& random)
+    {
+        std::vector<ContainerVisual> visuals{ compositor.CreateContainerVisual() };
+        for (size_t i = 1; i < visualCount; i++)
+        {
+            auto visual = compositor.CreateContainerVisual();
+            RandomizeTransform(visual, random);
+            visuals[random() % i].Children().InsertAtTop(visual);
+            visuals.push_back(visual);
+        }
+        return visuals;
+    }
+
+    size_t CountMismatches(SystemRasterTransformCache& cache, std::vector<ContainerVisual> const& visuals)
+    {
+        size_t mismatches = 0;
+        for (auto& visual : visuals)
+        {
+            mismatches += NearlyEqual(cache.GetWorldTransform(visual), ComputeWorldTransform(visual)) ? 0 : 1;
+        }
+        return mismatches;
+    }
+
+    bool Check(bool condition, char const* message)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << message << "\n";
+        }
+        return condition;
+    }
+}
+
+int main()
+{
+    constexpr size_t c_visualCount = 2'000;
+    constexpr size_t c_releasedCount = 1'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    std::mt19937 random(42);
+    auto visuals = BuildTree(compositor, c_visualCount, random);
+    SystemRasterTransformCache cache;
+    bool passed = true;
+
+    // Parents are looked up before their children, so each visual is read once, and every lookup
+    // but the root's ends at its parent's cached entry.
+    auto mismatches = CountMismatches(cache, visuals);
+    auto statistics = cache.GetStatistics();
+    std::cout << "First generation: " << mismatches << " mismatches, " << statistics.visualsComputed << " visuals computed, "
+        << statistics.cacheHits << " cache hits\n";
+    passed &= Check(mismatches == 0, "cached transforms differ from the direct walk");
+    passed &= Check(statistics.visualsComputed == c_visualCount, "a visual was computed more than once");
+    passed &= Check(statistics.cacheHits == c_visualCount - 1, "a lookup wasn't answered from the cache");
+
+    // Looking everything up again is all cache hits.
+    CountMismatches(cache, visuals);
+    passed &= Check(cache.GetStatistics().visualsComputed == c_visualCount, "a cached visual was computed again");
+
+    // Change a tenth of the visuals, including ones high in the tree, and start a new generation.
+    for (size_t i = 1; i < c_visualCount; i += 10)
+    {
+        RandomizeTransform(visuals[i], random);
+    }
+    cache.Invalidate();
+    passed &= Check(cache.GetStatistics().visualsComputed == 0 && cache.GetStatistics().cacheHits == 0, "Invalidate didn't reset the statistics");
+    mismatches = CountMismatches(cache, visuals);
+    std::cout << "After changes: " << mismatches << " mismatches\n";
+    passed &= Check(mismatches == 0, "transforms are stale after Invalidate");
+
+    // Look up scaled visuals and release them, then create unscaled ones in the same generation.
+    // The cache keeps the released visuals alive until an Invalidate finds them unused, so none of
+    // the new visuals can be at an address with a cached entry.
+    cache.Invalidate();
+    auto root = compositor.CreateContainerVisual();
+    {
+        std::vector<ContainerVisual> released;
+        for (size_t i = 0; i < c_releasedCount; i++)
+        {
+            auto visual = compositor.CreateContainerVisual();
+            visual.Scale({ 3.0f, 3.0f, 1.0f });
+            root.Children().InsertAtTop(visual);
+            cache.GetWorldTransform(visual);
+            released.push_back(visual);
+        }
+        root.Children().RemoveAll();
+    }
+
+    std::vector<ContainerVisual> created;
+    for (size_t i = 0; i < c_releasedCount; i++)
+    {
+        auto visual = compositor.CreateContainerVisual();
+        root.Children().InsertAtTop(visual);
+        created.push_back(visual);
+    }
+    mismatches = CountMismatches(cache, created);
+    std::cout << "Visuals created after others were released: " << mismatches << " mismatches\n";
+    passed &= Check(mismatches == 0, "a new visual got a released visual's transform");
+
+    // Two more generations drop the released visuals' entries, and the new ones are still right.
+    cache.Invalidate();
+    cache.Invalidate();
+    passed &= Check(CountMismatches(cache, created) == 0, "transforms are wrong after the released entries are discarded");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures SeqLockValue under contention: N reader threads load a value the size of
+// VisualTreeNode's published geometry while one writer stores a new value every few microseconds.
+// Reports the total reader throughput and the writer's store latency, against a value guarded by
+// a std::mutex (the way the geometry was guarded before), and checks that no reader ever sees a
+// torn value.
+
+#include "precomp.h"
+#include "SeqLockValue.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+    // Same layout as VisualTreeNode::Geometry.
+    struct Geometry
+    {
+        winrt::float2 size{ 0.0f, 0.0f };
+        winrt::float4x4 transform{ winrt::float4x4::identity() };
+        winrt::float4x4 inverseTransform{ winrt::float4x4::identity() };
+        bool isTransformInvertible{ true };
+    };
+
+    // Every float in a value written by the benchmark holds the same number, so a reader can tell
+    // whether it saw parts of two different writes.
+    Geometry MakeGeometry(uint32_t version) noexcept
+    {
+        auto value = static_cast<float>(version);
+        Geometry geometry;
+        geometry.size = { value, value };
+        std::fill_n(&geometry.transform.m11, 16, value);
+        std::fill_n(&geometry.inverseTransform.m11, 16, value);
+        return geometry;
+    }
+
+    bool IsConsistent(const Geometry& geometry) noexcept
+    {
+        auto value = geometry.size.x;
+        return geometry.size.y == value &&
+            std::all_of(&geometry.transform.m11, &geometry.transform.m11 + 16, [value](float element) { return element == value; }) &&
+            std::all_of(&geometry.inverseTransform.m11, &geometry.inverseTransform.m11 + 16, [value](float element) { return element == value; });
+    }
+
+    class SeqLockStorage
+    {
+    public:
+        static constexpr const char* Name = "SeqLockValue";
+
+        Geometry Load() const noexcept { return m_value.Load(); }
+        void Store(const Geometry& value) noexcept { m_value.Store(value); }
+
+    private:
+        SeqLockValue<Geometry> m_value{};
+    };
+
+    class MutexStorage
+    {
+    public:
+        static constexpr const char* Name = "std::mutex";
+
+        Geometry Load() const
+        {
+            std::unique_lock lock{ m_mutex };
+            return m_value;
+        }
+
+        void Store(const Geometry& value)
+        {
+            std::unique_lock lock{ m_mutex };
+            m_value = value;
+        }
+
+    private:
+        mutable std::mutex m_mutex{};
+        Geometry m_value{};
+    };
+
+    struct Result
+    {
+        double readsPerMicrosecond;
+        double writerP50Nanoseconds;
+        double writerP99Nanoseconds;
+        size_t writes;
+        size_t tornReads;
+    };
+
+    template<class TStorage>
+    Result Run(unsigned readerCount, std::chrono::milliseconds duration)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        TStorage storage;
+        storage.Store(MakeGeometry(0));
+
+        std::atomic<bool> stop{ false };
+        std::vector<size_t> reads(readerCount);
+        std::vector<size_t> tornReads(readerCount);
+        std::vector<std::thread> readers;
+        for (unsigned reader = 0; reader < readerCount; reader++)
+        {
+            readers.emplace_back([&, reader]()
+                {
+                    size_t count = 0;
+                    size_t torn = 0;
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        torn += IsConsistent(storage.Load()) ? 0 : 1;
+                        count++;
+                    }
+                    reads[reader] = count;
+                    tornReads[reader] = torn;
+                });
+        }
+
+        // Store a new value every 5 microseconds (about as often as a busy UI thread would update
+        // a node's geometry), timing each store.
+        std::vector<double> storeNanoseconds;
+        const auto start = Clock::now();
+        auto nextStore = start;
+        for (uint32_t version = 1; Clock::now() - start < duration; version++)
+        {
+            while (Clock::now() < nextStore)
+            {
+                YieldProcessor();
+            }
+
+            auto value = MakeGeometry(version);
+            auto storeStart = Clock::now();
+            storage.Store(value);
+            storeNanoseconds.push_back(std::chrono::duration<double, std::nano>(Clock::now() - storeStart).count());
+            nextStore = storeStart + std::chrono::microseconds(5);
+        }
+
+        stop = true;
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        auto elapsed = Clock::now() - start;
+
+        std::sort(storeNanoseconds.begin(), storeNanoseconds.end());
+        size_t totalReads = 0;
+        size_t totalTornReads = 0;
+        for (unsigned reader = 0; reader < readerCount; reader++)
+        {
+            totalReads += reads[reader];
+            totalTornReads += tornReads[reader];
+        }
+
+        return {
+            static_cast<double>(totalReads) / std::chrono::duration<double, std::micro>(elapsed).count(),
+            storeNanoseconds[storeNanoseconds.size() / 2],
+            storeNanoseconds[storeNanoseconds.size() * 99 / 100],
+            storeNanoseconds.size(),
+            totalTornReads };
+    }
+
+    template<class TStorage>
+    bool Report(unsigned readerCount, std::chrono::milliseconds duration)
+    {
+        auto result = Run<TStorage>(readerCount, duration);
+        std::cout << std::setw(14) << TStorage::Name << std::setw(9) << readerCount
+            << std::setw(16) << std::fixed << std::setprecision(1) << result.readsPerMicrosecond
+            << std::setw(13) << result.writerP50Nanoseconds << std::setw(13) << result.writerP99Nanoseconds
+            << std::setw(10) << result.writes << std::setw(8) << result.tornReads << "\n";
+        return result.tornReads == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs for a shorter time, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    auto duration = std::chrono::milliseconds(quick ? 100 : 1000);
+
+    std::cout << "One writer storing every 5 us against N readers (" << std::thread::hardware_concurrency() << " hardware threads)\n\n";
+    std::cout << std::setw(14) << "Storage" << std::setw(9) << "Readers" << std::setw(16) << "Reads per us" << std::setw(13) << "Store p50 ns"
+        << std::setw(13) << "Store p99 ns" << std::setw(10) << "Stores" << std::setw(8) << "Torn" << "\n";
+
+    bool passed = true;
+    for (unsigned readerCount : { 1u, 2u, 4u, 8u })
+    {
+        passed &= Report<SeqLockStorage>(readerCount, duration);
+        passed &= Report<MutexStorage>(readerCount, duration);
+    }
+
+    if (!passed)
+    {
+        std::cerr << "A reader saw a torn value.\n";
+        return 1;
+    }
+
+    return 0;
+}
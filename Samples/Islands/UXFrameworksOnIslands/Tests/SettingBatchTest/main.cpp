@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Counts how D2DSprites react to setting changes, on 1,000 sprites of a system output whose frame
+// passes each change to its resource list and then flushes it, the way SystemFrame does:
+//
+// * Changing every setting one at a time notifies every sprite once per setting, and re-renders it
+//   once for each setting that affects its content or surface.
+// * Changing every setting back inside one SettingCollection::Batch notifies every sprite once,
+//   with all of the settings, and re-renders it once.
+//
+// The sprites are D2DSprites whose only additions are counters and fixed content bounds, so the
+// reactions being counted are D2DSprite's own. It fails unless the batch causes exactly one
+// notification and one render per sprite, and leaves every sprite's pixel snapping matching the
+// setting.
+
+#include "precomp.h"
+#include "D2DSprite.h"
+#include "Output.h"
+
+#include <DispatcherQueue.h>
+
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    constexpr SettingId c_settingIds[] = {
+        Setting_ForceAliasedText,
+        Setting_DisablePixelSnapping,
+        Setting_ShowSpriteBounds,
+        Setting_ShowSpriteGeneration,
+        Setting_ShowPopupVisual };
+
+    // Counts the notifications and renders that D2DSprite's own handling causes.
+    class CountingSprite final : public SystemD2DSprite
+    {
+    public:
+        explicit CountingSprite(SystemOutput const& output) :
+            SystemD2DSprite(output)
+        {
+        }
+
+        void OnSettingsChanged(SystemOutput const& output, SettingMask changedSettings) override
+        {
+            m_notificationCount++;
+            SystemD2DSprite::OnSettingsChanged(output, changedSettings);
+        }
+
+        size_t NotificationCount() const noexcept { return m_notificationCount; }
+        size_t RenderCount() const noexcept { return m_renderCount; }
+
+        void ResetCounts() noexcept
+        {
+            m_notificationCount = 0;
+            m_renderCount = 0;
+        }
+
+    protected:
+        bool TryGetContentBounds(SystemOutput const&, D2D1_RECT_F& bounds) override
+        {
+            bounds = { 0.0f, 0.0f, 32.0f, 16.0f };
+            return true;
+        }
+
+        void RenderContent(SystemOutput const&, ID2D1DeviceContext5*) override
+        {
+            m_renderCount++;
+        }
+
+    private:
+        size_t m_notificationCount = 0;
+        size_t m_renderCount = 0;
+    };
+
+    // Passes setting changes to the output's resources and flushes them, as SystemFrame does
+    // (without the layout pass some settings also cause, which doesn't change these counts).
+    class Frame final : public SettingChangedHandler
+    {
+    public:
+        explicit Frame(SystemOutput const& output) :
+            SettingChangedHandler(output.GetSettings()),
+            m_output(output)
+        {
+        }
+
+        void OnSettingsChanged(SettingMask changedSettings) override
+        {
+            m_output.GetResourceList()->OnSettingsChanged(m_output, changedSettings);
+            m_output.GetResourceList()->FlushDirty(m_output);
+        }
+
+    private:
+        SystemOutput const& m_output;
+    };
+
+    struct Totals
+    {
+        size_t notifications = 0;
+        size_t renders = 0;
+        size_t spritesNotOnce = 0;
+        size_t spritesWithWrongSnapping = 0;
+    };
+
+    Totals CountAndReset(std::vector<std::unique_ptr<CountingSprite>> const& sprites, bool isPixelSnappingEnabled)
+    {
+        Totals totals;
+        for (auto& sprite : sprites)
+        {
+            totals.notifications += sprite->NotificationCount();
+            totals.renders += sprite->RenderCount();
+            totals.spritesNotOnce += (sprite->NotificationCount() == 1 && sprite->RenderCount() == 1) ? 0 : 1;
+            totals.spritesWithWrongSnapping += (sprite->IsPixelSnappingEnabled() == isPixelSnappingEnabled) ? 0 : 1;
+            sprite->ResetCounts();
+        }
+        return totals;
+    }
+
+    void Print(const char* name, Totals const& totals, size_t spriteCount)
+    {
+        std::cout << std::setw(24) << name << std::fixed << std::setprecision(1)
+            << std::setw(16) << (static_cast<double>(totals.notifications) / spriteCount)
+            << std::setw(10) << (static_cast<double>(totals.renders) / spriteCount) << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick uses fewer sprites, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t spriteCount = quick ? 100 : 1'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    auto settings = std::make_shared<SettingCollection>();
+    SystemOutput output(compositor, settings);
+    Frame frame(output);
+
+    std::vector<std::unique_ptr<CountingSprite>> sprites;
+    for (size_t i = 0; i < spriteCount; i++)
+    {
+        sprites.push_back(std::make_unique<CountingSprite>(output));
+    }
+    output.GetResourceList()->FlushDirty(output);
+    CountAndReset(sprites, true);
+
+    std::cout << "Changing all settings on " << spriteCount << " sprites, per sprite\n\n";
+    std::cout << std::setw(24) << "" << std::setw(16) << "Notifications" << std::setw(10) << "Renders" << "\n";
+
+    for (auto id : c_settingIds)
+    {
+        settings->SetSetting(id, true);
+    }
+    Print("One at a time", CountAndReset(sprites, false), spriteCount);
+
+    {
+        SettingCollection::Batch batch{ *settings };
+        for (auto id : c_settingIds)
+        {
+            settings->SetSetting(id, false);
+        }
+        batch.Commit();
+    }
+    auto batched = CountAndReset(sprites, true);
+    Print("In one batch", batched, spriteCount);
+
+    std::cout << "\nSprites not notified and rendered exactly once by the batch: " << batched.spritesNotOnce
+        << ", with the wrong pixel snapping: " << batched.spritesWithWrongSnapping << "\n";
+
+    return (batched.spritesNotOnce == 0 && batched.spritesWithWrongSnapping == 0) ? 0 : 1;
+}
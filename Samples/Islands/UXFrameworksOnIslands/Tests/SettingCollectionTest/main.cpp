@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Checks which notifications SettingCollection sends, with handlers subscribed the way the
+// sample's are: a check box per setting, subscribed to its own setting, and frames subscribed to
+// every setting. What a notification then costs each sprite is checked against the real D2DSprite
+// by SettingBatchTest, which needs Windows.
+//
+// * Clicking each check box notifies that check box and every frame once, with only that setting.
+// * Changing every setting in one batch notifies each check box once with its own setting, and
+//   each frame once with all of them, when the batch commits and not before.
+// * Nested batches notify when the outermost one commits, settings changed and changed back within
+//   a batch aren't reported, and a batch guard destroyed without Commit still commits.
+// * Setting an unchanged value, or changing a setting after a handler is removed, notifies no one.
+
+#include "precomp.h"
+#include "SettingCollection.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    constexpr SettingId c_settingIds[] = {
+        Setting_ForceAliasedText,
+        Setting_DisablePixelSnapping,
+        Setting_ShowSpriteBounds,
+        Setting_ShowSpriteGeneration,
+        Setting_ShowPopupVisual };
+
+    constexpr const char* c_settingNames[] = {
+        "ForceAliasedText",
+        "DisablePixelSnapping",
+        "ShowSpriteBounds",
+        "ShowSpriteGeneration",
+        "ShowPopupVisual" };
+
+    constexpr size_t c_frameCount = 5;
+
+    // Counts notifications to every handler, including ones that have since been destroyed.
+    size_t g_notificationCount = 0;
+
+    SettingMask AllSettingIds() noexcept
+    {
+        SettingMask mask = 0;
+        for (auto id : c_settingIds)
+        {
+            mask |= SettingMaskOf(id);
+        }
+        return mask;
+    }
+
+    // Records every notification it receives.
+    struct Handler : SettingChangedHandler
+    {
+        Handler(const std::shared_ptr<SettingCollection>& settings, SettingMask settingsOfInterest) :
+            SettingChangedHandler(settings, settingsOfInterest)
+        {
+        }
+
+        void OnSettingsChanged(SettingMask changedSettings) override
+        {
+            notifications.push_back(changedSettings);
+            g_notificationCount++;
+        }
+
+        std::vector<SettingMask> notifications;
+    };
+
+    struct Handlers
+    {
+        std::vector<std::unique_ptr<Handler>> checkBoxes;
+        std::vector<std::unique_ptr<Handler>> frames;
+
+        void Clear()
+        {
+            for (auto& handler : checkBoxes)
+            {
+                handler->notifications.clear();
+            }
+            for (auto& handler : frames)
+            {
+                handler->notifications.clear();
+            }
+        }
+
+        size_t Count() const
+        {
+            size_t count = 0;
+            for (auto& handler : checkBoxes)
+            {
+                count += handler->notifications.size();
+            }
+            for (auto& handler : frames)
+            {
+                count += handler->notifications.size();
+            }
+            return count;
+        }
+
+        // Whether each check box heard once about its own setting if it's in the mask (and nothing
+        // otherwise), and each frame heard once about exactly the mask.
+        bool NotifiedOnce(SettingMask changedSettings) const
+        {
+            for (size_t i = 0; i < checkBoxes.size(); i++)
+            {
+                auto expected = changedSettings & SettingMaskOf(c_settingIds[i]);
+                auto& notifications = checkBoxes[i]->notifications;
+                if ((expected == 0) ? !notifications.empty() : (notifications != std::vector<SettingMask>{ expected }))
+                {
+                    return false;
+                }
+            }
+            for (auto& frame : frames)
+            {
+                if (frame->notifications != std::vector<SettingMask>{ changedSettings })
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    bool Check(bool condition, const char* message)
+    {
+        if (!condition)
+        {
+            std::cout << "FAILED: " << message << "\n";
+        }
+        return condition;
+    }
+}
+
+int main()
+{
+    auto settings = std::make_shared<SettingCollection>();
+
+    Handlers handlers;
+    for (auto id : c_settingIds)
+    {
+        handlers.checkBoxes.push_back(std::make_unique<Handler>(settings, SettingMaskOf(id)));
+    }
+    for (size_t i = 0; i < c_frameCount; i++)
+    {
+        handlers.frames.push_back(std::make_unique<Handler>(settings, c_allSettings));
+    }
+
+    bool passed = true;
+
+    // One click on each check box.
+    std::cout << std::setw(22) << "Setting" << std::setw(16) << "Notifications" << "\n";
+    for (size_t i = 0; i < std::size(c_settingIds); i++)
+    {
+        handlers.Clear();
+        settings->SetSetting(c_settingIds[i], true);
+        bool notifiedOnce = handlers.NotifiedOnce(SettingMaskOf(c_settingIds[i]));
+        std::cout << std::setw(22) << c_settingNames[i] << std::setw(16) << handlers.Count() << (notifiedOnce ? "" : "  UNEXPECTED") << "\n";
+        passed &= notifiedOnce;
+
+        handlers.Clear();
+        settings->SetSetting(c_settingIds[i], true);
+        passed &= Check(handlers.Count() == 0, "setting an unchanged value notified a handler");
+    }
+
+    // Every setting at once, in one batch.
+    {
+        handlers.Clear();
+        SettingCollection::Batch batch{ *settings };
+        for (auto id : c_settingIds)
+        {
+            settings->SetSetting(id, false);
+        }
+        passed &= Check(handlers.Count() == 0, "a handler was notified before the batch committed");
+
+        batch.Commit();
+        bool notifiedOnce = handlers.NotifiedOnce(AllSettingIds());
+        std::cout << std::setw(22) << "All, in one batch" << std::setw(16) << handlers.Count() << (notifiedOnce ? "" : "  UNEXPECTED") << "\n";
+        passed &= notifiedOnce;
+    }
+
+    // Nested batches, with one setting changed back.
+    handlers.Clear();
+    settings->BeginBatch();
+    settings->SetSetting(Setting_ForceAliasedText, true);
+    settings->BeginBatch();
+    settings->SetSetting(Setting_ShowSpriteBounds, true);
+    settings->SetSetting(Setting_ForceAliasedText, false);
+    settings->CommitBatch();
+    passed &= Check(handlers.Count() == 0, "an inner batch notified a handler");
+    settings->CommitBatch();
+    passed &= Check(handlers.NotifiedOnce(SettingMaskOf(Setting_ShowSpriteBounds)), "nested batches didn't notify once with the net change");
+
+    // A batch with no net change.
+    handlers.Clear();
+    {
+        SettingCollection::Batch batch{ *settings };
+        settings->SetSetting(Setting_ShowPopupVisual, true);
+        settings->SetSetting(Setting_ShowPopupVisual, false);
+        batch.Commit();
+    }
+    passed &= Check(handlers.Count() == 0, "a batch without a net change notified a handler");
+
+    // A guard destroyed without Commit.
+    handlers.Clear();
+    {
+        SettingCollection::Batch batch{ *settings };
+        settings->SetSetting(Setting_DisablePixelSnapping, true);
+    }
+    passed &= Check(handlers.NotifiedOnce(SettingMaskOf(Setting_DisablePixelSnapping)), "a batch guard destroyed without Commit didn't commit");
+
+    // Removed handlers aren't notified.
+    handlers.checkBoxes.clear();
+    handlers.frames.clear();
+    Handler remaining{ settings, c_allSettings };
+    g_notificationCount = 0;
+    settings->SetSetting(Setting_ShowSpriteBounds, false);
+    passed &= Check(g_notificationCount == 1 && remaining.notifications.size() == 1, "a removed handler was notified");
+
+    return passed ? 0 : 1;
+}
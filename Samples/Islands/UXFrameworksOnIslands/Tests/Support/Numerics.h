@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+// The subset of winrt::Windows::Foundation::Numerics and winrt::Windows::Foundation value types
+// that the sample's platform-independent code uses, with the same layouts and row-vector
+// conventions, so that it can be built without the Windows SDK.
+namespace winrt
+{
+    struct float2
+    {
+        float x;
+        float y;
+    };
+
+    inline float2 operator+(float2 const& lhs, float2 const& rhs) noexcept { return { lhs.x + rhs.x, lhs.y + rhs.y }; }
+    inline float2 operator-(float2 const& lhs, float2 const& rhs) noexcept { return { lhs.x - rhs.x, lhs.y - rhs.y }; }
+    inline bool operator==(float2 const& lhs, float2 const& rhs) noexcept { return lhs.x == rhs.x && lhs.y == rhs.y; }
+    inline bool operator!=(float2 const& lhs, float2 const& rhs) noexcept { return !(lhs == rhs); }
+
+    struct float4x4
+    {
+        float m11, m12, m13, m14;
+        float m21, m22, m23, m24;
+        float m31, m32, m33, m34;
+        float m41, m42, m43, m44;
+
+        static float4x4 identity() noexcept
+        {
+            return { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        }
+    };
+
+    inline bool operator==(float4x4 const& lhs, float4x4 const& rhs) noexcept { return memcmp(&lhs, &rhs, sizeof(float4x4)) == 0; }
+    inline bool operator!=(float4x4 const& lhs, float4x4 const& rhs) noexcept { return !(lhs == rhs); }
+
+    inline float4x4 operator*(float4x4 const& lhs, float4x4 const& rhs) noexcept
+    {
+        float4x4 result{};
+        auto* a = &lhs.m11;
+        auto* b = &rhs.m11;
+        auto* c = &result.m11;
+        for (int row = 0; row < 4; row++)
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                c[row * 4 + column] =
+                    a[row * 4 + 0] * b[0 * 4 + column] + a[row * 4 + 1] * b[1 * 4 + column] +
+                    a[row * 4 + 2] * b[2 * 4 + column] + a[row * 4 + 3] * b[3 * 4 + column];
+            }
+        }
+        return result;
+    }
+
+    inline float4x4 make_float4x4_translation(float x, float y, float z = 0.0f) noexcept
+    {
+        auto result = float4x4::identity();
+        result.m41 = x;
+        result.m42 = y;
+        result.m43 = z;
+        return result;
+    }
+
+    inline float4x4 make_float4x4_scale(float x, float y, float z = 1.0f) noexcept
+    {
+        auto result = float4x4::identity();
+        result.m11 = x;
+        result.m22 = y;
+        result.m33 = z;
+        return result;
+    }
+
+    inline float4x4 make_float4x4_rotation_z(float radians) noexcept
+    {
+        auto result = float4x4::identity();
+        result.m11 = std::cos(radians);
+        result.m12 = std::sin(radians);
+        result.m21 = -std::sin(radians);
+        result.m22 = std::cos(radians);
+        return result;
+    }
+
+    inline float2 transform(float2 const& point, float4x4 const& matrix) noexcept
+    {
+        return {
+            (point.x * matrix.m11) + (point.y * matrix.m21) + matrix.m41,
+            (point.x * matrix.m12) + (point.y * matrix.m22) + matrix.m42 };
+    }
+
+    // Inverts the 2D affine part of the matrix, which is all the sample's transforms use.
+    inline bool invert(float4x4 const& matrix, float4x4* result) noexcept
+    {
+        auto determinant = (matrix.m11 * matrix.m22) - (matrix.m12 * matrix.m21);
+        if (determinant == 0.0f || !std::isfinite(determinant))
+        {
+            *result = float4x4{};
+            return false;
+        }
+
+        auto inverse = float4x4::identity();
+        inverse.m11 = matrix.m22 / determinant;
+        inverse.m12 = -matrix.m12 / determinant;
+        inverse.m21 = -matrix.m21 / determinant;
+        inverse.m22 = matrix.m11 / determinant;
+        inverse.m41 = -((matrix.m41 * inverse.m11) + (matrix.m42 * inverse.m21));
+        inverse.m42 = -((matrix.m41 * inverse.m12) + (matrix.m42 * inverse.m22));
+        *result = inverse;
+        return true;
+    }
+
+    struct Point
+    {
+        float X;
+        float Y;
+    };
+
+    struct Size
+    {
+        float Width;
+        float Height;
+    };
+
+    struct Rect
+    {
+        float X;
+        float Y;
+        float Width;
+        float Height;
+    };
+
+    inline bool operator==(Rect const& lhs, Rect const& rhs) noexcept
+    {
+        return lhs.X == rhs.X && lhs.Y == rhs.Y && lhs.Width == rhs.Width && lhs.Height == rhs.Height;
+    }
+    inline bool operator!=(Rect const& lhs, Rect const& rhs) noexcept { return !(lhs == rhs); }
+}
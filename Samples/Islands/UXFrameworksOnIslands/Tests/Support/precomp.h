@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+// Stands in for the sample's precomp.h when building its platform-independent parts (data
+// structures that only depend on the C++ standard library and the winrt numerics types) into the
+// tests and benchmarks. See Tests/readme.md.
+
+// C++ Standard headers
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YieldProcessor() _mm_pause()
+#else
+#define YieldProcessor() std::atomic_signal_fence(std::memory_order_seq_cst)
+#endif
+
+// Windows types
+using LONG = int32_t;
+
+struct RECT
+{
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+};
+
+// SAL annotations
+#define _In_
+#define _In_opt_
+#define _Inout_
+#define _Out_
+#define _In_reads_(count)
+#define _Out_writes_(count)
+#endif
+
+#ifndef WINRT_ASSERT
+#define WINRT_ASSERT(expression) assert(expression)
+#endif
+
+#include "Numerics.h"
@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Checks that TransformBatch gives the same results as transforming one point at a time with
+// winrt::transform (for every count, including ones that leave a remainder after the vector
+// loops, and with the results aliasing the points), and compares their speed. CMake builds this
+// once per code path: with runtime dispatch (AVX2 where supported), with only SSE2, and scalar.
+
+#include "precomp.h"
+#include "TransformBatch.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    winrt::Rect ReferenceBounds(const winrt::float4x4& transform, const winrt::float2& size)
+    {
+        std::array<winrt::float2, 4> corners{
+            winrt::transform({ 0.0f, 0.0f }, transform),
+            winrt::transform({ size.x, 0.0f }, transform),
+            winrt::transform({ 0.0f, size.y }, transform),
+            winrt::transform({ size.x, size.y }, transform) };
+
+        auto left = corners[0].x;
+        auto top = corners[0].y;
+        auto right = corners[0].x;
+        auto bottom = corners[0].y;
+        for (const auto& corner : corners)
+        {
+            left = std::min(left, corner.x);
+            top = std::min(top, corner.y);
+            right = std::max(right, corner.x);
+            bottom = std::max(bottom, corner.y);
+        }
+
+        return { left, top, right - left, bottom - top };
+    }
+
+    winrt::float4x4 RandomTransform(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        return winrt::make_float4x4_rotation_z(unit(random) * 3.0f) *
+            winrt::make_float4x4_scale(0.25f + 2.0f * std::fabs(unit(random)), 0.25f + 2.0f * std::fabs(unit(random))) *
+            winrt::make_float4x4_translation(unit(random) * 1000.0f, unit(random) * 1000.0f);
+    }
+
+    struct Inputs
+    {
+        winrt::float4x4 transform;
+        std::vector<winrt::float2> points;
+        std::vector<winrt::float4x4> transforms;
+        std::vector<winrt::float2> sizes;
+    };
+
+    Inputs CreateInputs(size_t count, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+        Inputs inputs{ RandomTransform(random), {}, {}, {} };
+        for (size_t i = 0; i < count; i++)
+        {
+            inputs.points.push_back({ coordinate(random), coordinate(random) });
+            inputs.transforms.push_back(RandomTransform(random));
+            inputs.sizes.push_back({ std::fabs(coordinate(random)), std::fabs(coordinate(random)) });
+        }
+        return inputs;
+    }
+
+    size_t CountMismatches(size_t count, std::mt19937& random)
+    {
+        auto inputs = CreateInputs(count, random);
+        size_t mismatches = 0;
+
+        std::vector<winrt::float2> points(count);
+        TransformBatch::TransformPoints(inputs.transform, inputs.points.data(), points.data(), count);
+
+        // The results may alias the points.
+        auto aliased = inputs.points;
+        TransformBatch::TransformPoints(inputs.transform, aliased.data(), aliased.data(), count);
+
+        std::vector<winrt::Rect> bounds(count);
+        TransformBatch::TransformBounds(inputs.transforms.data(), inputs.sizes.data(), bounds.data(), count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto expectedPoint = winrt::transform(inputs.points[i], inputs.transform);
+            auto expectedBounds = ReferenceBounds(inputs.transforms[i], inputs.sizes[i]);
+            mismatches += (points[i] != expectedPoint) ? 1 : 0;
+            mismatches += (aliased[i] != expectedPoint) ? 1 : 0;
+            mismatches += (bounds[i] != expectedBounds) ? 1 : 0;
+        }
+
+        return mismatches;
+    }
+
+    template<class TCallback>
+    double MeasureNanosecondsPerItem(size_t count, TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * count);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick only checks the results, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+
+    std::mt19937 random(42);
+
+    size_t mismatches = 0;
+    for (size_t count = 0; count <= 37; count++)
+    {
+        mismatches += CountMismatches(count, random);
+    }
+    mismatches += CountMismatches(100'003, random);
+
+    std::cout << TRANSFORM_BATCH_TEST_VARIANT << ": " << mismatches << " mismatches against winrt::transform\n";
+    if (mismatches != 0)
+    {
+        return 1;
+    }
+
+    if (quick)
+    {
+        return 0;
+    }
+
+    std::cout << "\nNanoseconds per item, one at a time against TransformBatch\n\n";
+    std::cout << std::setw(9) << "Count" << std::setw(12) << "Points" << std::setw(10) << "Batch" << std::setw(10) << "Speedup"
+        << std::setw(12) << "Bounds" << std::setw(10) << "Batch" << std::setw(10) << "Speedup" << "\n";
+
+    float checksum = 0.0f;
+    for (size_t count : { size_t{ 1'000 }, size_t{ 100'000 } })
+    {
+        auto inputs = CreateInputs(count, random);
+        std::vector<winrt::float2> points(count);
+        std::vector<winrt::Rect> bounds(count);
+
+        auto pointsOneAtATime = MeasureNanosecondsPerItem(count, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    points[i] = winrt::transform(inputs.points[i], inputs.transform);
+                }
+                checksum += points[count / 2].x;
+            });
+        auto pointsBatch = MeasureNanosecondsPerItem(count, [&]()
+            {
+                TransformBatch::TransformPoints(inputs.transform, inputs.points.data(), points.data(), count);
+                checksum += points[count / 2].x;
+            });
+        auto boundsOneAtATime = MeasureNanosecondsPerItem(count, [&]()
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    bounds[i] = ReferenceBounds(inputs.transforms[i], inputs.sizes[i]);
+                }
+                checksum += bounds[count / 2].X;
+            });
+        auto boundsBatch = MeasureNanosecondsPerItem(count, [&]()
+            {
+                TransformBatch::TransformBounds(inputs.transforms.data(), inputs.sizes.data(), bounds.data(), count);
+                checksum += bounds[count / 2].X;
+            });
+
+        std::cout << std::setw(9) << count << std::fixed << std::setprecision(2)
+            << std::setw(12) << pointsOneAtATime << std::setw(10) << pointsBatch << std::setw(9) << (pointsOneAtATime / pointsBatch) << "x"
+            << std::setw(12) << boundsOneAtATime << std::setw(10) << boundsBatch << std::setw(9) << (boundsOneAtATime / boundsBatch) << "x\n";
+    }
+
+    std::cout << "\n(checksum " << checksum << ")\n";
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures how VisualTreeNode keeps sizes and transforms up to date on a 5,000 node tree of system
+// composition visuals:
+//
+// * Building the tree one child at a time from the top down, where AddChild computes only the new
+//   child's subtree, against recomputing the parent's whole subtree on every insertion (what
+//   AddChild did before dirty tracking).
+// * Changing the offsets of many nodes through the VisualOffset setter and updating once, against
+//   recomputing the whole tree after each change.
+//
+// It also checks that the geometry published by AddChild and by the batched update matches a full
+// recompute, and that the geometry getters bring the tree up to date by themselves after more
+// changes through the VisualOffset and VisualAnchorPoint setters.
+
+#include "precomp.h"
+#include "VisualTreeNode.h"
+
+#include <DispatcherQueue.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr size_t c_fanOut = 8;
+
+    struct Tree
+    {
+        std::shared_ptr<VisualTreeNode> root;
+        std::vector<std::shared_ptr<VisualTreeNode>> nodes;
+    };
+
+    double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Builds a tree breadth first, so that every parent is in the tree before its children are
+    // added. If recomputeParent is set, recomputes the parent's subtree after every insertion.
+    Tree BuildTree(const winrt::WUC::Compositor& compositor, size_t nodeCount, bool recomputeParent)
+    {
+        Tree tree;
+        auto rootVisual = compositor.CreateContainerVisual();
+        rootVisual.Size({ 4000.0f, 4000.0f });
+        tree.root = VisualTreeNode::Create(rootVisual.as<::IUnknown>());
+        tree.root->Size({ 4000.0f, 4000.0f });
+        tree.nodes.push_back(tree.root);
+
+        for (size_t i = 1; i < nodeCount; i++)
+        {
+            auto& parent = tree.nodes[(i - 1) / c_fanOut];
+            auto visual = compositor.CreateContainerVisual();
+            visual.Size({ 100.0f, 100.0f });
+            visual.RelativeSizeAdjustment({ 0.25f, 0.25f });
+            visual.Offset({ static_cast<float>((i % c_fanOut) * 10), static_cast<float>((i % 3) * 7), 0.0f });
+            visual.Scale({ 0.9f, 0.9f, 1.0f });
+
+            auto node = VisualTreeNode::Create(visual.as<::IUnknown>());
+            parent->AddChild(node);
+            if (recomputeParent)
+            {
+                parent->ComputeSizeAndTransform();
+            }
+
+            tree.nodes.push_back(node);
+        }
+
+        return tree;
+    }
+
+    std::vector<winrt::Rect> PublishedBounds(const Tree& tree)
+    {
+        std::vector<winrt::Rect> bounds;
+        for (const auto& node : tree.nodes)
+        {
+            bounds.push_back(node->BoundsInTreeRootCoordinates());
+        }
+        return bounds;
+    }
+
+    // Returns the number of nodes whose published bounds differ from a full recompute.
+    size_t CountStaleNodes(const Tree& tree)
+    {
+        auto published = PublishedBounds(tree);
+        tree.root->ComputeSizeAndTransform();
+        auto expected = PublishedBounds(tree);
+
+        size_t staleCount = 0;
+        for (size_t i = 0; i < published.size(); i++)
+        {
+            staleCount += (published[i] != expected[i]) ? 1 : 0;
+        }
+        return staleCount;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick builds a smaller tree, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t nodeCount = quick ? 500 : 5'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    std::cout << "VisualTreeNode geometry updates, " << nodeCount << " nodes\n\n";
+
+    auto start = std::chrono::steady_clock::now();
+    auto tree = BuildTree(compositor, nodeCount, false);
+    auto eagerBuildMilliseconds = ElapsedMilliseconds(start);
+    auto staleAfterBuild = CountStaleNodes(tree);
+
+    start = std::chrono::steady_clock::now();
+    auto recomputedTree = BuildTree(compositor, nodeCount, true);
+    auto recomputeBuildMilliseconds = ElapsedMilliseconds(start);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Build, AddChild computing the new subtree:          " << std::setw(10) << eagerBuildMilliseconds << " ms\n";
+    std::cout << "Build, recomputing the parent after each AddChild:  " << std::setw(10) << recomputeBuildMilliseconds << " ms\n";
+
+    // Move a tenth of the nodes, then bring the tree up to date.
+    std::mt19937 random(42);
+    std::vector<size_t> moved(nodeCount / 10);
+    for (auto& index : moved)
+    {
+        index = 1 + (random() % (nodeCount - 1));
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (auto index : moved)
+    {
+        tree.nodes[index]->VisualOffset({ 5.0f, 5.0f, 0.0f });
+    }
+    tree.root->UpdateSizeAndTransform();
+    auto batchedMilliseconds = ElapsedMilliseconds(start);
+    auto staleAfterUpdate = CountStaleNodes(tree);
+
+    start = std::chrono::steady_clock::now();
+    for (auto index : moved)
+    {
+        recomputedTree.nodes[index]->Visual().as<winrt::WUC::Visual>().Offset({ 5.0f, 5.0f, 0.0f });
+        recomputedTree.root->ComputeSizeAndTransform();
+    }
+    auto recomputeMilliseconds = ElapsedMilliseconds(start);
+
+    // Move the nodes back and re-anchor them, and read the geometry without updating first.
+    for (auto index : moved)
+    {
+        tree.nodes[index]->VisualOffset({ 0.0f, 0.0f, 0.0f });
+        tree.nodes[index]->VisualAnchorPoint({ 0.5f, 0.5f });
+    }
+    auto staleAfterGetters = CountStaleNodes(tree);
+
+    std::cout << "Move " << moved.size() << " nodes, one batched update:        " << std::setw(10) << batchedMilliseconds << " ms\n";
+    std::cout << "Move " << moved.size() << " nodes, recomputing after each:    " << std::setw(10) << recomputeMilliseconds << " ms\n";
+    std::cout << "\nStale nodes after build: " << staleAfterBuild << ", after update: " << staleAfterUpdate
+        << ", read without an update: " << staleAfterGetters << "\n";
+
+    return (staleAfterBuild == 0 && staleAfterUpdate == 0 && staleAfterGetters == 0) ? 0 : 1;
+}
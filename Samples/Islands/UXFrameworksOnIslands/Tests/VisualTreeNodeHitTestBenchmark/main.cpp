@@ -0,0 +1,219 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Measures VisualTreeNode::HitTestInTreeRootCoordinates, which answers from the node's hit test
+// index, against a recursive walk of the same nodes in reverse z-order through their published
+// inverse transforms (the way VisualTreeNode hit tested before the index existed). The trees are
+// system composition visuals: a 4x4 grid of panels, some rotated or scaled, each holding a grid of
+// equally sized items, like list and grid views. Pooled and unpooled trees are both measured, since
+// the index is built from the pool's arrays for one and from the nodes themselves for the other.
+//
+// It checks that both find the same node for every point, both before and after a tenth of the
+// items move through the VisualOffset setter, which the hit test has to pick up by itself.
+
+#include "precomp.h"
+#include "VisualTreeNode.h"
+
+#include <DispatcherQueue.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr size_t c_panelsPerSide = 4;
+    constexpr float c_panelSize = 1000.0f;
+
+    struct Tree
+    {
+        std::vector<std::shared_ptr<VisualTreeNode>> nodes;
+        std::vector<std::vector<size_t>> children;
+        std::vector<size_t> items;
+    };
+
+    Tree BuildTree(winrt::WUC::Compositor const& compositor, size_t nodeCount, std::shared_ptr<VisualTreeNodePool> const& pool)
+    {
+        Tree tree;
+        auto rootVisual = compositor.CreateContainerVisual();
+        rootVisual.Size({ c_panelsPerSide * c_panelSize, c_panelsPerSide * c_panelSize });
+        tree.nodes.push_back(VisualTreeNode::Create(rootVisual.as<::IUnknown>(), pool));
+        tree.nodes[0]->Size(rootVisual.Size());
+        tree.children.emplace_back();
+
+        auto AddNode = [&](size_t parent, winrt::WUC::ContainerVisual const& visual)
+        {
+            auto index = tree.nodes.size();
+            auto node = VisualTreeNode::Create(visual.as<::IUnknown>());
+            tree.nodes[parent]->AddChild(node);
+            tree.nodes.push_back(node);
+            tree.children.emplace_back();
+            tree.children[parent].push_back(index);
+            return index;
+        };
+
+        constexpr size_t panelCount = c_panelsPerSide * c_panelsPerSide;
+        auto itemsPerPanel = (nodeCount - 1 - panelCount) / panelCount;
+        auto itemsPerSide = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(itemsPerPanel))));
+        auto itemSize = c_panelSize / static_cast<float>(itemsPerSide);
+
+        for (size_t i = 0; i < panelCount; i++)
+        {
+            auto panelVisual = compositor.CreateContainerVisual();
+            panelVisual.Size({ c_panelSize, c_panelSize });
+            panelVisual.Offset({ (i % c_panelsPerSide) * c_panelSize, (i / c_panelsPerSide) * c_panelSize, 0.0f });
+            panelVisual.CenterPoint({ c_panelSize / 2.0f, c_panelSize / 2.0f, 0.0f });
+            if (i % 5 == 1)
+            {
+                panelVisual.RotationAngleInDegrees(20.0f);
+            }
+            else if (i % 5 == 3)
+            {
+                panelVisual.Scale({ 0.75f, 0.75f, 1.0f });
+            }
+            auto panel = AddNode(0, panelVisual);
+
+            for (size_t j = 0; j < itemsPerPanel; j++)
+            {
+                auto itemVisual = compositor.CreateContainerVisual();
+                itemVisual.Size({ itemSize, itemSize });
+                itemVisual.Offset({ (j % itemsPerSide) * itemSize, (j / itemsPerSide) * itemSize, 0.0f });
+                tree.items.push_back(AddNode(panel, itemVisual));
+            }
+        }
+
+        return tree;
+    }
+
+    std::shared_ptr<VisualTreeNode> RecursiveHitTest(Tree const& tree, size_t index, winrt::float2 const& point)
+    {
+        auto& node = tree.nodes[index];
+        auto inverseTransform = node->InverseTransform4x4();
+        if (!inverseTransform)
+        {
+            return nullptr;
+        }
+
+        auto localPoint = winrt::transform(point, *inverseTransform);
+        auto size = node->Size();
+        if (localPoint.x < 0.0f || localPoint.x >= size.x || localPoint.y < 0.0f || localPoint.y >= size.y)
+        {
+            return nullptr;
+        }
+
+        for (auto child = tree.children[index].rbegin(); child != tree.children[index].rend(); ++child)
+        {
+            if (auto hit = RecursiveHitTest(tree, *child, point))
+            {
+                return hit;
+            }
+        }
+
+        return node;
+    }
+
+    size_t CountMismatches(Tree const& tree, std::vector<winrt::Point> const& points)
+    {
+        size_t mismatches = 0;
+        for (auto& point : points)
+        {
+            auto actual = tree.nodes[0]->HitTestInTreeRootCoordinates(point);
+            mismatches += (actual == RecursiveHitTest(tree, 0, { point.X, point.Y })) ? 0 : 1;
+        }
+        return mismatches;
+    }
+
+    template<class TCallback>
+    double MeasureNanosecondsPerPoint(std::vector<winrt::Point> const& points, TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            for (auto& point : points)
+            {
+                callback(point);
+            }
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * points.size());
+    }
+
+    bool RunCase(winrt::WUC::Compositor const& compositor, char const* name, size_t nodeCount, bool pooled, std::mt19937& random)
+    {
+        auto tree = BuildTree(compositor, nodeCount, pooled ? VisualTreeNodePool::Create() : nullptr);
+
+        std::uniform_real_distribution<float> coordinate(-100.0f, c_panelsPerSide * c_panelSize + 100.0f);
+        std::vector<winrt::Point> points(1'000);
+        for (auto& point : points)
+        {
+            point = { coordinate(random), coordinate(random) };
+        }
+
+        auto mismatches = CountMismatches(tree, points);
+
+        size_t checksum = 0;
+        auto indexNanoseconds = MeasureNanosecondsPerPoint(points, [&](winrt::Point const& point)
+            {
+                checksum += (tree.nodes[0]->HitTestInTreeRootCoordinates(point) != nullptr) ? 1 : 0;
+            });
+        auto walkNanoseconds = MeasureNanosecondsPerPoint(points, [&](winrt::Point const& point)
+            {
+                checksum += (RecursiveHitTest(tree, 0, { point.X, point.Y }) != nullptr) ? 1 : 0;
+            });
+
+        // Move some items, and hit test again without any explicit update.
+        for (size_t i = 0; i < tree.items.size(); i += 10)
+        {
+            tree.nodes[tree.items[i]]->VisualOffset({ coordinate(random) / 4.0f, coordinate(random) / 4.0f, 0.0f });
+        }
+        auto mismatchesAfterMove = CountMismatches(tree, points);
+
+        std::cout << std::setw(10) << name << std::setw(9) << tree.nodes.size() << std::fixed << std::setprecision(1)
+            << std::setw(12) << indexNanoseconds << std::setw(13) << walkNanoseconds << std::setw(9) << (walkNanoseconds / indexNanoseconds) << "x"
+            << std::setw(12) << mismatches << std::setw(13) << mismatchesAfterMove
+            << "  (checksum " << (checksum % 1000) << ")\n";
+
+        return mismatches == 0 && mismatchesAfterMove == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick builds smaller trees, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t nodeCount = quick ? 2'000 : 10'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    std::mt19937 random(42);
+
+    std::cout << "VisualTreeNode hit testing, nanoseconds per point\n\n";
+    std::cout << std::setw(10) << "Tree" << std::setw(9) << "Nodes" << std::setw(12) << "Index" << std::setw(13) << "Recursive"
+        << std::setw(10) << "Speedup" << std::setw(12) << "Mismatches" << std::setw(13) << "After moves" << "\n";
+
+    bool passed = true;
+    passed &= RunCase(compositor, "unpooled", nodeCount, false, random);
+    passed &= RunCase(compositor, "pooled", nodeCount, true, random);
+
+    if (!passed)
+    {
+        std::cerr << "HitTestInTreeRootCoordinates and the recursive walk disagree.\n";
+        return 1;
+    }
+
+    return 0;
+}
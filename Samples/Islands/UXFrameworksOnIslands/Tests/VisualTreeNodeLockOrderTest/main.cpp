@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Checks that VisualTreeNode takes its locks in a consistent order, by running the paths that take
+// a node's lock and its pool's lock against each other on pooled nodes:
+//
+// * The compositor's thread repeatedly adds a child to a parent and a grandchild to the child, and
+//   removes them again with RemoveAllChildren and RemoveChild. These lock the parent, then the
+//   child, then the pool.
+// * Other threads repeatedly set the child's and the grandchild's size, which locks the node and
+//   then the pool.
+//
+// If any of these took the pool's lock before a node's, the threads would eventually deadlock. A
+// watchdog fails the test if the iterations don't finish in time. The size setters don't touch the
+// composition visuals, so only the compositor's thread uses them.
+
+#include "precomp.h"
+#include "VisualTreeNode.h"
+
+#include <DispatcherQueue.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+    constexpr int c_sizeThreadCount = 2;
+    constexpr auto c_timeout = std::chrono::seconds(60);
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs fewer iterations, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t iterationCount = quick ? 20'000 : 200'000;
+
+    winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+    // The system compositor needs a dispatcher queue on its thread.
+    DispatcherQueueOptions options{ sizeof(DispatcherQueueOptions), DQTYPE_THREAD_CURRENT, DQTAT_COM_NONE };
+    winrt::com_ptr<ABI::Windows::System::IDispatcherQueueController> controller;
+    winrt::check_hresult(CreateDispatcherQueueController(options, controller.put()));
+    winrt::WUC::Compositor compositor;
+
+    auto pool = VisualTreeNodePool::Create();
+    auto parent = VisualTreeNode::Create(compositor.CreateContainerVisual().as<::IUnknown>(), pool);
+    auto child = VisualTreeNode::Create(compositor.CreateContainerVisual().as<::IUnknown>(), pool);
+    auto grandchild = VisualTreeNode::Create(compositor.CreateContainerVisual().as<::IUnknown>(), pool);
+    parent->Size({ 100.0f, 100.0f });
+
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    bool done = false;
+
+    std::thread watchdog([&]()
+        {
+            std::unique_lock lock{ doneMutex };
+            if (!doneChanged.wait_for(lock, c_timeout, [&]() { return done; }))
+            {
+                std::cerr << "FAILED: the threads didn't finish within " << c_timeout.count() << " seconds, so they're probably deadlocked.\n";
+                std::_Exit(1);
+            }
+        });
+
+    std::atomic<bool> stopSizing{ false };
+    std::atomic<size_t> sizeCount{ 0 };
+    std::vector<std::thread> sizeThreads;
+    for (int i = 0; i < c_sizeThreadCount; i++)
+    {
+        sizeThreads.emplace_back([&, i]()
+            {
+                auto& node = (i % 2 == 0) ? child : grandchild;
+                for (float size = 1.0f; !stopSizing; size += 1.0f)
+                {
+                    node->Size({ size, size });
+                    sizeCount++;
+                }
+            });
+    }
+
+    for (size_t i = 0; i < iterationCount; i++)
+    {
+        parent->AddChild(child);
+        child->AddChild(grandchild);
+        child->RemoveAllChildren();
+        parent->RemoveChild(child);
+    }
+
+    stopSizing = true;
+    for (auto& thread : sizeThreads)
+    {
+        thread.join();
+    }
+
+    {
+        std::unique_lock lock{ doneMutex };
+        done = true;
+    }
+    doneChanged.notify_all();
+    watchdog.join();
+
+    std::cout << iterationCount << " rounds of AddChild, RemoveAllChildren and RemoveChild against " << sizeCount
+        << " size changes on " << c_sizeThreadCount << " other threads, without deadlocking\n";
+
+    return 0;
+}
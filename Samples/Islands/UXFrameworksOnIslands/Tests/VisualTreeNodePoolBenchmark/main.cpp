@@ -0,0 +1,293 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+// Compares a full-tree walk over VisualTreeNodePool (as VisualTreeNode does when it builds a hit
+// test index for a pooled tree) with the same walk over individually allocated nodes that carry
+// the fields a non-pooled VisualTreeNode keeps for itself, and reports the heap memory each keeps
+// per node. Both walks compute every node's bounds in tree root coordinates, and must agree.
+
+#include "precomp.h"
+#include "VisualTreeNodePool.h"
+#include "TransformBatch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string_view>
+
+// Tracks the bytes currently allocated on the heap, so that the memory used by each representation
+// can be measured. Each allocation is prefixed with its size.
+namespace
+{
+    constexpr size_t c_allocationHeader = alignof(std::max_align_t);
+    size_t g_liveBytes = 0;
+}
+
+void* operator new(size_t size)
+{
+    if (auto memory = static_cast<char*>(std::malloc(size + c_allocationHeader)))
+    {
+        *reinterpret_cast<size_t*>(memory) = size;
+        g_liveBytes += size;
+        return memory + c_allocationHeader;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+    {
+        auto allocation = static_cast<char*>(memory) - c_allocationHeader;
+        g_liveBytes -= *reinterpret_cast<size_t*>(allocation);
+        std::free(allocation);
+    }
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    operator delete(memory);
+}
+
+struct VisualTreeNode
+{
+};
+
+namespace
+{
+    // The per-node state of a non-pooled VisualTreeNode that a tree walk touches, along with the
+    // members that make each node a separate, lockable heap object.
+    struct PointerNode
+    {
+        std::mutex mutex;
+        winrt::float2 size{ 0.0f, 0.0f };
+        winrt::float4x4 transform{ winrt::float4x4::identity() };
+        winrt::float4x4 inverseTransform{ winrt::float4x4::identity() };
+        bool isTransformInvertible{ true };
+        std::weak_ptr<PointerNode> parent;
+        std::vector<std::shared_ptr<PointerNode>> children;
+        std::function<bool()> hitTestCallback;
+    };
+
+    struct Shape
+    {
+        std::vector<uint32_t> parents;
+        std::vector<winrt::float4x4> transforms;
+        std::vector<winrt::float2> sizes;
+    };
+
+    Shape CreateShape(uint32_t nodeCount, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        Shape shape;
+        shape.parents.push_back(VisualTreeNodePool::c_invalidHandle);
+        shape.transforms.push_back(winrt::float4x4::identity());
+        shape.sizes.push_back({ 4000.0f, 4000.0f });
+        for (uint32_t i = 1; i < nodeCount; i++)
+        {
+            auto parent = static_cast<uint32_t>(unit(random) * i) % i;
+            shape.parents.push_back(parent);
+            shape.transforms.push_back(
+                winrt::make_float4x4_translation(unit(random) * 100.0f, unit(random) * 100.0f) * shape.transforms[parent]);
+            shape.sizes.push_back({ 10.0f + unit(random) * 200.0f, 10.0f + unit(random) * 200.0f });
+        }
+        return shape;
+    }
+
+    struct Entry
+    {
+        winrt::float4x4 inverseTransform;
+        winrt::float2 size;
+        winrt::Rect bounds;
+        int parentIndex;
+        bool isInvertible;
+    };
+
+    // The walk VisualTreeNode::AppendToHitTestIndexInternal does for a pooled tree.
+    void WalkPool(const VisualTreeNodePool& pool, VisualTreeNodePool::Handle root, std::vector<Entry>& entries, std::vector<winrt::Rect>& bounds)
+    {
+        entries.clear();
+        pool.ComputeBounds(bounds);
+
+        std::vector<std::pair<VisualTreeNodePool::Handle, int>> stack{ { root, -1 } };
+        while (!stack.empty())
+        {
+            auto [handle, parentIndex] = stack.back();
+            stack.pop_back();
+
+            auto index = static_cast<int>(entries.size());
+            entries.push_back({ pool.InverseTransform(handle), pool.Size(handle), bounds[handle], parentIndex, pool.IsTransformInvertible(handle) });
+
+            for (auto child = pool.LastChild(handle); child != VisualTreeNodePool::c_invalidHandle; child = pool.PreviousSibling(child))
+            {
+                stack.push_back({ child, index });
+            }
+        }
+    }
+
+    // The walk VisualTreeNode::AppendToHitTestIndexInternal does for a tree that isn't pooled.
+    void WalkPointers(PointerNode& node, int parentIndex, std::vector<Entry>& entries)
+    {
+        winrt::Rect bounds;
+        TransformBatch::TransformBounds(&node.transform, &node.size, &bounds, 1);
+
+        auto index = static_cast<int>(entries.size());
+        entries.push_back({ node.inverseTransform, node.size, bounds, parentIndex, node.isTransformInvertible });
+
+        for (auto& child : node.children)
+        {
+            std::unique_lock lock{ child->mutex };
+            WalkPointers(*child, index, entries);
+        }
+    }
+
+    template<class TCallback>
+    double MeasureMicroseconds(TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+    bool SameEntries(const std::vector<Entry>& lhs, const std::vector<Entry>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < lhs.size(); i++)
+        {
+            if (lhs[i].bounds != rhs[i].bounds || lhs[i].size != rhs[i].size || lhs[i].parentIndex != rhs[i].parentIndex ||
+                lhs[i].inverseTransform != rhs[i].inverseTransform || lhs[i].isInvertible != rhs[i].isInvertible)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RunCase(uint32_t nodeCount, uint32_t freedCount, std::mt19937& random)
+    {
+        auto shape = CreateShape(nodeCount, random);
+        std::vector<VisualTreeNode> nodes(nodeCount + freedCount);
+
+        // Pooled tree. Allocate freedCount extra handles first and free them once the tree is
+        // built, to leave holes like those left by removed subtrees.
+        std::vector<VisualTreeNodePool::Handle> handles(nodeCount);
+        std::vector<VisualTreeNodePool::Handle> freed;
+        freed.reserve(freedCount);
+        auto allocatedBefore = g_liveBytes;
+        VisualTreeNodePool pool;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            if (i < freedCount)
+            {
+                freed.push_back(pool.Allocate(&nodes[nodeCount + i]));
+            }
+
+            handles[i] = pool.Allocate(&nodes[i]);
+            pool.Size(handles[i]) = shape.sizes[i];
+            pool.Transform(handles[i]) = shape.transforms[i];
+            winrt::float4x4 inverse;
+            pool.IsTransformInvertible(handles[i], winrt::invert(shape.transforms[i], &inverse));
+            pool.InverseTransform(handles[i]) = inverse;
+            if (i > 0)
+            {
+                pool.AppendChild(handles[shape.parents[i]], handles[i]);
+            }
+        }
+        for (auto handle : freed)
+        {
+            pool.Free(handle);
+        }
+        auto poolBytes = g_liveBytes - allocatedBefore;
+
+        // Individually allocated tree.
+        std::vector<std::shared_ptr<PointerNode>> pointerNodes(nodeCount);
+        allocatedBefore = g_liveBytes;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            auto node = std::make_shared<PointerNode>();
+            node->size = shape.sizes[i];
+            node->transform = shape.transforms[i];
+            node->isTransformInvertible = winrt::invert(shape.transforms[i], &node->inverseTransform);
+            if (i > 0)
+            {
+                node->parent = pointerNodes[shape.parents[i]];
+                pointerNodes[shape.parents[i]]->children.push_back(node);
+            }
+            pointerNodes[i] = std::move(node);
+        }
+        auto pointerBytes = g_liveBytes - allocatedBefore;
+
+        std::vector<Entry> poolEntries;
+        std::vector<Entry> pointerEntries;
+        std::vector<winrt::Rect> bounds;
+        poolEntries.reserve(nodeCount);
+        pointerEntries.reserve(nodeCount);
+
+        auto poolMicroseconds = MeasureMicroseconds([&]() { WalkPool(pool, handles[0], poolEntries, bounds); });
+        auto pointerMicroseconds = MeasureMicroseconds([&]()
+            {
+                pointerEntries.clear();
+                std::unique_lock lock{ pointerNodes[0]->mutex };
+                WalkPointers(*pointerNodes[0], -1, pointerEntries);
+            });
+
+        auto same = SameEntries(poolEntries, pointerEntries);
+        std::cout << std::setw(9) << nodeCount << std::setw(8) << freedCount << std::fixed << std::setprecision(1)
+            << std::setw(12) << poolMicroseconds << std::setw(12) << pointerMicroseconds << std::setw(9) << (pointerMicroseconds / poolMicroseconds) << "x"
+            << std::setw(12) << (static_cast<double>(poolBytes) / nodeCount) << std::setw(12) << (static_cast<double>(pointerBytes) / nodeCount)
+            << std::setw(8) << (same ? "yes" : "NO") << "\n";
+        return same;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs only the smaller trees, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+
+    std::mt19937 random(42);
+
+    std::cout << "Full-tree walk computing bounds, microseconds per walk, and heap bytes per node\n\n";
+    std::cout << std::setw(9) << "Nodes" << std::setw(8) << "Freed" << std::setw(12) << "Pool" << std::setw(12) << "Pointers" << std::setw(10) << "Speedup"
+        << std::setw(12) << "Pool B" << std::setw(12) << "Pointers B" << std::setw(8) << "Same" << "\n";
+
+    bool passed = true;
+    for (uint32_t nodeCount : { 1'000u, 10'000u, 100'000u })
+    {
+        if (quick && nodeCount > 10'000u)
+        {
+            break;
+        }
+
+        passed &= RunCase(nodeCount, 0, random);
+        passed &= RunCase(nodeCount, nodeCount / 2, random);
+    }
+
+    if (!passed)
+    {
+        std::cerr << "The pooled and pointer walks disagree.\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -38,18 +38,27 @@ D2D_RECT_F TextVisual<T>::GetLogicalBounds() const noexcept
 }
 
 template<class T>
-D2D1_RECT_F TextVisual<T>::GetPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform)
+bool TextVisual<T>::TryGetContentBounds(Output<T> const& /*output*/, D2D1_RECT_F& bounds)
 {
     if (m_size.Width == 0 || m_size.Height == 0)
     {
         // Empty text layout.
-        return {};
-    }
-    else
-    {
-        // Call the base implementation to compute the bounds from the rendered primitives.
-        return D2DSprite<T>::GetPixelBounds(output, rasterTransform);
+        bounds = {};
+        return true;
     }
+
+    // The overhang metrics are how far the ink extends past each side of the layout box (the
+    // max width and height of the layout), so the layout box plus the overhangs bounds the ink.
+    DWRITE_OVERHANG_METRICS overhangMetrics;
+    winrt::check_hresult(m_textLayout->GetOverhangMetrics(/*out*/ &overhangMetrics));
+
+    bounds = {
+        m_origin.x - overhangMetrics.left,
+        m_origin.y - overhangMetrics.top,
+        m_origin.x + m_textLayout->GetMaxWidth() + overhangMetrics.right,
+        m_origin.y + m_textLayout->GetMaxHeight() + overhangMetrics.bottom
+    };
+    return true;
 }
 
 template<class T>
@@ -75,6 +84,10 @@ void TextVisual<T>::SetTextOrigin(winrt::Windows::Foundation::Numerics::float2 o
 {
     m_origin = origin;
     SetVisualSize();
+
+    // The content moves within its pixel bounds by any fractional part of the change.
+    InvalidatePixelBounds();
+    InvalidateContent();
 }
 
 template<class T>
@@ -95,6 +108,7 @@ void TextVisual<T>::SetFormatWidth(float width)
         m_textLayout->SetMaxWidth(width);
         m_size = MeasureTextLayout(m_textLayout.get());
         SetVisualSize();
+        InvalidatePixelBounds();
         InvalidateContent();
     }
 }
@@ -49,7 +49,7 @@ public:
 
 protected:
     // D2DVisual methods.
-    D2D1_RECT_F GetPixelBounds(Output<T> const& output, D2D1::Matrix3x2F const& rasterTransform) override;
+    bool TryGetContentBounds(Output<T> const& output, D2D1_RECT_F& bounds) override;
     void RenderContent(Output<T> const& output, ID2D1DeviceContext5* deviceContext) override;
 
 private:
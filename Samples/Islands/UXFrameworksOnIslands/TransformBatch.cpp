@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "TransformBatch.h"
+
+#include <algorithm>
+
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && !defined(TRANSFORM_BATCH_NO_SIMD)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_USE_SSE2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TRANSFORM_BATCH_TARGET_AVX2
+#else
+#define TRANSFORM_BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    // Offsets of the elements of a row-major 4x4 transform that apply to a 2D point.
+    constexpr size_t c_m11 = 0;
+    constexpr size_t c_m12 = 1;
+    constexpr size_t c_m21 = 4;
+    constexpr size_t c_m22 = 5;
+    constexpr size_t c_m41 = 12;
+    constexpr size_t c_m42 = 13;
+    constexpr size_t c_matrixSize = 16;
+
+    void TransformPoint(const float* transform, const float* point, float* result) noexcept
+    {
+        auto x = (point[0] * transform[c_m11]) + (point[1] * transform[c_m21]) + transform[c_m41];
+        auto y = (point[0] * transform[c_m12]) + (point[1] * transform[c_m22]) + transform[c_m42];
+        result[0] = x;
+        result[1] = y;
+    }
+
+    void TransformBoundsScalar(const float* transform, const float* size, float* result) noexcept
+    {
+        float corners[4][2]{ { 0.0f, 0.0f }, { size[0], 0.0f }, { 0.0f, size[1] }, { size[0], size[1] } };
+        for (auto& corner : corners)
+        {
+            TransformPoint(transform, corner, corner);
+        }
+
+        auto left = std::min({ corners[0][0], corners[1][0], corners[2][0], corners[3][0] });
+        auto top = std::min({ corners[0][1], corners[1][1], corners[2][1], corners[3][1] });
+        auto right = std::max({ corners[0][0], corners[1][0], corners[2][0], corners[3][0] });
+        auto bottom = std::max({ corners[0][1], corners[1][1], corners[2][1], corners[3][1] });
+
+        result[0] = left;
+        result[1] = top;
+        result[2] = right - left;
+        result[3] = bottom - top;
+    }
+
+#ifdef TRANSFORM_BATCH_USE_SSE2
+    bool IsAvx2Supported()
+    {
+#if defined(TRANSFORM_BATCH_NO_AVX2)
+        return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+
+        // AVX2 needs OS support for saving the YMM registers.
+        __cpuid(info, 1);
+        constexpr int osxsaveBit = 1 << 27;
+        if ((info[2] & osxsaveBit) == 0 || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    const bool g_isAvx2Supported = IsAvx2Supported();
+
+    // Reduces the four lanes of a vector to their minimum, in every lane.
+    __m128 HorizontalMin(__m128 value) noexcept
+    {
+        value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    __m128 HorizontalMax(__m128 value) noexcept
+    {
+        value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    // Both paths keep the scalar order of operations (and don't fuse the multiplies and adds), so
+    // they round exactly as TransformPoint does.
+
+    // Transforms pairs of points, returning the number transformed.
+    size_t TransformPointsSse2(const float* transform, const float* points, float* results, size_t count) noexcept
+    {
+        // Each vector holds two points as { x0, y0, x1, y1 }.
+        auto row1 = _mm_setr_ps(transform[c_m11], transform[c_m12], transform[c_m11], transform[c_m12]);
+        auto row2 = _mm_setr_ps(transform[c_m21], transform[c_m22], transform[c_m21], transform[c_m22]);
+        auto row4 = _mm_setr_ps(transform[c_m41], transform[c_m42], transform[c_m41], transform[c_m42]);
+
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            auto point = _mm_loadu_ps(points + (2 * i));
+            auto x = _mm_shuffle_ps(point, point, _MM_SHUFFLE(2, 2, 0, 0));
+            auto y = _mm_shuffle_ps(point, point, _MM_SHUFFLE(3, 3, 1, 1));
+            auto result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, row1), _mm_mul_ps(y, row2)), row4);
+            _mm_storeu_ps(results + (2 * i), result);
+        }
+
+        return i;
+    }
+
+    // Transforms groups of four points, returning the number transformed.
+    TRANSFORM_BATCH_TARGET_AVX2
+    size_t TransformPointsAvx2(const float* transform, const float* points, float* results, size_t count) noexcept
+    {
+        // Each vector holds four points as { x0, y0, x1, y1, x2, y2, x3, y3 }.
+        auto row1 = _mm256_setr_ps(
+            transform[c_m11], transform[c_m12], transform[c_m11], transform[c_m12],
+            transform[c_m11], transform[c_m12], transform[c_m11], transform[c_m12]);
+        auto row2 = _mm256_setr_ps(
+            transform[c_m21], transform[c_m22], transform[c_m21], transform[c_m22],
+            transform[c_m21], transform[c_m22], transform[c_m21], transform[c_m22]);
+        auto row4 = _mm256_setr_ps(
+            transform[c_m41], transform[c_m42], transform[c_m41], transform[c_m42],
+            transform[c_m41], transform[c_m42], transform[c_m41], transform[c_m42]);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto point = _mm256_loadu_ps(points + (2 * i));
+            auto x = _mm256_shuffle_ps(point, point, _MM_SHUFFLE(2, 2, 0, 0));
+            auto y = _mm256_shuffle_ps(point, point, _MM_SHUFFLE(3, 3, 1, 1));
+            auto result = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, row1), _mm256_mul_ps(y, row2)), row4);
+            _mm256_storeu_ps(results + (2 * i), result);
+        }
+
+        _mm256_zeroupper();
+        return i;
+    }
+
+    void TransformBoundsSse2(const float* transform, const float* size, float* result) noexcept
+    {
+        // Transform all four corners at once, as { topLeft, topRight, bottomLeft, bottomRight }.
+        auto cornerX = _mm_setr_ps(0.0f, size[0], 0.0f, size[0]);
+        auto cornerY = _mm_setr_ps(0.0f, 0.0f, size[1], size[1]);
+
+        auto x = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(cornerX, _mm_set1_ps(transform[c_m11])), _mm_mul_ps(cornerY, _mm_set1_ps(transform[c_m21]))),
+            _mm_set1_ps(transform[c_m41]));
+        auto y = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(cornerX, _mm_set1_ps(transform[c_m12])), _mm_mul_ps(cornerY, _mm_set1_ps(transform[c_m22]))),
+            _mm_set1_ps(transform[c_m42]));
+
+        auto left = _mm_cvtss_f32(HorizontalMin(x));
+        auto top = _mm_cvtss_f32(HorizontalMin(y));
+        auto right = _mm_cvtss_f32(HorizontalMax(x));
+        auto bottom = _mm_cvtss_f32(HorizontalMax(y));
+
+        result[0] = left;
+        result[1] = top;
+        result[2] = right - left;
+        result[3] = bottom - top;
+    }
+
+    // Returns the element at offset of the first transform in the low half, and of the second
+    // transform in the high half.
+    TRANSFORM_BATCH_TARGET_AVX2
+    __m256 Broadcast(const float* first, const float* second, size_t offset) noexcept
+    {
+        return _mm256_set_m128(_mm_set1_ps(second[offset]), _mm_set1_ps(first[offset]));
+    }
+
+    // Computes the bounds of pairs of rectangles, returning the number computed.
+    TRANSFORM_BATCH_TARGET_AVX2
+    size_t TransformBoundsAvx2(const float* transforms, const float* sizes, float* results, size_t count) noexcept
+    {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto* first = transforms + (c_matrixSize * i);
+            const auto* second = first + c_matrixSize;
+            const auto* size = sizes + (2 * i);
+
+            // The low half holds the corners of the first rectangle and the high half those of the
+            // second, each as { topLeft, topRight, bottomLeft, bottomRight }.
+            auto cornerX = _mm256_setr_ps(0.0f, size[0], 0.0f, size[0], 0.0f, size[2], 0.0f, size[2]);
+            auto cornerY = _mm256_setr_ps(0.0f, 0.0f, size[1], size[1], 0.0f, 0.0f, size[3], size[3]);
+            auto x = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(cornerX, Broadcast(first, second, c_m11)), _mm256_mul_ps(cornerY, Broadcast(first, second, c_m21))),
+                Broadcast(first, second, c_m41));
+            auto y = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(cornerX, Broadcast(first, second, c_m12)), _mm256_mul_ps(cornerY, Broadcast(first, second, c_m22))),
+                Broadcast(first, second, c_m42));
+
+            // Reduce each half to its minimum and maximum, as HorizontalMin and HorizontalMax do.
+            auto minX = _mm256_min_ps(x, _mm256_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+            minX = _mm256_min_ps(minX, _mm256_shuffle_ps(minX, minX, _MM_SHUFFLE(1, 0, 3, 2)));
+            auto minY = _mm256_min_ps(y, _mm256_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1)));
+            minY = _mm256_min_ps(minY, _mm256_shuffle_ps(minY, minY, _MM_SHUFFLE(1, 0, 3, 2)));
+            auto maxX = _mm256_max_ps(x, _mm256_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+            maxX = _mm256_max_ps(maxX, _mm256_shuffle_ps(maxX, maxX, _MM_SHUFFLE(1, 0, 3, 2)));
+            auto maxY = _mm256_max_ps(y, _mm256_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1)));
+            maxY = _mm256_max_ps(maxY, _mm256_shuffle_ps(maxY, maxY, _MM_SHUFFLE(1, 0, 3, 2)));
+
+            // Gather { left, top, right, bottom } for both rectangles, then turn the right and
+            // bottom edges into the width and height.
+            auto leftTop = _mm256_unpacklo_ps(minX, minY);
+            auto rightBottom = _mm256_unpacklo_ps(maxX, maxY);
+            auto edges = _mm256_shuffle_ps(leftTop, rightBottom, _MM_SHUFFLE(1, 0, 1, 0));
+            auto bounds = _mm256_sub_ps(edges, _mm256_blend_ps(_mm256_setzero_ps(), leftTop, 0xCC));
+            _mm256_storeu_ps(results + (4 * i), bounds);
+        }
+
+        _mm256_zeroupper();
+        return i;
+    }
+#endif
+}
+
+void TransformBatch::TransformPoints(const float* transform, const float* points, float* results, size_t count) noexcept
+{
+    size_t i = 0;
+
+#ifdef TRANSFORM_BATCH_USE_SSE2
+    i = g_isAvx2Supported ?
+        TransformPointsAvx2(transform, points, results, count) :
+        TransformPointsSse2(transform, points, results, count);
+    i += TransformPointsSse2(transform, points + (2 * i), results + (2 * i), count - i);
+#endif
+
+    for (; i < count; i++)
+    {
+        TransformPoint(transform, points + (2 * i), results + (2 * i));
+    }
+}
+
+void TransformBatch::TransformBounds(const float* transforms, const float* sizes, float* results, size_t count) noexcept
+{
+    size_t i = 0;
+
+#ifdef TRANSFORM_BATCH_USE_SSE2
+    if (g_isAvx2Supported)
+    {
+        i = TransformBoundsAvx2(transforms, sizes, results, count);
+    }
+
+    for (; i < count; i++)
+    {
+        TransformBoundsSse2(transforms + (c_matrixSize * i), sizes + (2 * i), results + (4 * i));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        TransformBoundsScalar(transforms + (c_matrixSize * i), sizes + (2 * i), results + (4 * i));
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+
+// Transforms arrays of points and rectangles at once. On x86 and x64 this uses AVX2 (when the CPU
+// supports it) or SSE2 to transform several points (or the corners of one or two rectangles) per
+// instruction, and elsewhere it falls back to the same arithmetic as winrt::transform, so every
+// path gives identical results.
+//
+// Only the 2D part of each 4x4 transform is used (m11, m12, m21, m22, m41, m42), matching
+// winrt::transform for a float2.
+//
+// This header only depends on the standard library. The kernels work on arrays of floats, and the
+// templates accept winrt::float4x4, winrt::float2 and winrt::Rect (or any types with the same
+// members and layout).
+namespace TransformBatch
+{
+    // Transforms count points, stored as { x, y } pairs, by the same row-major 4x4 transform. The
+    // results may alias the points.
+    void TransformPoints(const float* transform, const float* points, float* results, size_t count) noexcept;
+
+    // Computes the axis-aligned bounds, as { x, y, width, height }, of each rectangle
+    // { 0, 0, sizes[i] } after it has been transformed by transforms[i].
+    void TransformBounds(const float* transforms, const float* sizes, float* results, size_t count) noexcept;
+
+    template<class TMatrix, class TVector>
+    void TransformPoints(const TMatrix& transform, const TVector* points, TVector* results, size_t count) noexcept
+    {
+        static_assert(sizeof(TMatrix) == 16 * sizeof(float), "TMatrix must have the layout of a float4x4");
+        static_assert(sizeof(TVector) == 2 * sizeof(float), "TVector must have the layout of a float2");
+
+        if (count > 0)
+        {
+            TransformPoints(&transform.m11, &points->x, &results->x, count);
+        }
+    }
+
+    template<class TMatrix, class TVector, class TRect>
+    void TransformBounds(const TMatrix* transforms, const TVector* sizes, TRect* results, size_t count) noexcept
+    {
+        static_assert(sizeof(TMatrix) == 16 * sizeof(float), "TMatrix must have the layout of a float4x4");
+        static_assert(sizeof(TVector) == 2 * sizeof(float), "TVector must have the layout of a float2");
+        static_assert(sizeof(TRect) == 4 * sizeof(float), "TRect must have the layout of a Rect");
+
+        if (count > 0)
+        {
+            TransformBounds(&transforms->m11, &sizes->x, &results->X, count);
+        }
+    }
+}
@@ -3,43 +3,90 @@
 #include "precomp.h"
 #include "VisualTreeNode.h"
 
+#include "TransformBatch.h"
+
+namespace
+{
+    winrt::Windows::Foundation::Rect ComputeBoundsInTreeRootCoordinates(
+        winrt::Windows::Foundation::Numerics::float2 const& size,
+        winrt::Windows::Foundation::Numerics::float4x4 const& transform)
+    {
+        // Transform the local bounds to the root visual's coordinate space, and take the bounding
+        // box of the result.
+        winrt::Windows::Foundation::Rect bounds;
+        TransformBatch::TransformBounds(&transform, &size, &bounds, 1);
+        return bounds;
+    }
+}
+
 // static
 std::shared_ptr<VisualTreeNode> VisualTreeNode::Create(
-    _In_ winrt::com_ptr<::IUnknown> const& visual) noexcept
+    _In_ winrt::com_ptr<::IUnknown> const& visual,
+    _In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool) noexcept
 {
     try
     {
         auto node = std::make_shared<VisualTreeNode>();
-        node->Initialize(visual);
+        node->Initialize(visual, pool);
         return node;
     }
     catch (...) {}
     return nullptr;
 }
 
+VisualTreeNode::~VisualTreeNode() noexcept
+{
+    if (m_pool != nullptr)
+    {
+        auto poolLock = m_pool->Lock();
+        m_pool->Free(m_poolHandle);
+    }
+}
+
 winrt::Windows::Foundation::Numerics::float2 VisualTreeNode::Size() const noexcept
 {
-    std::unique_lock lock{ m_mutex };
-    return SizeInternal();
+    EnsureSizeAndTransformUpdated();
+    return m_publishedGeometry.Load().size;
 }
 
 void VisualTreeNode::Size(_In_ winrt::Windows::Foundation::Numerics::float2 const& value) noexcept
 {
     std::unique_lock lock{ m_mutex };
-    m_size = value;
+    auto poolLock = LockPool();
+    SizeInternal(value);
+
+    // Children may be sized relative to this node.
+    for (auto& child : m_children)
+    {
+        child->MarkSizeAndTransformDirty();
+    }
+
+    PublishGeometry();
+    InvalidateHitTestIndex();
 }
 
 winrt::Windows::Foundation::Numerics::float4x4 VisualTreeNode::Transform4x4() const noexcept
 {
-    std::unique_lock lock{ m_mutex };
-    return TransformInternal();
+    EnsureSizeAndTransformUpdated();
+    return m_publishedGeometry.Load().transform;
 }
 
-winrt::Windows::Foundation::Numerics::float3x2 VisualTreeNode::Transform3x2() const noexcept
+std::optional<winrt::Windows::Foundation::Numerics::float4x4> VisualTreeNode::InverseTransform4x4() const noexcept
 {
-    std::unique_lock lock{ m_mutex };
+    EnsureSizeAndTransformUpdated();
+    auto geometry = m_publishedGeometry.Load();
+    if (!geometry.isTransformInvertible)
+    {
+        return std::nullopt;
+    }
 
-    auto t = TransformInternal();
+    return geometry.inverseTransform;
+}
+
+winrt::Windows::Foundation::Numerics::float3x2 VisualTreeNode::Transform3x2() const noexcept
+{
+    EnsureSizeAndTransformUpdated();
+    auto t = m_publishedGeometry.Load().transform;
     winrt::Windows::Foundation::Numerics::float3x2 ct{ t.m11, t.m12, t.m21, t.m22, t.m41, t.m42};
 
     return ct;
@@ -68,7 +115,31 @@ void VisualTreeNode::AddChild(_In_ std::shared_ptr<VisualTreeNode> const& child)
         child->UpdateParent(shared_from_this());
         m_children.push_back(child);
 
-        ComputeSizeAndTransformInternal();
+        // Take the child's lock before any pool lock, since the pools are always locked after the
+        // nodes (see VisualTreeNodePool).
+        std::unique_lock childLock{ child->m_mutex };
+        auto poolLock = LockPool();
+        if (child->m_pool != m_pool)
+        {
+            // Keep the child's old pool alive while its lock is held, since moving the subtree
+            // may release the last reference to it.
+            auto oldPool = child->m_pool;
+            auto oldPoolLock = (oldPool != nullptr) ? oldPool->Lock() : std::unique_lock<std::mutex>{};
+            child->MoveToPoolInternal(m_pool);
+        }
+
+        if (m_pool != nullptr)
+        {
+            m_pool->AppendChild(m_poolHandle, child->m_poolHandle);
+        }
+
+        // Compute the child's subtree now, so that its published geometry is current as soon as
+        // it is in the tree. Only the child's subtree depends on it, so building a tree one child
+        // at a time from the top down stays linear. If this node is itself waiting for an update,
+        // that update recomputes the child again.
+        child->ComputeSizeAndTransformInternal();
+
+        InvalidateHitTestIndex();
     }
 }
 
@@ -92,7 +163,16 @@ void VisualTreeNode::RemoveChild(_In_ std::shared_ptr<VisualTreeNode> const& chi
 
         child->UpdateParent(nullptr);
 
+        // The child stays in the pool as the root of its own subtree.
+        if (m_pool != nullptr)
+        {
+            auto poolLock = m_pool->Lock();
+            m_pool->Unlink(child->m_poolHandle);
+        }
+
         m_children.erase(it);
+
+        InvalidateHitTestIndex();
     }
 }
 
@@ -109,91 +189,159 @@ void VisualTreeNode::RemoveAllChildren()
         parent2.Children().RemoveAll();
     }
 
+    // UpdateParent takes each child's lock, which has to come before the pool lock.
     for (auto& child : m_children)
     {
         child->UpdateParent(nullptr);
     }
 
+    auto poolLock = LockPool();
+    if (m_pool != nullptr)
+    {
+        for (auto& child : m_children)
+        {
+            m_pool->Unlink(child->m_poolHandle);
+        }
+    }
+
+    // Release the pool before the children, since destroying a pooled node takes the pool lock.
+    poolLock = {};
     m_children.clear();
+
+    InvalidateHitTestIndex();
 }
 
 void VisualTreeNode::ComputeSizeAndTransform()
 {
     std::unique_lock lock{ m_mutex };
+    auto poolLock = LockPool();
 
     ComputeSizeAndTransformInternal();
+    InvalidateHitTestIndex();
 }
 
-winrt::Windows::Foundation::Rect VisualTreeNode::BoundsInTreeRootCoordinates() const
+void VisualTreeNode::UpdateSizeAndTransform()
 {
     std::unique_lock lock{ m_mutex };
+    auto poolLock = LockPool();
 
-    // Local bound components.
-    auto topLeft = winrt::Windows::Foundation::Numerics::float2{ 0.0f, 0.0f };
-    auto topRight = winrt::Windows::Foundation::Numerics::float2{ m_size.x, 0.0f };
-    auto bottomLeft = winrt::Windows::Foundation::Numerics::float2{ 0.0f, m_size.y };
-    auto bottomRight = winrt::Windows::Foundation::Numerics::float2{ m_size.x, m_size.y };
+    if (UpdateSizeAndTransformInternal())
+    {
+        InvalidateHitTestIndex();
+    }
+}
 
-    // Transform the local bounds to the root visual's coordinate space.
-    auto topLeftTransformed = winrt::Windows::Foundation::Numerics::transform(topLeft, m_transform);
-    auto topRightTransformed = winrt::Windows::Foundation::Numerics::transform(topRight, m_transform);
-    auto bottomLeftTransformed = winrt::Windows::Foundation::Numerics::transform(bottomLeft, m_transform);
-    auto bottomRightTransformed = winrt::Windows::Foundation::Numerics::transform(bottomRight, m_transform);
+void VisualTreeNode::MarkSizeAndTransformDirty() noexcept
+{
+    m_isSizeAndTransformDirty = true;
+    for (auto ancestor = Parent(); ancestor != nullptr; ancestor = ancestor->Parent())
+    {
+        ancestor->m_hasDirtyDescendant = true;
+    }
+}
 
-    // Compute the bounding box of the transformed local bounds.
-    auto left = std::min({ topLeftTransformed.x, topRightTransformed.x, bottomLeftTransformed.x, bottomRightTransformed.x });
-    auto top = std::min({ topLeftTransformed.y, topRightTransformed.y, bottomLeftTransformed.y, bottomRightTransformed.y });
-    auto right = std::max({ topLeftTransformed.x, topRightTransformed.x, bottomLeftTransformed.x, bottomRightTransformed.x });
-    auto bottom = std::max({ topLeftTransformed.y, topRightTransformed.y, bottomLeftTransformed.y, bottomRightTransformed.y });
+void VisualTreeNode::VisualOffset(_In_ winrt::Windows::Foundation::Numerics::float3 const& value)
+{
+    if (auto visual = m_visual.try_as<winrt::Windows::UI::Composition::Visual>())
+    {
+        visual.Offset(value);
+    }
+    else if (auto visual2 = m_visual.try_as<winrt::Microsoft::UI::Composition::Visual>())
+    {
+        visual2.Offset(value);
+    }
 
-    return winrt::Windows::Foundation::Rect{ left, top, right - left, bottom - top };
+    MarkSizeAndTransformDirty();
 }
 
-std::shared_ptr<VisualTreeNode> VisualTreeNode::HitTestInTreeRootCoordinates(
-    _In_ winrt::Windows::Foundation::Point const& point)
+void VisualTreeNode::VisualScale(_In_ winrt::Windows::Foundation::Numerics::float3 const& value)
 {
-    std::unique_lock lock{ m_mutex };
+    if (auto visual = m_visual.try_as<winrt::Windows::UI::Composition::Visual>())
+    {
+        visual.Scale(value);
+    }
+    else if (auto visual2 = m_visual.try_as<winrt::Microsoft::UI::Composition::Visual>())
+    {
+        visual2.Scale(value);
+    }
 
-    auto pointInTreeCoordinates = winrt::Windows::Foundation::Numerics::float2{ point.X, point.Y };
+    MarkSizeAndTransformDirty();
+}
 
-    // Transform the point to the local coordinate space.
-    winrt::Windows::Foundation::Numerics::float4x4 inverseTransform;
-    if (!winrt::Windows::Foundation::Numerics::invert(m_transform, &inverseTransform))
+void VisualTreeNode::VisualRotationAngle(float value)
+{
+    if (auto visual = m_visual.try_as<winrt::Windows::UI::Composition::Visual>())
+    {
+        visual.RotationAngle(value);
+    }
+    else if (auto visual2 = m_visual.try_as<winrt::Microsoft::UI::Composition::Visual>())
     {
-        // For now, hit testing is not supported if the transform is not invertible.
-        return nullptr;
+        visual2.RotationAngle(value);
     }
 
-    auto pointInLocalCoordinates = winrt::Windows::Foundation::Numerics::transform(pointInTreeCoordinates, inverseTransform);
-    if (pointInLocalCoordinates.x < 0.0f || pointInLocalCoordinates.x >= m_size.x ||
-        pointInLocalCoordinates.y < 0.0f || pointInLocalCoordinates.y >= m_size.y)
+    MarkSizeAndTransformDirty();
+}
+
+void VisualTreeNode::VisualAnchorPoint(_In_ winrt::Windows::Foundation::Numerics::float2 const& value)
+{
+    if (auto visual = m_visual.try_as<winrt::Windows::UI::Composition::Visual>())
     {
-        // Out of bounds.
-        return nullptr;
+        visual.AnchorPoint(value);
     }
+    else if (auto visual2 = m_visual.try_as<winrt::Microsoft::UI::Composition::Visual>())
+    {
+        visual2.AnchorPoint(value);
+    }
+
+    MarkSizeAndTransformDirty();
+}
 
-    // Check if the point is within any of the children.
-    // Iterate in reverse to obey the z-order.
-    for (auto it = m_children.rbegin(); it != m_children.rend(); ++it)
+winrt::Windows::Foundation::Rect VisualTreeNode::BoundsInTreeRootCoordinates() const
+{
+    EnsureSizeAndTransformUpdated();
+    auto geometry = m_publishedGeometry.Load();
+    return ComputeBoundsInTreeRootCoordinates(geometry.size, geometry.transform);
+}
+
+std::shared_ptr<VisualTreeNode> VisualTreeNode::HitTestInTreeRootCoordinates(
+    _In_ winrt::Windows::Foundation::Point const& point)
+{
+    std::unique_lock lock{ m_mutex };
+    auto poolLock = LockPool();
+
+    if (UpdateSizeAndTransformInternal())
     {
-        auto child = *it;
-        auto childHit = child->HitTestInTreeRootCoordinates(point);
-        if (nullptr != childHit)
-        {
-            return childHit;
-        }
+        InvalidateHitTestIndex();
+    }
+
+    // Mark the index valid before reading the tree, so that a change made while it is being
+    // rebuilt invalidates it again.
+    if (!m_isHitTestIndexValid.exchange(true))
+    {
+        std::vector<HitTestIndex::Entry> entries{};
+        AppendToHitTestIndexInternal(entries, -1);
+        m_hitTestIndex.Build(std::move(entries));
     }
 
-    // If none of the children were hit, then return this visual.
-    return shared_from_this();
+    return m_hitTestIndex.HitTest(point);
+}
+
+std::shared_ptr<VisualTreeNode> VisualTreeNode::Parent() const noexcept
+{
+    std::unique_lock lock{ m_parentMutex };
+    return m_parent.lock();
 }
 
 bool VisualTreeNode::Match(_In_ winrt::com_ptr<::IUnknown> const& visual) const noexcept
 {
-    std::unique_lock lock{ m_mutex };
     return m_visual.get() == visual.get();
 }
 
+winrt::Windows::Foundation::Rect VisualTreeNode::BoundsInTreeRootCoordinatesInternal() const
+{
+    return ComputeBoundsInTreeRootCoordinates(SizeInternal(), TransformInternal());
+}
+
 // Helpers
 namespace
 {
@@ -254,9 +402,53 @@ void VisualTreeNode::IsBorderVisible(bool enable)
     }
 }
 
-void VisualTreeNode::Initialize(_In_ winrt::com_ptr<::IUnknown> const& visual)
+void VisualTreeNode::Initialize(
+    _In_ winrt::com_ptr<::IUnknown> const& visual,
+    _In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool)
 {
     m_visual = visual;
+
+    if (pool != nullptr)
+    {
+        auto poolLock = pool->Lock();
+        MoveToPoolInternal(pool);
+    }
+}
+
+std::unique_lock<std::mutex> VisualTreeNode::LockPool() const
+{
+    return (m_pool != nullptr) ? m_pool->Lock() : std::unique_lock<std::mutex>{};
+}
+
+void VisualTreeNode::MoveToPoolInternal(_In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool)
+{
+    auto size = SizeInternal();
+    auto transform = TransformInternal();
+
+    if (m_pool != nullptr)
+    {
+        m_pool->Free(m_poolHandle);
+        m_poolHandle = VisualTreeNodePool::c_invalidHandle;
+    }
+
+    m_pool = pool;
+    if (m_pool != nullptr)
+    {
+        m_poolHandle = m_pool->Allocate(this);
+    }
+
+    SizeInternal(size);
+    TransformInternal(transform);
+
+    for (auto& child : m_children)
+    {
+        child->MoveToPoolInternal(pool);
+
+        if (m_pool != nullptr)
+        {
+            m_pool->AppendChild(m_poolHandle, child->m_poolHandle);
+        }
+    }
 }
 
 void VisualTreeNode::UpdateParent(_In_ std::shared_ptr<VisualTreeNode> const& value)
@@ -264,36 +456,148 @@ void VisualTreeNode::UpdateParent(_In_ std::shared_ptr<VisualTreeNode> const& va
     // This is private, but needs to take the lock since it is only called on child VisualTreeNodes.
     // See usage in AddChild, RemoveChild, and RemoveAllChildren.
     std::unique_lock lock{ m_mutex };
+    std::unique_lock parentLock{ m_parentMutex };
     m_parent = value;
 }
 
+void VisualTreeNode::InvalidateHitTestIndex() noexcept
+{
+    // Any ancestor may have an index that includes this node, so they all need to be rebuilt.
+    m_isHitTestIndexValid = false;
+    for (auto ancestor = Parent(); ancestor != nullptr; ancestor = ancestor->Parent())
+    {
+        ancestor->m_isHitTestIndexValid = false;
+    }
+}
+
+void VisualTreeNode::AppendToHitTestIndexInternal(
+    _Inout_ std::vector<HitTestIndex::Entry>& entries,
+    int parentIndex)
+{
+    if (m_pool != nullptr)
+    {
+        // Walk the pool's links rather than the child nodes, so the subtree is read from packed
+        // arrays without taking each node's lock. The bounds of the whole pool are transformed in
+        // one batch up front.
+        std::vector<winrt::Windows::Foundation::Rect> bounds;
+        m_pool->ComputeBounds(bounds);
+
+        std::vector<std::pair<VisualTreeNodePool::Handle, int>> stack{ { m_poolHandle, parentIndex } };
+        while (!stack.empty())
+        {
+            auto [handle, handleParentIndex] = stack.back();
+            stack.pop_back();
+
+            auto handleIndex = static_cast<int>(entries.size());
+            entries.push_back({
+                m_pool->Node(handle)->weak_from_this(),
+                m_pool->InverseTransform(handle),
+                m_pool->Size(handle),
+                bounds[handle],
+                handleParentIndex,
+                m_pool->IsTransformInvertible(handle) });
+
+            // Push the children last to first, so that they are popped in z-order.
+            for (auto child = m_pool->LastChild(handle);
+                child != VisualTreeNodePool::c_invalidHandle;
+                child = m_pool->PreviousSibling(child))
+            {
+                stack.push_back({ child, handleIndex });
+            }
+        }
+
+        return;
+    }
+
+    auto index = static_cast<int>(entries.size());
+    entries.push_back({
+        weak_from_this(),
+        InverseTransformInternal(),
+        SizeInternal(),
+        BoundsInTreeRootCoordinatesInternal(),
+        parentIndex,
+        IsTransformInvertibleInternal() });
+
+    // Children are appended in z-order, so the entries end up in pre-order.
+    for (auto& child : m_children)
+    {
+        std::unique_lock childLock{ child->m_mutex };
+        child->AppendToHitTestIndexInternal(entries, index);
+    }
+}
+
 winrt::Windows::Foundation::Numerics::float2 const& VisualTreeNode::SizeInternal() const noexcept
 {
-    return m_size;
+    return (m_pool != nullptr) ? std::as_const(*m_pool).Size(m_poolHandle) : m_size;
+}
+
+void VisualTreeNode::SizeInternal(_In_ winrt::Windows::Foundation::Numerics::float2 const& value) noexcept
+{
+    if (m_pool != nullptr)
+    {
+        m_pool->Size(m_poolHandle) = value;
+    }
+    else
+    {
+        m_size = value;
+    }
 }
 
 winrt::Windows::Foundation::Numerics::float4x4 const& VisualTreeNode::TransformInternal() const noexcept
 {
-    return m_transform;
+    return (m_pool != nullptr) ? std::as_const(*m_pool).Transform(m_poolHandle) : m_transform;
+}
+
+winrt::Windows::Foundation::Numerics::float4x4 const& VisualTreeNode::InverseTransformInternal() const noexcept
+{
+    return (m_pool != nullptr) ? std::as_const(*m_pool).InverseTransform(m_poolHandle) : m_inverseTransform;
+}
+
+bool VisualTreeNode::IsTransformInvertibleInternal() const noexcept
+{
+    return (m_pool != nullptr) ? m_pool->IsTransformInvertible(m_poolHandle) : m_isTransformInvertible;
+}
+
+void VisualTreeNode::TransformInternal(_In_ winrt::Windows::Foundation::Numerics::float4x4 const& value) noexcept
+{
+    winrt::Windows::Foundation::Numerics::float4x4 inverse;
+    bool isInvertible = winrt::Windows::Foundation::Numerics::invert(value, &inverse);
+
+    if (m_pool != nullptr)
+    {
+        m_pool->Transform(m_poolHandle) = value;
+        m_pool->InverseTransform(m_poolHandle) = inverse;
+        m_pool->IsTransformInvertible(m_poolHandle, isInvertible);
+    }
+    else
+    {
+        m_transform = value;
+        m_inverseTransform = inverse;
+        m_isTransformInvertible = isInvertible;
+    }
 }
 
 void VisualTreeNode::ComputeSizeAndTransformInternal()
 {
+    m_isSizeAndTransformDirty = false;
+    m_hasDirtyDescendant = false;
+
     if (auto strongParent = m_parent.lock())
     {
         // Compute the local size of this visual.
         auto parentSize = strongParent->SizeInternal();
         auto visualSize = VisualSize();
         auto visualRelativeSizeAdjustment = VisualRelativeSizeAdjustment();
-        m_size = {
+        winrt::Windows::Foundation::Numerics::float2 size{
             visualSize.x + (visualRelativeSizeAdjustment.x * parentSize.x),
             visualSize.y + (visualRelativeSizeAdjustment.y * parentSize.y) };
+        SizeInternal(size);
 
         // Compute the local transform of this visual.
         auto visualAnchorPoint = VisualAnchorPoint();
         winrt::Windows::Foundation::Numerics::float3 anchorPointOffset{
-            visualAnchorPoint.x * m_size.x,
-            visualAnchorPoint.y * m_size.y,
+            visualAnchorPoint.x * size.x,
+            visualAnchorPoint.y * size.y,
             0.0f };
         auto visualOffset = VisualOffset();
         auto visualRelativeOffsetAdjustment = VisualRelativeOffsetAdjustment();
@@ -316,9 +620,12 @@ void VisualTreeNode::ComputeSizeAndTransformInternal()
             winrt::Windows::Foundation::Numerics::make_float4x4_translation(visualCenterPoint);
 
         auto localTransform = rotation * scale * translation;
-        m_transform = localTransform * strongParent->TransformInternal();
+        TransformInternal(localTransform * strongParent->TransformInternal());
     }
 
+    m_isHitTestIndexValid = false;
+    PublishGeometry();
+
     // Recursively compute the size and transform of all children.
     for (auto& child : m_children)
     {
@@ -326,6 +633,63 @@ void VisualTreeNode::ComputeSizeAndTransformInternal()
     }
 }
 
+bool VisualTreeNode::UpdateSizeAndTransformInternal()
+{
+    if (m_isSizeAndTransformDirty)
+    {
+        // Everything below a dirty node depends on it, so recompute the whole subtree.
+        ComputeSizeAndTransformInternal();
+        return true;
+    }
+
+    bool updated = false;
+    if (m_hasDirtyDescendant.exchange(false))
+    {
+        for (auto& child : m_children)
+        {
+            updated = child->UpdateSizeAndTransformInternal() || updated;
+        }
+    }
+
+    return updated;
+}
+
+void VisualTreeNode::PublishGeometry() noexcept
+{
+    m_publishedGeometry.Store({ SizeInternal(), TransformInternal(), InverseTransformInternal(), IsTransformInvertibleInternal() });
+}
+
+void VisualTreeNode::EnsureSizeAndTransformUpdated() const noexcept
+{
+    // A dirty node recomputes its whole subtree, so only this node and its ancestors matter. The
+    // update starts from the root, which is where the dirty descendant flags lead down from.
+    bool isDirty = m_isSizeAndTransformDirty;
+    std::shared_ptr<VisualTreeNode> root{};
+    for (auto ancestor = Parent(); ancestor != nullptr; ancestor = ancestor->Parent())
+    {
+        isDirty = isDirty || ancestor->m_isSizeAndTransformDirty;
+        root = ancestor;
+    }
+
+    if (!isDirty)
+    {
+        return;
+    }
+
+    try
+    {
+        if (root != nullptr)
+        {
+            root->UpdateSizeAndTransform();
+        }
+        else
+        {
+            const_cast<VisualTreeNode*>(this)->UpdateSizeAndTransform();
+        }
+    }
+    catch (...) {}
+}
+
 winrt::Windows::Foundation::Numerics::float3 VisualTreeNode::VisualOffset() const noexcept
 {
     winrt::Windows::Foundation::Numerics::float3 offset{ 0.0f, 0.0f, 0.0f };
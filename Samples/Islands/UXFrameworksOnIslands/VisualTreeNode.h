@@ -7,16 +7,22 @@
 #include <winrt/Windows.Foundation.Numerics.h>
 
 #include "HitTestContext.h"
+#include "HitTestIndex.h"
+#include "SeqLockValue.h"
+#include "VisualTreeNodePool.h"
 
 class FocusList;
 
 struct VisualTreeNode : std::enable_shared_from_this<VisualTreeNode>
 {
+    // If a pool is given, this node and every node later added beneath it keep their geometry and
+    // tree links in the pool rather than in the node.
     [[nodiscard]] static std::shared_ptr<VisualTreeNode> Create(
-        _In_ winrt::com_ptr<::IUnknown> const& visual) noexcept;
+        _In_ winrt::com_ptr<::IUnknown> const& visual,
+        _In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool = nullptr) noexcept;
 
     explicit VisualTreeNode() noexcept = default;
-    ~VisualTreeNode() noexcept = default;
+    ~VisualTreeNode() noexcept;
 
     // Disable move and copy.
     explicit VisualTreeNode(VisualTreeNode const&) = delete;
@@ -24,24 +30,49 @@ struct VisualTreeNode : std::enable_shared_from_this<VisualTreeNode>
     VisualTreeNode& operator=(VisualTreeNode const&) = delete;
     VisualTreeNode& operator=(VisualTreeNode&&) = delete;
 
+    // The geometry getters read a snapshot published by the last size/transform update, so they
+    // never block on the mutex and can be called from automation threads. If this node or one of
+    // its ancestors has been marked dirty since, they first bring the tree up to date, which does
+    // take the locks.
     [[nodiscard]] winrt::Windows::Foundation::Numerics::float2 Size() const noexcept;
     void Size(_In_ winrt::Windows::Foundation::Numerics::float2 const& value) noexcept;
 
     [[nodiscard]] winrt::Windows::Foundation::Numerics::float4x4 Transform4x4() const noexcept;
     [[nodiscard]] winrt::Windows::Foundation::Numerics::float3x2 Transform3x2() const noexcept;
 
+    // Returns nullopt if the transform isn't invertible.
+    [[nodiscard]] std::optional<winrt::Windows::Foundation::Numerics::float4x4> InverseTransform4x4() const noexcept;
+
     void AddChild(_In_ std::shared_ptr<VisualTreeNode> const& child);
     void RemoveChild(_In_ std::shared_ptr<VisualTreeNode> const& child);
     void RemoveAllChildren();
 
+    // Recomputes the size and transform of this node and its whole subtree from the visuals, now.
     void ComputeSizeAndTransform();
+
+    // Recomputes only the parts of the subtree that were marked dirty, in a single top-down pass.
+    // The geometry getters and hit testing do this automatically before they read anything.
+    void UpdateSizeAndTransform();
+
+    // Marks this node's subtree as needing its size and transform recomputed by the next update.
+    // Use this after changing visual properties directly.
+    void MarkSizeAndTransformDirty() noexcept;
+
+    // Set a visual property and mark the subtree dirty, without recomputing anything yet. This
+    // allows many changes to be batched into one update.
+    void VisualOffset(_In_ winrt::Windows::Foundation::Numerics::float3 const& value);
+    void VisualScale(_In_ winrt::Windows::Foundation::Numerics::float3 const& value);
+    void VisualRotationAngle(float value);
+    void VisualAnchorPoint(_In_ winrt::Windows::Foundation::Numerics::float2 const& value);
+
     [[nodiscard]] winrt::Windows::Foundation::Rect BoundsInTreeRootCoordinates() const;
 
     [[nodiscard]] std::shared_ptr<VisualTreeNode> HitTestInTreeRootCoordinates(
         _In_ winrt::Windows::Foundation::Point const& point);
 
     [[nodiscard]] bool Match(_In_ winrt::com_ptr<::IUnknown> const& visual) const noexcept;
-    [[nodiscard]] winrt::com_ptr<::IUnknown> Visual() const noexcept { std::unique_lock lock{ m_mutex }; return m_visual; }
+    // The visual is only set during Create, so it can be read without the lock.
+    [[nodiscard]] winrt::com_ptr<::IUnknown> Visual() const noexcept { return m_visual; }
 
     void HitTestCallback(_In_ ::HitTestCallback const& value) noexcept { m_hitTestCallback = value; }
     [[nodiscard]] ::HitTestCallback const& HitTestCallback() const noexcept { return m_hitTestCallback; }
@@ -49,21 +80,62 @@ struct VisualTreeNode : std::enable_shared_from_this<VisualTreeNode>
     void OwningFocusList(_In_ const std::weak_ptr<FocusList>& value) noexcept { m_owningFocusList = value; }
     [[nodiscard]] std::shared_ptr<FocusList> OwningFocusList() const noexcept { return m_owningFocusList.lock(); }
 
-    std::shared_ptr<VisualTreeNode> Parent() const noexcept { return m_parent.lock(); }
+    std::shared_ptr<VisualTreeNode> Parent() const noexcept;
 
     void IsBorderVisible(bool visible);
 
 private:
-    void Initialize(_In_ winrt::com_ptr<::IUnknown> const& visual);
+    struct Geometry
+    {
+        winrt::Windows::Foundation::Numerics::float2 size{ 0.0f, 0.0f };
+        winrt::Windows::Foundation::Numerics::float4x4 transform{ winrt::Windows::Foundation::Numerics::float4x4::identity() };
+        winrt::Windows::Foundation::Numerics::float4x4 inverseTransform{ winrt::Windows::Foundation::Numerics::float4x4::identity() };
+        bool isTransformInvertible{ true };
+    };
+
+    void Initialize(
+        _In_ winrt::com_ptr<::IUnknown> const& visual,
+        _In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool);
+
+    // Returns an empty lock if this node isn't pooled. Every node in a subtree shares the subtree
+    // root's pool, so this covers the whole subtree.
+    [[nodiscard]] std::unique_lock<std::mutex> LockPool() const;
+
+    // Moves this node's subtree into another pool (or out of pooling, if null). The caller must
+    // hold the locks of both pools.
+    void MoveToPoolInternal(_In_opt_ std::shared_ptr<VisualTreeNodePool> const& pool);
 
     // Called on child visuals, so does need to hold the lock.
     void UpdateParent(_In_ std::shared_ptr<VisualTreeNode> const& value);
 
+    // Marks the hit test index of this node and each of its ancestors as out of date.
+    void InvalidateHitTestIndex() noexcept;
+    void AppendToHitTestIndexInternal(_Inout_ std::vector<HitTestIndex::Entry>& entries, int parentIndex);
+
+    [[nodiscard]] winrt::Windows::Foundation::Rect BoundsInTreeRootCoordinatesInternal() const;
+
+    // Geometry storage, in the pool if there is one. Callers must hold the pool lock.
     [[nodiscard]] winrt::Windows::Foundation::Numerics::float2 const& SizeInternal() const noexcept;
+    void SizeInternal(_In_ winrt::Windows::Foundation::Numerics::float2 const& value) noexcept;
     [[nodiscard]] winrt::Windows::Foundation::Numerics::float4x4 const& TransformInternal() const noexcept;
+    [[nodiscard]] winrt::Windows::Foundation::Numerics::float4x4 const& InverseTransformInternal() const noexcept;
+    [[nodiscard]] bool IsTransformInvertibleInternal() const noexcept;
+
+    // Also caches the inverse, so that hit testing doesn't need to invert the transform per query.
+    void TransformInternal(_In_ winrt::Windows::Foundation::Numerics::float4x4 const& value) noexcept;
 
     void ComputeSizeAndTransformInternal();
 
+    // Returns true if any node in the subtree was recomputed.
+    bool UpdateSizeAndTransformInternal();
+
+    // Makes the current size and transform visible to the lock-free getters.
+    void PublishGeometry() noexcept;
+
+    // Updates the tree this node is in if this node or an ancestor is dirty, so that the published
+    // geometry is current.
+    void EnsureSizeAndTransformUpdated() const noexcept;
+
     winrt::Windows::Foundation::Numerics::float3 VisualOffset() const noexcept;
     winrt::Windows::Foundation::Numerics::float2 VisualSize() const noexcept;
     winrt::Windows::Foundation::Numerics::float3 VisualScale() const noexcept;
@@ -79,12 +151,33 @@ private:
 
     winrt::com_ptr<::IUnknown> m_visual{ nullptr };
     winrt::com_ptr<::IUnknown> m_borderVisual{ nullptr };
+
+    // Only used when the node isn't pooled.
     winrt::Windows::Foundation::Numerics::float2 m_size{ 0.0f, 0.0f };
     winrt::Windows::Foundation::Numerics::float4x4 m_transform{ winrt::Windows::Foundation::Numerics::float4x4::identity() };
+    winrt::Windows::Foundation::Numerics::float4x4 m_inverseTransform{ winrt::Windows::Foundation::Numerics::float4x4::identity() };
+    bool m_isTransformInvertible{ true };
 
+    std::shared_ptr<VisualTreeNodePool> m_pool{};
+    VisualTreeNodePool::Handle m_poolHandle{ VisualTreeNodePool::c_invalidHandle };
+
+    // Copy of the geometry for readers that don't hold the lock.
+    SeqLockValue<Geometry> m_publishedGeometry{};
+
+    // Set without holding the lock, since they are also set on ancestors.
+    std::atomic<bool> m_isSizeAndTransformDirty{ false };
+    std::atomic<bool> m_hasDirtyDescendant{ false };
+
+    // Guards m_parent, so that ancestors can be walked without taking their m_mutex. Writers also
+    // hold m_mutex, and no other lock is taken while holding this one.
+    mutable std::mutex m_parentMutex{};
     std::weak_ptr<VisualTreeNode> m_parent{};
     std::vector<std::shared_ptr<VisualTreeNode>> m_children{};
 
+    // Built on demand by HitTestInTreeRootCoordinates, and rebuilt after anything in the subtree changes.
+    HitTestIndex m_hitTestIndex{};
+    std::atomic<bool> m_isHitTestIndexValid{ false };
+
     ::HitTestCallback m_hitTestCallback{};
     std::weak_ptr<FocusList> m_owningFocusList{};
 };
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#include "precomp.h"
+#include "VisualTreeNodePool.h"
+
+#include "TransformBatch.h"
+
+VisualTreeNodePool::Handle VisualTreeNodePool::Allocate(_In_ VisualTreeNode* node)
+{
+    Handle handle;
+    if (!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_parents.emplace_back();
+        m_firstChildren.emplace_back();
+        m_lastChildren.emplace_back();
+        m_nextSiblings.emplace_back();
+        m_previousSiblings.emplace_back();
+        m_sizes.emplace_back();
+        m_transforms.emplace_back();
+        m_inverseTransforms.emplace_back();
+        m_isTransformInvertible.emplace_back();
+    }
+
+    m_nodes[handle] = node;
+    m_parents[handle] = c_invalidHandle;
+    m_firstChildren[handle] = c_invalidHandle;
+    m_lastChildren[handle] = c_invalidHandle;
+    m_nextSiblings[handle] = c_invalidHandle;
+    m_previousSiblings[handle] = c_invalidHandle;
+    m_sizes[handle] = { 0.0f, 0.0f };
+    m_transforms[handle] = winrt::float4x4::identity();
+    m_inverseTransforms[handle] = winrt::float4x4::identity();
+    m_isTransformInvertible[handle] = 1;
+
+    return handle;
+}
+
+void VisualTreeNodePool::Free(Handle handle) noexcept
+{
+    Unlink(handle);
+
+    // Any children that are still alive become roots of their own subtrees.
+    for (auto child = m_firstChildren[handle]; child != c_invalidHandle;)
+    {
+        auto next = m_nextSiblings[child];
+        m_parents[child] = c_invalidHandle;
+        m_nextSiblings[child] = c_invalidHandle;
+        m_previousSiblings[child] = c_invalidHandle;
+        child = next;
+    }
+
+    m_nodes[handle] = nullptr;
+    m_firstChildren[handle] = c_invalidHandle;
+    m_lastChildren[handle] = c_invalidHandle;
+    m_freeHandles.push_back(handle);
+}
+
+void VisualTreeNodePool::AppendChild(Handle parent, Handle child) noexcept
+{
+    Unlink(child);
+
+    m_parents[child] = parent;
+    m_previousSiblings[child] = m_lastChildren[parent];
+
+    if (m_lastChildren[parent] != c_invalidHandle)
+    {
+        m_nextSiblings[m_lastChildren[parent]] = child;
+    }
+    else
+    {
+        m_firstChildren[parent] = child;
+    }
+
+    m_lastChildren[parent] = child;
+}
+
+void VisualTreeNodePool::Unlink(Handle child) noexcept
+{
+    auto parent = m_parents[child];
+    if (parent == c_invalidHandle)
+    {
+        return;
+    }
+
+    auto previous = m_previousSiblings[child];
+    auto next = m_nextSiblings[child];
+
+    if (previous != c_invalidHandle)
+    {
+        m_nextSiblings[previous] = next;
+    }
+    else
+    {
+        m_firstChildren[parent] = next;
+    }
+
+    if (next != c_invalidHandle)
+    {
+        m_previousSiblings[next] = previous;
+    }
+    else
+    {
+        m_lastChildren[parent] = previous;
+    }
+
+    m_parents[child] = c_invalidHandle;
+    m_nextSiblings[child] = c_invalidHandle;
+    m_previousSiblings[child] = c_invalidHandle;
+}
+
+void VisualTreeNodePool::ComputeBounds(_Out_ std::vector<winrt::Rect>& bounds) const
+{
+    // Transform each run of handles in use as one batch. Free handles are skipped, since their
+    // transforms and sizes are stale and a pool that has shrunk may have many of them.
+    bounds.resize(m_nodes.size());
+
+    size_t begin = 0;
+    while (begin < m_nodes.size())
+    {
+        if (m_nodes[begin] == nullptr)
+        {
+            begin++;
+            continue;
+        }
+
+        auto end = begin + 1;
+        while (end < m_nodes.size() && m_nodes[end] != nullptr)
+        {
+            end++;
+        }
+
+        TransformBatch::TransformBounds(&m_transforms[begin], &m_sizes[begin], &bounds[begin], end - begin);
+        begin = end;
+    }
+}
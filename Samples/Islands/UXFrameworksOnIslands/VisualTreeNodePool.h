@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.  All rights reserved.
+
+#pragma once
+
+struct VisualTreeNode;
+
+// Structure-of-arrays storage for the nodes of a visual tree. Each pooled VisualTreeNode owns a
+// stable handle into the pool, and its size, transforms and tree links are kept in contiguous
+// arrays indexed by that handle instead of in the node itself. This lets whole-tree walks (such as
+// building the hit test index) run over packed memory without visiting or locking each node.
+//
+// The pool has its own lock, which callers must hold while using any of the other methods. It is
+// always taken after the locks of every VisualTreeNode involved, never before. When a subtree moves
+// between pools, the destination pool is locked before the subtree's old one.
+class VisualTreeNodePool
+{
+public:
+    using Handle = uint32_t;
+    static constexpr Handle c_invalidHandle = std::numeric_limits<Handle>::max();
+
+    [[nodiscard]] static std::shared_ptr<VisualTreeNodePool> Create()
+    {
+        return std::make_shared<VisualTreeNodePool>();
+    }
+
+    [[nodiscard]] std::unique_lock<std::mutex> Lock() const { return std::unique_lock{ m_mutex }; }
+
+    // Returns a handle with an identity transform, zero size, and no links. Allocating may move
+    // the arrays, so references returned by the accessors below are only valid until then.
+    [[nodiscard]] Handle Allocate(_In_ VisualTreeNode* node);
+
+    // Unlinks the handle from its parent and children, and returns it to the free list.
+    void Free(Handle handle) noexcept;
+
+    void AppendChild(Handle parent, Handle child) noexcept;
+    void Unlink(Handle child) noexcept;
+
+    [[nodiscard]] VisualTreeNode* Node(Handle handle) const noexcept { return m_nodes[handle]; }
+    [[nodiscard]] Handle Parent(Handle handle) const noexcept { return m_parents[handle]; }
+    [[nodiscard]] Handle FirstChild(Handle handle) const noexcept { return m_firstChildren[handle]; }
+    [[nodiscard]] Handle LastChild(Handle handle) const noexcept { return m_lastChildren[handle]; }
+    [[nodiscard]] Handle NextSibling(Handle handle) const noexcept { return m_nextSiblings[handle]; }
+    [[nodiscard]] Handle PreviousSibling(Handle handle) const noexcept { return m_previousSiblings[handle]; }
+
+    [[nodiscard]] winrt::float2& Size(Handle handle) noexcept { return m_sizes[handle]; }
+    [[nodiscard]] winrt::float2 const& Size(Handle handle) const noexcept { return m_sizes[handle]; }
+    [[nodiscard]] winrt::float4x4& Transform(Handle handle) noexcept { return m_transforms[handle]; }
+    [[nodiscard]] winrt::float4x4 const& Transform(Handle handle) const noexcept { return m_transforms[handle]; }
+    [[nodiscard]] winrt::float4x4& InverseTransform(Handle handle) noexcept { return m_inverseTransforms[handle]; }
+    [[nodiscard]] winrt::float4x4 const& InverseTransform(Handle handle) const noexcept { return m_inverseTransforms[handle]; }
+    [[nodiscard]] bool IsTransformInvertible(Handle handle) const noexcept { return m_isTransformInvertible[handle] != 0; }
+    void IsTransformInvertible(Handle handle, bool value) noexcept { m_isTransformInvertible[handle] = value ? 1 : 0; }
+
+    // Computes the bounds of every handle in use in tree root coordinates, indexed by handle. The
+    // bounds of free handles are left unspecified.
+    void ComputeBounds(_Out_ std::vector<winrt::Rect>& bounds) const;
+
+private:
+    mutable std::mutex m_mutex{};
+
+    std::vector<VisualTreeNode*> m_nodes{};
+    std::vector<Handle> m_parents{};
+    std::vector<Handle> m_firstChildren{};
+    std::vector<Handle> m_lastChildren{};
+    std::vector<Handle> m_nextSiblings{};
+    std::vector<Handle> m_previousSiblings{};
+    std::vector<winrt::float2> m_sizes{};
+    std::vector<winrt::float4x4> m_transforms{};
+    std::vector<winrt::float4x4> m_inverseTransforms{};
+    std::vector<uint8_t> m_isTransformInvertible{};
+
+    std::vector<Handle> m_freeHandles{};
+};
@@ -3,10 +3,14 @@
 #pragma once
 
 // C++ Standard headers
+#include <array>
+#include <atomic>
 #include <string>
 #include <vector>
+#include <list>
 #include <cstdio>
 #include <mutex>
+#include <unordered_map>
 #include <functional>
 #include <variant>
 
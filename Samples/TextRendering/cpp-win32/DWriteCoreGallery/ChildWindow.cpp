@@ -80,6 +80,11 @@ LRESULT ChildWindow::Handle_Paint(HWND hwnd, UINT message, WPARAM wParam, LPARAM
     PAINTSTRUCT ps;
     auto hdc = wil::BeginPaint(hwnd, &ps);
     OnPaint(hdc.get(), ps.rcPaint);
+
+    if (m_textRenderer)
+    {
+        m_textRenderer->TraceFrameStatistics();
+    }
     return 0;
 }
 
@@ -5,6 +5,7 @@
 #include "Helpers.h"
 #include "Resource.h"
 #include "FontFaceListWindow.h"
+#include "FontMetadataCache.h"
 
 namespace
 {
@@ -31,6 +32,12 @@ namespace
         { DWRITE_FONT_AXIS_TAG_WEIGHT, 400 },
         { DWRITE_FONT_AXIS_TAG_ITALIC, 0 }
     };
+
+    std::wstring ToWideString(std::u16string const& value)
+    {
+        static_assert(sizeof(wchar_t) == sizeof(char16_t));
+        return std::wstring{ reinterpret_cast<wchar_t const*>(value.data()), value.size() };
+    }
 }
 
 FontFaceListWindow::FontFaceListWindow(HWND parentWindow, TextRenderer* textRenderer) :
@@ -86,6 +93,9 @@ void FontFaceListWindow::SetFontFamily(
     _In_opt_ IDWriteFontCollection3* customFontCollection
     )
 {
+    // Font metadata is read from the cache where possible, which avoids creating a font face.
+    auto& metadataCache = FontMetadataCache::GetInstance();
+
     // Create a new vector of font items, one for each font.
     uint32_t fontCount = fontFamily->GetFontCount();
     std::vector<FontItem> fontItems(fontCount);
@@ -95,31 +105,105 @@ void FontFaceListWindow::SetFontFamily(
     {
         auto& item = fontItems[fontIndex];
 
-        // Create a font face for this font.
         wil::com_ptr<IDWriteFontFaceReference> fontFaceReference;
         THROW_IF_FAILED(fontFamily->GetFontFaceReference(fontIndex, &fontFaceReference));
-        wil::com_ptr<IDWriteFontFace3> fontFace3;
-        THROW_IF_FAILED(fontFaceReference->CreateFontFace(&fontFace3));
-        auto fontFace = fontFace3.query<IDWriteFontFace6>();
 
-        // Initialize the file name.
-        item.m_fileName = GetFontFilePath(fontFace.get());
+        // Initialize the file name. This is empty if the font is not a local file.
+        item.m_fileName = GetFontFilePath(fontFaceReference.get());
 
-        // Get the face index only if it's an OpenType collection.
-        if (fontFace->GetType() == DWRITE_FONT_FACE_TYPE_OPENTYPE_COLLECTION)
+        FontFaceMetadata const* metadata = item.m_fileName.empty() ? nullptr :
+            metadataCache.GetFaceMetadata(item.m_fileName, fontFaceReference->GetFontFaceIndex());
+
+        std::vector<DWRITE_FONT_AXIS_VALUE> axisValues;
+        std::vector<DWRITE_FONT_AXIS_RANGE> axisRanges;
+        std::wstring faceName;
+
+        if (metadata != nullptr)
         {
-            item.m_faceIndex = fontFaceReference->GetFontFaceIndex();
+            // Get the axis values from the font face reference. These identify the named instance
+            // for a variable font, and are derived from the font's tables otherwise.
+            axisValues = GetFontAxisValues(fontFaceReference.query<IDWriteFontFaceReference1>().get());
+            if (axisValues.empty())
+            {
+                for (auto const& axisValue : metadata->GetDefaultAxisValues())
+                {
+                    axisValues.push_back({ static_cast<DWRITE_FONT_AXIS_TAG>(axisValue.tag), axisValue.value });
+                }
+            }
+
+            // Axes the font does not vary along have a range of a single value.
+            std::vector<OpenTypeAxisValue> instanceValues;
+            for (auto const& axisValue : axisValues)
+            {
+                auto axis = metadata->FindAxis(axisValue.axisTag);
+                axisRanges.push_back({
+                    axisValue.axisTag,
+                    axis != nullptr ? axis->minValue : axisValue.value,
+                    axis != nullptr ? axis->maxValue : axisValue.value });
+                instanceValues.push_back({ static_cast<uint32_t>(axisValue.axisTag), axisValue.value });
+            }
+
+            // Get the face index only if it's an OpenType collection.
+            if (metadata->isCollection)
+            {
+                item.m_faceIndex = fontFaceReference->GetFontFaceIndex();
+            }
+
+            // These are the same names the font face provides below (see FontFaceMetadata::GetFamilyName).
+            item.m_typoFamilyName = ToWideString(metadata->GetFamilyName(FontFamilyModel::Typographic));
+            item.m_wssFamilyName = ToWideString(metadata->GetFamilyName(FontFamilyModel::WeightStretchStyle));
+            item.m_gdiFamilyName = ToWideString(metadata->GetName({ OpenTypeNameId_FamilyName }));
+            item.m_fullName = ToWideString(metadata->GetName({ OpenTypeNameId_FullName }));
+            item.m_postName = ToWideString(metadata->GetName({ OpenTypeNameId_PostScriptName }));
+            faceName = ToWideString(metadata->GetFaceName(static_cast<FontFamilyModel>(fontFamilyModel)));
+
+            // The face and PostScript names of a named instance come from the fvar table. The
+            // default instance keeps the full name from the name table.
+            auto instance = metadata->FindNamedInstance(instanceValues);
+            if (instance != nullptr)
+            {
+                auto instanceName = ToWideString(metadata->GetName({ instance->subfamilyNameId }));
+                if (!instanceName.empty())
+                {
+                    if (instance != metadata->FindNamedInstance({}))
+                    {
+                        item.m_fullName = item.m_typoFamilyName + L' ' + instanceName;
+                    }
+                    faceName = std::move(instanceName);
+                }
+
+                auto postName = ToWideString(metadata->GetName({ instance->postScriptNameId }));
+                if (!postName.empty())
+                {
+                    item.m_postName = std::move(postName);
+                }
+            }
         }
+        else
+        {
+            // Create a font face for this font.
+            wil::com_ptr<IDWriteFontFace3> fontFace3;
+            THROW_IF_FAILED(fontFaceReference->CreateFontFace(&fontFace3));
+            auto fontFace = fontFace3.query<IDWriteFontFace6>();
 
-        item.m_typoFamilyName = GetFamilyName(fontFace.get(), DWRITE_FONT_FAMILY_MODEL_TYPOGRAPHIC);
-        item.m_wssFamilyName = GetFamilyName(fontFace.get(), DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE);
-        item.m_gdiFamilyName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_WIN32_FAMILY_NAMES);
-        item.m_fullName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_FULL_NAME);
-        item.m_postName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_POSTSCRIPT_NAME);
+            // Get the face index only if it's an OpenType collection.
+            if (fontFace->GetType() == DWRITE_FONT_FACE_TYPE_OPENTYPE_COLLECTION)
+            {
+                item.m_faceIndex = fontFaceReference->GetFontFaceIndex();
+            }
+
+            item.m_typoFamilyName = GetFamilyName(fontFace.get(), DWRITE_FONT_FAMILY_MODEL_TYPOGRAPHIC);
+            item.m_wssFamilyName = GetFamilyName(fontFace.get(), DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE);
+            item.m_gdiFamilyName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_WIN32_FAMILY_NAMES);
+            item.m_fullName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_FULL_NAME);
+            item.m_postName = GetInformationalString(fontFace.get(), DWRITE_INFORMATIONAL_STRING_POSTSCRIPT_NAME);
+
+            axisValues = GetFontAxisValues(fontFace.get());
+            axisRanges = GetFontAxisRanges(fontFace.get());
+            faceName = GetFaceName(fontFace.get(), fontFamilyModel);
+        }
 
         // Initialize the vector of axes.
-        auto axisValues = GetFontAxisValues(fontFace.get());
-        auto axisRanges = GetFontAxisRanges(fontFace.get());
         THROW_HR_IF(E_UNEXPECTED, axisRanges.size() != axisValues.size());
         item.m_axes.resize(axisValues.size());
         for (size_t i = 0; i < axisValues.size(); i++)
@@ -134,7 +218,7 @@ void FontFaceListWindow::SetFontFamily(
         // Create a text layout object for the face name, styled to match the font.
         auto itemFormat = CreateTextFormat(item.m_typoFamilyName.c_str(), g_faceNameFontSize, axisValues, customFontCollection);
         THROW_IF_FAILED(itemFormat->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP));
-        item.m_faceNameTextLayout = CreateTextLayout(itemFormat.get(), GetFaceName(fontFace.get(), fontFamilyModel));
+        item.m_faceNameTextLayout = CreateTextLayout(itemFormat.get(), faceName);
 
         // Initialize the face name height.
         DWRITE_TEXT_METRICS1 metrics;
@@ -199,7 +283,7 @@ void FontFaceListWindow::DrawItem(TextRenderer* textRenderer, int itemIndex, boo
     // Helper for drawing values.
     auto DrawValue = [&](_In_z_ wchar_t const* value)
     {
-        auto textLayout = CreateTextLayout(m_valueTextFormat.get(), value);
+        auto textLayout = m_layoutCache.GetTextLayout(m_valueTextFormat.get(), value);
         THROW_IF_FAILED(textLayout->Draw(nullptr, textRenderer, rightX, y));
     };
 
@@ -243,7 +327,7 @@ void FontFaceListWindow::DrawItem(TextRenderer* textRenderer, int itemIndex, boo
         // Draw the axis tag.
         uint32_t tagValue = axis.axisTag;
         wchar_t tagString[] = { tagValue & 0xFF, (tagValue >> 8) & 0xFF, (tagValue >> 16) & 0xFF, (tagValue >> 24) & 0xFF, 0 };
-        auto textLayout = CreateTextLayout(m_labelTextFormat.get(), tagString);
+        auto textLayout = m_layoutCache.GetTextLayout(m_labelTextFormat.get(), tagString);
         DrawLabel(textLayout.get());
 
         // Create the value string.
@@ -287,6 +371,12 @@ void FontFaceListWindow::DrawItem(TextRenderer* textRenderer, int itemIndex, boo
     }
 }
 
+void FontFaceListWindow::OnPaint(HDC hdc, RECT invalidRect)
+{
+    ListWindow::OnPaint(hdc, invalidRect);
+    m_layoutCache.TraceFrameStatistics(L"FontFaceListWindow");
+}
+
 int FontFaceListWindow::GetItemPixelHeight(float dpiScale, int itemIndex)
 {
     return static_cast<int>(ceilf(m_fontItems[itemIndex].m_itemHeight * dpiScale));
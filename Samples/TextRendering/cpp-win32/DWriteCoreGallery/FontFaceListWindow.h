@@ -3,6 +3,7 @@
 
 #pragma once
 #include "ListWindow.h"
+#include "TextLayoutCache.h"
 
 class FontFaceListWindow final : public ListWindow
 {
@@ -18,6 +19,7 @@ public:
 protected:
     void DrawItem(TextRenderer* textRenderer, int itemIndex, bool isSelected) override;
     int GetItemPixelHeight(float dpiScale, int itemIndex) override;
+    void OnPaint(HDC hdc, RECT invalidRect) override;
 
 private:
     struct AxisInfo
@@ -64,4 +66,7 @@ private:
     float m_rowHeight = 0;
 
     std::vector<FontItem> m_fontItems;
+
+    // Layouts for the values and axis tags, which are drawn again on every paint.
+    TextLayoutCache m_layoutCache;
 };
@@ -55,7 +55,10 @@ FontFamilyListWindow::FontFamilyListWindow(
     DWRITE_TRIMMING trimming = { DWRITE_TRIMMING_GRANULARITY_CHARACTER };
     THROW_IF_FAILED(m_textFormat->SetTrimming(&trimming, trimmingSign.get()));
 
-    // Initialize the vector of family names.
+    // Initialize the vector of family names. These come from the font collection rather than from
+    // FontMetadataCache: the collection's family names are stored in its font set, so reading them
+    // doesn't create font faces or open font files, and a custom collection may not be made of
+    // local files at all.
     uint32_t familyCount = m_fontCollection->GetFontFamilyCount();
     m_familyNames.reserve(familyCount);
 
@@ -70,16 +73,41 @@ FontFamilyListWindow::FontFamilyListWindow(
         m_familyNames.push_back(GetLocalString(familyNames.get()));
     }
 
-    // Sort the vector of family names.
-    auto LessIgnoreCase = [](std::wstring const& left, std::wstring const& right)
+    // Sort the vector of family names. Each name's sort key is computed once, which orders the names
+    // the same way as CompareStringW but only compares bytes during the sort.
+    auto GetSortKey = [](std::wstring const& name)
     {
-        return CompareStringW(
-            LOCALE_USER_DEFAULT, NORM_IGNORECASE, 
-            left.c_str(), static_cast<int>(left.length()), 
-            right.c_str(), static_cast<int>(right.length())
-        ) == CSTR_LESS_THAN;
+        std::string sortKey;
+        if (!name.empty())
+        {
+            int nameLength = static_cast<int>(name.length());
+            int keySize = LCMapStringW(LOCALE_USER_DEFAULT, LCMAP_SORTKEY | NORM_IGNORECASE, name.c_str(), nameLength, nullptr, 0);
+            THROW_LAST_ERROR_IF(keySize == 0);
+
+            // For LCMAP_SORTKEY, the output is an array of bytes and its size is in bytes.
+            sortKey.resize(keySize);
+            THROW_LAST_ERROR_IF(0 == LCMapStringW(
+                LOCALE_USER_DEFAULT, LCMAP_SORTKEY | NORM_IGNORECASE,
+                name.c_str(), nameLength,
+                reinterpret_cast<wchar_t*>(sortKey.data()), keySize
+            ));
+        }
+        return sortKey;
     };
-    std::sort(m_familyNames.begin(), m_familyNames.end(), LessIgnoreCase);
+
+    std::vector<std::pair<std::string, std::wstring>> sortEntries;
+    sortEntries.reserve(m_familyNames.size());
+    for (auto& familyName : m_familyNames)
+    {
+        sortEntries.emplace_back(GetSortKey(familyName), std::move(familyName));
+    }
+
+    std::sort(sortEntries.begin(), sortEntries.end(), [](auto const& left, auto const& right) { return left.first < right.first; });
+
+    for (size_t i = 0; i < sortEntries.size(); i++)
+    {
+        m_familyNames[i] = std::move(sortEntries[i].second);
+    }
 
     // Initialize the list.
     SetItemCount(familyCount);
@@ -87,17 +115,25 @@ FontFamilyListWindow::FontFamilyListWindow(
 
 void FontFamilyListWindow::DrawItem(TextRenderer* textRenderer, int itemIndex, bool isSelected)
 {
-    // Create the text layout object.
-    auto textLayout = CreateTextLayout(m_textFormat.get(), m_familyNames[itemIndex]);
-
-    // Set the maximum width, for trimming.
+    // Get the text layout object, with the maximum width set for trimming. A width of zero would
+    // mean no trimming to the cache, so use a tiny width instead if the window is too narrow. The
+    // width is rounded down to a multiple of 16 DIPs so that resizing the window doesn't create new
+    // layouts for every pixel. The tradeoff is that a name can be trimmed up to 16 DIPs before it
+    // reaches the edge of the window.
     float widthInDips = GetPixelWidth() / textRenderer->GetDpiScale();
-    THROW_IF_FAILED(textLayout->SetMaxWidth(std::max(0.0f, widthInDips - g_leftMargin)));
+    float maxWidth = TextLayoutCache::RoundTrimmingWidth(std::max(0.01f, widthInDips - g_leftMargin));
+    auto textLayout = m_layoutCache.GetTextLayout(m_textFormat.get(), m_familyNames[itemIndex], maxWidth);
 
     // Draw the text.
     THROW_IF_FAILED(textLayout->Draw(nullptr, textRenderer, g_leftMargin, g_topMargin));
 }
 
+void FontFamilyListWindow::OnPaint(HDC hdc, RECT invalidRect)
+{
+    ListWindow::OnPaint(hdc, invalidRect);
+    m_layoutCache.TraceFrameStatistics(L"FontFamilyListWindow");
+}
+
 int FontFamilyListWindow::GetItemPixelHeight(float dpiScale, int itemIndex)
 {
     return static_cast<int>(ceilf(m_itemHeight * dpiScale));
@@ -3,6 +3,7 @@
 
 #pragma once
 #include "ListWindow.h"
+#include "TextLayoutCache.h"
 
 class FontFamilyListWindow final : public ListWindow
 {
@@ -37,6 +38,7 @@ public:
 protected:
     void DrawItem(TextRenderer* textRenderer, int itemIndex, bool isSelected) override;
     int GetItemPixelHeight(float dpiScale, int itemIndex) override;
+    void OnPaint(HDC hdc, RECT invalidRect) override;
 
 private:
     wil::com_ptr<IDWriteFontCollection3> m_inputFontCollection;
@@ -45,4 +47,7 @@ private:
     DWRITE_FONT_FAMILY_MODEL m_fontFamilyModel;
     std::vector<std::wstring> m_familyNames;
     float m_itemHeight = 0;
+
+    // Layouts for the family names, keyed by the trimming width.
+    TextLayoutCache m_layoutCache;
 };
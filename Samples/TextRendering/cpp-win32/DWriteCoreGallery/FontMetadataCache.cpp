@@ -0,0 +1,297 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "Main.h"
+#include "FontMetadataCache.h"
+
+namespace
+{
+    // Identifies the cache file format. Bump the version if the layout changes.
+    constexpr uint32_t g_cacheFileMagic = MakeOpenTypeTag('D', 'W', 'F', 'M');
+    constexpr uint32_t g_cacheFileVersion = 1;
+
+    constexpr wchar_t g_cacheDirectoryName[] = L"DWriteCoreGallery";
+    constexpr wchar_t g_cacheFileName[] = L"FontMetadataCache.bin";
+
+    static_assert(sizeof(wchar_t) == sizeof(char16_t));
+
+    std::unique_ptr<FontMetadataCache> g_instance;
+
+    std::wstring GetCacheFilePath()
+    {
+        wchar_t buffer[MAX_PATH];
+        DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", buffer, ARRAYSIZE(buffer));
+        if (length == 0 || length >= ARRAYSIZE(buffer))
+        {
+            return {};
+        }
+
+        std::wstring path{ buffer, length };
+        path += L'\\';
+        path += g_cacheDirectoryName;
+
+        // The directory may already exist.
+        CreateDirectoryW(path.c_str(), nullptr);
+
+        path += L'\\';
+        path += g_cacheFileName;
+        return path;
+    }
+
+    // Reads the metadata of every face in a font file.
+    bool ParseFontFile(std::span<uint8_t const> fileData, _Out_ std::vector<FontFaceMetadata>& faces)
+    {
+        faces.clear();
+
+        // Each face needs at least a 4-byte offset in the collection header, which bounds the count.
+        uint32_t faceCount = GetOpenTypeFaceCount(fileData);
+        if (faceCount == 0 || faceCount > fileData.size() / 4)
+        {
+            return false;
+        }
+
+        faces.resize(faceCount);
+        for (uint32_t faceIndex = 0; faceIndex < faceCount; faceIndex++)
+        {
+            if (!ParseFontFaceMetadata(fileData, faceIndex, faces[faceIndex]))
+            {
+                faces.clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Calls ParseFontFile on a mapped view of a font file. If a page of the view can't be read (for
+    // example, because the file is on a network share that disconnects), touching it raises an
+    // EXCEPTION_IN_PAGE_ERROR structured exception rather than returning an error, and the file is
+    // treated as unreadable.
+    //
+    // This function uses __try, so it must not have objects with destructors. The project builds
+    // with /EHsc, so destructors in ParseFontFile's frames are not run when it's unwound this way,
+    // and any memory they allocated leaks; that's acceptable for a rare I/O error.
+    bool ParseMappedFontFile(std::span<uint8_t const> fileData, _Out_ std::vector<FontFaceMetadata>& faces)
+    {
+        __try
+        {
+            return ParseFontFile(fileData, faces);
+        }
+        __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+        {
+            return false;
+        }
+    }
+
+    bool GetFileSizeAndTime(std::wstring const& filePath, _Out_ uint64_t& fileSize, _Out_ uint64_t& lastWriteTime) noexcept
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExW(filePath.c_str(), GetFileExInfoStandard, &data))
+        {
+            fileSize = 0;
+            lastWriteTime = 0;
+            return false;
+        }
+
+        fileSize = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        lastWriteTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+}
+
+FontMetadataCache& FontMetadataCache::GetInstance()
+{
+    if (g_instance == nullptr)
+    {
+        g_instance.reset(new FontMetadataCache);
+    }
+    return *g_instance;
+}
+
+void FontMetadataCache::SaveInstance() noexcept
+{
+    if (g_instance != nullptr)
+    {
+        try
+        {
+            g_instance->Save();
+        }
+        CATCH_LOG();
+    }
+}
+
+FontMetadataCache::FontMetadataCache() : m_cacheFilePath{ GetCacheFilePath() }
+{
+    Load();
+}
+
+_Ret_maybenull_ FontFaceMetadata const* FontMetadataCache::GetFaceMetadata(std::wstring const& filePath, uint32_t faceIndex)
+{
+    uint64_t fileSize;
+    uint64_t lastWriteTime;
+    if (!GetFileSizeAndTime(filePath, fileSize, lastWriteTime))
+    {
+        return nullptr;
+    }
+
+    auto it = m_files.find(filePath);
+    if (it == m_files.end() || it->second.fileSize != fileSize || it->second.lastWriteTime != lastWriteTime)
+    {
+        // An entry with no faces records that the file could not be read, so it isn't tried again
+        // until it changes.
+        FileEntry entry{ fileSize, lastWriteTime };
+        ReadFontFile(filePath, fileSize, entry.faces);
+
+        it = m_files.insert_or_assign(filePath, std::move(entry)).first;
+        m_isDirty = true;
+    }
+
+    auto const& faces = it->second.faces;
+    return (faceIndex < faces.size()) ? &faces[faceIndex] : nullptr;
+}
+
+bool FontMetadataCache::ReadFontFile(std::wstring const& filePath, uint64_t fileSize, _Out_ std::vector<FontFaceMetadata>& faces)
+{
+    faces.clear();
+
+    if (fileSize == 0 || fileSize > SIZE_MAX)
+    {
+        return false;
+    }
+
+    wil::unique_hfile file{ CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    if (!file)
+    {
+        return false;
+    }
+
+    wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    if (!mapping)
+    {
+        return false;
+    }
+
+    wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+    if (!view)
+    {
+        return false;
+    }
+
+    // Only the pages holding the table directory and the tables that are read are touched.
+    std::span<uint8_t const> fileData{ view.get(), static_cast<size_t>(fileSize) };
+    if (!ParseMappedFontFile(fileData, faces))
+    {
+        faces.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void FontMetadataCache::Load()
+{
+    if (m_cacheFilePath.empty())
+    {
+        return;
+    }
+
+    wil::unique_hfile file{ CreateFileW(m_cacheFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    if (!file)
+    {
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart > MAXDWORD)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(fileSize.QuadPart));
+    DWORD bytesRead;
+    if (!ReadFile(file.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr) || bytesRead != buffer.size())
+    {
+        return;
+    }
+
+    BinaryReader reader{ buffer };
+    if (reader.ReadUInt32() != g_cacheFileMagic || reader.ReadUInt32() != g_cacheFileVersion)
+    {
+        return;
+    }
+
+    // A cache file that is truncated or corrupt is ignored as a whole.
+    std::map<std::wstring, FileEntry> files;
+    uint32_t fileCount = reader.ReadUInt32();
+    for (uint32_t i = 0; i < fileCount && reader.IsValid(); i++)
+    {
+        auto path = reader.ReadString();
+
+        FileEntry entry;
+        entry.fileSize = reader.ReadUInt64();
+        entry.lastWriteTime = reader.ReadUInt64();
+
+        uint32_t faceCount = reader.ReadUInt32();
+        if (faceCount > reader.GetRemaining().size())
+        {
+            return;
+        }
+
+        entry.faces.resize(faceCount);
+        for (auto& face : entry.faces)
+        {
+            if (!ReadFontFaceMetadata(reader, face))
+            {
+                return;
+            }
+        }
+
+        files.insert_or_assign(std::wstring{ reinterpret_cast<wchar_t const*>(path.data()), path.size() }, std::move(entry));
+    }
+
+    if (reader.IsValid())
+    {
+        m_files = std::move(files);
+    }
+}
+
+void FontMetadataCache::Save()
+{
+    if (!m_isDirty || m_cacheFilePath.empty())
+    {
+        return;
+    }
+
+    std::vector<uint8_t> buffer;
+    BinaryWriter writer{ buffer };
+    writer.WriteUInt32(g_cacheFileMagic);
+    writer.WriteUInt32(g_cacheFileVersion);
+    writer.WriteUInt32(static_cast<uint32_t>(m_files.size()));
+
+    for (auto const& [path, entry] : m_files)
+    {
+        writer.WriteString({ reinterpret_cast<char16_t const*>(path.data()), path.size() });
+        writer.WriteUInt64(entry.fileSize);
+        writer.WriteUInt64(entry.lastWriteTime);
+        writer.WriteUInt32(static_cast<uint32_t>(entry.faces.size()));
+
+        for (auto const& face : entry.faces)
+        {
+            WriteFontFaceMetadata(writer, face);
+        }
+    }
+
+    // Write to a temporary file and then replace the cache file, so a reader never sees a
+    // partially written cache.
+    std::wstring tempFilePath = m_cacheFilePath + L".tmp";
+    {
+        wil::unique_hfile file{ CreateFileW(tempFilePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        DWORD bytesWritten;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &bytesWritten, nullptr));
+    }
+
+    THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(tempFilePath.c_str(), m_cacheFilePath.c_str(), MOVEFILE_REPLACE_EXISTING));
+    m_isDirty = false;
+}
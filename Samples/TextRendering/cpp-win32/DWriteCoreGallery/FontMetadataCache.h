@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+#include "OpenTypeReader.h"
+
+/// <summary>
+/// Caches the metadata of local font files, so the font face list can be populated without creating
+/// a font face for each font. On a cache miss, the font file is memory-mapped and its tables are read
+/// directly. Entries are keyed by file path, and are discarded if the file's size or last write time
+/// changes. The cache is loaded from disk on first use, and wWinMain saves it by calling SaveInstance
+/// once the main window is closed. It is only used on the UI thread.
+/// </summary>
+class FontMetadataCache
+{
+public:
+    /// <summary>
+    /// Returns the process-wide cache, loading it from disk if necessary.
+    /// </summary>
+    static FontMetadataCache& GetInstance();
+
+    /// <summary>
+    /// Saves the process-wide cache if it has been used. Errors are logged rather than thrown,
+    /// since failing to save only means the next run reads more fonts.
+    /// </summary>
+    static void SaveInstance() noexcept;
+
+    // Disable move and copy.
+    FontMetadataCache(FontMetadataCache const&) = delete;
+    FontMetadataCache& operator=(FontMetadataCache const&) = delete;
+
+    /// <summary>
+    /// Returns the metadata for one face of a local font file.
+    /// </summary>
+    /// <param name="filePath">Full path of the font file.</param>
+    /// <param name="faceIndex">Index of the face within the file; zero unless the file is a collection.</param>
+    /// <returns>Returns the metadata, or nullptr if the file can't be read or isn't an OpenType font.</returns>
+    _Ret_maybenull_ FontFaceMetadata const* GetFaceMetadata(std::wstring const& filePath, uint32_t faceIndex);
+
+    /// <summary>
+    /// Writes the cache to disk if any entries have been added since it was loaded.
+    /// </summary>
+    void Save();
+
+private:
+    FontMetadataCache();
+
+    struct FileEntry
+    {
+        uint64_t fileSize = 0;
+        uint64_t lastWriteTime = 0;
+        std::vector<FontFaceMetadata> faces;
+    };
+
+    void Load();
+    static bool ReadFontFile(std::wstring const& filePath, uint64_t fileSize, _Out_ std::vector<FontFaceMetadata>& faces);
+
+    std::wstring m_cacheFilePath;
+    std::map<std::wstring, FileEntry> m_files;
+    bool m_isDirty = false;
+};
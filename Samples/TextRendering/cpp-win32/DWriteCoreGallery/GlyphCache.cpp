@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "GlyphCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Space left between glyphs in the atlas, so rounding never samples a neighbor.
+    constexpr uint32_t g_glyphPadding = 1;
+
+    uint32_t FloatBits(float value) noexcept
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    void HashCombine(size_t& hash, size_t value) noexcept
+    {
+        hash ^= value + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+    }
+}
+
+size_t GlyphKeyHash::operator()(GlyphKey const& key) const noexcept
+{
+    size_t hash = (static_cast<size_t>(key.fontFaceId) << 16) ^ key.glyphIndex;
+    HashCombine(hash, (static_cast<size_t>(key.subpixelOffset) << 8) | key.bytesPerPixel);
+    HashCombine(hash, (static_cast<size_t>(key.measuringMode) << 16) | (static_cast<size_t>(key.renderingMode) << 8) | key.gridFitMode);
+    HashCombine(hash, FloatBits(key.emSize));
+    HashCombine(hash, FloatBits(key.m11));
+    HashCombine(hash, FloatBits(key.m12));
+    HashCombine(hash, FloatBits(key.m21));
+    HashCombine(hash, FloatBits(key.m22));
+    return hash;
+}
+
+GlyphCache::GlyphCache(uint32_t atlasSize) :
+    m_atlasSize{ std::max(atlasSize, c_maxGlyphSize + g_glyphPadding) },
+    m_atlas(static_cast<size_t>(m_atlasSize) * m_atlasSize * 3)
+{
+}
+
+GlyphEntry const* GlyphCache::Find(GlyphKey const& key) noexcept
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    m_statistics.hitCount++;
+    return &it->second;
+}
+
+GlyphEntry const* GlyphCache::Add(GlyphKey const& key, int32_t left, int32_t top, uint32_t width, uint32_t height, std::span<uint8_t const> coverage)
+{
+    m_statistics.missCount++;
+
+    size_t rowSize = static_cast<size_t>(width) * key.bytesPerPixel;
+    if (width > c_maxGlyphSize || height > c_maxGlyphSize ||
+        (key.bytesPerPixel != 1 && key.bytesPerPixel != 3) ||
+        coverage.size() < rowSize * height)
+    {
+        return nullptr;
+    }
+
+    GlyphEntry entry{ left, top, 0, 0, width, height, key.bytesPerPixel == 3 };
+
+    if (width != 0 && height != 0)
+    {
+        if (!TryAllocate(width, height, entry.atlasX, entry.atlasY))
+        {
+            // Start over with an empty atlas. A glyph no larger than c_maxGlyphSize always fits.
+            Clear();
+            m_statistics.resetCount++;
+            TryAllocate(width, height, entry.atlasX, entry.atlasY);
+        }
+
+        for (uint32_t row = 0; row < height; row++)
+        {
+            uint8_t const* source = &coverage[row * rowSize];
+            uint8_t* dest = &m_atlas[((static_cast<size_t>(entry.atlasY) + row) * m_atlasSize + entry.atlasX) * 3];
+
+            if (key.bytesPerPixel == 3)
+            {
+                memcpy(dest, source, rowSize);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < width; i++)
+                {
+                    dest[i * 3] = source[i];
+                    dest[i * 3 + 1] = source[i];
+                    dest[i * 3 + 2] = source[i];
+                }
+            }
+        }
+    }
+
+    return &m_entries.insert_or_assign(key, entry).first->second;
+}
+
+void GlyphCache::Clear() noexcept
+{
+    m_entries.clear();
+    m_shelfX = 0;
+    m_shelfY = 0;
+    m_shelfHeight = 0;
+    m_generation++;
+}
+
+GlyphCache::Statistics GlyphCache::TakeFrameStatistics() noexcept
+{
+    Statistics frameStatistics;
+    frameStatistics.hitCount = m_statistics.hitCount - m_frameStartStatistics.hitCount;
+    frameStatistics.missCount = m_statistics.missCount - m_frameStartStatistics.missCount;
+    frameStatistics.resetCount = m_statistics.resetCount - m_frameStartStatistics.resetCount;
+    m_frameStartStatistics = m_statistics;
+    return frameStatistics;
+}
+
+bool GlyphCache::TryAllocate(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) noexcept
+{
+    uint32_t paddedWidth = width + g_glyphPadding;
+    uint32_t paddedHeight = height + g_glyphPadding;
+
+    // Start a new shelf if the glyph doesn't fit at the end of the current one.
+    if (m_shelfX + paddedWidth > m_atlasSize)
+    {
+        m_shelfY += m_shelfHeight;
+        m_shelfX = 0;
+        m_shelfHeight = 0;
+    }
+
+    if (m_shelfY + paddedHeight > m_atlasSize)
+    {
+        return false;
+    }
+
+    x = m_shelfX;
+    y = m_shelfY;
+    m_shelfX += paddedWidth;
+    m_shelfHeight = std::max(m_shelfHeight, paddedHeight);
+    return true;
+}
+
+GlyphBlender::GlyphBlender(GlyphBlendParameters const& parameters) :
+    m_parameters{ parameters },
+    m_fromLinear(c_linearTableSize)
+{
+    m_parameters.gamma = std::clamp(m_parameters.gamma, 1.0f, 3.0f);
+    m_parameters.enhancedContrast = std::max(m_parameters.enhancedContrast, 0.0f);
+    m_parameters.grayscaleEnhancedContrast = std::max(m_parameters.grayscaleEnhancedContrast, 0.0f);
+    m_parameters.clearTypeLevel = std::clamp(m_parameters.clearTypeLevel, 0.0f, 1.0f);
+
+    constexpr float maxLinear = c_linearTableSize - 1;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        m_toLinear[i] = static_cast<uint16_t>(std::lround(std::pow(i / 255.0f, m_parameters.gamma) * maxLinear));
+    }
+    for (uint32_t i = 0; i < c_linearTableSize; i++)
+    {
+        m_fromLinear[i] = static_cast<uint8_t>(std::lround(std::pow(i / maxLinear, 1 / m_parameters.gamma) * 255));
+    }
+
+    SetTextColor(0, 0, 0);
+}
+
+void GlyphBlender::SetTextColor(uint8_t red, uint8_t green, uint8_t blue) noexcept
+{
+    m_textColor = { red, green, blue };
+
+    // Light text on a dark background looks bolder, so DirectWrite reduces the enhanced contrast for
+    // it, down to none for text at three quarters of full intensity or brighter.
+    float intensity = (0.25f * red + 0.5f * green + 0.25f * blue) / 255;
+    float multiplier = std::clamp(4 * (0.75f - intensity), 0.0f, 1.0f);
+
+    auto fillTable = [](std::array<uint32_t, 256>& table, float contrast)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            float coverage = i / 255.0f;
+            table[i] = static_cast<uint32_t>(std::lround(coverage * (contrast + 1) / (coverage * contrast + 1) * 65536));
+        }
+    };
+    fillTable(m_clearTypeCoverage, m_parameters.enhancedContrast * multiplier);
+    fillTable(m_grayscaleCoverage, m_parameters.grayscaleEnhancedContrast * multiplier);
+}
+
+void GlyphBlender::Blend(
+    uint32_t* pixels,
+    uint32_t bitmapWidth,
+    uint32_t bitmapHeight,
+    int32_t x,
+    int32_t y,
+    GlyphCache const& cache,
+    GlyphEntry const& entry
+) const noexcept
+{
+    // Clip the glyph to the bitmap.
+    int64_t firstColumn = std::max<int64_t>(0, -static_cast<int64_t>(x));
+    int64_t firstRow = std::max<int64_t>(0, -static_cast<int64_t>(y));
+    int64_t lastColumn = std::min<int64_t>(entry.width, static_cast<int64_t>(bitmapWidth) - x);
+    int64_t lastRow = std::min<int64_t>(entry.height, static_cast<int64_t>(bitmapHeight) - y);
+    if (firstColumn >= lastColumn || firstRow >= lastRow)
+    {
+        return;
+    }
+
+    // The ClearType level as a fraction of 256, and the atlas subpixel that covers each channel.
+    int clearTypeLevel = static_cast<int>(std::lround(m_parameters.clearTypeLevel * 256));
+    size_t redSubpixel = m_parameters.isBgr ? 2 : 0;
+    size_t blueSubpixel = m_parameters.isBgr ? 0 : 2;
+
+    int foregroundLinear[3] = { m_toLinear[m_textColor[0]], m_toLinear[m_textColor[1]], m_toLinear[m_textColor[2]] };
+
+    auto blendChannel = [&](uint32_t pixel, int shift, int channel, uint32_t coverage) -> uint32_t
+    {
+        if (coverage >= 65536)
+        {
+            return m_textColor[channel];
+        }
+
+        uint8_t background = static_cast<uint8_t>(pixel >> shift);
+        int backgroundLinear = m_toLinear[background];
+        int linear = backgroundLinear + static_cast<int>(((static_cast<int64_t>(foregroundLinear[channel] - backgroundLinear) * coverage) + 32768) >> 16);
+        return m_fromLinear[linear];
+    };
+
+    for (int64_t row = firstRow; row < lastRow; row++)
+    {
+        // Both pointers start at the first column inside the bitmap.
+        uint8_t const* coverage = cache.GetCoverageRow(entry, static_cast<uint32_t>(row)) + (firstColumn * 3);
+        uint32_t* dest = pixels + (static_cast<size_t>(y + row) * bitmapWidth) + static_cast<size_t>(x + firstColumn);
+
+        for (int64_t column = firstColumn; column < lastColumn; column++, coverage += 3, dest++)
+        {
+            if ((coverage[0] | coverage[1] | coverage[2]) == 0)
+            {
+                continue;
+            }
+
+            uint32_t subpixels[3];
+            if (entry.isClearType)
+            {
+                int average = (coverage[0] + coverage[1] + coverage[2] + 1) / 3;
+                for (size_t i = 0; i < 3; i++)
+                {
+                    int value = average + (((coverage[i] - average) * clearTypeLevel + 128) >> 8);
+                    subpixels[i] = m_clearTypeCoverage[std::clamp(value, 0, 255)];
+                }
+            }
+            else
+            {
+                subpixels[0] = subpixels[1] = subpixels[2] = m_grayscaleCoverage[coverage[0]];
+            }
+
+            // Pixels are 0xAARRGGBB.
+            uint32_t pixel = *dest;
+            uint32_t r = blendChannel(pixel, 16, 0, subpixels[redSubpixel]);
+            uint32_t g = blendChannel(pixel, 8, 1, subpixels[1]);
+            uint32_t b = blendChannel(pixel, 0, 2, subpixels[blueSubpixel]);
+            *dest = (pixel & 0xFF000000) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
@@ -0,0 +1,223 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This header is platform-neutral: it depends only on the C++ standard library, so the cache,
+// atlas policy and blending can be tested headlessly with synthetic coverage bitmaps.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Identifies a rasterized glyph. The transform includes the pixels-per-DIP scale, and the modes
+/// are those the glyph was rasterized with, so the key fully determines the glyph's coverage bitmap.
+/// </summary>
+struct GlyphKey
+{
+    uint32_t fontFaceId;
+    uint16_t glyphIndex;
+
+    // Horizontal position of the glyph origin within its pixel, in quarter pixels (0-3).
+    uint8_t subpixelOffset;
+
+    // Bytes of coverage per pixel: 3 for ClearType, 1 for grayscale or aliased text.
+    uint8_t bytesPerPixel;
+
+    // DWRITE_MEASURING_MODE, DWRITE_RENDERING_MODE1 and DWRITE_GRID_FIT_MODE values.
+    uint8_t measuringMode;
+    uint8_t renderingMode;
+    uint8_t gridFitMode;
+
+    float emSize;
+    float m11;
+    float m12;
+    float m21;
+    float m22;
+
+    bool operator==(GlyphKey const&) const = default;
+};
+
+struct GlyphKeyHash
+{
+    size_t operator()(GlyphKey const& key) const noexcept;
+};
+
+/// <summary>
+/// Location of a cached glyph's coverage within the atlas.
+/// </summary>
+struct GlyphEntry
+{
+    // Offset of the top-left corner of the coverage bitmap from the glyph origin, in pixels.
+    int32_t left;
+    int32_t top;
+
+    // Position and size of the coverage bitmap within the atlas. Blank glyphs have zero size.
+    uint32_t atlasX;
+    uint32_t atlasY;
+    uint32_t width;
+    uint32_t height;
+
+    // Whether the coverage is per subpixel, rather than grayscale replicated to all three.
+    bool isClearType;
+};
+
+/// <summary>
+/// Caches glyph coverage bitmaps in a single atlas, so that glyphs drawn repeatedly (such as the
+/// labels on every row of a list) are only rasterized once. Coverage is stored with three bytes per
+/// pixel, one for each ClearType subpixel; grayscale coverage is replicated to all three.
+///
+/// Glyphs are packed into shelves. When the atlas is full, it is emptied and the generation number
+/// changes, which tells callers to discard anything that refers to cached glyphs.
+/// </summary>
+class GlyphCache
+{
+public:
+    static constexpr uint32_t c_defaultAtlasSize = 1024;
+
+    // Glyphs larger than this in either dimension are not cached.
+    static constexpr uint32_t c_maxGlyphSize = 128;
+
+    struct Statistics
+    {
+        uint64_t hitCount = 0;
+        uint64_t missCount = 0;
+        uint64_t resetCount = 0;
+
+        double GetHitRate() const noexcept
+        {
+            uint64_t total = hitCount + missCount;
+            return total != 0 ? static_cast<double>(hitCount) / static_cast<double>(total) : 0.0;
+        }
+    };
+
+    explicit GlyphCache(uint32_t atlasSize = c_defaultAtlasSize);
+
+    /// <summary>
+    /// Returns the cached glyph, or nullptr. The pointer is valid until the next call to Add.
+    /// </summary>
+    GlyphEntry const* Find(GlyphKey const& key) noexcept;
+
+    /// <summary>
+    /// Copies a glyph's coverage into the atlas. Returns nullptr if the glyph is too large to cache.
+    /// If the atlas is full, it is emptied first. The pointer is valid until the next call to Add.
+    /// </summary>
+    /// <param name="key">Key of the glyph, whose bytesPerPixel describes the coverage.</param>
+    /// <param name="left">Offset of the coverage bitmap from the glyph origin.</param>
+    /// <param name="top">Offset of the coverage bitmap from the glyph origin.</param>
+    /// <param name="width">Width of the coverage bitmap in pixels.</param>
+    /// <param name="height">Height of the coverage bitmap in pixels.</param>
+    /// <param name="coverage">Coverage rows, each width * key.bytesPerPixel bytes.</param>
+    GlyphEntry const* Add(GlyphKey const& key, int32_t left, int32_t top, uint32_t width, uint32_t height, std::span<uint8_t const> coverage);
+
+    void Clear() noexcept;
+
+    uint32_t GetGeneration() const noexcept { return m_generation; }
+    size_t GetGlyphCount() const noexcept { return m_entries.size(); }
+    Statistics const& GetStatistics() const noexcept { return m_statistics; }
+
+    /// <summary>
+    /// Returns the counters accumulated since the previous call, for reporting them once per paint.
+    /// </summary>
+    Statistics TakeFrameStatistics() noexcept;
+
+    /// <summary>
+    /// Returns the coverage of the first pixel in a row of a cached glyph.
+    /// </summary>
+    uint8_t const* GetCoverageRow(GlyphEntry const& entry, uint32_t row) const noexcept
+    {
+        return &m_atlas[((static_cast<size_t>(entry.atlasY) + row) * m_atlasSize + entry.atlasX) * 3];
+    }
+
+private:
+    bool TryAllocate(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) noexcept;
+
+    uint32_t m_atlasSize;
+    std::vector<uint8_t> m_atlas;
+    std::unordered_map<GlyphKey, GlyphEntry, GlyphKeyHash> m_entries;
+
+    // Current shelf: glyphs are placed left to right starting at m_shelfX.
+    uint32_t m_shelfX = 0;
+    uint32_t m_shelfY = 0;
+    uint32_t m_shelfHeight = 0;
+
+    uint32_t m_generation = 0;
+    Statistics m_statistics;
+    Statistics m_frameStartStatistics;
+};
+
+/// <summary>
+/// How glyph coverage is blended, from the IDWriteRenderingParams that DirectWrite would use to draw
+/// the same text.
+/// </summary>
+struct GlyphBlendParameters
+{
+    // Gamma of the blend: colors are blended in a space linearized by this exponent.
+    float gamma = 1.8f;
+
+    // Enhanced contrast for ClearType and for grayscale coverage, which thickens thin strokes.
+    float enhancedContrast = 0.5f;
+    float grayscaleEnhancedContrast = 1.0f;
+
+    // Degree of ClearType color fringing, from 0 (the subpixels are averaged) to 1.
+    float clearTypeLevel = 1.0f;
+
+    // Whether the subpixels are in blue, green, red order (DWRITE_PIXEL_GEOMETRY_BGR). The coverage
+    // in the atlas is always in red, green, blue order.
+    bool isBgr = false;
+};
+
+/// <summary>
+/// Blends cached glyphs into 32-bit BGRA bitmaps the way DirectWrite blends text: the ClearType
+/// level mixes each subpixel's coverage with the average of the three, enhanced contrast thickens
+/// the coverage (less so for light text on a dark background, as DirectWrite does), and each color
+/// channel is blended in a space linearized by the gamma. These depend only on the parameters and
+/// the text color, so they are precomputed into tables.
+/// </summary>
+class GlyphBlender
+{
+public:
+    explicit GlyphBlender(GlyphBlendParameters const& parameters = {});
+
+    GlyphBlendParameters const& GetParameters() const noexcept { return m_parameters; }
+
+    /// <summary>
+    /// Sets the color of the text, which also sets the enhanced contrast used for it.
+    /// </summary>
+    void SetTextColor(uint8_t red, uint8_t green, uint8_t blue) noexcept;
+
+    /// <summary>
+    /// Blends a cached glyph into a 32-bit BGRA bitmap in the text color, clipping to the bitmap.
+    /// </summary>
+    /// <param name="pixels">Pixels of the bitmap, in rows of bitmapWidth pixels.</param>
+    /// <param name="x">Position of the top-left corner of the glyph's coverage bitmap.</param>
+    /// <param name="y">Position of the top-left corner of the glyph's coverage bitmap.</param>
+    void Blend(
+        uint32_t* pixels,
+        uint32_t bitmapWidth,
+        uint32_t bitmapHeight,
+        int32_t x,
+        int32_t y,
+        GlyphCache const& cache,
+        GlyphEntry const& entry
+    ) const noexcept;
+
+    // Size of the table that converts linear values back to color values.
+    static constexpr uint32_t c_linearTableSize = 8192;
+
+private:
+    GlyphBlendParameters m_parameters;
+    std::array<uint8_t, 3> m_textColor = {};
+
+    // Color values in linear space, scaled to c_linearTableSize - 1, and the inverse.
+    std::array<uint16_t, 256> m_toLinear;
+    std::vector<uint8_t> m_fromLinear;
+
+    // Enhanced coverage, as a fraction of 65536, for each ClearType and grayscale coverage value.
+    std::array<uint32_t, 256> m_clearTypeCoverage;
+    std::array<uint32_t, 256> m_grayscaleCoverage;
+};
@@ -50,6 +50,19 @@ std::wstring GetFontFilePath(IDWriteFontFace* fontFace)
     uint32_t fileCount = 1;
     THROW_IF_FAILED(fontFace->GetFiles(&fileCount, &fileReference));
 
+    return GetFontFilePath(fileReference.get());
+}
+
+std::wstring GetFontFilePath(IDWriteFontFaceReference* fontFaceReference)
+{
+    wil::com_ptr<IDWriteFontFile> fileReference;
+    THROW_IF_FAILED(fontFaceReference->GetFontFile(&fileReference));
+
+    return GetFontFilePath(fileReference.get());
+}
+
+std::wstring GetFontFilePath(IDWriteFontFile* fileReference)
+{
     wil::com_ptr<IDWriteFontFileLoader> fileLoader;
     THROW_IF_FAILED(fileReference->GetLoader(&fileLoader));
 
@@ -124,14 +137,14 @@ std::wstring GetInformationalString(IDWriteFontFace6* fontFace, DWRITE_INFORMATI
 std::wstring GetFamilyName(IDWriteFontFace6* fontFace, DWRITE_FONT_FAMILY_MODEL fontFamilyModel)
 {
     wil::com_ptr<IDWriteLocalizedStrings> localizedStrings;
-    THROW_IF_FAILED(fontFace->GetFamilyNames(DWRITE_FONT_FAMILY_MODEL_TYPOGRAPHIC, &localizedStrings));
+    THROW_IF_FAILED(fontFace->GetFamilyNames(fontFamilyModel, &localizedStrings));
     return GetLocalString(localizedStrings.get());
 }
 
 std::wstring GetFaceName(IDWriteFontFace6* fontFace, DWRITE_FONT_FAMILY_MODEL fontFamilyModel)
 {
     wil::com_ptr<IDWriteLocalizedStrings> localizedStrings;
-    THROW_IF_FAILED(fontFace->GetFaceNames(DWRITE_FONT_FAMILY_MODEL_TYPOGRAPHIC, &localizedStrings));
+    THROW_IF_FAILED(fontFace->GetFaceNames(fontFamilyModel, &localizedStrings));
     return GetLocalString(localizedStrings.get());
 }
 
@@ -145,6 +158,16 @@ std::vector<DWRITE_FONT_AXIS_VALUE> GetFontAxisValues(IDWriteFontFace6* fontFace
     return axisValues;
 }
 
+std::vector<DWRITE_FONT_AXIS_VALUE> GetFontAxisValues(IDWriteFontFaceReference1* fontFaceReference)
+{
+    uint32_t axisCount = fontFaceReference->GetFontAxisValueCount();
+
+    std::vector<DWRITE_FONT_AXIS_VALUE> axisValues(axisCount);
+    THROW_IF_FAILED(fontFaceReference->GetFontAxisValues(axisValues.data(), axisCount));
+
+    return axisValues;
+}
+
 std::vector<DWRITE_FONT_AXIS_RANGE> GetFontAxisRanges(IDWriteFontFace6* fontFace)
 {
     wil::com_ptr<IDWriteFontResource> fontResource;
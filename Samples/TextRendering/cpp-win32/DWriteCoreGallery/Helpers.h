@@ -17,6 +17,8 @@ wil::com_ptr<IDWriteTextLayout4> CreateTextLayout(IDWriteTextFormat3* textFormat
 wil::com_ptr<IDWriteTextLayout4> CreateTextLayout(IDWriteTextFormat3* textFormat, _In_z_ wchar_t const* text);
 
 std::wstring GetFontFilePath(IDWriteFontFace* fontFace);
+std::wstring GetFontFilePath(IDWriteFontFaceReference* fontFaceReference);
+std::wstring GetFontFilePath(IDWriteFontFile* fontFile);
 std::wstring GetLocalString(IDWriteLocalizedStrings* localizedStrings);
 std::wstring GetPropertyString(IDWriteFontSet2* fontSet, uint32_t fontIndex, DWRITE_FONT_PROPERTY_ID propertyId);
 std::wstring GetInformationalString(IDWriteFontFace6* fontFace, DWRITE_INFORMATIONAL_STRING_ID stringId);
@@ -34,4 +36,5 @@ inline std::wstring GetTypoFaceName(IDWriteFontFace6* fontFace)
 }
 
 std::vector<DWRITE_FONT_AXIS_VALUE> GetFontAxisValues(IDWriteFontFace6* fontFace);
+std::vector<DWRITE_FONT_AXIS_VALUE> GetFontAxisValues(IDWriteFontFaceReference1* fontFaceReference);
 std::vector<DWRITE_FONT_AXIS_RANGE> GetFontAxisRanges(IDWriteFontFace6* fontFace);
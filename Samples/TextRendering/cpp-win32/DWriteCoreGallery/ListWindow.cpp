@@ -8,19 +8,35 @@ void ListWindow::SetItemCount(int itemCount)
 {
     m_itemCount = itemCount;
 
-    int totalHeight = 0;
-    float dpiScale = GetTextRenderer()->GetDpiScale();
-
-    for (int itemIndex = 0; itemIndex < itemCount; itemIndex++)
-    {
-        totalHeight += GetItemPixelHeight(dpiScale, itemIndex);
-    }
+    // Force the item offsets to be recomputed for the new items.
+    m_itemOffsetsDpiScale = 0;
+    int totalHeight = GetItemOffsets().GetTotal();
 
     SetPixelScrollTop(0);
     SetPixelScrollHeight(totalHeight);
     InvalidateRect(GetHandle(), nullptr, true);
 }
 
+PrefixSums const& ListWindow::GetItemOffsets()
+{
+    // Item heights only change with the DPI scale or the items themselves, so they are computed
+    // once and then looked up rather than summed on every call.
+    float dpiScale = GetTextRenderer()->GetDpiScale();
+    if (dpiScale != m_itemOffsetsDpiScale)
+    {
+        std::vector<int> itemHeights(m_itemCount);
+        for (int itemIndex = 0; itemIndex < m_itemCount; itemIndex++)
+        {
+            itemHeights[itemIndex] = GetItemPixelHeight(dpiScale, itemIndex);
+        }
+
+        m_itemOffsets.Assign(itemHeights);
+        m_itemOffsetsDpiScale = dpiScale;
+    }
+
+    return m_itemOffsets;
+}
+
 void ListWindow::SetSelectedIndex(int itemIndex)
 {
     SetSelectedIndex(itemIndex, nullptr, false);
@@ -70,15 +86,9 @@ void ListWindow::SetSelectedIndex(int itemIndex, _In_opt_ RECT const* itemRect,
 
 RECT ListWindow::GetItemRect(int itemIndex)
 {
-    int top = -GetPixelScrollTop();
-    float dpiScale = GetTextRenderer()->GetDpiScale();
-
-    for (int i = 0; i < itemIndex; i++)
-    {
-        top += GetItemPixelHeight(dpiScale, i);
-    }
-
-    int bottom = top + GetItemPixelHeight(dpiScale, itemIndex);
+    auto& itemOffsets = GetItemOffsets();
+    int top = itemOffsets.GetPrefixSum(itemIndex) - GetPixelScrollTop();
+    int bottom = top + itemOffsets.GetValue(itemIndex);
 
     return RECT{ 0, top, GetPixelWidth(), bottom };
 }
@@ -87,20 +97,14 @@ int ListWindow::ItemIndexFromY(int y, _Out_ RECT* itemRect)
 {
     if (y >= 0 && y < GetPixelHeight())
     {
-        int top = -GetPixelScrollTop();
-        float dpiScale = GetTextRenderer()->GetDpiScale();
+        auto& itemOffsets = GetItemOffsets();
+        int i = itemOffsets.FindIndex(y + GetPixelScrollTop());
 
-        for (int i = 0; i < m_itemCount; i++)
+        if (i < m_itemCount)
         {
-            int bottom = top + GetItemPixelHeight(dpiScale, i);
-
-            if (bottom > y)
-            {
-                *itemRect = { 0, top, GetPixelWidth(), bottom };
-                return i;
-            }
-
-            top = bottom;
+            int top = itemOffsets.GetPrefixSum(i) - GetPixelScrollTop();
+            *itemRect = { 0, top, GetPixelWidth(), top + itemOffsets.GetValue(i) };
+            return i;
         }
     }
 
@@ -125,20 +129,23 @@ void ListWindow::InvalidateSelectedItem()
 
 void ListWindow::OnPaint(HDC hdc, RECT invalidRect)
 {
-    // Resize the text renderer to the size of one item.
     auto textRenderer = GetTextRenderer();
-    float dpiScale = textRenderer->GetDpiScale();
-    int itemTop = -GetPixelScrollTop();
+    auto& itemOffsets = GetItemOffsets();
 
-    for (int itemIndex = 0; itemIndex < m_itemCount; itemIndex++)
-    {
-        int itemPixelHeight = GetItemPixelHeight(dpiScale, itemIndex);
-        textRenderer->Resize(SIZE{ GetPixelWidth(), itemPixelHeight });
+    // Only visit the items that intersect the invalid rect, starting with the one at its top.
+    int firstIndex = itemOffsets.FindIndex(invalidRect.top + GetPixelScrollTop());
+    int itemTop = itemOffsets.GetPrefixSum(firstIndex) - GetPixelScrollTop();
 
+    for (int itemIndex = firstIndex; itemIndex < m_itemCount && itemTop < invalidRect.bottom; itemIndex++)
+    {
+        int itemPixelHeight = itemOffsets.GetValue(itemIndex);
         int itemBottom = itemTop + itemPixelHeight;
 
-        if (itemTop < invalidRect.bottom && itemBottom > invalidRect.top)
+        if (itemBottom > invalidRect.top)
         {
+            // Resize the text renderer to the size of one item.
+            textRenderer->Resize(SIZE{ GetPixelWidth(), itemPixelHeight });
+
             bool isSelected = (itemIndex == m_selectedIndex);
             textRenderer->Clear(isSelected ? COLOR_HIGHLIGHT : COLOR_WINDOW);
             textRenderer->SetTextColor(isSelected ? COLOR_HIGHLIGHTTEXT : COLOR_WINDOWTEXT);
@@ -223,7 +230,7 @@ bool ListWindow::OnKeyDown(uint32_t keyCode)
 
 int ListWindow::ItemCountPerPage(int startIndex, int endIndex, int increment)
 {
-    float dpiScale = GetTextRenderer()->GetDpiScale();
+    auto& itemOffsets = GetItemOffsets();
 
     int const pageHeight = GetPixelHeight();
 
@@ -232,7 +239,7 @@ int ListWindow::ItemCountPerPage(int startIndex, int endIndex, int increment)
 
     for (int i = startIndex; i != endIndex; i += increment)
     {
-        totalItemHeight += GetItemPixelHeight(dpiScale, i);
+        totalItemHeight += itemOffsets.GetValue(i);
         if (totalItemHeight >= pageHeight)
         {
             break;
@@ -3,6 +3,7 @@
 
 #pragma once
 #include "ChildWindow.h"
+#include "PrefixSums.h"
 
 class ListWindow : public ScrollableChildWindow
 {
@@ -33,8 +34,13 @@ private:
     int ItemIndexFromY(int y, _Out_ RECT* itemRect);
     void SetSelectedIndex(int itemIndex, _In_opt_ RECT const* itemRect, bool ensureVisible);
     int ItemCountPerPage(int startIndex, int endIndex, int increment);
+    PrefixSums const& GetItemOffsets();
 
     int m_itemCount = 0;
     int m_selectedIndex = -1;
     bool m_haveFocus = false;
+
+    // Pixel heights of the items, and the DPI scale they were computed for.
+    PrefixSums m_itemOffsets;
+    float m_itemOffsetsDpiScale = 0;
 };
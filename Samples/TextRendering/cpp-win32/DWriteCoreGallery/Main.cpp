@@ -3,6 +3,7 @@
 
 #include "Main.h"
 #include "MainWindow.h"
+#include "FontMetadataCache.h"
 #include "Resource.h"
 
 //#define USE_INBOX_DWRITE
@@ -49,6 +50,9 @@ int APIENTRY wWinMain(
         DispatchMessage(&msg);
     }
 
+    // Save the metadata of any fonts read during this run, so the next run doesn't read them again.
+    FontMetadataCache::SaveInstance();
+
     return (int)msg.wParam;
 }
 
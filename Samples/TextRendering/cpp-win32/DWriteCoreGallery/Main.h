@@ -23,6 +23,9 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <string_view>
 #include <memory>
 #include <algorithm>
 #include <span>
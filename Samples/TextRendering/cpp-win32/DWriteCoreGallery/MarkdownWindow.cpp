@@ -30,224 +30,86 @@ std::span<char const> LoadMarkdownResource(uint32_t resourceId)
 
 namespace
 {
-    _Ret_range_(begin, end) char const* SkipSpaces(_In_reads_(end - begin) char const* begin, char const* end) noexcept
+    /// <summary>
+    /// Receives tokenizer events for one block and builds the output of ParsePseudoMarkdownBlock.
+    /// </summary>
+    struct MarkdownBlockBuilder
     {
-        return std::find_if(begin, end, [](char ch) { return ch != ' '; });
-    }
-
-    _Ret_range_(begin, end) char const* FindNewLine(_In_reads_(end - begin) char const* begin, char const* end) noexcept
-    {
-        return std::find_if(begin, end, [](char ch) { return ch == '\n' || ch == '\r'; });
-    }
-
-    _Ret_range_(begin, end) char const* SkipNewLine(_In_reads_(end - begin) char const* begin, char const* end) noexcept
-    {
-        auto p = begin;
-        if (p != end && *p == '\r') { ++p; }
-        if (p != end && *p == '\n') { ++p; }
-        return p;
-    }
-}
-
-MarkdownBlockType ParsePseudoMarkdownBlock(
-    _In_reads_(inputEnd - inputPos) char const*& inputPos,
-    char const* inputEnd,
-    _Out_ std::wstring& text,
-    _Out_ std::vector<DWRITE_TEXT_RANGE>& boldRanges,
-    _Out_ std::vector<DWRITE_TEXT_RANGE>& italicRanges,
-    _Out_ std::vector<DWRITE_TEXT_RANGE>& codeRanges
-)
-{
-    // Clear all the outputs.
-    text.clear();
-    boldRanges.clear();
-    italicRanges.clear();
-    codeRanges.clear();
-
-    if (inputPos == inputEnd)
-    {
-        return MarkdownBlockType::Body;
-    }
-
-    // Let pos be the current character position in the input.
-    char const* pos = inputPos;
-
-    // Determine the block type based on the first character.
-    auto blockType = MarkdownBlockType::Body;
-    if (*pos == '#')
-    {
-        blockType = MarkdownBlockType::Heading;
-        pos = SkipSpaces(pos + 1, inputEnd);
-    }
-    else if (*pos == '`')
-    {
-        blockType = MarkdownBlockType::Code;
-        pos = SkipNewLine(FindNewLine(pos, inputEnd), inputEnd);
-    }
-    else
-    {
-        pos = SkipSpaces(pos, inputEnd);
-    }
+        std::wstring& text;
+        std::vector<DWRITE_TEXT_RANGE>& boldRanges;
+        std::vector<DWRITE_TEXT_RANGE>& italicRanges;
+        std::vector<DWRITE_TEXT_RANGE>& codeRanges;
 
-    // Pointer to the first character that has not yet been added to the output text.
-    char const* outputTextPos = pos;
+        // Start position and state of each inline span, indexed by MarkdownSpanType.
+        uint32_t spanStarts[3] = {};
+        bool isInSpan[3] = {};
 
-    // Helper to add output characters between addTextPos and the current position.
-    auto AddText = [&]()
-    {
-        int length = static_cast<int>(pos - outputTextPos);
-        if (length > 0)
+        void Text(char const* begin, char const* end)
         {
-            uint32_t wideLength = MultiByteToWideChar(CP_UTF8, 0, outputTextPos, length, nullptr, 0);
-            if (wideLength != 0)
+            static_assert(sizeof(wchar_t) == sizeof(char16_t));
+
+            // Convert directly into the string's buffer. UTF-16 never needs more code units than
+            // UTF-8 has bytes, so the input length is an upper bound on the output length.
+            size_t destIndex = text.size();
+            size_t maxLength = static_cast<size_t>(end - begin);
+            text.resize_and_overwrite(destIndex + maxLength, [&](wchar_t* buffer, size_t)
             {
-                size_t destIndex = text.size();
-                text.resize(destIndex + wideLength);
-                MultiByteToWideChar(CP_UTF8, 0, outputTextPos, length, &text[destIndex], wideLength);
-            }
+                return destIndex + ConvertUtf8ToUtf16(begin, maxLength, reinterpret_cast<char16_t*>(buffer + destIndex));
+            });
         }
-        outputTextPos = pos;
-    };
-
-    // Current character properties.
-    struct InlineSpan
-    {
-        std::vector<DWRITE_TEXT_RANGE>& textRanges;
-        uint32_t startPos;
-        bool isInSpan;
 
-        void ProcessMarkup(std::wstring const& text)
+        void SoftBreak()
         {
-            if (!isInSpan)
+            if (!text.empty() && text.back() != L' ')
             {
-                startPos = static_cast<uint32_t>(text.size());
+                text += L' ';
             }
-            else
-            {
-                uint32_t length = static_cast<uint32_t>(text.size() - startPos);
-                textRanges.push_back(DWRITE_TEXT_RANGE{ startPos, length });
-            }
-            isInSpan = !isInSpan;
         }
-    };
-    InlineSpan boldSpan = { boldRanges };
-    InlineSpan italicSpan = { italicRanges };
-    InlineSpan codeSpan = { codeRanges };
-
-    // Assume initially that the end of the block is the end of the input.
-    auto blockEnd = inputEnd;
 
-    // Iterate until we reach the end of the block.
-    while (pos != blockEnd)
-    {
-        switch (*pos)
+        void ToggleSpan(MarkdownSpanType spanType)
         {
-        case '\r':
-        case '\n':
-            // Add any pending text up to the newline.
-            AddText();
-
-            // Advance past the newline.
-            pos = SkipNewLine(pos + 1, blockEnd);
-
-            if (blockType == MarkdownBlockType::Code)
-            {
-                // Check for end of code block.
-                if (pos < blockEnd && *pos == '`')
-                {
-                    pos = SkipNewLine(FindNewLine(pos, blockEnd), blockEnd);
-                    outputTextPos = pos;
-                    blockEnd = pos;
-                }
-            }
-            else
+            auto index = static_cast<size_t>(spanType);
+            if (!isInSpan[index])
             {
-                outputTextPos = pos;
-
-                // Skip blank lines.
-                while (pos < blockEnd && (*pos == '\r' || *pos == '\n'))
-                {
-                    ++pos;
-                }
-
-                // Determine whether to end the block.
-                if (blockType == MarkdownBlockType::Heading || pos > outputTextPos)
-                {
-                    // End the current block, either because it's a heading or because there
-                    // were multiple newlines.
-                    outputTextPos = pos;
-                    blockEnd = pos;
-                }
-                else
-                {
-                    // Add a single space in place of the newline, and continue the current block.
-                    if (!text.empty() && text.back() != ' ')
-                    {
-                        text += L' ';
-                    }
-                }
-            }
-            break;
-
-        case '*':
-            if (blockType == MarkdownBlockType::Body)
-            {
-                // Add any pending text up to the inline markup.
-                AddText();
-
-                // Check whether it's **bold** or *italic*.
-                if (pos + 1 < blockEnd && pos[1] == '*')
-                {
-                    pos += 2;
-                    boldSpan.ProcessMarkup(text);
-                }
-                else
-                {
-                    pos++;
-                    italicSpan.ProcessMarkup(text);
-                }
-
-                // Do not include the markup in the output text.
-                outputTextPos = pos;
+                spanStarts[index] = static_cast<uint32_t>(text.size());
             }
             else
             {
-                // Treat '*' in non-body text as plain text.
-                ++pos;
+                uint32_t length = static_cast<uint32_t>(text.size() - spanStarts[index]);
+                GetRanges(spanType).push_back(DWRITE_TEXT_RANGE{ spanStarts[index], length });
             }
-            break;
-
-        case '`':
-            if (blockType == MarkdownBlockType::Body)
-            {
-                // Add any pending text up to the inline markup.
-                AddText();
-
-                // Begin or end the inline code range.
-                pos++;
-                codeSpan.ProcessMarkup(text);
+            isInSpan[index] = !isInSpan[index];
+        }
 
-                // Do not include the markup in the output text.
-                outputTextPos = pos;
-            }
-            else
+        std::vector<DWRITE_TEXT_RANGE>& GetRanges(MarkdownSpanType spanType)
+        {
+            switch (spanType)
             {
-                // Treat '`' in non-body text as plain text.
-                ++pos;
+            case MarkdownSpanType::Bold:    return boldRanges;
+            case MarkdownSpanType::Italic:  return italicRanges;
+            default:                        return codeRanges;
             }
-            break;
-
-        default:
-            // Advance past plain text character.
-            ++pos;
-            break;
         }
-    }
+    };
+}
 
-    AddText();
-    inputPos = pos;
+MarkdownBlockType ParsePseudoMarkdownBlock(
+    _In_reads_(inputEnd - inputPos) char const*& inputPos,
+    char const* inputEnd,
+    _Out_ std::wstring& text,
+    _Out_ std::vector<DWRITE_TEXT_RANGE>& boldRanges,
+    _Out_ std::vector<DWRITE_TEXT_RANGE>& italicRanges,
+    _Out_ std::vector<DWRITE_TEXT_RANGE>& codeRanges
+)
+{
+    // Clear all the outputs.
+    text.clear();
+    boldRanges.clear();
+    italicRanges.clear();
+    codeRanges.clear();
 
-    return blockType;
+    MarkdownBlockBuilder builder{ text, boldRanges, italicRanges, codeRanges };
+    return TokenizePseudoMarkdownBlock(inputPos, inputEnd, builder);
 }
 
 namespace
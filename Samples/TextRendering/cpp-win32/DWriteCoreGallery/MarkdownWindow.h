@@ -3,6 +3,7 @@
 
 #pragma once
 #include "StaticTextWindow.h"
+#include "PseudoMarkdown.h"
 
 class MarkdownWindow : public StaticTextWindow
 {
@@ -10,16 +11,6 @@ public:
     MarkdownWindow(HWND parentWindow, TextRenderer* textRenderer, uint32_t resourceId);
 };
 
-/// <summary>
-/// Block type returned by pseudo-markdown parser.
-/// </summary>
-enum class MarkdownBlockType
-{
-    Body,
-    Heading,
-    Code
-};
-
 /// <summary>
 /// Styling properties for creating text layouts from pseudo-Markdown.
 /// </summary>
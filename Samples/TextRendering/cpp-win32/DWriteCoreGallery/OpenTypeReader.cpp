@@ -0,0 +1,625 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "OpenTypeReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t g_ttcfTag = MakeOpenTypeTag('t', 't', 'c', 'f');
+    constexpr uint32_t g_nameTag = MakeOpenTypeTag('n', 'a', 'm', 'e');
+    constexpr uint32_t g_fvarTag = MakeOpenTypeTag('f', 'v', 'a', 'r');
+    constexpr uint32_t g_statTag = MakeOpenTypeTag('S', 'T', 'A', 'T');
+    constexpr uint32_t g_os2Tag = MakeOpenTypeTag('O', 'S', '/', '2');
+
+    constexpr uint32_t g_weightAxisTag = MakeOpenTypeTag('w', 'g', 'h', 't');
+    constexpr uint32_t g_widthAxisTag = MakeOpenTypeTag('w', 'd', 't', 'h');
+    constexpr uint32_t g_italicAxisTag = MakeOpenTypeTag('i', 't', 'a', 'l');
+    constexpr uint32_t g_slantAxisTag = MakeOpenTypeTag('s', 'l', 'n', 't');
+
+    // Version of the serialized form written by WriteFontFaceMetadata. Bump this if it changes.
+    constexpr uint16_t g_metadataFormatVersion = 1;
+
+    /// <summary>
+    /// Bounds-checked view of big-endian font data. Reads outside the view return zero.
+    /// </summary>
+    class FontDataView
+    {
+    public:
+        FontDataView() noexcept = default;
+
+        explicit FontDataView(std::span<uint8_t const> data) noexcept : m_data{ data }
+        {
+        }
+
+        size_t size() const noexcept { return m_data.size(); }
+
+        bool Contains(size_t offset, size_t length) const noexcept
+        {
+            return offset <= m_data.size() && length <= m_data.size() - offset;
+        }
+
+        uint8_t UInt8(size_t offset) const noexcept
+        {
+            return Contains(offset, 1) ? m_data[offset] : 0;
+        }
+
+        uint16_t UInt16(size_t offset) const noexcept
+        {
+            if (!Contains(offset, 2))
+            {
+                return 0;
+            }
+            return static_cast<uint16_t>((m_data[offset] << 8) | m_data[offset + 1]);
+        }
+
+        uint32_t UInt32(size_t offset) const noexcept
+        {
+            return (static_cast<uint32_t>(UInt16(offset)) << 16) | UInt16(offset + 2);
+        }
+
+        // Reads a tag, with the first character in the low byte to match MakeOpenTypeTag.
+        uint32_t Tag(size_t offset) const noexcept
+        {
+            if (!Contains(offset, 4))
+            {
+                return 0;
+            }
+            return MakeOpenTypeTag(
+                static_cast<char>(m_data[offset]),
+                static_cast<char>(m_data[offset + 1]),
+                static_cast<char>(m_data[offset + 2]),
+                static_cast<char>(m_data[offset + 3]));
+        }
+
+        // Reads a 16.16 fixed-point value.
+        float Fixed(size_t offset) const noexcept
+        {
+            return static_cast<float>(static_cast<int32_t>(UInt32(offset))) / 65536.0f;
+        }
+
+        FontDataView Subview(size_t offset, size_t length) const noexcept
+        {
+            return Contains(offset, length) ? FontDataView{ m_data.subspan(offset, length) } : FontDataView{};
+        }
+
+    private:
+        std::span<uint8_t const> m_data;
+    };
+
+    /// <summary>
+    /// Returns the offset of the table directory for a face, or SIZE_MAX if the face does not exist.
+    /// </summary>
+    size_t GetTableDirectoryOffset(FontDataView file, uint32_t faceIndex, bool& isCollection) noexcept
+    {
+        isCollection = (file.Tag(0) == g_ttcfTag);
+        if (!isCollection)
+        {
+            return (faceIndex == 0 && file.Contains(0, 12)) ? 0 : SIZE_MAX;
+        }
+
+        uint32_t faceCount = file.UInt32(8);
+        if (faceIndex >= faceCount || !file.Contains(12, (faceIndex + 1) * size_t{ 4 }))
+        {
+            return SIZE_MAX;
+        }
+
+        size_t offset = file.UInt32(12 + faceIndex * size_t{ 4 });
+        return file.Contains(offset, 12) ? offset : SIZE_MAX;
+    }
+
+    /// <summary>
+    /// Returns the table with the specified tag, or an empty view if there is none.
+    /// </summary>
+    FontDataView FindTable(FontDataView file, size_t directoryOffset, uint32_t tag) noexcept
+    {
+        uint16_t tableCount = file.UInt16(directoryOffset + 4);
+        for (size_t i = 0; i < tableCount; i++)
+        {
+            size_t recordOffset = directoryOffset + 12 + (i * 16);
+            if (file.Tag(recordOffset) == tag)
+            {
+                return file.Subview(file.UInt32(recordOffset + 8), file.UInt32(recordOffset + 12));
+            }
+        }
+        return {};
+    }
+
+    /// <summary>
+    /// Returns how strongly a name record is preferred, or -1 if it can't be decoded.
+    /// </summary>
+    int GetNameRecordRank(uint16_t platformId, uint16_t encodingId, uint16_t languageId) noexcept
+    {
+        switch (platformId)
+        {
+        case 3: // Windows
+            if (encodingId != 1 && encodingId != 10)
+            {
+                return -1;
+            }
+            return (languageId == 0x0409) ? 3 : 2;
+
+        case 0: // Unicode
+            return 1;
+
+        case 1: // Macintosh, Roman encoding
+            return (encodingId == 0 && languageId == 0) ? 0 : -1;
+
+        default:
+            return -1;
+        }
+    }
+
+    /// <summary>
+    /// Long descriptive strings that the font lists never display, and which would bloat the cache.
+    /// </summary>
+    bool IsIgnoredNameId(uint16_t nameId) noexcept
+    {
+        switch (nameId)
+        {
+        case 0:     // copyright
+        case 7:     // trademark
+        case 10:    // description
+        case 11:    // vendor URL
+        case 12:    // designer URL
+        case 13:    // license
+        case 14:    // license URL
+        case 19:    // sample text
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    void ReadNameTable(FontDataView table, FontFaceMetadata& metadata)
+    {
+        uint16_t recordCount = table.UInt16(2);
+        size_t storageOffset = table.UInt16(4);
+
+        struct Candidate
+        {
+            uint16_t nameId;
+            int rank;
+            uint16_t platformId;
+            size_t offset;
+            size_t length;
+        };
+        std::vector<Candidate> candidates;
+
+        for (size_t i = 0; i < recordCount; i++)
+        {
+            size_t recordOffset = 6 + (i * 12);
+            if (!table.Contains(recordOffset, 12))
+            {
+                break;
+            }
+
+            uint16_t platformId = table.UInt16(recordOffset);
+            uint16_t nameId = table.UInt16(recordOffset + 6);
+            int rank = GetNameRecordRank(platformId, table.UInt16(recordOffset + 2), table.UInt16(recordOffset + 4));
+            size_t offset = storageOffset + table.UInt16(recordOffset + 10);
+            size_t length = table.UInt16(recordOffset + 8);
+
+            if (rank < 0 || IsIgnoredNameId(nameId) || !table.Contains(offset, length))
+            {
+                continue;
+            }
+
+            auto existing = std::find_if(candidates.begin(), candidates.end(), [&](Candidate const& c) { return c.nameId == nameId; });
+            if (existing == candidates.end())
+            {
+                candidates.push_back({ nameId, rank, platformId, offset, length });
+            }
+            else if (rank > existing->rank)
+            {
+                *existing = { nameId, rank, platformId, offset, length };
+            }
+        }
+
+        metadata.names.clear();
+        metadata.names.reserve(candidates.size());
+
+        for (auto const& candidate : candidates)
+        {
+            std::u16string value;
+            if (candidate.platformId == 1)
+            {
+                // Mac Roman. Only the ASCII range is decoded exactly; other bytes are rare in names.
+                value.resize(candidate.length);
+                for (size_t i = 0; i < candidate.length; i++)
+                {
+                    uint8_t ch = table.UInt8(candidate.offset + i);
+                    value[i] = static_cast<char16_t>(ch < 0x80 ? ch : 0xFFFD);
+                }
+            }
+            else
+            {
+                // UTF-16 big-endian.
+                value.resize(candidate.length / 2);
+                for (size_t i = 0; i < value.size(); i++)
+                {
+                    value[i] = static_cast<char16_t>(table.UInt16(candidate.offset + (i * 2)));
+                }
+            }
+
+            metadata.names.push_back({ candidate.nameId, std::move(value) });
+        }
+
+        std::sort(metadata.names.begin(), metadata.names.end(), [](OpenTypeName const& a, OpenTypeName const& b) { return a.nameId < b.nameId; });
+    }
+
+    bool ReadFvarTable(FontDataView table, FontFaceMetadata& metadata)
+    {
+        if (table.size() == 0)
+        {
+            return true;
+        }
+
+        size_t axesOffset = table.UInt16(4);
+        size_t axisCount = table.UInt16(8);
+        size_t axisSize = table.UInt16(10);
+        size_t instanceCount = table.UInt16(12);
+        size_t instanceSize = table.UInt16(14);
+
+        if (axisSize < 20 || instanceSize < 4 + (axisCount * 4) ||
+            !table.Contains(axesOffset, (axisCount * axisSize) + (instanceCount * instanceSize)))
+        {
+            return false;
+        }
+
+        metadata.axes.resize(axisCount);
+        for (size_t i = 0; i < axisCount; i++)
+        {
+            size_t offset = axesOffset + (i * axisSize);
+            auto& axis = metadata.axes[i];
+            axis.tag = table.Tag(offset);
+            axis.minValue = table.Fixed(offset + 4);
+            axis.defaultValue = table.Fixed(offset + 8);
+            axis.maxValue = table.Fixed(offset + 12);
+        }
+
+        // The postScriptNameID field is only present if the instance record has room for it.
+        bool hasPostScriptNameIds = instanceSize >= 6 + (axisCount * 4);
+
+        size_t instancesOffset = axesOffset + (axisCount * axisSize);
+        metadata.namedInstances.resize(instanceCount);
+        for (size_t i = 0; i < instanceCount; i++)
+        {
+            size_t offset = instancesOffset + (i * instanceSize);
+            auto& instance = metadata.namedInstances[i];
+            instance.subfamilyNameId = table.UInt16(offset);
+            instance.postScriptNameId = hasPostScriptNameIds ? table.UInt16(offset + 4 + (axisCount * 4)) : static_cast<uint16_t>(OpenTypeNameId_None);
+
+            instance.coordinates.resize(axisCount);
+            for (size_t j = 0; j < axisCount; j++)
+            {
+                instance.coordinates[j] = table.Fixed(offset + 4 + (j * 4));
+            }
+        }
+
+        return true;
+    }
+
+    void ReadStatTable(FontDataView table, FontFaceMetadata& metadata) noexcept
+    {
+        // The elided fallback name was added in version 1.1.
+        if (table.UInt16(0) == 1 && table.UInt16(2) >= 1 && table.Contains(18, 2))
+        {
+            metadata.elidedFallbackNameId = table.UInt16(18);
+        }
+    }
+
+    void ReadOs2Table(FontDataView table, FontFaceMetadata& metadata) noexcept
+    {
+        if (table.Contains(0, 64))
+        {
+            metadata.weightClass = table.UInt16(4);
+            metadata.widthClass = table.UInt16(6);
+            metadata.fsSelection = table.UInt16(62);
+        }
+    }
+
+    float WidthClassToPercent(uint16_t widthClass) noexcept
+    {
+        constexpr float widths[] = { 50.0f, 62.5f, 75.0f, 87.5f, 100.0f, 112.5f, 125.0f, 150.0f, 200.0f };
+        return (widthClass >= 1 && widthClass <= 9) ? widths[widthClass - 1] : 100.0f;
+    }
+}
+
+std::u16string const* FontFaceMetadata::FindName(uint16_t nameId) const noexcept
+{
+    auto it = std::lower_bound(names.begin(), names.end(), nameId, [](OpenTypeName const& name, uint16_t id) { return name.nameId < id; });
+    return (it != names.end() && it->nameId == nameId && !it->value.empty()) ? &it->value : nullptr;
+}
+
+std::u16string FontFaceMetadata::GetName(std::initializer_list<uint16_t> nameIds) const
+{
+    for (uint16_t nameId : nameIds)
+    {
+        if (auto name = FindName(nameId))
+        {
+            return *name;
+        }
+    }
+    return {};
+}
+
+std::u16string FontFaceMetadata::GetFamilyName(FontFamilyModel familyModel) const
+{
+    if (familyModel == FontFamilyModel::Typographic)
+    {
+        return GetName({ OpenTypeNameId_TypographicFamilyName, OpenTypeNameId_FamilyName });
+    }
+    return GetName({ OpenTypeNameId_WwsFamilyName, OpenTypeNameId_TypographicFamilyName, OpenTypeNameId_FamilyName });
+}
+
+std::u16string FontFaceMetadata::GetFaceName(FontFamilyModel familyModel) const
+{
+    if (familyModel == FontFamilyModel::Typographic)
+    {
+        return GetName({ OpenTypeNameId_TypographicSubfamilyName, OpenTypeNameId_SubfamilyName, elidedFallbackNameId });
+    }
+    return GetName({ OpenTypeNameId_WwsSubfamilyName, OpenTypeNameId_TypographicSubfamilyName, OpenTypeNameId_SubfamilyName });
+}
+
+OpenTypeAxis const* FontFaceMetadata::FindAxis(uint32_t tag) const noexcept
+{
+    auto it = std::find_if(axes.begin(), axes.end(), [tag](OpenTypeAxis const& axis) { return axis.tag == tag; });
+    return (it != axes.end()) ? &*it : nullptr;
+}
+
+OpenTypeNamedInstance const* FontFaceMetadata::FindNamedInstance(std::span<OpenTypeAxisValue const> axisValues) const noexcept
+{
+    for (auto const& instance : namedInstances)
+    {
+        bool isMatch = true;
+        for (size_t i = 0; i < axes.size() && isMatch; i++)
+        {
+            float value = axes[i].defaultValue;
+            for (auto const& axisValue : axisValues)
+            {
+                if (axisValue.tag == axes[i].tag)
+                {
+                    value = axisValue.value;
+                }
+            }
+
+            isMatch = std::fabs(instance.coordinates[i] - value) < 0.001f;
+        }
+
+        if (isMatch)
+        {
+            return &instance;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<OpenTypeAxisValue> FontFaceMetadata::GetDefaultAxisValues() const
+{
+    std::vector<OpenTypeAxisValue> axisValues;
+
+    if (!axes.empty())
+    {
+        for (auto const& axis : axes)
+        {
+            axisValues.push_back({ axis.tag, axis.defaultValue });
+        }
+    }
+    else
+    {
+        // fsSelection bit 0 is ITALIC.
+        axisValues.push_back({ g_weightAxisTag, static_cast<float>(weightClass) });
+        axisValues.push_back({ g_widthAxisTag, WidthClassToPercent(widthClass) });
+        axisValues.push_back({ g_italicAxisTag, (fsSelection & 1) ? 1.0f : 0.0f });
+        axisValues.push_back({ g_slantAxisTag, 0.0f });
+    }
+
+    return axisValues;
+}
+
+void BinaryWriter::WriteFloat(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteUInt32(bits);
+}
+
+void BinaryWriter::WriteString(std::u16string_view value)
+{
+    WriteUInt32(static_cast<uint32_t>(value.size()));
+    for (char16_t ch : value)
+    {
+        WriteUInt16(static_cast<uint16_t>(ch));
+    }
+}
+
+void BinaryWriter::WriteBytes(uint64_t value, size_t byteCount)
+{
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+float BinaryReader::ReadFloat() noexcept
+{
+    uint32_t bits = ReadUInt32();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::u16string BinaryReader::ReadString()
+{
+    size_t length = ReadUInt32();
+    if (length > m_input.size() / 2)
+    {
+        m_isValid = false;
+        return {};
+    }
+
+    std::u16string value(length, u'\0');
+    for (auto& ch : value)
+    {
+        ch = static_cast<char16_t>(ReadUInt16());
+    }
+    return value;
+}
+
+uint64_t BinaryReader::ReadBytes(size_t byteCount) noexcept
+{
+    if (!m_isValid || m_input.size() < byteCount)
+    {
+        m_isValid = false;
+        return 0;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        value |= static_cast<uint64_t>(m_input[i]) << (i * 8);
+    }
+
+    m_input = m_input.subspan(byteCount);
+    return value;
+}
+
+uint32_t GetOpenTypeFaceCount(std::span<uint8_t const> fileData) noexcept
+{
+    FontDataView file{ fileData };
+    if (file.Tag(0) == g_ttcfTag)
+    {
+        return file.UInt32(8);
+    }
+
+    // TrueType outlines use version 0x00010000 or 'true', and CFF outlines use 'OTTO'.
+    uint32_t version = file.UInt32(0);
+    return (version == 0x00010000 || version == 0x74727565 || version == 0x4F54544F) ? 1 : 0;
+}
+
+bool ParseFontFaceMetadata(std::span<uint8_t const> fileData, uint32_t faceIndex, FontFaceMetadata& metadata)
+{
+    metadata = {};
+
+    FontDataView file{ fileData };
+    size_t directoryOffset = GetTableDirectoryOffset(file, faceIndex, metadata.isCollection);
+    if (directoryOffset == SIZE_MAX || !file.Contains(directoryOffset + 12, file.UInt16(directoryOffset + 4) * size_t{ 16 }))
+    {
+        return false;
+    }
+
+    auto nameTable = FindTable(file, directoryOffset, g_nameTag);
+    if (nameTable.size() == 0)
+    {
+        return false;
+    }
+
+    ReadNameTable(nameTable, metadata);
+    ReadOs2Table(FindTable(file, directoryOffset, g_os2Tag), metadata);
+    ReadStatTable(FindTable(file, directoryOffset, g_statTag), metadata);
+    return ReadFvarTable(FindTable(file, directoryOffset, g_fvarTag), metadata);
+}
+
+void WriteFontFaceMetadata(BinaryWriter& writer, FontFaceMetadata const& metadata)
+{
+    writer.WriteUInt16(g_metadataFormatVersion);
+    writer.WriteUInt8(metadata.isCollection ? 1 : 0);
+    writer.WriteUInt16(metadata.weightClass);
+    writer.WriteUInt16(metadata.widthClass);
+    writer.WriteUInt16(metadata.fsSelection);
+    writer.WriteUInt16(metadata.elidedFallbackNameId);
+
+    writer.WriteUInt32(static_cast<uint32_t>(metadata.names.size()));
+    for (auto const& name : metadata.names)
+    {
+        writer.WriteUInt16(name.nameId);
+        writer.WriteString(name.value);
+    }
+
+    writer.WriteUInt32(static_cast<uint32_t>(metadata.axes.size()));
+    for (auto const& axis : metadata.axes)
+    {
+        writer.WriteUInt32(axis.tag);
+        writer.WriteFloat(axis.minValue);
+        writer.WriteFloat(axis.defaultValue);
+        writer.WriteFloat(axis.maxValue);
+    }
+
+    writer.WriteUInt32(static_cast<uint32_t>(metadata.namedInstances.size()));
+    for (auto const& instance : metadata.namedInstances)
+    {
+        writer.WriteUInt16(instance.subfamilyNameId);
+        writer.WriteUInt16(instance.postScriptNameId);
+        for (float coordinate : instance.coordinates)
+        {
+            writer.WriteFloat(coordinate);
+        }
+    }
+}
+
+bool ReadFontFaceMetadata(BinaryReader& reader, FontFaceMetadata& metadata)
+{
+    metadata = {};
+
+    if (reader.ReadUInt16() != g_metadataFormatVersion)
+    {
+        return false;
+    }
+
+    metadata.isCollection = reader.ReadUInt8() != 0;
+    metadata.weightClass = reader.ReadUInt16();
+    metadata.widthClass = reader.ReadUInt16();
+    metadata.fsSelection = reader.ReadUInt16();
+    metadata.elidedFallbackNameId = reader.ReadUInt16();
+
+    // Each count is checked against the remaining input so corrupt data can't cause huge allocations.
+    size_t nameCount = reader.ReadUInt32();
+    if (nameCount > reader.GetRemaining().size() / 6)
+    {
+        return false;
+    }
+    metadata.names.resize(nameCount);
+    for (auto& name : metadata.names)
+    {
+        name.nameId = reader.ReadUInt16();
+        name.value = reader.ReadString();
+    }
+
+    size_t axisCount = reader.ReadUInt32();
+    if (axisCount > reader.GetRemaining().size() / 16)
+    {
+        return false;
+    }
+    metadata.axes.resize(axisCount);
+    for (auto& axis : metadata.axes)
+    {
+        axis.tag = reader.ReadUInt32();
+        axis.minValue = reader.ReadFloat();
+        axis.defaultValue = reader.ReadFloat();
+        axis.maxValue = reader.ReadFloat();
+    }
+
+    size_t instanceCount = reader.ReadUInt32();
+    if (instanceCount > reader.GetRemaining().size() / (4 + (axisCount * 4)))
+    {
+        return false;
+    }
+    metadata.namedInstances.resize(instanceCount);
+    for (auto& instance : metadata.namedInstances)
+    {
+        instance.subfamilyNameId = reader.ReadUInt16();
+        instance.postScriptNameId = reader.ReadUInt16();
+        instance.coordinates.resize(axisCount);
+        for (auto& coordinate : instance.coordinates)
+        {
+            coordinate = reader.ReadFloat();
+        }
+    }
+
+    return reader.IsValid();
+}
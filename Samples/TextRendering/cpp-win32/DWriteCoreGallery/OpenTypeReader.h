@@ -0,0 +1,234 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This header is platform-neutral: it depends only on the C++ standard library, so font files can
+// be parsed and the metadata cache format can be tested without Windows headers.
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// Makes a four-character OpenType tag, with the first character in the low byte. This is the same
+/// byte order as DWRITE_MAKE_OPENTYPE_TAG, so tags can be compared with DWRITE_FONT_AXIS_TAG values.
+/// </summary>
+constexpr uint32_t MakeOpenTypeTag(char a, char b, char c, char d) noexcept
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+        (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+        (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+        (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+/// <summary>
+/// Well-known name IDs in the OpenType 'name' table.
+/// </summary>
+enum OpenTypeNameId : uint16_t
+{
+    OpenTypeNameId_FamilyName = 1,
+    OpenTypeNameId_SubfamilyName = 2,
+    OpenTypeNameId_FullName = 4,
+    OpenTypeNameId_PostScriptName = 6,
+    OpenTypeNameId_TypographicFamilyName = 16,
+    OpenTypeNameId_TypographicSubfamilyName = 17,
+    OpenTypeNameId_WwsFamilyName = 21,
+    OpenTypeNameId_WwsSubfamilyName = 22,
+    OpenTypeNameId_None = 0xFFFF
+};
+
+/// <summary>
+/// Font family model, with the same values as DWRITE_FONT_FAMILY_MODEL.
+/// </summary>
+enum class FontFamilyModel
+{
+    Typographic = 0,
+    WeightStretchStyle = 1
+};
+
+/// <summary>
+/// A string from the 'name' table. Only the preferred (English, if present) string for each name ID is kept.
+/// </summary>
+struct OpenTypeName
+{
+    uint16_t nameId;
+    std::u16string value;
+
+    bool operator==(OpenTypeName const&) const = default;
+};
+
+/// <summary>
+/// A variation axis from the 'fvar' table.
+/// </summary>
+struct OpenTypeAxis
+{
+    uint32_t tag;
+    float minValue;
+    float defaultValue;
+    float maxValue;
+
+    bool operator==(OpenTypeAxis const&) const = default;
+};
+
+/// <summary>
+/// A named instance from the 'fvar' table. Coordinates are in the same order as the axes.
+/// </summary>
+struct OpenTypeNamedInstance
+{
+    uint16_t subfamilyNameId;
+    uint16_t postScriptNameId;
+    std::vector<float> coordinates;
+
+    bool operator==(OpenTypeNamedInstance const&) const = default;
+};
+
+/// <summary>
+/// Axis value computed for a font face, in the same form as DWRITE_FONT_AXIS_VALUE.
+/// </summary>
+struct OpenTypeAxisValue
+{
+    uint32_t tag;
+    float value;
+};
+
+/// <summary>
+/// Metadata for one face of an OpenType or TrueType font file, read directly from the name, fvar,
+/// STAT, and OS/2 tables without creating a font face.
+/// </summary>
+struct FontFaceMetadata
+{
+    bool isCollection = false;
+    uint16_t weightClass = 400;
+    uint16_t widthClass = 5;
+    uint16_t fsSelection = 0;
+    uint16_t elidedFallbackNameId = OpenTypeNameId_None;
+
+    std::vector<OpenTypeName> names;
+    std::vector<OpenTypeAxis> axes;
+    std::vector<OpenTypeNamedInstance> namedInstances;
+
+    bool operator==(FontFaceMetadata const&) const = default;
+
+    /// <summary>
+    /// Returns the string for the specified name ID, or nullptr if there is none.
+    /// </summary>
+    std::u16string const* FindName(uint16_t nameId) const noexcept;
+
+    /// <summary>
+    /// Returns the first string that exists among the specified name IDs, or an empty string.
+    /// </summary>
+    std::u16string GetName(std::initializer_list<uint16_t> nameIds) const;
+
+    /// <summary>
+    /// Returns the family name in the specified family model. For the typographic model this is the
+    /// typographic family name (name ID 16), or else the family name (1). For the weight-stretch-style
+    /// model it is the WWS family name (21), or else the typographic family name, or else the family
+    /// name. DirectWrite uses the same names, except that for a font with no WWS names whose
+    /// typographic subfamily names something other than weight, stretch or style, it moves those
+    /// words into the weight-stretch-style family name.
+    /// </summary>
+    std::u16string GetFamilyName(FontFamilyModel familyModel) const;
+
+    /// <summary>
+    /// Returns the face name of the default instance in the specified family model, using the
+    /// subfamily name IDs (17 and 2, or 22, 17 and 2) that match GetFamilyName.
+    /// </summary>
+    std::u16string GetFaceName(FontFamilyModel familyModel) const;
+
+    /// <summary>
+    /// Returns the axis with the specified tag, or nullptr if the font does not vary along it.
+    /// </summary>
+    OpenTypeAxis const* FindAxis(uint32_t tag) const noexcept;
+
+    /// <summary>
+    /// Returns the named instance whose coordinates match the specified axis values, or nullptr.
+    /// Axes that are not specified are compared against their default values.
+    /// </summary>
+    OpenTypeNamedInstance const* FindNamedInstance(std::span<OpenTypeAxisValue const> axisValues) const noexcept;
+
+    /// <summary>
+    /// Returns the axis values of the default instance: the fvar defaults for a variable font, or
+    /// values derived from the OS/2 table (weight, width, italic, slant) otherwise. This matches the
+    /// axes DirectWrite reports for the face.
+    /// </summary>
+    std::vector<OpenTypeAxisValue> GetDefaultAxisValues() const;
+};
+
+/// <summary>
+/// Writes the little-endian binary format used by the on-disk metadata cache.
+/// </summary>
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(std::vector<uint8_t>& buffer) noexcept : m_buffer{ buffer }
+    {
+    }
+
+    void WriteUInt8(uint8_t value) { m_buffer.push_back(value); }
+    void WriteUInt16(uint16_t value) { WriteBytes(value, 2); }
+    void WriteUInt32(uint32_t value) { WriteBytes(value, 4); }
+    void WriteUInt64(uint64_t value) { WriteBytes(value, 8); }
+    void WriteFloat(float value);
+    void WriteString(std::u16string_view value);
+
+private:
+    void WriteBytes(uint64_t value, size_t byteCount);
+
+    std::vector<uint8_t>& m_buffer;
+};
+
+/// <summary>
+/// Reads data written by BinaryWriter. Once a read runs past the end of the input, it and all
+/// subsequent reads return zero, and IsValid returns false.
+/// </summary>
+class BinaryReader
+{
+public:
+    explicit BinaryReader(std::span<uint8_t const> input) noexcept : m_input{ input }
+    {
+    }
+
+    bool IsValid() const noexcept { return m_isValid; }
+    std::span<uint8_t const> GetRemaining() const noexcept { return m_input; }
+
+    uint8_t ReadUInt8() noexcept { return static_cast<uint8_t>(ReadBytes(1)); }
+    uint16_t ReadUInt16() noexcept { return static_cast<uint16_t>(ReadBytes(2)); }
+    uint32_t ReadUInt32() noexcept { return static_cast<uint32_t>(ReadBytes(4)); }
+    uint64_t ReadUInt64() noexcept { return ReadBytes(8); }
+    float ReadFloat() noexcept;
+    std::u16string ReadString();
+
+private:
+    uint64_t ReadBytes(size_t byteCount) noexcept;
+
+    std::span<uint8_t const> m_input;
+    bool m_isValid = true;
+};
+
+/// <summary>
+/// Returns the number of faces in a font file: the font count for a collection (TTC), 1 for a single
+/// font, or 0 if the data is not an OpenType or TrueType font.
+/// </summary>
+uint32_t GetOpenTypeFaceCount(std::span<uint8_t const> fileData) noexcept;
+
+/// <summary>
+/// Reads the metadata for one face of a font file. All offsets are bounds checked, so this is safe
+/// to call on untrusted data.
+/// </summary>
+/// <returns>Returns false if the face does not exist or its tables are malformed.</returns>
+bool ParseFontFaceMetadata(std::span<uint8_t const> fileData, uint32_t faceIndex, FontFaceMetadata& metadata);
+
+/// <summary>
+/// Writes the metadata in the binary form used by the on-disk metadata cache.
+/// </summary>
+void WriteFontFaceMetadata(BinaryWriter& writer, FontFaceMetadata const& metadata);
+
+/// <summary>
+/// Reads metadata written by WriteFontFaceMetadata.
+/// </summary>
+/// <returns>Returns false if the input is truncated or malformed.</returns>
+bool ReadFontFaceMetadata(BinaryReader& reader, FontFaceMetadata& metadata);
@@ -0,0 +1,78 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This header is platform-neutral: it depends only on the C++ standard library, so it can be
+// built and tested without Windows headers.
+#include <algorithm>
+#include <vector>
+
+/// <summary>
+/// Keeps the running totals of an array of non-negative integers, so that the sum of any prefix
+/// takes O(1) time and finding the index that contains a given offset takes O(log n) time.
+/// ListWindow uses this to map item indices to pixel offsets and back.
+/// </summary>
+class PrefixSums
+{
+public:
+    /// <summary>
+    /// Replaces the values, in O(n) time.
+    /// </summary>
+    void Assign(std::vector<int> const& values)
+    {
+        m_sums.resize(values.size() + 1);
+        m_sums[0] = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            m_sums[i + 1] = m_sums[i] + values[i];
+        }
+    }
+
+    void Clear() noexcept
+    {
+        m_sums.clear();
+    }
+
+    int GetCount() const noexcept
+    {
+        return m_sums.empty() ? 0 : static_cast<int>(m_sums.size() - 1);
+    }
+
+    int GetValue(int index) const noexcept
+    {
+        return m_sums[index + 1] - m_sums[index];
+    }
+
+    /// <summary>
+    /// Returns the sum of the first count values.
+    /// </summary>
+    int GetPrefixSum(int count) const noexcept
+    {
+        return m_sums.empty() ? 0 : m_sums[count];
+    }
+
+    int GetTotal() const noexcept
+    {
+        return GetPrefixSum(GetCount());
+    }
+
+    /// <summary>
+    /// Returns the index of the value that spans the specified offset, i.e., the first index whose
+    /// prefix sum (including the value itself) is greater than offset. Returns GetCount() if the
+    /// offset is at or beyond the total.
+    /// </summary>
+    int FindIndex(int offset) const noexcept
+    {
+        if (m_sums.empty())
+        {
+            return 0;
+        }
+
+        return static_cast<int>(std::upper_bound(m_sums.begin() + 1, m_sums.end(), offset) - (m_sums.begin() + 1));
+    }
+
+private:
+    // m_sums[i] is the sum of the first i values, so it has one more element than there are values.
+    std::vector<int> m_sums;
+};
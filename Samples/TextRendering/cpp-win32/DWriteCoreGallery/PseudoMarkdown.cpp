@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "PseudoMarkdown.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PSEUDO_MARKDOWN_USE_SSE2
+#endif
+
+size_t ConvertUtf8ToUtf16(char const* input, size_t inputLength, char16_t* output) noexcept
+{
+    auto pos = reinterpret_cast<uint8_t const*>(input);
+    auto end = pos + inputLength;
+    char16_t* out = output;
+
+    while (pos < end)
+    {
+#ifdef PSEUDO_MARKDOWN_USE_SSE2
+        // Widen 16 ASCII characters at a time, until a non-ASCII byte is found.
+        while (end - pos >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pos));
+            if (_mm_movemask_epi8(chunk) != 0)
+            {
+                break;
+            }
+
+            __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(chunk, zero));
+            pos += 16;
+            out += 16;
+        }
+
+        if (pos == end)
+        {
+            break;
+        }
+#endif
+
+        uint8_t lead = *pos++;
+        if (lead < 0x80)
+        {
+            *out++ = lead;
+            continue;
+        }
+
+        // Determine the sequence length and the valid range of the first continuation byte,
+        // which excludes overlong encodings, surrogates, and values above U+10FFFF.
+        uint32_t codePoint;
+        int continuationCount;
+        uint8_t low = 0x80;
+        uint8_t high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            continuationCount = 1;
+            codePoint = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            continuationCount = 2;
+            codePoint = lead & 0x0F;
+            if (lead == 0xE0) { low = 0xA0; }
+            else if (lead == 0xED) { high = 0x9F; }
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            continuationCount = 3;
+            codePoint = lead & 0x07;
+            if (lead == 0xF0) { low = 0x90; }
+            else if (lead == 0xF4) { high = 0x8F; }
+        }
+        else
+        {
+            // Not a valid lead byte.
+            *out++ = 0xFFFD;
+            continue;
+        }
+
+        int i = 0;
+        for (; i < continuationCount; i++)
+        {
+            if (pos == end || *pos < low || *pos > high)
+            {
+                break;
+            }
+
+            codePoint = (codePoint << 6) | (*pos++ & 0x3F);
+            low = 0x80;
+            high = 0xBF;
+        }
+
+        if (i < continuationCount)
+        {
+            // Truncated sequence. The bytes consumed so far are replaced by a single U+FFFD, and
+            // the byte that ended it is decoded again as the start of a new sequence.
+            *out++ = 0xFFFD;
+        }
+        else if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            *out++ = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            *out++ = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+        else
+        {
+            *out++ = static_cast<char16_t>(codePoint);
+        }
+    }
+
+    return static_cast<size_t>(out - output);
+}
@@ -0,0 +1,236 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This header is platform-neutral: it depends only on the C++ standard library, so the tokenizer
+// and transcoder can be built and tested without Windows headers.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// Block type returned by pseudo-markdown parser.
+/// </summary>
+enum class MarkdownBlockType
+{
+    Body,
+    Heading,
+    Code
+};
+
+/// <summary>
+/// Inline span type reported by the pseudo-markdown tokenizer.
+/// </summary>
+enum class MarkdownSpanType
+{
+    Bold,
+    Italic,
+    Code
+};
+
+namespace PseudoMarkdownDetail
+{
+    inline char const* SkipSpaces(char const* begin, char const* end) noexcept
+    {
+        return std::find_if(begin, end, [](char ch) { return ch != ' '; });
+    }
+
+    inline char const* FindNewLine(char const* begin, char const* end) noexcept
+    {
+        return std::find_if(begin, end, [](char ch) { return ch == '\n' || ch == '\r'; });
+    }
+
+    inline char const* SkipNewLine(char const* begin, char const* end) noexcept
+    {
+        auto p = begin;
+        if (p != end && *p == '\r') { ++p; }
+        if (p != end && *p == '\n') { ++p; }
+        return p;
+    }
+}
+
+/// <summary>
+/// Tokenizes one block of pseudo-markdown, without copying or converting the input. The handler
+/// receives events that reference the input bytes directly:
+///
+///   handler.Text(char const* begin, char const* end)  - UTF-8 text to append to the block.
+///   handler.SoftBreak()                               - a single newline within a body block,
+///                                                       which becomes a space unless the text
+///                                                       already ends with one.
+///   handler.ToggleSpan(MarkdownSpanType spanType)     - begins or ends an inline span.
+///
+/// Text events never split a UTF-8 sequence, because they only break at ASCII characters.
+/// </summary>
+/// <param name="inputPos">On entry, points to the start of the UTF-8 input text. On return, points to the end of the first block.</param>
+/// <param name="inputEnd">Points to the end of the input text.</param>
+/// <param name="handler">Receives the events for the block.</param>
+/// <returns>Returns the block type.</returns>
+template<class Handler>
+MarkdownBlockType TokenizePseudoMarkdownBlock(char const*& inputPos, char const* inputEnd, Handler& handler)
+{
+    using namespace PseudoMarkdownDetail;
+
+    if (inputPos == inputEnd)
+    {
+        return MarkdownBlockType::Body;
+    }
+
+    // Let pos be the current character position in the input.
+    char const* pos = inputPos;
+
+    // Determine the block type based on the first character.
+    auto blockType = MarkdownBlockType::Body;
+    if (*pos == '#')
+    {
+        blockType = MarkdownBlockType::Heading;
+        pos = SkipSpaces(pos + 1, inputEnd);
+    }
+    else if (*pos == '`')
+    {
+        blockType = MarkdownBlockType::Code;
+        pos = SkipNewLine(FindNewLine(pos, inputEnd), inputEnd);
+    }
+    else
+    {
+        pos = SkipSpaces(pos, inputEnd);
+    }
+
+    // Pointer to the first character that has not yet been reported as text.
+    char const* outputTextPos = pos;
+
+    // Helper to report the characters between outputTextPos and the current position.
+    auto AddText = [&]()
+    {
+        if (pos > outputTextPos)
+        {
+            handler.Text(outputTextPos, pos);
+        }
+        outputTextPos = pos;
+    };
+
+    // Assume initially that the end of the block is the end of the input.
+    auto blockEnd = inputEnd;
+
+    // Iterate until we reach the end of the block.
+    while (pos != blockEnd)
+    {
+        // Skip quickly over runs of plain text, which are most of the input.
+        pos = std::find_if(pos, blockEnd, [](char ch) { return ch == '\r' || ch == '\n' || ch == '*' || ch == '`'; });
+        if (pos == blockEnd)
+        {
+            break;
+        }
+
+        switch (*pos)
+        {
+        case '\r':
+        case '\n':
+            // Add any pending text up to the newline.
+            AddText();
+
+            // Advance past the newline.
+            pos = SkipNewLine(pos + 1, blockEnd);
+
+            if (blockType == MarkdownBlockType::Code)
+            {
+                // Check for end of code block.
+                if (pos < blockEnd && *pos == '`')
+                {
+                    pos = SkipNewLine(FindNewLine(pos, blockEnd), blockEnd);
+                    outputTextPos = pos;
+                    blockEnd = pos;
+                }
+            }
+            else
+            {
+                outputTextPos = pos;
+
+                // Skip blank lines.
+                while (pos < blockEnd && (*pos == '\r' || *pos == '\n'))
+                {
+                    ++pos;
+                }
+
+                // Determine whether to end the block.
+                if (blockType == MarkdownBlockType::Heading || pos > outputTextPos)
+                {
+                    // End the current block, either because it's a heading or because there
+                    // were multiple newlines.
+                    outputTextPos = pos;
+                    blockEnd = pos;
+                }
+                else
+                {
+                    // Continue the current block, with a space in place of the newline.
+                    handler.SoftBreak();
+                }
+            }
+            break;
+
+        case '*':
+            if (blockType == MarkdownBlockType::Body)
+            {
+                // Add any pending text up to the inline markup.
+                AddText();
+
+                // Check whether it's **bold** or *italic*.
+                if (pos + 1 < blockEnd && pos[1] == '*')
+                {
+                    pos += 2;
+                    handler.ToggleSpan(MarkdownSpanType::Bold);
+                }
+                else
+                {
+                    pos++;
+                    handler.ToggleSpan(MarkdownSpanType::Italic);
+                }
+
+                // Do not include the markup in the output text.
+                outputTextPos = pos;
+            }
+            else
+            {
+                // Treat '*' in non-body text as plain text.
+                ++pos;
+            }
+            break;
+
+        case '`':
+            if (blockType == MarkdownBlockType::Body)
+            {
+                // Add any pending text up to the inline markup.
+                AddText();
+
+                // Begin or end the inline code range.
+                pos++;
+                handler.ToggleSpan(MarkdownSpanType::Code);
+
+                // Do not include the markup in the output text.
+                outputTextPos = pos;
+            }
+            else
+            {
+                // Treat '`' in non-body text as plain text.
+                ++pos;
+            }
+            break;
+        }
+    }
+
+    AddText();
+    inputPos = pos;
+
+    return blockType;
+}
+
+/// <summary>
+/// Converts UTF-8 to UTF-16 in a single pass. Runs of ASCII are widened 16 bytes at a time using
+/// SSE2 where available. Each ill-formed sequence is replaced by U+FFFD, following the Unicode
+/// "maximal subpart" practice.
+/// </summary>
+/// <param name="input">Points to the UTF-8 input.</param>
+/// <param name="inputLength">Length of the input in bytes.</param>
+/// <param name="output">Receives the UTF-16 output. Must have room for inputLength code units, which is always enough.</param>
+/// <returns>Returns the number of UTF-16 code units written.</returns>
+size_t ConvertUtf8ToUtf16(char const* input, size_t inputLength, char16_t* output) noexcept;
@@ -24,6 +24,7 @@ StaticTextWindow::StaticTextWindow(HWND parentWindow, TextRenderer* textRenderer
 void StaticTextWindow::SetTextLayouts(std::vector<wil::com_ptr<IDWriteTextLayout4>>&& textLayouts)
 {
     m_textLayouts = std::move(textLayouts);
+    m_layoutHeights.clear();
     SetPixelScrollTop(0);
     OnSize();
     InvalidateRect(GetHandle(), nullptr, true);
@@ -54,17 +55,16 @@ void StaticTextWindow::OnPaint(HDC hdc, RECT invalidRect)
     g->SetTextColor(COLOR_WINDOWTEXT);
 
     // Draw the text layouts to the off-screen render target.
-    for (auto& textLayout : m_textLayouts)
+    for (size_t i = 0; i < m_textLayouts.size() && i < m_layoutHeights.size(); i++)
     {
-        DWRITE_TEXT_METRICS1 metrics;
-        THROW_IF_FAILED(textLayout->GetMetrics(&metrics));
+        float layoutHeight = m_layoutHeights[i];
 
-        if (targetY + metrics.height >= 0)
+        if (targetY + layoutHeight >= 0)
         {
-            THROW_IF_FAILED(textLayout->Draw(nullptr, GetTextRenderer(), targetX, targetY));
+            THROW_IF_FAILED(m_textLayouts[i]->Draw(nullptr, GetTextRenderer(), targetX, targetY));
         }
 
-        targetY += metrics.height + g_paragraphGap;
+        targetY += layoutHeight + g_paragraphGap;
 
         if (targetY > targetHeight)
         {
@@ -81,21 +81,37 @@ void StaticTextWindow::OnSize()
     float scale = GetTextRenderer()->GetDpiScale();
     float clientWidthInDips = GetPixelWidth() / scale;
 
-    float columnWidth = std::max(
+    // Round the column width down to a whole DIP, so that small changes (such as a fractional DPI
+    // scale) don't cause every layout to be measured again.
+    float columnWidth = floorf(std::max(
         clientWidthInDips - (g_leftMargin + g_rightMargin),
         g_minColumnWidth
-    );
+    ));
 
-    float height = g_topMargin;
-
-    for (auto& textLayout : m_textLayouts)
+    // Only reformat the text layouts if the column width changed.
+    if (columnWidth != m_layoutWidth || m_layoutHeights.size() != m_textLayouts.size())
     {
-        THROW_IF_FAILED(textLayout->SetMaxWidth(columnWidth));
+        m_layoutHeights.clear();
+        m_layoutHeights.reserve(m_textLayouts.size());
+
+        for (auto& textLayout : m_textLayouts)
+        {
+            THROW_IF_FAILED(textLayout->SetMaxWidth(columnWidth));
+
+            DWRITE_TEXT_METRICS1 metrics;
+            THROW_IF_FAILED(textLayout->GetMetrics(&metrics));
 
-        DWRITE_TEXT_METRICS1 metrics;
-        THROW_IF_FAILED(textLayout->GetMetrics(&metrics));
+            m_layoutHeights.push_back(metrics.height);
+        }
 
-        height += metrics.height + g_paragraphGap;
+        m_layoutWidth = columnWidth;
+    }
+
+    float height = g_topMargin;
+
+    for (float layoutHeight : m_layoutHeights)
+    {
+        height += layoutHeight + g_paragraphGap;
     }
 
     height += g_bottomMargin - g_paragraphGap;
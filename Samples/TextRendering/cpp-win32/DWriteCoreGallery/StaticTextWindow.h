@@ -21,4 +21,9 @@ protected:
 
 private:
     std::vector<wil::com_ptr<IDWriteTextLayout4>> m_textLayouts;
+
+    // Height of each text layout at m_layoutWidth, so resizing without changing the column width
+    // (or painting) does not need to measure the layouts again.
+    std::vector<float> m_layoutHeights;
+    float m_layoutWidth = 0;
 };
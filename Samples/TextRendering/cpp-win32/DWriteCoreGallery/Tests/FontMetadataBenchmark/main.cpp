@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Measures the two ways FontMetadataCache gets a font's metadata: parsing the font file's tables
+// (a cache miss) and reading the entry back from the cache file (a hit), for every face of every
+// font in a directory. The files are read into memory first, so parsing is timed with the file
+// data in memory, as it is for a mapped file whose pages are already cached. Fails if any face
+// reads back from the cache format differently from how it was parsed.
+//
+// Usage: FontMetadataBenchmark [--quick] [directory...]
+//
+// The directories default to the fonts bundled with the sample. Pass a system font directory, such
+// as C:\Windows\Fonts or /usr/share/fonts, for a realistic mix of fonts.
+
+#include "OpenTypeReader.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+    bool IsFontFile(std::filesystem::path const& path)
+    {
+        auto extension = path.extension().string();
+        for (auto& ch : extension)
+        {
+            ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        }
+        return extension == ".ttf" || extension == ".otf" || extension == ".ttc" || extension == ".otc";
+    }
+
+    std::vector<std::vector<uint8_t>> ReadFontFiles(std::vector<std::filesystem::path> const& directories)
+    {
+        std::vector<std::vector<uint8_t>> files;
+        for (auto const& directory : directories)
+        {
+            std::error_code error;
+            for (auto const& entry : std::filesystem::recursive_directory_iterator(directory, error))
+            {
+                if (entry.is_regular_file() && IsFontFile(entry.path()))
+                {
+                    std::ifstream file(entry.path(), std::ios::binary);
+                    files.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                }
+            }
+        }
+        return files;
+    }
+
+    // Parses every face of a font file, as FontMetadataCache does on a cache miss.
+    bool ParseFontFile(std::span<uint8_t const> fileData, std::vector<FontFaceMetadata>& faces)
+    {
+        faces.clear();
+
+        uint32_t faceCount = GetOpenTypeFaceCount(fileData);
+        if (faceCount == 0 || faceCount > fileData.size() / 4)
+        {
+            return false;
+        }
+
+        faces.resize(faceCount);
+        for (uint32_t faceIndex = 0; faceIndex < faceCount; faceIndex++)
+        {
+            if (!ParseFontFaceMetadata(fileData, faceIndex, faces[faceIndex]))
+            {
+                faces.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<class TCallback>
+    double MeasureMicroseconds(TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick only checks the round trip through the cache format, for use as a test.
+    bool quick = false;
+    std::vector<std::filesystem::path> directories;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view{ argv[i] } == "--quick")
+        {
+            quick = true;
+        }
+        else
+        {
+            directories.emplace_back(argv[i]);
+        }
+    }
+
+    if (directories.empty())
+    {
+        directories.emplace_back(SAMPLE_DIR "/RobotoMono");
+        directories.emplace_back(SAMPLE_DIR "/SourceSansPro");
+    }
+
+    auto files = ReadFontFiles(directories);
+
+    // Parse every file, and write the faces that parse in the cache format.
+    std::vector<FontFaceMetadata> parsedFaces;
+    std::vector<FontFaceMetadata> faces;
+    size_t fileBytes = 0;
+    size_t rejectedCount = 0;
+    for (auto const& file : files)
+    {
+        fileBytes += file.size();
+        if (ParseFontFile(file, faces))
+        {
+            parsedFaces.insert(parsedFaces.end(), faces.begin(), faces.end());
+        }
+        else
+        {
+            ++rejectedCount;
+        }
+    }
+
+    std::vector<uint8_t> cacheData;
+    BinaryWriter writer{ cacheData };
+    for (auto const& face : parsedFaces)
+    {
+        WriteFontFaceMetadata(writer, face);
+    }
+
+    std::cout << files.size() << " font files (" << (fileBytes / 1024) << " KB), " << rejectedCount << " rejected, "
+        << parsedFaces.size() << " faces, " << (cacheData.size() / 1024) << " KB in the cache format\n";
+
+    if (parsedFaces.empty())
+    {
+        std::cerr << "No fonts were found.\n";
+        return 1;
+    }
+
+    // Check that every face reads back from the cache unchanged.
+    size_t mismatchCount = 0;
+    BinaryReader reader{ cacheData };
+    FontFaceMetadata face;
+    for (auto const& parsedFace : parsedFaces)
+    {
+        mismatchCount += (ReadFontFaceMetadata(reader, face) && face == parsedFace) ? 0 : 1;
+    }
+
+    if (mismatchCount != 0 || !reader.GetRemaining().empty())
+    {
+        std::cerr << mismatchCount << " faces read back from the cache format differently.\n";
+        return 1;
+    }
+
+    if (quick)
+    {
+        return 0;
+    }
+
+    size_t checksum = 0;
+    auto parseMicroseconds = MeasureMicroseconds([&]()
+        {
+            for (auto const& file : files)
+            {
+                ParseFontFile(file, faces);
+                checksum += faces.size();
+            }
+        });
+
+    auto cacheMicroseconds = MeasureMicroseconds([&]()
+        {
+            BinaryReader cacheReader{ cacheData };
+            for (size_t i = 0; i < parsedFaces.size(); i++)
+            {
+                ReadFontFaceMetadata(cacheReader, face);
+                checksum += face.names.size();
+            }
+        });
+
+    auto faceCount = static_cast<double>(parsedFaces.size());
+    std::cout << "\nMicroseconds per face\n\n" << std::fixed << std::setprecision(2);
+    std::cout << std::setw(28) << "Parsing the font tables" << std::setw(10) << (parseMicroseconds / faceCount) << "\n";
+    std::cout << std::setw(28) << "Reading the cache entry" << std::setw(10) << (cacheMicroseconds / faceCount) << "\n";
+    std::cout << "\nCache bytes per face: " << std::setprecision(0) << (static_cast<double>(cacheData.size()) / faceCount) << "\n";
+    std::cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
@@ -0,0 +1,387 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Checks GlyphCache and GlyphBlender with synthetic coverage bitmaps:
+//
+// * Every field of GlyphKey, including the measuring, rendering and grid fit modes, identifies a
+//   separate glyph.
+// * Glyphs packed into the atlas never overlap and read back as they were added, and a full atlas
+//   is emptied and its generation changes.
+// * Blending matches a floating-point reference of the ClearType level, enhanced contrast, gamma
+//   and pixel geometry, for glyphs clipped by every edge of the bitmap, and never writes outside it.
+
+#include "GlyphCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    int g_failureCount = 0;
+
+    void Check(bool condition, std::string_view what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << "\n";
+            ++g_failureCount;
+        }
+    }
+
+    GlyphKey MakeKey(uint16_t glyphIndex, uint8_t bytesPerPixel = 3)
+    {
+        GlyphKey key = {};
+        key.fontFaceId = 1;
+        key.glyphIndex = glyphIndex;
+        key.bytesPerPixel = bytesPerPixel;
+        key.measuringMode = 0;
+        key.renderingMode = 5;
+        key.gridFitMode = 2;
+        key.emSize = 12;
+        key.m11 = 1.5f;
+        key.m22 = 1.5f;
+        return key;
+    }
+
+    std::vector<uint8_t> MakeCoverage(uint32_t width, uint32_t height, uint8_t bytesPerPixel, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> value(0, 255);
+        std::vector<uint8_t> coverage(static_cast<size_t>(width) * height * bytesPerPixel);
+        for (auto& byte : coverage)
+        {
+            // About a third of the coverage is empty, as around a real glyph's strokes.
+            int v = value(random);
+            byte = static_cast<uint8_t>(v < 80 ? 0 : v);
+        }
+        return coverage;
+    }
+
+    void CheckKeys()
+    {
+        GlyphCache cache;
+        std::vector<uint8_t> coverage(3, 255);
+
+        auto base = MakeKey(7);
+        cache.Add(base, 0, 0, 1, 1, coverage);
+        Check(cache.Find(base) != nullptr, "added glyph is found");
+
+        std::vector<GlyphKey> variants(11, base);
+        variants[0].fontFaceId++;
+        variants[1].glyphIndex++;
+        variants[2].subpixelOffset++;
+        variants[3].bytesPerPixel = 1;
+        variants[4].measuringMode++;
+        variants[5].renderingMode++;
+        variants[6].gridFitMode++;
+        variants[7].emSize++;
+        variants[8].m11++;
+        variants[9].m12++;
+        variants[10].m22++;
+
+        for (auto const& variant : variants)
+        {
+            Check(cache.Find(variant) == nullptr, "each key field identifies a separate glyph");
+        }
+
+        auto const& statistics = cache.GetStatistics();
+        Check(statistics.hitCount == 1 && statistics.missCount == 1, "statistics count hits and adds");
+
+        auto frame = cache.TakeFrameStatistics();
+        Check(frame.hitCount == 1 && frame.missCount == 1 && frame.resetCount == 0, "first frame counts every lookup");
+        cache.Find(base);
+        frame = cache.TakeFrameStatistics();
+        Check(frame.hitCount == 1 && frame.missCount == 0, "each frame counts only its own lookups");
+    }
+
+    void CheckAtlas(size_t glyphCount, std::mt19937& random)
+    {
+        constexpr uint32_t atlasSize = 256;
+        GlyphCache cache{ atlasSize };
+        std::uniform_int_distribution<uint32_t> size(0, 40);
+
+        struct AddedGlyph
+        {
+            GlyphKey key;
+            std::vector<uint8_t> coverage;
+        };
+        std::vector<AddedGlyph> added;
+
+        bool isIntact = true;
+        bool isDisjoint = true;
+        uint32_t generation = cache.GetGeneration();
+        for (size_t i = 0; i < glyphCount; i++)
+        {
+            uint8_t bytesPerPixel = (i % 3 == 0) ? 1 : 3;
+            auto key = MakeKey(static_cast<uint16_t>(i), bytesPerPixel);
+            uint32_t width = size(random);
+            uint32_t height = size(random);
+            auto coverage = MakeCoverage(width, height, bytesPerPixel, random);
+
+            auto entry = cache.Add(key, -1, -static_cast<int32_t>(height), width, height, coverage);
+            if (entry == nullptr || entry->width != width || entry->height != height || entry->isClearType != (bytesPerPixel == 3))
+            {
+                Check(false, "glyph is added with its size");
+                return;
+            }
+
+            // A reset drops every glyph added before it.
+            if (cache.GetGeneration() != generation)
+            {
+                generation = cache.GetGeneration();
+                added.clear();
+            }
+            added.push_back({ key, std::move(coverage) });
+
+            // Every glyph still in the cache reads back as added, and no two overlap.
+            if (i % 16 == 15 || i + 1 == glyphCount)
+            {
+                std::vector<uint8_t> owner(static_cast<size_t>(atlasSize) * atlasSize, 0);
+                for (size_t j = 0; j < added.size(); j++)
+                {
+                    auto const& glyph = added[j];
+                    auto cached = cache.Find(glyph.key);
+                    if (cached == nullptr)
+                    {
+                        isIntact = false;
+                        continue;
+                    }
+
+                    for (uint32_t row = 0; row < cached->height; row++)
+                    {
+                        auto cachedRow = cache.GetCoverageRow(*cached, row);
+                        for (uint32_t column = 0; column < cached->width; column++)
+                        {
+                            auto& pixelOwner = owner[(static_cast<size_t>(cached->atlasY) + row) * atlasSize + cached->atlasX + column];
+                            isDisjoint &= pixelOwner == 0;
+                            pixelOwner = 1;
+
+                            for (uint32_t subpixel = 0; subpixel < 3; subpixel++)
+                            {
+                                size_t source = (static_cast<size_t>(row) * cached->width + column) * glyph.key.bytesPerPixel +
+                                    (glyph.key.bytesPerPixel == 3 ? subpixel : 0);
+                                isIntact &= cachedRow[column * 3 + subpixel] == glyph.coverage[source];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        Check(isIntact, "cached glyphs read back as they were added");
+        Check(isDisjoint, "glyphs in the atlas don't overlap");
+        Check(cache.GetStatistics().resetCount > 0 && cache.GetGeneration() == cache.GetStatistics().resetCount, "a full atlas is emptied and its generation changes");
+
+        std::vector<uint8_t> large(static_cast<size_t>(GlyphCache::c_maxGlyphSize + 1) * 3, 255);
+        Check(cache.Add(MakeKey(60000), 0, 0, GlyphCache::c_maxGlyphSize + 1, 1, large) == nullptr, "glyphs larger than the limit aren't cached");
+
+        std::cout << "Atlas: " << glyphCount << " glyphs added, " << cache.GetStatistics().resetCount << " resets\n";
+    }
+
+    // Floating-point version of GlyphBlender::Blend for one channel of one pixel.
+    uint8_t ReferenceBlend(GlyphBlendParameters const& parameters, std::array<uint8_t, 3> textColor, bool isClearType,
+        uint8_t const* subpixels, size_t channel, uint8_t background)
+    {
+        // The atlas subpixel that covers this channel.
+        size_t subpixel = (parameters.isBgr && channel != 1) ? 2 - channel : channel;
+
+        float coverage;
+        float contrast;
+        if (isClearType)
+        {
+            float average = (subpixels[0] + subpixels[1] + subpixels[2]) / 3.0f;
+            coverage = (average + (subpixels[subpixel] - average) * parameters.clearTypeLevel) / 255;
+            contrast = parameters.enhancedContrast;
+        }
+        else
+        {
+            coverage = subpixels[0] / 255.0f;
+            contrast = parameters.grayscaleEnhancedContrast;
+        }
+
+        float intensity = (0.25f * textColor[0] + 0.5f * textColor[1] + 0.25f * textColor[2]) / 255;
+        contrast *= std::clamp(4 * (0.75f - intensity), 0.0f, 1.0f);
+        coverage = coverage * (contrast + 1) / (coverage * contrast + 1);
+
+        float foreground = std::pow(textColor[channel] / 255.0f, parameters.gamma);
+        float back = std::pow(background / 255.0f, parameters.gamma);
+        return static_cast<uint8_t>(std::lround(std::pow(back + (foreground - back) * coverage, 1 / parameters.gamma) * 255));
+    }
+
+    // Blends glyphs at positions that clip them by each edge of a bitmap, and returns the largest
+    // difference from the reference.
+    int CheckBlend(GlyphBlendParameters const& parameters, size_t iterationCount, std::mt19937& random)
+    {
+        constexpr uint32_t bitmapWidth = 24;
+        constexpr uint32_t bitmapHeight = 16;
+        constexpr size_t guardSize = 64;
+        constexpr uint32_t guardPixel = 0xDEADBEEF;
+
+        GlyphCache cache;
+        GlyphBlender blender{ parameters };
+        std::uniform_int_distribution<int> byteValue(0, 255);
+        std::uniform_int_distribution<int32_t> position(-12, 28);
+        std::uniform_int_distribution<uint32_t> size(1, 12);
+
+        int maxError = 0;
+        bool isInBounds = true;
+        for (size_t iteration = 0; iteration < iterationCount; iteration++)
+        {
+            std::array<uint8_t, 3> textColor = { static_cast<uint8_t>(byteValue(random)), static_cast<uint8_t>(byteValue(random)), static_cast<uint8_t>(byteValue(random)) };
+            blender.SetTextColor(textColor[0], textColor[1], textColor[2]);
+
+            uint8_t bytesPerPixel = (iteration % 4 == 0) ? 1 : 3;
+            uint32_t width = size(random);
+            uint32_t height = size(random);
+            auto coverage = MakeCoverage(width, height, bytesPerPixel, random);
+            auto entry = cache.Add(MakeKey(static_cast<uint16_t>(iteration), bytesPerPixel), 0, 0, width, height, coverage);
+
+            // The bitmap, with guard pixels before and after it.
+            std::vector<uint32_t> buffer(guardSize + (bitmapWidth * bitmapHeight) + guardSize, guardPixel);
+            uint32_t* pixels = buffer.data() + guardSize;
+            for (size_t i = 0; i < bitmapWidth * bitmapHeight; i++)
+            {
+                pixels[i] = 0xFF000000 | (static_cast<uint32_t>(byteValue(random)) << 16) | (static_cast<uint32_t>(byteValue(random)) << 8) | static_cast<uint32_t>(byteValue(random));
+            }
+            std::vector<uint32_t> original(pixels, pixels + (bitmapWidth * bitmapHeight));
+
+            int32_t x = position(random);
+            int32_t y = position(random);
+            blender.Blend(pixels, bitmapWidth, bitmapHeight, x, y, cache, *entry);
+
+            for (size_t i = 0; i < guardSize; i++)
+            {
+                isInBounds &= buffer[i] == guardPixel && buffer[buffer.size() - 1 - i] == guardPixel;
+            }
+
+            for (int32_t row = 0; row < static_cast<int32_t>(bitmapHeight); row++)
+            {
+                for (int32_t column = 0; column < static_cast<int32_t>(bitmapWidth); column++)
+                {
+                    uint32_t before = original[row * bitmapWidth + column];
+                    uint32_t after = pixels[row * bitmapWidth + column];
+
+                    int32_t glyphColumn = column - x;
+                    int32_t glyphRow = row - y;
+                    if (glyphColumn < 0 || glyphRow < 0 || glyphColumn >= static_cast<int32_t>(width) || glyphRow >= static_cast<int32_t>(height))
+                    {
+                        isInBounds &= before == after;
+                        continue;
+                    }
+
+                    uint8_t const* subpixels = cache.GetCoverageRow(*entry, glyphRow) + (glyphColumn * 3);
+                    if ((subpixels[0] | subpixels[1] | subpixels[2]) == 0)
+                    {
+                        isInBounds &= before == after;
+                        continue;
+                    }
+
+                    for (size_t channel = 0; channel < 3; channel++)
+                    {
+                        int shift = 16 - static_cast<int>(channel * 8);
+                        uint8_t expected = ReferenceBlend(parameters, textColor, entry->isClearType, subpixels, channel, static_cast<uint8_t>(before >> shift));
+                        maxError = std::max(maxError, std::abs(static_cast<int>(static_cast<uint8_t>(after >> shift)) - expected));
+                    }
+                    isInBounds &= (after >> 24) == (before >> 24);
+                }
+            }
+        }
+
+        Check(isInBounds, "blending only changes covered pixels inside the bitmap");
+        return maxError;
+    }
+
+    void CheckBlendProperties()
+    {
+        GlyphCache cache;
+        std::vector<uint8_t> coverage = { 255, 255, 255, 0, 128, 255 };
+        auto entry = cache.Add(MakeKey(1), 0, 0, 2, 1, coverage);
+
+        // Full coverage gives exactly the text color, whatever the gamma.
+        GlyphBlender blender{ { 2.2f, 1.0f, 1.0f, 1.0f, false } };
+        blender.SetTextColor(10, 20, 30);
+        uint32_t pixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        blender.Blend(pixels, 2, 1, 0, 0, cache, *entry);
+        Check(pixels[0] == 0xFF0A141E, "full coverage gives the text color");
+
+        // The second pixel covers blue but not red, so in BGR order it's the other way around.
+        GlyphBlender bgrBlender{ { 2.2f, 1.0f, 1.0f, 1.0f, true } };
+        uint32_t rgbPixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        uint32_t bgrPixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        blender.SetTextColor(0, 0, 0);
+        bgrBlender.SetTextColor(0, 0, 0);
+        blender.Blend(rgbPixels, 2, 1, 0, 0, cache, *entry);
+        bgrBlender.Blend(bgrPixels, 2, 1, 0, 0, cache, *entry);
+        Check((rgbPixels[1] & 0xFF0000) == 0xFF0000 && (rgbPixels[1] & 0xFF) == 0, "RGB order blends red by the first subpixel");
+        Check((bgrPixels[1] & 0xFF0000) == 0 && (bgrPixels[1] & 0xFF) == 0xFF, "BGR order blends red by the last subpixel");
+
+        // A ClearType level of zero averages the subpixels.
+        GlyphBlender grayBlender{ { 1.8f, 0.5f, 1.0f, 0.0f, false } };
+        grayBlender.SetTextColor(0, 0, 0);
+        uint32_t grayPixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        grayBlender.Blend(grayPixels, 2, 1, 0, 0, cache, *entry);
+        uint32_t grayPixel = grayPixels[1];
+        Check(((grayPixel >> 16) & 0xFF) == (grayPixel & 0xFF) && ((grayPixel >> 8) & 0xFF) == (grayPixel & 0xFF), "ClearType level zero gives gray");
+
+        // Enhanced contrast darkens dark text, but not light text on a dark background.
+        GlyphBlender plain{ { 1.8f, 0.0f, 0.0f, 1.0f, false } };
+        GlyphBlender contrast{ { 1.8f, 2.0f, 2.0f, 1.0f, false } };
+        uint32_t plainPixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        uint32_t contrastPixels[2] = { 0xFFFFFFFF, 0xFFFFFFFF };
+        plain.Blend(plainPixels, 2, 1, 0, 0, cache, *entry);
+        contrast.Blend(contrastPixels, 2, 1, 0, 0, cache, *entry);
+        Check(((contrastPixels[1] >> 8) & 0xFF) < ((plainPixels[1] >> 8) & 0xFF), "enhanced contrast darkens dark text");
+
+        plain.SetTextColor(255, 255, 255);
+        contrast.SetTextColor(255, 255, 255);
+        plainPixels[1] = 0xFF000000;
+        contrastPixels[1] = 0xFF000000;
+        plain.Blend(plainPixels, 2, 1, 0, 0, cache, *entry);
+        contrast.Blend(contrastPixels, 2, 1, 0, 0, cache, *entry);
+        Check(plainPixels[1] == contrastPixels[1], "enhanced contrast doesn't apply to white text");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs fewer iterations, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t iterationCount = quick ? 2'000 : 50'000;
+
+    std::mt19937 random(42);
+
+    CheckKeys();
+    CheckAtlas(quick ? 2'000 : 20'000, random);
+    CheckBlendProperties();
+
+    const GlyphBlendParameters parameterSets[] =
+    {
+        { 1.0f, 0.0f, 0.0f, 1.0f, false },
+        { 1.8f, 0.5f, 1.0f, 1.0f, false },
+        { 2.2f, 1.0f, 1.0f, 0.5f, true },
+        { 2.2f, 0.0f, 0.0f, 0.0f, false },
+    };
+
+    for (auto const& parameters : parameterSets)
+    {
+        int maxError = CheckBlend(parameters, iterationCount, random);
+        std::cout << "Blend with gamma " << parameters.gamma << ", enhanced contrast " << parameters.enhancedContrast
+            << ", ClearType level " << parameters.clearTypeLevel << (parameters.isBgr ? ", BGR" : ", RGB")
+            << ": largest difference from the reference " << maxError << "\n";
+
+        // The table from linear values has 8192 steps, and at gamma 2.2 its first step is already 4
+        // levels, so the darkest blends can be that far off.
+        Check(maxError <= 4, "blending matches the reference");
+    }
+
+    if (g_failureCount != 0)
+    {
+        std::cerr << g_failureCount << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "All checks passed.\n";
+    return 0;
+}
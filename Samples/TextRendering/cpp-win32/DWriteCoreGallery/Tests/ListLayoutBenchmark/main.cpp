@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Measures the item layout that ListWindow does for a list of 50,000 items of varying heights
+// (like FontFaceListWindow, whose items are as tall as their font's sample text), with the item
+// offsets in PrefixSums as ListWindow keeps them, and by summing item heights as it did before:
+//
+// * Painting: finding the items that intersect a window-sized invalid rect.
+// * Hit testing: finding the item at a y coordinate.
+// * Selection: finding an item's rect.
+//
+// Each operation is done at random scroll positions throughout the list, and the two approaches
+// must give the same results.
+
+#include "PrefixSums.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr int c_windowHeight = 800;
+    constexpr float c_dpiScale = 1.5f;
+
+    struct ItemRect
+    {
+        int top;
+        int bottom;
+
+        bool operator==(ItemRect const&) const = default;
+    };
+
+    // Stands in for the item heights of a derived list, which ListWindow gets through a virtual
+    // GetItemPixelHeight call.
+    struct ListItems
+    {
+        std::vector<float> heights;
+
+        virtual int GetItemPixelHeight(float dpiScale, int itemIndex)
+        {
+            return static_cast<int>(ceilf(heights[itemIndex] * dpiScale));
+        }
+    };
+
+    // What ListWindow did before it kept the item offsets.
+    struct SummingLayout
+    {
+        ListItems& items;
+
+        ItemRect GetItemRect(int itemIndex, int scrollTop)
+        {
+            int top = -scrollTop;
+            for (int i = 0; i < itemIndex; i++)
+            {
+                top += items.GetItemPixelHeight(c_dpiScale, i);
+            }
+            return { top, top + items.GetItemPixelHeight(c_dpiScale, itemIndex) };
+        }
+
+        int ItemIndexFromY(int y, int scrollTop)
+        {
+            int top = -scrollTop;
+            for (int i = 0; i < static_cast<int>(items.heights.size()); i++)
+            {
+                int bottom = top + items.GetItemPixelHeight(c_dpiScale, i);
+                if (bottom > y)
+                {
+                    return i;
+                }
+                top = bottom;
+            }
+            return -1;
+        }
+
+        // Returns the indices of the items that would be drawn.
+        void GetPaintedItems(int scrollTop, std::vector<int>& painted)
+        {
+            painted.clear();
+            int itemTop = -scrollTop;
+            for (int i = 0; i < static_cast<int>(items.heights.size()); i++)
+            {
+                int itemBottom = itemTop + items.GetItemPixelHeight(c_dpiScale, i);
+                if (itemTop < c_windowHeight && itemBottom > 0)
+                {
+                    painted.push_back(i);
+                }
+                itemTop = itemBottom;
+            }
+        }
+    };
+
+    // What ListWindow does now.
+    struct OffsetLayout
+    {
+        PrefixSums itemOffsets;
+
+        explicit OffsetLayout(ListItems& items)
+        {
+            std::vector<int> itemHeights(items.heights.size());
+            for (int i = 0; i < static_cast<int>(itemHeights.size()); i++)
+            {
+                itemHeights[i] = items.GetItemPixelHeight(c_dpiScale, i);
+            }
+            itemOffsets.Assign(itemHeights);
+        }
+
+        ItemRect GetItemRect(int itemIndex, int scrollTop) const
+        {
+            int top = itemOffsets.GetPrefixSum(itemIndex) - scrollTop;
+            return { top, top + itemOffsets.GetValue(itemIndex) };
+        }
+
+        int ItemIndexFromY(int y, int scrollTop) const
+        {
+            int i = itemOffsets.FindIndex(y + scrollTop);
+            return (i < itemOffsets.GetCount()) ? i : -1;
+        }
+
+        void GetPaintedItems(int scrollTop, std::vector<int>& painted) const
+        {
+            painted.clear();
+            int firstIndex = itemOffsets.FindIndex(scrollTop);
+            int itemTop = itemOffsets.GetPrefixSum(firstIndex) - scrollTop;
+            for (int i = firstIndex; i < itemOffsets.GetCount() && itemTop < c_windowHeight; i++)
+            {
+                int itemBottom = itemTop + itemOffsets.GetValue(i);
+                if (itemBottom > 0)
+                {
+                    painted.push_back(i);
+                }
+                itemTop = itemBottom;
+            }
+        }
+    };
+
+    template<class TCallback>
+    double MeasureMicroseconds(size_t operationCount, TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations * operationCount);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick uses a smaller list and only checks the results, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    int itemCount = quick ? 5'000 : 50'000;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> itemHeight(18.0f, 60.0f);
+
+    ListItems items;
+    for (int i = 0; i < itemCount; i++)
+    {
+        items.heights.push_back(itemHeight(random));
+    }
+
+    SummingLayout summing{ items };
+    OffsetLayout offsets{ items };
+    int scrollHeight = offsets.itemOffsets.GetTotal();
+
+    // Random scroll positions, y coordinates and items throughout the list.
+    constexpr size_t c_operationCount = 64;
+    std::vector<int> scrollTops(c_operationCount);
+    std::vector<int> ys(c_operationCount);
+    std::vector<int> itemIndices(c_operationCount);
+    for (size_t i = 0; i < c_operationCount; i++)
+    {
+        scrollTops[i] = std::uniform_int_distribution<int>(0, scrollHeight - c_windowHeight)(random);
+        ys[i] = std::uniform_int_distribution<int>(0, c_windowHeight - 1)(random);
+        itemIndices[i] = std::uniform_int_distribution<int>(0, itemCount - 1)(random);
+    }
+
+    // Check that both layouts agree.
+    size_t mismatches = 0;
+    std::vector<int> summingPainted;
+    std::vector<int> offsetPainted;
+    for (size_t i = 0; i < c_operationCount; i++)
+    {
+        summing.GetPaintedItems(scrollTops[i], summingPainted);
+        offsets.GetPaintedItems(scrollTops[i], offsetPainted);
+        mismatches += (summingPainted != offsetPainted) ? 1 : 0;
+        mismatches += (summing.ItemIndexFromY(ys[i], scrollTops[i]) != offsets.ItemIndexFromY(ys[i], scrollTops[i])) ? 1 : 0;
+        mismatches += (summing.GetItemRect(itemIndices[i], scrollTops[i]) != offsets.GetItemRect(itemIndices[i], scrollTops[i])) ? 1 : 0;
+    }
+
+    std::cout << itemCount << " items, " << scrollHeight << " pixels tall: " << mismatches << " mismatches\n";
+    if (mismatches != 0)
+    {
+        return 1;
+    }
+
+    if (quick)
+    {
+        return 0;
+    }
+
+    size_t checksum = 0;
+    auto summingPaint = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (auto scrollTop : scrollTops) { summing.GetPaintedItems(scrollTop, summingPainted); checksum += summingPainted.size(); }
+        });
+    auto offsetPaint = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (auto scrollTop : scrollTops) { offsets.GetPaintedItems(scrollTop, offsetPainted); checksum += offsetPainted.size(); }
+        });
+    auto summingHitTest = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (size_t i = 0; i < c_operationCount; i++) { checksum += summing.ItemIndexFromY(ys[i], scrollTops[i]); }
+        });
+    auto offsetHitTest = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (size_t i = 0; i < c_operationCount; i++) { checksum += offsets.ItemIndexFromY(ys[i], scrollTops[i]); }
+        });
+    auto summingItemRect = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (size_t i = 0; i < c_operationCount; i++) { checksum += summing.GetItemRect(itemIndices[i], scrollTops[i]).top; }
+        });
+    auto offsetItemRect = MeasureMicroseconds(c_operationCount, [&]()
+        {
+            for (size_t i = 0; i < c_operationCount; i++) { checksum += offsets.GetItemRect(itemIndices[i], scrollTops[i]).top; }
+        });
+    auto build = MeasureMicroseconds(1, [&]() { OffsetLayout layout{ items }; checksum += layout.itemOffsets.GetTotal(); });
+
+    std::cout << "\nMicroseconds per operation\n\n";
+    std::cout << std::setw(12) << "Operation" << std::setw(12) << "Summing" << std::setw(12) << "Offsets" << std::setw(12) << "Speedup" << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(12) << "Paint" << std::setw(12) << summingPaint << std::setw(12) << offsetPaint << std::setw(11) << std::setprecision(0) << (summingPaint / offsetPaint) << "x\n" << std::setprecision(3);
+    std::cout << std::setw(12) << "Hit test" << std::setw(12) << summingHitTest << std::setw(12) << offsetHitTest << std::setw(11) << std::setprecision(0) << (summingHitTest / offsetHitTest) << "x\n" << std::setprecision(3);
+    std::cout << std::setw(12) << "Item rect" << std::setw(12) << summingItemRect << std::setw(12) << offsetItemRect << std::setw(11) << std::setprecision(0) << (summingItemRect / offsetItemRect) << "x\n" << std::setprecision(3);
+    std::cout << "\nComputing the offsets when the items or DPI scale change: " << build << " microseconds\n";
+    std::cout << "(checksum " << checksum << ")\n";
+    return 0;
+}
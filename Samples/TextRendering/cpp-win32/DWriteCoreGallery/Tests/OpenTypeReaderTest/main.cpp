@@ -0,0 +1,331 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Checks the OpenType reader that FontMetadataCache uses against the fonts bundled with the sample:
+//
+// * The names, OS/2 values, axes and named instances read from each font, and the family and face
+//   names FontFaceListWindow shows for it in each family model.
+// * A collection (TTC) synthesized from the fonts reads the same as the fonts themselves.
+// * Metadata written in the cache format reads back unchanged, and every truncation of it fails.
+// * Truncated and corrupted font files are rejected or read without reading out of bounds. Run
+//   under AddressSanitizer to check the latter.
+
+#include "OpenTypeReader.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    constexpr uint32_t g_weightAxisTag = MakeOpenTypeTag('w', 'g', 'h', 't');
+    constexpr uint32_t g_widthAxisTag = MakeOpenTypeTag('w', 'd', 't', 'h');
+    constexpr uint32_t g_italicAxisTag = MakeOpenTypeTag('i', 't', 'a', 'l');
+    constexpr uint32_t g_slantAxisTag = MakeOpenTypeTag('s', 'l', 'n', 't');
+
+    int g_failureCount = 0;
+
+    void Check(bool condition, std::string_view what, std::string_view context)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << " (" << context << ")\n";
+            ++g_failureCount;
+        }
+    }
+
+    std::u16string ToU16(std::string_view value)
+    {
+        return { value.begin(), value.end() };
+    }
+
+    std::vector<uint8_t> ReadFile(std::string const& name)
+    {
+        std::ifstream file(std::string(SAMPLE_DIR "/") + name, std::ios::binary);
+        return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    }
+
+    struct ExpectedFont
+    {
+        char const* fileName;
+        char const* typographicFamilyName;
+        char const* faceName;
+        char const* fullName;
+        char const* postScriptName;
+        uint16_t weightClass;
+        bool isItalic;
+        size_t namedInstanceCount;
+    };
+
+    const ExpectedFont g_expectedFonts[] =
+    {
+        { "RobotoMono/RobotoMono-VariableFont_wght.ttf", "Roboto Mono", "Regular", "Roboto Mono Regular", "RobotoMono-Regular", 400, false, 5 },
+        { "RobotoMono/RobotoMono-Italic-VariableFont_wght.ttf", "Roboto Mono", "Italic", "Roboto Mono Italic", "RobotoMono-Italic", 400, true, 5 },
+        { "SourceSansPro/SourceSansPro-Regular.ttf", "Source Sans Pro", "Regular", "Source Sans Pro Regular", "SourceSansPro-Regular", 400, false, 0 },
+        { "SourceSansPro/SourceSansPro-Italic.ttf", "Source Sans Pro", "Italic", "Source Sans Pro Italic", "SourceSansPro-Italic", 400, true, 0 },
+        { "SourceSansPro/SourceSansPro-Bold.ttf", "Source Sans Pro", "Bold", "Source Sans Pro Bold", "SourceSansPro-Bold", 700, false, 0 },
+        { "SourceSansPro/SourceSansPro-BoldItalic.ttf", "Source Sans Pro", "Bold Italic", "Source Sans Pro Bold Italic", "SourceSansPro-BoldItalic", 700, true, 0 },
+    };
+
+    float FindValue(std::vector<OpenTypeAxisValue> const& axisValues, uint32_t tag)
+    {
+        for (auto const& axisValue : axisValues)
+        {
+            if (axisValue.tag == tag)
+            {
+                return axisValue.value;
+            }
+        }
+        return -1.0f;
+    }
+
+    void CheckFont(ExpectedFont const& expected, FontFaceMetadata const& metadata)
+    {
+        std::string_view context = expected.fileName;
+
+        Check(!metadata.isCollection, "not a collection", context);
+        Check(metadata.weightClass == expected.weightClass, "weight class", context);
+        Check(((metadata.fsSelection & 1) != 0) == expected.isItalic, "italic bit", context);
+        Check(metadata.GetName({ OpenTypeNameId_FamilyName }) == ToU16(expected.typographicFamilyName), "family name", context);
+        Check(metadata.GetName({ OpenTypeNameId_FullName }) == ToU16(expected.fullName), "full name", context);
+        Check(metadata.GetName({ OpenTypeNameId_PostScriptName }) == ToU16(expected.postScriptName), "PostScript name", context);
+
+        // None of these fonts has typographic or WWS names, so both family models use name IDs 1 and 2.
+        for (auto familyModel : { FontFamilyModel::Typographic, FontFamilyModel::WeightStretchStyle })
+        {
+            Check(metadata.GetFamilyName(familyModel) == ToU16(expected.typographicFamilyName), "family name in family model", context);
+            Check(metadata.GetFaceName(familyModel) == ToU16(expected.faceName), "face name in family model", context);
+        }
+
+        // Descriptive strings aren't kept.
+        Check(metadata.FindName(0) == nullptr && metadata.FindName(13) == nullptr, "copyright and license are dropped", context);
+
+        Check(metadata.namedInstances.size() == expected.namedInstanceCount, "named instance count", context);
+        auto defaultValues = metadata.GetDefaultAxisValues();
+        if (expected.namedInstanceCount != 0)
+        {
+            Check(metadata.axes.size() == 1 && metadata.axes[0].tag == g_weightAxisTag, "weight axis", context);
+            Check(metadata.axes[0].minValue == 100 && metadata.axes[0].defaultValue == 400 && metadata.axes[0].maxValue == 700, "weight axis range", context);
+            Check(defaultValues.size() == 1 && FindValue(defaultValues, g_weightAxisTag) == 400, "default axis values", context);
+
+            // The bold instance, and the default instance when no values are given.
+            OpenTypeAxisValue bold{ g_weightAxisTag, 700 };
+            auto instance = metadata.FindNamedInstance({ &bold, 1 });
+            Check(instance != nullptr && metadata.GetName({ instance->subfamilyNameId }) == ToU16(expected.isItalic ? "Bold Italic" : "Bold"), "bold instance name", context);
+            Check(instance != nullptr && metadata.GetName({ instance->postScriptNameId }).ends_with(ToU16(expected.isItalic ? "-BoldItalic" : "-Bold")), "bold instance PostScript name", context);
+
+            instance = metadata.FindNamedInstance({});
+            Check(instance != nullptr && instance->coordinates[0] == 400, "default instance", context);
+
+            OpenTypeAxisValue between{ g_weightAxisTag, 650 };
+            Check(metadata.FindNamedInstance({ &between, 1 }) == nullptr, "no instance between named instances", context);
+        }
+        else
+        {
+            Check(metadata.axes.empty(), "no axes", context);
+            Check(FindValue(defaultValues, g_weightAxisTag) == expected.weightClass, "default weight", context);
+            Check(FindValue(defaultValues, g_widthAxisTag) == 100, "default width", context);
+            Check(FindValue(defaultValues, g_italicAxisTag) == (expected.isItalic ? 1 : 0), "default italic", context);
+            Check(FindValue(defaultValues, g_slantAxisTag) == 0, "default slant", context);
+        }
+    }
+
+    void CheckNamePolicy()
+    {
+        auto makeMetadata = [](std::initializer_list<std::pair<uint16_t, char const*>> names)
+        {
+            FontFaceMetadata metadata;
+            for (auto const& [nameId, value] : names)
+            {
+                metadata.names.push_back({ nameId, ToU16(value) });
+            }
+            return metadata;
+        };
+
+        // A weight that only the typographic names group with the rest of the family.
+        auto semibold = makeMetadata({ { 1, "Segoe UI Semibold" }, { 2, "Regular" }, { 16, "Segoe UI" }, { 17, "Semibold" } });
+        Check(semibold.GetFamilyName(FontFamilyModel::Typographic) == u"Segoe UI", "typographic family", "Segoe UI Semibold");
+        Check(semibold.GetFaceName(FontFamilyModel::Typographic) == u"Semibold", "typographic face", "Segoe UI Semibold");
+        Check(semibold.GetFamilyName(FontFamilyModel::WeightStretchStyle) == u"Segoe UI", "WSS family", "Segoe UI Semibold");
+        Check(semibold.GetFaceName(FontFamilyModel::WeightStretchStyle) == u"Semibold", "WSS face", "Segoe UI Semibold");
+
+        // An optical size, which the WWS names keep in the family name.
+        auto sitka = makeMetadata({ { 1, "Sitka Small" }, { 2, "Regular" }, { 16, "Sitka" }, { 17, "Small" }, { 21, "Sitka Small" }, { 22, "Regular" } });
+        Check(sitka.GetFamilyName(FontFamilyModel::Typographic) == u"Sitka", "typographic family", "Sitka Small");
+        Check(sitka.GetFaceName(FontFamilyModel::Typographic) == u"Small", "typographic face", "Sitka Small");
+        Check(sitka.GetFamilyName(FontFamilyModel::WeightStretchStyle) == u"Sitka Small", "WSS family", "Sitka Small");
+        Check(sitka.GetFaceName(FontFamilyModel::WeightStretchStyle) == u"Regular", "WSS face", "Sitka Small");
+
+        // The elided fallback name stands in for a missing subfamily name in the typographic model.
+        auto elided = makeMetadata({ { 1, "Variable" }, { 256, "Normal" } });
+        elided.elidedFallbackNameId = 256;
+        Check(elided.GetFaceName(FontFamilyModel::Typographic) == u"Normal", "elided fallback name", "Variable");
+    }
+
+    // Builds a collection from single fonts, moving each font's tables by the offset of its copy.
+    std::vector<uint8_t> MakeCollection(std::vector<std::vector<uint8_t>> const& fonts)
+    {
+        auto putUInt32 = [](std::vector<uint8_t>& data, size_t offset, uint32_t value)
+        {
+            for (size_t i = 0; i < 4; i++)
+            {
+                data[offset + i] = static_cast<uint8_t>(value >> (24 - (i * 8)));
+            }
+        };
+
+        std::vector<uint8_t> collection(12 + (fonts.size() * 4));
+        collection[0] = 't';
+        collection[1] = 't';
+        collection[2] = 'c';
+        collection[3] = 'f';
+        putUInt32(collection, 4, 0x00010000);
+        putUInt32(collection, 8, static_cast<uint32_t>(fonts.size()));
+
+        for (size_t i = 0; i < fonts.size(); i++)
+        {
+            collection.resize((collection.size() + 3) & ~size_t{ 3 });
+            auto fontOffset = static_cast<uint32_t>(collection.size());
+            putUInt32(collection, 12 + (i * 4), fontOffset);
+            collection.insert(collection.end(), fonts[i].begin(), fonts[i].end());
+
+            size_t tableCount = (fonts[i][4] << 8) | fonts[i][5];
+            for (size_t table = 0; table < tableCount; table++)
+            {
+                size_t recordOffset = fontOffset + 12 + (table * 16) + 8;
+                uint32_t tableOffset = 0;
+                for (size_t byte = 0; byte < 4; byte++)
+                {
+                    tableOffset = (tableOffset << 8) | collection[recordOffset + byte];
+                }
+                putUInt32(collection, recordOffset, tableOffset + fontOffset);
+            }
+        }
+
+        return collection;
+    }
+
+    void CheckSerialization(FontFaceMetadata const& metadata, std::string_view context)
+    {
+        std::vector<uint8_t> buffer;
+        BinaryWriter writer{ buffer };
+        WriteFontFaceMetadata(writer, metadata);
+
+        FontFaceMetadata roundTrip;
+        BinaryReader reader{ buffer };
+        Check(ReadFontFaceMetadata(reader, roundTrip) && roundTrip == metadata, "cache format round trip", context);
+        Check(reader.GetRemaining().empty(), "cache format reads all input", context);
+
+        for (size_t length = 0; length < buffer.size(); length++)
+        {
+            BinaryReader truncatedReader{ std::span<uint8_t const>{ buffer.data(), length } };
+            if (ReadFontFaceMetadata(truncatedReader, roundTrip))
+            {
+                Check(false, "truncated cache data is rejected", context);
+                break;
+            }
+        }
+    }
+
+    // Parses truncated and corrupted copies of a font. Any result is acceptable as long as nothing
+    // outside the data is read, which AddressSanitizer checks, and the reader doesn't crash.
+    size_t ParseDamagedFont(std::vector<uint8_t> const& font, size_t corruptionCount, std::mt19937& random)
+    {
+        size_t parsedCount = 0;
+        FontFaceMetadata metadata;
+
+        // Every truncation within the table directory, and a spread of them through the tables.
+        size_t directoryEnd = 12 + (((font[4] << 8) | font[5]) * size_t{ 16 });
+        for (size_t length = 0; length < font.size(); length += (length < directoryEnd) ? 1 : 97)
+        {
+            std::vector<uint8_t> truncated(font.begin(), font.begin() + length);
+            parsedCount += ParseFontFaceMetadata(truncated, 0, metadata) ? 1 : 0;
+        }
+
+        // Random bytes overwritten, mostly in the table directory and the tables that are read.
+        std::vector<uint8_t> corrupted;
+        std::uniform_int_distribution<size_t> directoryOffset(0, directoryEnd - 1);
+        std::uniform_int_distribution<size_t> fileOffset(0, font.size() - 1);
+        std::uniform_int_distribution<int> byteValue(0, 255);
+        for (size_t i = 0; i < corruptionCount; i++)
+        {
+            corrupted = font;
+            for (int j = 0; j < 4; j++)
+            {
+                corrupted[(j == 0) ? directoryOffset(random) : fileOffset(random)] = static_cast<uint8_t>(byteValue(random));
+            }
+            parsedCount += ParseFontFaceMetadata(corrupted, 0, metadata) ? 1 : 0;
+        }
+
+        return parsedCount;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick corrupts fewer copies of each font, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t corruptionCount = quick ? 2'000 : 100'000;
+
+    std::mt19937 random(42);
+
+    CheckNamePolicy();
+
+    std::vector<std::vector<uint8_t>> fonts;
+    std::vector<FontFaceMetadata> fontMetadata;
+    for (auto const& expected : g_expectedFonts)
+    {
+        auto font = ReadFile(expected.fileName);
+        if (font.empty())
+        {
+            Check(false, "font file exists", expected.fileName);
+            continue;
+        }
+
+        FontFaceMetadata metadata;
+        Check(GetOpenTypeFaceCount(font) == 1, "face count", expected.fileName);
+        Check(ParseFontFaceMetadata(font, 0, metadata), "font parses", expected.fileName);
+        Check(!ParseFontFaceMetadata(font, 1, metadata) && metadata.names.empty(), "no second face", expected.fileName);
+        Check(ParseFontFaceMetadata(font, 0, metadata), "font parses again", expected.fileName);
+
+        CheckFont(expected, metadata);
+        CheckSerialization(metadata, expected.fileName);
+
+        size_t parsedCount = ParseDamagedFont(font, corruptionCount, random);
+        std::cout << expected.fileName << ": " << metadata.names.size() << " names, " << metadata.axes.size() << " axes, "
+            << metadata.namedInstances.size() << " named instances; " << parsedCount << " damaged copies parsed\n";
+
+        fonts.push_back(std::move(font));
+        fontMetadata.push_back(std::move(metadata));
+    }
+
+    // A collection of all the fonts reads the same as each font.
+    auto collection = MakeCollection(fonts);
+    Check(GetOpenTypeFaceCount(collection) == fonts.size(), "collection face count", "collection");
+    for (size_t i = 0; i < fonts.size(); i++)
+    {
+        FontFaceMetadata metadata;
+        Check(ParseFontFaceMetadata(collection, static_cast<uint32_t>(i), metadata), "collection face parses", g_expectedFonts[i].fileName);
+
+        Check(metadata.isCollection, "collection face is in a collection", g_expectedFonts[i].fileName);
+        metadata.isCollection = false;
+        Check(metadata == fontMetadata[i], "collection face matches font", g_expectedFonts[i].fileName);
+    }
+
+    FontFaceMetadata metadata;
+    Check(!ParseFontFaceMetadata(collection, static_cast<uint32_t>(fonts.size()), metadata), "face past the end of a collection", "collection");
+
+    // Not a font at all.
+    std::vector<uint8_t> text(1000, 'a');
+    Check(GetOpenTypeFaceCount(text) == 0 && !ParseFontFaceMetadata(text, 0, metadata), "non-font data is rejected", "text");
+
+    if (g_failureCount != 0)
+    {
+        std::cerr << g_failureCount << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "All checks passed.\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Compares parsing a pseudo-Markdown document with TokenizePseudoMarkdownBlock and
+// ConvertUtf8ToUtf16 (as MarkdownWindow does) against the character-at-a-time parser it replaced,
+// which converted each run of text separately. The documents are the sample's own markdown files,
+// repeated to about a megabyte, as they are and with non-ASCII text added to every line. Fails if
+// the two parsers produce different blocks.
+
+#include "PseudoMarkdownReference.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+    std::string ReadFile(char const* name)
+    {
+        std::ifstream file(std::string(SAMPLE_DIR "/") + name, std::ios::binary);
+        return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    }
+
+    std::string AddNonAsciiText(std::string_view document)
+    {
+        // Add the text to the end of every line that isn't blank, so that the blocks are unchanged.
+        std::string result;
+        for (auto ch : document)
+        {
+            if (ch == '\n' && !result.empty() && result.back() != '\n' && result.back() != '\r')
+            {
+                result += " \xCE\x95\xCE\xBB\xCE\xBB\xCE\xB7\xCE\xBD\xCE\xB9\xCE\xBA\xCE\xAC \xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E \xF0\x9F\x98\x80";
+            }
+            result += ch;
+        }
+        return result;
+    }
+
+    template<class TParseBlock>
+    std::vector<MarkdownBlock> ParseDocument(std::string_view document, TParseBlock&& parseBlock)
+    {
+        std::vector<MarkdownBlock> blocks;
+        char const* pos = document.data();
+        char const* end = pos + document.size();
+        while (pos != end)
+        {
+            blocks.push_back(parseBlock(pos, end));
+        }
+        return blocks;
+    }
+
+    template<class TCallback>
+    double MeasureMegabytesPerSecond(size_t bytes, TCallback&& callback)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        callback();
+
+        size_t iterations = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200))
+        {
+            callback();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        }
+
+        return static_cast<double>(bytes * iterations) / 1e6 / std::chrono::duration<double>(elapsed).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick only parses the documents once each, and checks the results, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+
+    std::string documents;
+    for (auto name : { "Introduction.md", "OpticalSize.md", "CustomFontCollection.md", "SystemFontCollectionTypo.md", "SystemFontCollectionWss.md" })
+    {
+        auto document = ReadFile(name);
+        if (document.empty())
+        {
+            std::cerr << "Couldn't read " << name << "\n";
+            return 1;
+        }
+        documents += document;
+        documents += "\n\n";
+    }
+
+    std::string asciiDocument;
+    while (asciiDocument.size() < 1'000'000)
+    {
+        asciiDocument += documents;
+    }
+
+    struct Input
+    {
+        char const* name;
+        std::string document;
+    };
+    Input inputs[] = {
+        { "Sample documents", asciiDocument },
+        { "With non-ASCII text", AddNonAsciiText(asciiDocument) } };
+
+    std::cout << "Parsing pseudo-Markdown, MB/s\n\n";
+    std::cout << std::setw(22) << "Document" << std::setw(10) << "Blocks" << std::setw(12) << "Previous" << std::setw(12) << "Tokenizer"
+        << std::setw(10) << "Speedup" << std::setw(8) << "Same" << "\n";
+
+    bool passed = true;
+    for (auto& input : inputs)
+    {
+        auto blocks = ParseDocument(input.document, ParseBlock);
+        auto referenceBlocks = ParseDocument(input.document, ReferenceParseBlock);
+        bool same = (blocks == referenceBlocks);
+        passed &= same;
+
+        double previous = 0.0;
+        double tokenizer = 0.0;
+        if (!quick)
+        {
+            size_t blockCount = 0;
+            previous = MeasureMegabytesPerSecond(input.document.size(), [&]() { blockCount += ParseDocument(input.document, ReferenceParseBlock).size(); });
+            tokenizer = MeasureMegabytesPerSecond(input.document.size(), [&]() { blockCount += ParseDocument(input.document, ParseBlock).size(); });
+        }
+
+        std::cout << std::setw(22) << input.name << std::setw(10) << blocks.size() << std::fixed << std::setprecision(1)
+            << std::setw(12) << previous << std::setw(12) << tokenizer << std::setw(9) << (quick ? 0.0 : tokenizer / previous) << "x"
+            << std::setw(8) << (same ? "yes" : "NO") << "\n";
+    }
+
+    if (!passed)
+    {
+        std::cerr << "The tokenizer and the previous parser disagree.\n";
+        return 1;
+    }
+
+    return 0;
+}
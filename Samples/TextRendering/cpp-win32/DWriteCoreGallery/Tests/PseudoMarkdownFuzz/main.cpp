@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Fuzzes TokenizePseudoMarkdownBlock and ConvertUtf8ToUtf16 against the reference parser and
+// decoder in PseudoMarkdownReference.h. For any input:
+//
+// - Every block consumes at least one byte, so parsing a document always ends.
+// - Text events are in order, within the input, and only start or end next to ASCII characters
+//   (or the ends of the input), so they never split a UTF-8 sequence.
+// - Tokenizing and converting gives the same blocks as the reference parser.
+// - ConvertUtf8ToUtf16 writes no more code units than there are input bytes, and gives the same
+//   result as the reference decoder.
+//
+// Built with DWRITECOREGALLERY_LIBFUZZER, this is a libFuzzer target. Otherwise it runs its own
+// driver over random inputs made mostly of markup characters and UTF-8 fragments, and over
+// mutations of the sample's markdown documents.
+
+#include "PseudoMarkdownReference.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string_view>
+
+namespace
+{
+    struct CheckingHandler
+    {
+        char const* inputBegin;
+        char const* inputEnd;
+        char const* lastTextEnd;
+        bool isValid = true;
+
+        void Text(char const* begin, char const* end)
+        {
+            // A UTF-8 sequence can only be split between two non-ASCII bytes.
+            auto isBoundary = [&](char const* p)
+            {
+                return (p == inputBegin) || (p == inputEnd) ||
+                    (static_cast<uint8_t>(p[-1]) < 0x80) || (static_cast<uint8_t>(*p) < 0x80);
+            };
+
+            isValid &= (begin >= lastTextEnd) && (begin < end) && (end <= inputEnd);
+            isValid &= isBoundary(begin) && isBoundary(end);
+            lastTextEnd = end;
+        }
+
+        void SoftBreak() {}
+        void ToggleSpan(MarkdownSpanType) {}
+    };
+
+    bool Fail(char const* message, uint8_t const* data, size_t size)
+    {
+        std::cerr << message << " for this input of " << size << " bytes:\n";
+        for (size_t i = 0; i < size; i++)
+        {
+            char hex[4];
+            std::snprintf(hex, sizeof(hex), "%02X ", data[i]);
+            std::cerr << hex;
+        }
+        std::cerr << "\n";
+        return false;
+    }
+
+    bool CheckInput(uint8_t const* data, size_t size)
+    {
+        auto input = reinterpret_cast<char const*>(data);
+        auto inputEnd = input + size;
+
+        // Tokenize, checking the events and progress of each block.
+        char const* pos = input;
+        while (pos != inputEnd)
+        {
+            auto blockStart = pos;
+            CheckingHandler handler{ input, inputEnd, pos };
+            TokenizePseudoMarkdownBlock(pos, inputEnd, handler);
+            if (!handler.isValid)
+            {
+                return Fail("Bad text event", data, size);
+            }
+            if (pos <= blockStart || pos > inputEnd)
+            {
+                return Fail("A block made no progress", data, size);
+            }
+        }
+
+        // Parse with both parsers.
+        pos = input;
+        char const* referencePos = input;
+        while (pos != inputEnd)
+        {
+            auto block = ParseBlock(pos, inputEnd);
+            auto referenceBlock = ReferenceParseBlock(referencePos, inputEnd);
+            if (pos != referencePos || !(block == referenceBlock))
+            {
+                return Fail("The parsers disagree", data, size);
+            }
+        }
+
+        // Convert the whole input.
+        std::u16string converted(size, u'\0');
+        converted.resize(ConvertUtf8ToUtf16(input, size, converted.data()));
+        std::u16string referenceConverted;
+        ReferenceUtf8ToUtf16(input, size, referenceConverted);
+        if (converted != referenceConverted)
+        {
+            return Fail("The decoders disagree", data, size);
+        }
+
+        return true;
+    }
+}
+
+#ifdef PSEUDO_MARKDOWN_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size)
+{
+    if (!CheckInput(data, size))
+    {
+        std::abort();
+    }
+    return 0;
+}
+
+#else
+
+namespace
+{
+    std::string ReadFile(char const* name)
+    {
+        std::ifstream file(std::string(SAMPLE_DIR "/") + name, std::ios::binary);
+        return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    }
+
+    // Bytes that the parser or decoder treat specially, and plain text.
+    constexpr std::string_view c_alphabet =
+        "##``**  \r\n\r\nab"
+        "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"  // Well-formed two, three and four byte sequences.
+        "\x80\xBF\xC0\xC1\xE0\xED\xF4\xF5\xFF"; // Continuation bytes, and lead bytes with limits.
+
+    std::string RandomInput(std::mt19937& random)
+    {
+        std::uniform_int_distribution<size_t> length(0, 64);
+        std::uniform_int_distribution<size_t> symbol(0, c_alphabet.size() - 1);
+
+        std::string input(length(random), ' ');
+        for (auto& ch : input)
+        {
+            ch = c_alphabet[symbol(random)];
+        }
+        return input;
+    }
+
+    std::string MutateInput(std::string input, std::mt19937& random)
+    {
+        std::uniform_int_distribution<size_t> mutationCount(1, 8);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (auto count = mutationCount(random); count > 0; count--)
+        {
+            auto position = std::uniform_int_distribution<size_t>(0, input.size())(random);
+            switch (random() % 3)
+            {
+            case 0:
+                input.insert(input.begin() + position, static_cast<char>(byte(random)));
+                break;
+            case 1:
+                if (position < input.size())
+                {
+                    input.erase(input.begin() + position);
+                }
+                break;
+            default:
+                if (position < input.size())
+                {
+                    input[position] = static_cast<char>(byte(random));
+                }
+                break;
+            }
+        }
+        return input;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // --quick runs fewer inputs, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+    size_t iterations = quick ? 20'000 : 1'000'000;
+
+    std::vector<std::string> documents;
+    for (auto name : { "Introduction.md", "OpticalSize.md", "CustomFontCollection.md", "SystemFontCollectionTypo.md", "SystemFontCollectionWss.md" })
+    {
+        documents.push_back(ReadFile(name));
+        if (documents.back().empty())
+        {
+            std::cerr << "Couldn't read " << name << "\n";
+            return 1;
+        }
+    }
+
+    std::mt19937 random(42);
+    for (size_t i = 0; i < iterations; i++)
+    {
+        auto input = (i % 2 == 0) ? RandomInput(random) : MutateInput(documents[(i / 2) % documents.size()], random);
+        if (!CheckInput(reinterpret_cast<uint8_t const*>(input.data()), input.size()))
+        {
+            return 1;
+        }
+    }
+
+    std::cout << iterations << " inputs passed\n";
+    return 0;
+}
+
+#endif
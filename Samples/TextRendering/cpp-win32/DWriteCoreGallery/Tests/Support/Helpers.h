@@ -0,0 +1,9 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// Stands in for the sample's Helpers.h, alongside Support/Main.h. Each test that builds a source
+// including it defines the functions it uses, with fakes that record their calls.
+
+wil::com_ptr<IDWriteTextLayout4> CreateTextLayout(IDWriteTextFormat3* textFormat, std::span<wchar_t const> text);
@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// Stands in for the sample's Main.h when building sources that use DirectWrite only through a few
+// interface methods, such as TextLayoutCache, into the tests. It declares fake DirectWrite
+// interfaces that count their references, and just enough of WIL to hold them. See Tests/readme.md.
+
+// C++ Standard headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Windows types and macros
+using HRESULT = int32_t;
+constexpr HRESULT S_OK = 0;
+
+#define FAILED(hr) ((hr) < 0)
+#define THROW_IF_FAILED(expression) \
+    do { if (FAILED(expression)) { throw std::runtime_error(#expression); } } while (0)
+#define UNREFERENCED_PARAMETER(parameter) ((void)(parameter))
+
+// SAL annotations
+#define _In_
+#define _In_z_
+#define _Out_
+
+/// <summary>
+/// Reference counting for the fake DirectWrite interfaces. Objects are created with a count of one
+/// and delete themselves when it drops to zero.
+/// </summary>
+class FakeUnknown
+{
+public:
+    virtual ~FakeUnknown() = default;
+
+    uint32_t AddRef() noexcept { return ++m_refCount; }
+
+    uint32_t Release() noexcept
+    {
+        uint32_t refCount = --m_refCount;
+        if (refCount == 0)
+        {
+            delete this;
+        }
+        return refCount;
+    }
+
+    uint32_t GetRefCount() const noexcept { return m_refCount; }
+
+private:
+    uint32_t m_refCount = 1;
+};
+
+struct IDWriteTextFormat3 : FakeUnknown
+{
+};
+
+struct IDWriteTextLayout4 : FakeUnknown
+{
+    IDWriteTextFormat3* textFormat = nullptr;
+    std::wstring text;
+    float maxWidth = 0;
+
+    HRESULT SetMaxWidth(float value) noexcept
+    {
+        maxWidth = value;
+        return S_OK;
+    }
+};
+
+namespace wil
+{
+    /// <summary>
+    /// The parts of wil::com_ptr the tested sources use.
+    /// </summary>
+    template<class T>
+    class com_ptr
+    {
+    public:
+        com_ptr() noexcept = default;
+
+        com_ptr(T* pointer) noexcept : m_pointer{ pointer }
+        {
+            if (m_pointer != nullptr)
+            {
+                m_pointer->AddRef();
+            }
+        }
+
+        com_ptr(com_ptr const& other) noexcept : com_ptr{ other.m_pointer }
+        {
+        }
+
+        com_ptr(com_ptr&& other) noexcept : m_pointer{ std::exchange(other.m_pointer, nullptr) }
+        {
+        }
+
+        ~com_ptr()
+        {
+            if (m_pointer != nullptr)
+            {
+                m_pointer->Release();
+            }
+        }
+
+        com_ptr& operator=(com_ptr other) noexcept
+        {
+            std::swap(m_pointer, other.m_pointer);
+            return *this;
+        }
+
+        // Takes ownership of a pointer that already holds a reference, as wil::com_ptr::attach does.
+        void attach(T* pointer) noexcept
+        {
+            com_ptr old;
+            old.m_pointer = std::exchange(m_pointer, pointer);
+        }
+
+        T* get() const noexcept { return m_pointer; }
+        T* operator->() const noexcept { return m_pointer; }
+        explicit operator bool() const noexcept { return m_pointer != nullptr; }
+
+    private:
+        T* m_pointer = nullptr;
+    };
+}
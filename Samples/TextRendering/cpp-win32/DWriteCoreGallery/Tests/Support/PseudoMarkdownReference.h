@@ -0,0 +1,300 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// Reference implementations for testing PseudoMarkdown.h: the character-at-a-time parser that
+// MarkdownWindow used before TokenizePseudoMarkdownBlock, and a UTF-8 decoder written directly
+// from the well-formed byte sequence table of the Unicode standard (Table 3-7). Both produce the
+// same output as ParsePseudoMarkdownBlock, with char16_t in place of wchar_t and pairs of
+// { start, length } in place of DWRITE_TEXT_RANGE, so that they build on any platform.
+
+#include "PseudoMarkdown.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using TextRange = std::pair<uint32_t, uint32_t>;
+
+struct MarkdownBlock
+{
+    MarkdownBlockType type = MarkdownBlockType::Body;
+    std::u16string text;
+    std::vector<TextRange> boldRanges;
+    std::vector<TextRange> italicRanges;
+    std::vector<TextRange> codeRanges;
+
+    bool operator==(MarkdownBlock const&) const = default;
+};
+
+/// <summary>
+/// Decodes UTF-8, replacing each maximal subpart of an ill-formed sequence with U+FFFD.
+/// </summary>
+inline void ReferenceUtf8ToUtf16(char const* input, size_t inputLength, std::u16string& output)
+{
+    auto bytes = reinterpret_cast<uint8_t const*>(input);
+    size_t i = 0;
+    while (i < inputLength)
+    {
+        uint8_t lead = bytes[i];
+        if (lead < 0x80)
+        {
+            output += static_cast<char16_t>(lead);
+            i++;
+            continue;
+        }
+
+        // The sequence length, and the range of the second byte, from Table 3-7.
+        size_t length = 0;
+        uint8_t secondLow = 0x80;
+        uint8_t secondHigh = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) { length = 2; }
+        else if (lead == 0xE0) { length = 3; secondLow = 0xA0; }
+        else if ((lead >= 0xE1 && lead <= 0xEC) || lead == 0xEE || lead == 0xEF) { length = 3; }
+        else if (lead == 0xED) { length = 3; secondHigh = 0x9F; }
+        else if (lead == 0xF0) { length = 4; secondLow = 0x90; }
+        else if (lead >= 0xF1 && lead <= 0xF3) { length = 4; }
+        else if (lead == 0xF4) { length = 4; secondHigh = 0x8F; }
+
+        // The number of bytes, starting with the lead byte, that could begin a well-formed sequence.
+        size_t valid = 1;
+        while (length != 0 && valid < length && i + valid < inputLength)
+        {
+            uint8_t byte = bytes[i + valid];
+            uint8_t low = (valid == 1) ? secondLow : 0x80;
+            uint8_t high = (valid == 1) ? secondHigh : 0xBF;
+            if (byte < low || byte > high)
+            {
+                break;
+            }
+            valid++;
+        }
+
+        if (length == 0 || valid < length)
+        {
+            output += u'\xFFFD';
+            i += valid;
+            continue;
+        }
+
+        uint32_t codePoint = lead & (0x7F >> length);
+        for (size_t j = 1; j < length; j++)
+        {
+            codePoint = (codePoint << 6) | (bytes[i + j] & 0x3F);
+        }
+
+        if (codePoint >= 0x10000)
+        {
+            output += static_cast<char16_t>(0xD800 + ((codePoint - 0x10000) >> 10));
+            output += static_cast<char16_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+        }
+        else
+        {
+            output += static_cast<char16_t>(codePoint);
+        }
+        i += length;
+    }
+}
+
+/// <summary>
+/// Parses one block the way MarkdownWindow did before TokenizePseudoMarkdownBlock: one character
+/// at a time, converting each run of text into a temporary string before appending it.
+/// </summary>
+inline MarkdownBlock ReferenceParseBlock(char const*& inputPos, char const* inputEnd)
+{
+    using namespace PseudoMarkdownDetail;
+
+    MarkdownBlock block;
+    if (inputPos == inputEnd)
+    {
+        return block;
+    }
+
+    char const* pos = inputPos;
+    if (*pos == '#')
+    {
+        block.type = MarkdownBlockType::Heading;
+        pos = SkipSpaces(pos + 1, inputEnd);
+    }
+    else if (*pos == '`')
+    {
+        block.type = MarkdownBlockType::Code;
+        pos = SkipNewLine(FindNewLine(pos, inputEnd), inputEnd);
+    }
+    else
+    {
+        pos = SkipSpaces(pos, inputEnd);
+    }
+
+    char const* outputTextPos = pos;
+    auto AddText = [&]()
+    {
+        if (pos > outputTextPos)
+        {
+            std::u16string converted;
+            ReferenceUtf8ToUtf16(outputTextPos, static_cast<size_t>(pos - outputTextPos), converted);
+            block.text += converted;
+        }
+        outputTextPos = pos;
+    };
+
+    struct InlineSpan
+    {
+        std::vector<TextRange>& textRanges;
+        uint32_t startPos;
+        bool isInSpan;
+
+        void ProcessMarkup(std::u16string const& text)
+        {
+            if (!isInSpan)
+            {
+                startPos = static_cast<uint32_t>(text.size());
+            }
+            else
+            {
+                textRanges.push_back({ startPos, static_cast<uint32_t>(text.size() - startPos) });
+            }
+            isInSpan = !isInSpan;
+        }
+    };
+    InlineSpan boldSpan = { block.boldRanges, 0, false };
+    InlineSpan italicSpan = { block.italicRanges, 0, false };
+    InlineSpan codeSpan = { block.codeRanges, 0, false };
+
+    auto blockEnd = inputEnd;
+    while (pos != blockEnd)
+    {
+        switch (*pos)
+        {
+        case '\r':
+        case '\n':
+            AddText();
+            pos = SkipNewLine(pos + 1, blockEnd);
+
+            if (block.type == MarkdownBlockType::Code)
+            {
+                if (pos < blockEnd && *pos == '`')
+                {
+                    pos = SkipNewLine(FindNewLine(pos, blockEnd), blockEnd);
+                    outputTextPos = pos;
+                    blockEnd = pos;
+                }
+            }
+            else
+            {
+                outputTextPos = pos;
+                while (pos < blockEnd && (*pos == '\r' || *pos == '\n'))
+                {
+                    ++pos;
+                }
+
+                if (block.type == MarkdownBlockType::Heading || pos > outputTextPos)
+                {
+                    outputTextPos = pos;
+                    blockEnd = pos;
+                }
+                else if (!block.text.empty() && block.text.back() != u' ')
+                {
+                    block.text += u' ';
+                }
+            }
+            break;
+
+        case '*':
+            if (block.type == MarkdownBlockType::Body)
+            {
+                AddText();
+                if (pos + 1 < blockEnd && pos[1] == '*')
+                {
+                    pos += 2;
+                    boldSpan.ProcessMarkup(block.text);
+                }
+                else
+                {
+                    pos++;
+                    italicSpan.ProcessMarkup(block.text);
+                }
+                outputTextPos = pos;
+            }
+            else
+            {
+                ++pos;
+            }
+            break;
+
+        case '`':
+            if (block.type == MarkdownBlockType::Body)
+            {
+                AddText();
+                pos++;
+                codeSpan.ProcessMarkup(block.text);
+                outputTextPos = pos;
+            }
+            else
+            {
+                ++pos;
+            }
+            break;
+
+        default:
+            ++pos;
+            break;
+        }
+    }
+
+    AddText();
+    inputPos = pos;
+    return block;
+}
+
+/// <summary>
+/// Receives TokenizePseudoMarkdownBlock events and builds a MarkdownBlock, the way
+/// MarkdownWindow's MarkdownBlockBuilder does.
+/// </summary>
+struct MarkdownBlockBuilder
+{
+    MarkdownBlock& block;
+    uint32_t spanStarts[3] = {};
+    bool isInSpan[3] = {};
+
+    void Text(char const* begin, char const* end)
+    {
+        size_t destIndex = block.text.size();
+        size_t maxLength = static_cast<size_t>(end - begin);
+        block.text.resize(destIndex + maxLength);
+        block.text.resize(destIndex + ConvertUtf8ToUtf16(begin, maxLength, block.text.data() + destIndex));
+    }
+
+    void SoftBreak()
+    {
+        if (!block.text.empty() && block.text.back() != u' ')
+        {
+            block.text += u' ';
+        }
+    }
+
+    void ToggleSpan(MarkdownSpanType spanType)
+    {
+        auto index = static_cast<size_t>(spanType);
+        if (!isInSpan[index])
+        {
+            spanStarts[index] = static_cast<uint32_t>(block.text.size());
+        }
+        else
+        {
+            auto& ranges = (spanType == MarkdownSpanType::Bold) ? block.boldRanges :
+                (spanType == MarkdownSpanType::Italic) ? block.italicRanges : block.codeRanges;
+            ranges.push_back({ spanStarts[index], static_cast<uint32_t>(block.text.size() - spanStarts[index]) });
+        }
+        isInSpan[index] = !isInSpan[index];
+    }
+};
+
+inline MarkdownBlock ParseBlock(char const*& inputPos, char const* inputEnd)
+{
+    MarkdownBlock block;
+    MarkdownBlockBuilder builder{ block };
+    block.type = TokenizePseudoMarkdownBlock(inputPos, inputEnd, builder);
+    return block;
+}
@@ -0,0 +1,232 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// Checks the caching policy of TextLayoutCache without DirectWrite, using the fake text formats and
+// layouts in Support/Main.h:
+//
+// * Layouts are keyed by text format, string and maximum width, and the key owns its string.
+// * The least recently used layout is discarded when the cache is full.
+// * The cache holds a reference to each text format, and releases it along with the entry.
+// * The per-paint counters cover the lookups since the previous paint.
+// * Resizing a font family list reuses the layouts for each rounded trimming width, and prints how
+//   many layouts a resize creates with and without RoundTrimmingWidth.
+
+#include "Main.h"
+#include "Helpers.h"
+#include "TextLayoutCache.h"
+
+#include <iostream>
+
+namespace
+{
+    int g_failureCount = 0;
+    size_t g_createdLayoutCount = 0;
+
+    void Check(bool condition, std::string_view what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << "\n";
+            ++g_failureCount;
+        }
+    }
+
+    wil::com_ptr<IDWriteTextFormat3> CreateTextFormat()
+    {
+        wil::com_ptr<IDWriteTextFormat3> textFormat;
+        textFormat.attach(new IDWriteTextFormat3);
+        return textFormat;
+    }
+
+    void CheckKeys()
+    {
+        TextLayoutCache cache;
+        auto format1 = CreateTextFormat();
+        auto format2 = CreateTextFormat();
+
+        auto layout = cache.GetTextLayout(format1.get(), L"Segoe UI");
+        Check(layout && layout->text == L"Segoe UI" && layout->textFormat == format1.get(), "layout is created for the format and text");
+        Check(layout->maxWidth == 0, "a maximum width of zero isn't set");
+        Check(cache.GetTextLayout(format1.get(), L"Segoe UI").get() == layout.get(), "same key returns the same layout");
+        Check(cache.GetTextLayout(format2.get(), L"Segoe UI").get() != layout.get(), "format is part of the key");
+        Check(cache.GetTextLayout(format1.get(), L"Segoe Print").get() != layout.get(), "text is part of the key");
+
+        auto trimmed = cache.GetTextLayout(format1.get(), L"Segoe UI", 100);
+        Check(trimmed.get() != layout.get() && trimmed->maxWidth == 100, "maximum width is part of the key and is set");
+
+        // The cache keeps its own copy of the string, so the caller's buffer can change.
+        std::wstring buffer = L"Consolas";
+        auto consolas = cache.GetTextLayout(format1.get(), buffer);
+        buffer = L"Calibri!";
+        Check(cache.GetTextLayout(format1.get(), L"Consolas").get() == consolas.get(), "key owns its string");
+
+        auto const& statistics = cache.GetStatistics();
+        Check(statistics.hitCount == 2 && statistics.missCount == 5 && statistics.evictionCount == 0, "hit and miss counts");
+        Check(g_createdLayoutCount == 5, "one layout is created per miss");
+    }
+
+    void CheckEviction()
+    {
+        TextLayoutCache cache{ 3 };
+        auto format = CreateTextFormat();
+
+        auto a = cache.GetTextLayout(format.get(), L"A");
+        cache.GetTextLayout(format.get(), L"B");
+        cache.GetTextLayout(format.get(), L"C");
+
+        // Using A makes B the least recently used entry, which D replaces.
+        Check(cache.GetTextLayout(format.get(), L"A").get() == a.get(), "A is cached");
+        cache.GetTextLayout(format.get(), L"D");
+        Check(cache.GetSize() == 3 && cache.GetStatistics().evictionCount == 1, "one entry is evicted");
+        Check(cache.GetTextLayout(format.get(), L"A").get() == a.get(), "recently used A is kept");
+
+        // The frame counters cover everything so far, and then start again.
+        auto frame = cache.TakeFrameStatistics();
+        Check(frame.hitCount == 2 && frame.missCount == 4 && frame.evictionCount == 1, "first frame counts every lookup");
+        cache.TraceFrameStatistics(L"CheckEviction");
+        frame = cache.TakeFrameStatistics();
+        Check(frame.hitCount == 0 && frame.missCount == 0 && frame.evictionCount == 0, "tracing starts a new frame");
+
+        auto missCount = cache.GetStatistics().missCount;
+        cache.GetTextLayout(format.get(), L"C");
+        cache.GetTextLayout(format.get(), L"D");
+        Check(cache.GetStatistics().missCount == missCount, "C and D are kept");
+        cache.GetTextLayout(format.get(), L"B");
+        Check(cache.GetStatistics().missCount == missCount + 1, "least recently used B was evicted");
+
+        // A capacity of zero still caches the most recent layout.
+        TextLayoutCache tiny{ 0 };
+        auto x = tiny.GetTextLayout(format.get(), L"X");
+        Check(tiny.GetTextLayout(format.get(), L"X").get() == x.get() && tiny.GetSize() == 1, "capacity is at least one");
+    }
+
+    void CheckReferences()
+    {
+        TextLayoutCache cache;
+        auto format = CreateTextFormat();
+        auto rawFormat = format.get();
+
+        auto layout = cache.GetTextLayout(rawFormat, L"Text");
+        Check(rawFormat->GetRefCount() == 2, "cache holds a reference to the format");
+        Check(layout->GetRefCount() == 2, "cache holds a reference to the layout");
+
+        // The format stays alive while it's cached, so its address can't be reused by a new format
+        // and match the old entries.
+        format = {};
+        Check(rawFormat->GetRefCount() == 1, "format is kept alive by the cache");
+        Check(cache.GetTextLayout(rawFormat, L"Text").get() == layout.get(), "entry for the format is still found");
+
+        cache.Clear();
+        Check(cache.GetSize() == 0, "clear removes all entries");
+        Check(layout->GetRefCount() == 1, "clear releases the layouts");
+    }
+
+    void CheckRoundTrimmingWidth()
+    {
+        constexpr float step = TextLayoutCache::c_trimmingWidthStep;
+
+        Check(TextLayoutCache::RoundTrimmingWidth(0.01f) == 0.01f, "narrow widths are unchanged");
+        Check(TextLayoutCache::RoundTrimmingWidth(step - 0.5f) == step - 0.5f, "widths under one step are unchanged");
+        Check(TextLayoutCache::RoundTrimmingWidth(step) == step, "a whole step is unchanged");
+        Check(TextLayoutCache::RoundTrimmingWidth(5 * step + 0.75f) == 5 * step, "widths are rounded down");
+
+        bool isValid = true;
+        float previous = 0;
+        for (float width = 0.01f; width < 2000; width += 0.37f)
+        {
+            float rounded = TextLayoutCache::RoundTrimmingWidth(width);
+            isValid &= rounded > 0 && rounded <= width && width - rounded < step && rounded >= previous;
+            previous = rounded;
+        }
+        Check(isValid, "rounded widths are positive, no wider than the width, within a step of it, and monotonic");
+    }
+
+    // Resizes a simulated FontFamilyListWindow one pixel at a time, drawing the visible family names
+    // at each width as FontFamilyListWindow::DrawItem does, and returns the number of layouts created.
+    size_t SimulateResize(bool roundWidth, float fromWidth, float toWidth, size_t familyCount)
+    {
+        constexpr float leftMargin = 10;
+        constexpr float dpiScale = 1.5f;
+
+        std::vector<std::wstring> familyNames;
+        for (size_t i = 0; i < familyCount; i++)
+        {
+            familyNames.push_back(L"Family " + std::to_wstring(i));
+        }
+
+        TextLayoutCache cache;
+        auto format = CreateTextFormat();
+
+        int fromPixels = static_cast<int>(fromWidth * dpiScale);
+        int toPixels = static_cast<int>(toWidth * dpiScale);
+        int direction = (toPixels > fromPixels) ? 1 : -1;
+        for (int pixelWidth = fromPixels; pixelWidth != toPixels + direction; pixelWidth += direction)
+        {
+            float widthInDips = pixelWidth / dpiScale;
+            float maxWidth = std::max(0.01f, widthInDips - leftMargin);
+            if (roundWidth)
+            {
+                maxWidth = TextLayoutCache::RoundTrimmingWidth(maxWidth);
+            }
+
+            for (auto const& familyName : familyNames)
+            {
+                cache.GetTextLayout(format.get(), familyName, maxWidth);
+            }
+        }
+
+        return static_cast<size_t>(cache.GetStatistics().missCount);
+    }
+
+    void CheckResize(bool quick)
+    {
+        constexpr size_t visibleFamilyCount = 40;
+        float fromWidth = 800;
+        float toWidth = quick ? 600.0f : 200.0f;
+
+        size_t exactCount = SimulateResize(false, fromWidth, toWidth, visibleFamilyCount);
+        size_t roundedCount = SimulateResize(true, fromWidth, toWidth, visibleFamilyCount);
+
+        // Each family gets one layout per step the width passes through, plus one for the initial width.
+        size_t stepCount = static_cast<size_t>((fromWidth - toWidth) / TextLayoutCache::c_trimmingWidthStep) + 2;
+        Check(roundedCount <= visibleFamilyCount * stepCount, "resizing creates one layout per family per step");
+        Check(roundedCount * 4 < exactCount, "rounding the width creates far fewer layouts");
+
+        std::cout << "Resizing a list of " << visibleFamilyCount << " visible families from " << fromWidth << " to " << toWidth
+            << " DIPs at 150% creates " << exactCount << " layouts for each width, and " << roundedCount << " with rounded widths\n";
+    }
+}
+
+wil::com_ptr<IDWriteTextLayout4> CreateTextLayout(IDWriteTextFormat3* textFormat, std::span<wchar_t const> text)
+{
+    ++g_createdLayoutCount;
+
+    auto textLayout = new IDWriteTextLayout4;
+    textLayout->textFormat = textFormat;
+    textLayout->text.assign(text.begin(), text.end());
+
+    wil::com_ptr<IDWriteTextLayout4> result;
+    result.attach(textLayout);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    // --quick simulates a shorter resize, for use as a test.
+    bool quick = (argc > 1) && (std::string_view{ argv[1] } == "--quick");
+
+    CheckKeys();
+    CheckEviction();
+    CheckReferences();
+    CheckRoundTrimmingWidth();
+    CheckResize(quick);
+
+    if (g_failureCount != 0)
+    {
+        std::cerr << g_failureCount << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "All checks passed.\n";
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "Main.h"
+#include "Helpers.h"
+#include "TextLayoutCache.h"
+
+size_t TextLayoutCache::KeyHash::operator()(Key const& key) const noexcept
+{
+    size_t hash = std::hash<std::wstring_view>{}(key.text);
+    hash ^= std::hash<void const*>{}(key.textFormat) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>{}(key.maxWidth) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+wil::com_ptr<IDWriteTextLayout4> TextLayoutCache::GetTextLayout(IDWriteTextFormat3* textFormat, std::wstring_view text, float maxWidth)
+{
+    auto it = m_index.find(Key{ textFormat, text, maxWidth });
+    if (it != m_index.end())
+    {
+        // Move the entry to the front of the list.
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        m_statistics.hitCount++;
+        return it->second->textLayout;
+    }
+
+    m_statistics.missCount++;
+
+    auto textLayout = CreateTextLayout(textFormat, std::span<wchar_t const>(text.data(), text.size()));
+    if (maxWidth != 0)
+    {
+        THROW_IF_FAILED(textLayout->SetMaxWidth(maxWidth));
+    }
+
+    // Discard the least recently used entry if the cache is full.
+    if (m_entries.size() >= m_capacity)
+    {
+        auto& last = m_entries.back();
+        m_index.erase(Key{ last.textFormat.get(), last.text, last.maxWidth });
+        m_entries.pop_back();
+        m_statistics.evictionCount++;
+    }
+
+    m_entries.push_front(Entry{ wil::com_ptr<IDWriteTextFormat3>{ textFormat }, std::wstring{ text }, maxWidth, textLayout });
+
+    auto& entry = m_entries.front();
+    m_index.emplace(Key{ textFormat, entry.text, maxWidth }, m_entries.begin());
+
+    return textLayout;
+}
+
+void TextLayoutCache::Clear() noexcept
+{
+    m_index.clear();
+    m_entries.clear();
+}
+
+TextLayoutCache::Statistics TextLayoutCache::TakeFrameStatistics() noexcept
+{
+    Statistics frameStatistics{
+        m_statistics.hitCount - m_frameStartStatistics.hitCount,
+        m_statistics.missCount - m_frameStartStatistics.missCount,
+        m_statistics.evictionCount - m_frameStartStatistics.evictionCount
+    };
+    m_frameStartStatistics = m_statistics;
+    return frameStatistics;
+}
+
+void TextLayoutCache::TraceFrameStatistics(_In_z_ wchar_t const* cacheName)
+{
+    auto frameStatistics = TakeFrameStatistics();
+
+#ifdef _DEBUG
+    if (frameStatistics.hitCount != 0 || frameStatistics.missCount != 0)
+    {
+        wchar_t buffer[256];
+        swprintf_s(
+            buffer,
+            L"%s: %llu layouts reused, %llu created, %llu evicted, %zu cached\n",
+            cacheName,
+            frameStatistics.hitCount,
+            frameStatistics.missCount,
+            frameStatistics.evictionCount,
+            m_entries.size()
+        );
+        OutputDebugStringW(buffer);
+    }
+#else
+    UNREFERENCED_PARAMETER(cacheName);
+    UNREFERENCED_PARAMETER(frameStatistics);
+#endif
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+/// <summary>
+/// Bounded cache of text layout objects, keyed by text format, string, and maximum width. List
+/// windows draw the same strings on every paint while scrolling, so reusing the layouts avoids
+/// shaping the text again. When the cache is full, the least recently used layout is discarded.
+/// </summary>
+class TextLayoutCache
+{
+public:
+    static constexpr size_t c_defaultCapacity = 1024;
+    static constexpr float c_trimmingWidthStep = 16;
+
+    struct Statistics
+    {
+        uint64_t hitCount = 0;
+        uint64_t missCount = 0;
+        uint64_t evictionCount = 0;
+    };
+
+    explicit TextLayoutCache(size_t capacity = c_defaultCapacity) : m_capacity{ std::max<size_t>(capacity, 1) }
+    {
+    }
+
+    // Disable move and copy, since the index refers to strings owned by the entries.
+    TextLayoutCache(TextLayoutCache const&) = delete;
+    TextLayoutCache& operator=(TextLayoutCache const&) = delete;
+
+    /// <summary>
+    /// Returns a text layout for the specified string, creating one if it is not in the cache.
+    /// </summary>
+    /// <param name="textFormat">Text format of the layout. The cache holds a reference to it, so its identity is stable.</param>
+    /// <param name="text">Text of the layout.</param>
+    /// <param name="maxWidth">Maximum width of the layout in DIPs, or zero for no wrapping or trimming.</param>
+    wil::com_ptr<IDWriteTextLayout4> GetTextLayout(IDWriteTextFormat3* textFormat, std::wstring_view text, float maxWidth = 0);
+
+    void Clear() noexcept;
+
+    size_t GetSize() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    Statistics const& GetStatistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    /// <summary>
+    /// Returns the counters accumulated since the previous call, for reporting them once per paint.
+    /// </summary>
+    Statistics TakeFrameStatistics() noexcept;
+
+    /// <summary>
+    /// In debug builds, writes the counters accumulated since the previous call to the debugger
+    /// output, if the cache was used. Called by list windows after each paint.
+    /// </summary>
+    void TraceFrameStatistics(_In_z_ wchar_t const* cacheName);
+
+    /// <summary>
+    /// Rounds a trimming width down to a multiple of c_trimmingWidthStep DIPs, so that the layouts
+    /// for a width are reused until the width changes by a whole step, rather than created again
+    /// for every pixel while a window is resized. Text is trimmed at most one step early. Widths
+    /// narrower than one step are returned unchanged.
+    /// </summary>
+    static float RoundTrimmingWidth(float maxWidth) noexcept
+    {
+        return (maxWidth < c_trimmingWidthStep) ? maxWidth : floorf(maxWidth / c_trimmingWidthStep) * c_trimmingWidthStep;
+    }
+
+private:
+    struct Key
+    {
+        IDWriteTextFormat3* textFormat;
+        std::wstring_view text;
+        float maxWidth;
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(Key const& key) const noexcept;
+    };
+
+    struct Entry
+    {
+        wil::com_ptr<IDWriteTextFormat3> textFormat;
+        std::wstring text;
+        float maxWidth;
+        wil::com_ptr<IDWriteTextLayout4> textLayout;
+    };
+
+    size_t m_capacity;
+
+    // Entries in most recently used order, and an index into them. The keys in the index refer to
+    // the text of the entries, which does not move because list nodes are never relocated.
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+
+    Statistics m_statistics;
+    Statistics m_frameStartStatistics;
+};
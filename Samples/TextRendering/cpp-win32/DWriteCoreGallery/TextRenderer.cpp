@@ -15,6 +15,19 @@ TextRenderer::TextRenderer(HWND hwnd)
 
     THROW_IF_FAILED(g_factory->CreateRenderingParams(&m_renderingParams));
 
+    // Blend cached glyphs with the same parameters the render target uses to draw text.
+    GlyphBlendParameters blendParameters;
+    blendParameters.gamma = m_renderingParams->GetGamma();
+    blendParameters.enhancedContrast = m_renderingParams->GetEnhancedContrast();
+    blendParameters.clearTypeLevel = m_renderingParams->GetClearTypeLevel();
+    blendParameters.isBgr = m_renderingParams->GetPixelGeometry() == DWRITE_PIXEL_GEOMETRY_BGR;
+    if (auto renderingParams1 = m_renderingParams.try_query<IDWriteRenderingParams1>())
+    {
+        blendParameters.grayscaleEnhancedContrast = renderingParams1->GetGrayscaleEnhancedContrast();
+    }
+    m_glyphBlender = GlyphBlender{ blendParameters };
+    m_glyphBlender.SetTextColor(GetRValue(m_textColor), GetGValue(m_textColor), GetBValue(m_textColor));
+
     wil::com_ptr<IDWriteGdiInterop> gdiInterop;
     THROW_IF_FAILED(g_factory->GetGdiInterop(&gdiInterop));
 
@@ -64,6 +77,35 @@ void TextRenderer::CopyTo(HDC hdcDest, POINT topLeft)
     BitBlt(hdcDest, topLeft.x, topLeft.y, m_logicalPixelSize.cx, m_logicalPixelSize.cy, m_targetHdc, 0, 0, SRCCOPY);
 }
 
+void TextRenderer::TraceFrameStatistics()
+{
+    auto frameStatistics = m_glyphCache.TakeFrameStatistics();
+
+#ifdef _DEBUG
+    if (frameStatistics.hitCount != 0 || frameStatistics.missCount != 0)
+    {
+        wchar_t buffer[256];
+        swprintf_s(
+            buffer,
+            L"TextRenderer: %llu glyphs drawn from the cache, %llu rasterized, %llu atlas resets, %.1f%% hit rate\n",
+            frameStatistics.hitCount,
+            frameStatistics.missCount,
+            frameStatistics.resetCount,
+            frameStatistics.GetHitRate() * 100
+        );
+        OutputDebugStringW(buffer);
+    }
+#else
+    UNREFERENCED_PARAMETER(frameStatistics);
+#endif
+}
+
+void TextRenderer::SetTextColor(int sysColorIndex)
+{
+    m_textColor = GetSysColor(sysColorIndex);
+    m_glyphBlender.SetTextColor(GetRValue(m_textColor), GetGValue(m_textColor), GetBValue(m_textColor));
+}
+
 // IUnknown method
 HRESULT STDMETHODCALLTYPE TextRenderer::QueryInterface(REFIID riid, _COM_Outptr_ void** ppvObject) noexcept
 {
@@ -221,6 +263,12 @@ HRESULT STDMETHODCALLTYPE TextRenderer::DrawGlyphRun(
 {
     try
     {
+        if (orientationAngle == DWRITE_GLYPH_ORIENTATION_ANGLE_0_DEGREES &&
+            TryDrawCachedGlyphRun(baselineOriginX, baselineOriginY, measuringMode, glyphRun))
+        {
+            return S_OK;
+        }
+
         OrientationTransform orientation(
             this,
             orientationAngle,
@@ -245,6 +293,224 @@ HRESULT STDMETHODCALLTYPE TextRenderer::DrawGlyphRun(
     }
 }
 
+uint32_t TextRenderer::GetFontFaceId(IDWriteFontFace* fontFace)
+{
+    // Release the font faces when the atlas is emptied. Numbers are never reused, so any glyphs
+    // cached under a released face's number can never match again.
+    if (m_fontFaceGeneration != m_glyphCache.GetGeneration())
+    {
+        m_fontFaceIds.clear();
+        m_fontFaces.clear();
+        m_fontFaceGeneration = m_glyphCache.GetGeneration();
+    }
+
+    auto [it, inserted] = m_fontFaceIds.try_emplace(fontFace, m_nextFontFaceId);
+    if (inserted)
+    {
+        m_fontFaces.emplace_back(fontFace);
+        m_nextFontFaceId++;
+    }
+    return it->second;
+}
+
+_Ret_maybenull_ GlyphEntry const* TextRenderer::RasterizeGlyph(
+    GlyphKey const& key,
+    DWRITE_GLYPH_RUN const* glyphRun,
+    DWRITE_MEASURING_MODE measuringMode,
+    DWRITE_RENDERING_MODE1 renderingMode,
+    DWRITE_GRID_FIT_MODE gridFitMode
+)
+{
+    uint16_t glyphIndex = key.glyphIndex;
+    float glyphAdvance = 0;
+
+    DWRITE_GLYPH_RUN singleGlyphRun = *glyphRun;
+    singleGlyphRun.glyphCount = 1;
+    singleGlyphRun.glyphIndices = &glyphIndex;
+    singleGlyphRun.glyphAdvances = &glyphAdvance;
+    singleGlyphRun.glyphOffsets = nullptr;
+
+    // The subpixel offset is the translation, so the coverage is relative to the glyph's pixel.
+    DWRITE_MATRIX transform = { key.m11, key.m12, key.m21, key.m22, key.subpixelOffset * 0.25f, 0 };
+
+    bool isClearType = key.bytesPerPixel == 3;
+    auto textureType = isClearType ? DWRITE_TEXTURE_CLEARTYPE_3x1 : DWRITE_TEXTURE_ALIASED_1x1;
+
+    wil::com_ptr<IDWriteGlyphRunAnalysis> analysis;
+    THROW_IF_FAILED(g_factory->CreateGlyphRunAnalysis(
+        &singleGlyphRun,
+        &transform,
+        renderingMode,
+        measuringMode,
+        gridFitMode,
+        isClearType ? DWRITE_TEXT_ANTIALIAS_MODE_CLEARTYPE : DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE,
+        0,
+        0,
+        &analysis
+    ));
+
+    RECT bounds;
+    THROW_IF_FAILED(analysis->GetAlphaTextureBounds(textureType, &bounds));
+
+    uint32_t width = bounds.right > bounds.left ? bounds.right - bounds.left : 0;
+    uint32_t height = bounds.bottom > bounds.top ? bounds.bottom - bounds.top : 0;
+    if (width > GlyphCache::c_maxGlyphSize || height > GlyphCache::c_maxGlyphSize)
+    {
+        return nullptr;
+    }
+
+    m_coverageBuffer.resize(static_cast<size_t>(width) * height * key.bytesPerPixel);
+    if (!m_coverageBuffer.empty())
+    {
+        THROW_IF_FAILED(analysis->CreateAlphaTexture(textureType, &bounds, m_coverageBuffer.data(), static_cast<uint32_t>(m_coverageBuffer.size())));
+    }
+
+    return m_glyphCache.Add(key, bounds.left, bounds.top, width, height, m_coverageBuffer);
+}
+
+bool TextRenderer::TryDrawCachedGlyphRun(
+    float baselineOriginX,
+    float baselineOriginY,
+    DWRITE_MEASURING_MODE measuringMode,
+    DWRITE_GLYPH_RUN const* glyphRun
+)
+{
+    // Right-to-left and sideways runs are left to the render target.
+    if ((glyphRun->bidiLevel & 1) != 0 || glyphRun->isSideways || glyphRun->glyphAdvances == nullptr)
+    {
+        return false;
+    }
+
+    // So are color fonts, whose glyphs may be drawn as several layers in different colors.
+    auto fontFace = wil::try_com_query<IDWriteFontFace3>(glyphRun->fontFace);
+    if (fontFace == nullptr || fontFace->IsColorFont())
+    {
+        return false;
+    }
+
+    // The glyph transform maps DIPs to pixels, not including the translation.
+    DWRITE_MATRIX transform;
+    THROW_IF_FAILED(m_renderTarget->GetCurrentTransform(&transform));
+    float pixelsPerDip = m_renderTarget->GetPixelsPerDip();
+
+    DWRITE_MATRIX glyphTransform = {
+        transform.m11 * pixelsPerDip,
+        transform.m12 * pixelsPerDip,
+        transform.m21 * pixelsPerDip,
+        transform.m22 * pixelsPerDip,
+        0,
+        0
+    };
+
+    DWRITE_RENDERING_MODE1 renderingMode;
+    DWRITE_GRID_FIT_MODE gridFitMode;
+    THROW_IF_FAILED(fontFace->GetRecommendedRenderingMode(
+        glyphRun->fontEmSize,
+        96.0f,
+        96.0f,
+        &glyphTransform,
+        false,
+        DWRITE_OUTLINE_THRESHOLD_ANTIALIASED,
+        measuringMode,
+        m_renderingParams.get(),
+        &renderingMode,
+        &gridFitMode
+    ));
+
+    // Very large text is drawn as outlines, which aren't worth caching.
+    if (renderingMode == DWRITE_RENDERING_MODE1_OUTLINE)
+    {
+        return false;
+    }
+
+    // Without separate subpixels (flat pixel geometry), ClearType coverage would only add color
+    // fringes, so the glyphs are rasterized in grayscale.
+    bool isClearType = renderingMode != DWRITE_RENDERING_MODE1_ALIASED &&
+        m_renderTarget->GetTextAntialiasMode() == DWRITE_TEXT_ANTIALIAS_MODE_CLEARTYPE &&
+        m_renderingParams->GetClearTypeLevel() > 0 &&
+        m_renderingParams->GetPixelGeometry() != DWRITE_PIXEL_GEOMETRY_FLAT;
+
+    DWRITE_BITMAP_DATA_BGRA32 bitmapData;
+    THROW_IF_FAILED(m_renderTarget->GetBitmapData(&bitmapData));
+
+    // Finish any batched GDI drawing, such as clearing the background, before writing pixels.
+    GdiFlush();
+
+    GlyphKey key = {};
+    key.fontFaceId = GetFontFaceId(glyphRun->fontFace);
+    key.bytesPerPixel = isClearType ? 3 : 1;
+    key.measuringMode = static_cast<uint8_t>(measuringMode);
+    key.renderingMode = static_cast<uint8_t>(renderingMode);
+    key.gridFitMode = static_cast<uint8_t>(gridFitMode);
+    key.emSize = glyphRun->fontEmSize;
+    key.m11 = glyphTransform.m11;
+    key.m12 = glyphTransform.m12;
+    key.m21 = glyphTransform.m21;
+    key.m22 = glyphTransform.m22;
+
+    float penX = baselineOriginX;
+    for (uint32_t i = 0; i < glyphRun->glyphCount; i++)
+    {
+        float glyphX = penX;
+        float glyphY = baselineOriginY;
+        if (glyphRun->glyphOffsets != nullptr)
+        {
+            glyphX += glyphRun->glyphOffsets[i].advanceOffset;
+            glyphY -= glyphRun->glyphOffsets[i].ascenderOffset;
+        }
+        penX += glyphRun->glyphAdvances[i];
+
+        // Position the glyph origin to a quarter pixel horizontally and a whole pixel vertically.
+        float pixelX = glyphX * glyphTransform.m11 + glyphY * glyphTransform.m21 + transform.dx;
+        float pixelY = glyphX * glyphTransform.m12 + glyphY * glyphTransform.m22 + transform.dy;
+
+        int quarterPixelX = static_cast<int>(floorf(pixelX * 4 + 0.5f));
+        int originX = quarterPixelX >> 2;
+        int originY = static_cast<int>(floorf(pixelY + 0.5f));
+
+        key.glyphIndex = glyphRun->glyphIndices[i];
+        key.subpixelOffset = static_cast<uint8_t>(quarterPixelX & 3);
+
+        GlyphEntry const* entry = m_glyphCache.Find(key);
+        if (entry == nullptr)
+        {
+            entry = RasterizeGlyph(key, glyphRun, measuringMode, renderingMode, gridFitMode);
+        }
+
+        if (entry == nullptr)
+        {
+            // The glyph is too large for the atlas, so let the render target draw it.
+            DWRITE_GLYPH_RUN singleGlyphRun = *glyphRun;
+            singleGlyphRun.glyphCount = 1;
+            singleGlyphRun.glyphIndices = &glyphRun->glyphIndices[i];
+            singleGlyphRun.glyphAdvances = &glyphRun->glyphAdvances[i];
+            singleGlyphRun.glyphOffsets = nullptr;
+
+            THROW_IF_FAILED(m_renderTarget->DrawGlyphRunWithColorSupport(
+                glyphX,
+                glyphY,
+                measuringMode,
+                &singleGlyphRun,
+                m_renderingParams.get(),
+                m_textColor
+            ));
+            continue;
+        }
+
+        m_glyphBlender.Blend(
+            bitmapData.pixels,
+            bitmapData.width,
+            bitmapData.height,
+            originX + entry->left,
+            originY + entry->top,
+            m_glyphCache,
+            *entry
+        );
+    }
+
+    return true;
+}
+
 // IDWriteTextRenderer method
 HRESULT STDMETHODCALLTYPE TextRenderer::DrawUnderline(
     _In_opt_ void* clientDrawingContext,
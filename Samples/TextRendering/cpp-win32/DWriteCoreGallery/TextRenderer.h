@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "GlyphCache.h"
+
 class TextRenderer final : public IDWriteTextRenderer1
 {
 public:
@@ -10,7 +12,7 @@ public:
 
     void Resize(SIZE pixelSize);
     void Clear(int sysColorIndex);
-    void SetTextColor(int sysColorIndex) { m_textColor = GetSysColor(sysColorIndex); }
+    void SetTextColor(int sysColorIndex);
     void CopyTo(HDC hdcDest, POINT topLeft);
 
     float GetDpiScale() const noexcept { return m_dpiScale; }
@@ -20,6 +22,12 @@ public:
 
     IDWriteTextAnalyzer2* GetTextAnalyzer();
 
+    GlyphCache::Statistics const& GetGlyphCacheStatistics() const noexcept { return m_glyphCache.GetStatistics(); }
+
+    // In debug builds, writes the glyph cache counters accumulated since the previous call to the
+    // debugger output, if any glyphs were drawn. Called after each window paints.
+    void TraceFrameStatistics();
+
     // IUnknown methods
     HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, _COM_Outptr_ void** ppvObject) noexcept override;
     ULONG STDMETHODCALLTYPE AddRef() noexcept override;
@@ -130,6 +138,23 @@ public:
 private:
     static DWRITE_MATRIX CombineTransform(DWRITE_MATRIX a, DWRITE_MATRIX b) noexcept;
 
+    bool TryDrawCachedGlyphRun(
+        float baselineOriginX,
+        float baselineOriginY,
+        DWRITE_MEASURING_MODE measuringMode,
+        DWRITE_GLYPH_RUN const* glyphRun
+    );
+
+    _Ret_maybenull_ GlyphEntry const* RasterizeGlyph(
+        GlyphKey const& key,
+        DWRITE_GLYPH_RUN const* glyphRun,
+        DWRITE_MEASURING_MODE measuringMode,
+        DWRITE_RENDERING_MODE1 renderingMode,
+        DWRITE_GRID_FIT_MODE gridFitMode
+    );
+
+    uint32_t GetFontFaceId(IDWriteFontFace* fontFace);
+
     class OrientationTransform
     {
     public:
@@ -160,4 +185,14 @@ private:
     SIZE m_logicalPixelSize = {};
     COLORREF m_textColor = GetSysColor(COLOR_WINDOWTEXT);
     uint32_t m_colorPaletteIndex = 0;
+
+    // Coverage of recently drawn glyphs. Font faces are identified in the cache by number; the
+    // faces are held until the atlas is emptied, so an address is never reused for another face.
+    GlyphCache m_glyphCache;
+    GlyphBlender m_glyphBlender;
+    std::unordered_map<IDWriteFontFace*, uint32_t> m_fontFaceIds;
+    std::vector<wil::com_ptr<IDWriteFontFace>> m_fontFaces;
+    uint32_t m_fontFaceGeneration = 0;
+    uint32_t m_nextFontFaceId = 0;
+    std::vector<uint8_t> m_coverageBuffer;
 };
@@ -2,6 +2,7 @@
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 #include "ArgumentParser.h"
 #include "ExecutionProviderManager.h" // for printing EP table in help
+#include <cwchar>
 #include <iostream>
 #include <string_view>
 
@@ -46,6 +47,36 @@ namespace Shared
         {
             options.image_path = arguments[++i];
         }
+        else if (arguments[i] == L"--image_dir" && i + 1 < arguments.size())
+        {
+            options.image_directory = arguments[++i];
+        }
+        else if (arguments[i] == L"--image_list" && i + 1 < arguments.size())
+        {
+            options.image_list_path = arguments[++i];
+        }
+        else if (arguments[i] == L"--batch_size" && i + 1 < arguments.size())
+        {
+            std::wstring batch_size_str{arguments[++i]};
+            options.batch_size = std::wcstoll(batch_size_str.c_str(), nullptr, 10);
+            if (options.batch_size < 1)
+            {
+                std::wcout << L"ERROR: --batch_size must be a positive integer.\n";
+                PrintUsage();
+                return false;
+            }
+        }
+        else if (arguments[i] == L"--benchmark" && i + 1 < arguments.size())
+        {
+            std::wstring benchmark_runs_str{arguments[++i]};
+            options.benchmark_runs = static_cast<int>(std::wcstol(benchmark_runs_str.c_str(), nullptr, 10));
+            if (options.benchmark_runs < 1)
+            {
+                std::wcout << L"ERROR: --benchmark must be a positive integer.\n";
+                PrintUsage();
+                return false;
+            }
+        }
         else if (arguments[i] == L"--ep_policy" && i + 1 < arguments.size())
         {
             auto policy_str = arguments[++i];
@@ -168,8 +199,12 @@ namespace Shared
                    << L"  --download                    Download required packages\n"
                    << L"  --use_model_catalog           Use the model catalog for model selection\n"
                    << L"  --model <path>                Path to the input ONNX model (default: SqueezeNet.onnx in executable directory)\n"
-                   << L"  --compiled_output <path>      Path for compiled output model (default: SqueezeNet_ctx.onnx)\n"
+                   << L"  --compiled_output <path>      Path for compiled output model (default: a cache in CompiledModels)\n"
                    << L"  --image_path <path>           Path to the input image (default: sample kitten image)\n"
+                   << L"  --image_dir <path>            Classify every image in a directory (batch mode)\n"
+                   << L"  --image_list <path>           Classify the images listed in a text file, one per line (batch mode)\n"
+                   << L"  --batch_size <n>              Images per inference in batch mode, if the model allows (default: 1)\n"
+                   << L"  --benchmark <runs>            Time repeated inference with per-call tensors and with a reused I/O binding\n"
                    << L"\n"
                    << L"Exactly one of --ep_policy or --ep_name must be specified.\n"
                    << L"--use_model_catalog and --model are mutually exclusive.\n"
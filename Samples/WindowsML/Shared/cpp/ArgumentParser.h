@@ -2,6 +2,7 @@
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -35,6 +36,11 @@ namespace Shared
         std::wstring ep_name; // e.g. L"QNNExecutionProvider"
         std::optional<std::wstring> device_type; // Only for OpenVINOExecutionProvider: NPU | GPU | CPU (uppercase)
         std::wstring image_path;
+        // Batch mode: classify every image in a directory and/or every path listed in a file
+        std::wstring image_directory;
+        std::wstring image_list_path;
+        int64_t batch_size = 1; // Images per inference when the model's batch dimension is dynamic
+        int benchmark_runs = 0; // Repeated inferences to time after classifying the image (0 = no benchmark)
         std::wstring model_path;
         std::wstring output_path;
         ModelVariant model_variant = ModelVariant::Default; // Model precision/format selection
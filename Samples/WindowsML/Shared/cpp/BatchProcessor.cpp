@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "BatchProcessor.h"
+#include "ImageProcessor.h"
+#include "InferenceEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cwctype>
+#include <execution>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        /// <summary>
+        /// Preprocessed images of one batch, packed into a single NCHW buffer
+        /// </summary>
+        struct PreparedBatch
+        {
+            size_t firstImage = 0;
+            size_t imageCount = 0;
+            int64_t tensorBatchSize = 0; // imageCount, or the model's fixed batch size with zero padding
+            std::vector<float> tensorData;
+            std::vector<Clock::time_point> startTimes;
+            std::vector<uint8_t> isLoaded;
+        };
+
+        bool IsImageFile(const std::filesystem::path& path)
+        {
+            std::wstring extension = path.extension().wstring();
+            for (auto& ch : extension) ch = static_cast<wchar_t>(towlower(ch));
+
+            return extension == L".jpg" || extension == L".jpeg" || extension == L".png" || extension == L".bmp" ||
+                   extension == L".gif" || extension == L".tif" || extension == L".tiff";
+        }
+
+        PreparedBatch PrepareBatch(const std::vector<std::filesystem::path>& imagePaths, size_t firstImage, size_t imageCount, int64_t tensorBatchSize)
+        {
+            constexpr size_t imageElementCount = ImageProcessor::CHANNELS * ImageProcessor::IMAGE_SIZE * ImageProcessor::IMAGE_SIZE;
+
+            PreparedBatch batch;
+            batch.firstImage = firstImage;
+            batch.imageCount = imageCount;
+            batch.tensorBatchSize = tensorBatchSize;
+            batch.tensorData.assign(static_cast<size_t>(tensorBatchSize) * imageElementCount, 0.0f);
+            batch.startTimes.resize(imageCount);
+            batch.isLoaded.resize(imageCount);
+
+            // Decode and preprocess the images of the batch in parallel, each into its slice of the tensor.
+            // The parallel algorithms run on the Windows thread pool.
+            std::vector<size_t> indices(imageCount);
+            std::iota(indices.begin(), indices.end(), size_t{0});
+
+            std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+                batch.startTimes[i] = Clock::now();
+                const std::filesystem::path& imagePath = imagePaths[firstImage + i];
+
+                try
+                {
+                    auto videoFrame = ImageProcessor::LoadImageFileAsync(winrt::hstring{imagePath.wstring()}).get();
+                    ImageProcessor::BindVideoFrameAsTensor(videoFrame, batch.tensorData.data() + i * imageElementCount);
+                    batch.isLoaded[i] = 1;
+                }
+                catch (...)
+                {
+                    // The image is skipped; its slice of the tensor stays zero. It is reported by
+                    // RunBatches, since writing to the console from several threads interleaves.
+                }
+            });
+
+            return batch;
+        }
+
+        double Percentile(std::vector<double> values, double percentile)
+        {
+            if (values.empty())
+            {
+                return 0.0;
+            }
+
+            // Nearest-rank percentile
+            size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * values.size()));
+            size_t index = std::clamp<size_t>(rank, 1, values.size()) - 1;
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+        }
+    } // namespace
+
+    std::vector<std::filesystem::path> BatchProcessor::CollectImagePaths(const CommandLineOptions& options)
+    {
+        std::vector<std::filesystem::path> imagePaths;
+
+        if (!options.image_directory.empty())
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(options.image_directory))
+            {
+                if (entry.is_regular_file() && IsImageFile(entry.path()))
+                {
+                    imagePaths.push_back(entry.path());
+                }
+            }
+            std::sort(imagePaths.begin(), imagePaths.end());
+        }
+
+        if (!options.image_list_path.empty())
+        {
+            // One UTF-8 path per line; relative paths are relative to the list file
+            std::filesystem::path listPath{options.image_list_path};
+            std::ifstream listFile{listPath};
+            if (listFile.fail())
+            {
+                throw std::runtime_error("Unable to open image list file.");
+            }
+
+            for (std::string line; std::getline(listFile, line);)
+            {
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                if (line.empty())
+                {
+                    continue;
+                }
+
+                std::filesystem::path imagePath{std::u8string(line.begin(), line.end())};
+                imagePaths.push_back(imagePath.is_absolute() ? imagePath : listPath.parent_path() / imagePath);
+            }
+        }
+
+        return imagePaths;
+    }
+
+    int64_t BatchProcessor::DetermineBatchSize(const std::vector<int64_t>& modelInputShape, int64_t requestedBatchSize)
+    {
+        if (modelInputShape.size() != 4)
+        {
+            throw std::runtime_error("Batch mode requires a model with an NCHW image input.");
+        }
+
+        if (modelInputShape[0] == -1)
+        {
+            return std::max<int64_t>(requestedBatchSize, 1);
+        }
+
+        if (modelInputShape[0] != requestedBatchSize)
+        {
+            std::wcout << L"Model has a fixed batch size of " << modelInputShape[0] << L"; ignoring --batch_size" << std::endl;
+        }
+        return modelInputShape[0];
+    }
+
+    BatchStatistics BatchProcessor::RunBatches(
+        Ort::Session& session,
+        const char* inputName,
+        const char* outputName,
+        const std::vector<int64_t>& modelInputShape,
+        const std::vector<std::filesystem::path>& imagePaths,
+        int64_t batchSize,
+        const BatchResultCallback& onResult)
+    {
+        const bool isDynamicBatch = modelInputShape[0] == -1;
+        const size_t imagesPerBatch = static_cast<size_t>(batchSize);
+
+        // Start preprocessing a batch asynchronously. A dynamic batch dimension takes the number of images;
+        // a fixed one is filled with zero padding.
+        auto startBatch = [&](size_t firstImage) {
+            size_t imageCount = std::min(imagesPerBatch, imagePaths.size() - firstImage);
+            int64_t tensorBatchSize = isDynamicBatch ? static_cast<int64_t>(imageCount) : batchSize;
+            return std::async(std::launch::async, PrepareBatch, std::cref(imagePaths), firstImage, imageCount, tensorBatchSize);
+        };
+
+        BatchStatistics statistics;
+        std::vector<double> latencies;
+        latencies.reserve(imagePaths.size());
+
+        const Clock::time_point runStart = Clock::now();
+        std::future<PreparedBatch> nextBatch;
+        if (!imagePaths.empty())
+        {
+            nextBatch = startBatch(0);
+        }
+
+        const char* inputNames[] = {inputName};
+        const char* outputNames[] = {outputName};
+
+        for (size_t firstImage = 0; firstImage < imagePaths.size(); firstImage += imagesPerBatch)
+        {
+            PreparedBatch batch = nextBatch.get();
+
+            // Overlap preprocessing of the following batch with inference of this one
+            if (firstImage + imagesPerBatch < imagePaths.size())
+            {
+                nextBatch = startBatch(firstImage + imagesPerBatch);
+            }
+
+            std::vector<int64_t> inputShape = InferenceEngine::PrepareInputShape(modelInputShape);
+            inputShape[0] = batch.tensorBatchSize;
+
+            Ort::Value inputTensor = InferenceEngine::CreateInputTensor(batch.tensorData, inputShape);
+            auto outputTensors = session.Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
+            std::vector<float> results = InferenceEngine::ExtractResults(outputTensors);
+
+            const Clock::time_point batchEnd = Clock::now();
+            const size_t resultsPerImage = results.size() / static_cast<size_t>(batch.tensorBatchSize);
+
+            for (size_t i = 0; i < batch.imageCount; ++i)
+            {
+                const std::filesystem::path& imagePath = imagePaths[batch.firstImage + i];
+
+                // Images that failed to load are left out of the results and the latencies.
+                if (!batch.isLoaded[i])
+                {
+                    std::wcout << L"Failed to load image: " << imagePath.wstring() << std::endl;
+                    statistics.failedImageCount++;
+                    continue;
+                }
+
+                latencies.push_back(std::chrono::duration<double, std::milli>(batchEnd - batch.startTimes[i]).count());
+
+                auto imageResults = results.begin() + i * resultsPerImage;
+                onResult(imagePath, std::vector<float>(imageResults, imageResults + resultsPerImage));
+                statistics.imageCount++;
+            }
+
+            statistics.batchCount++;
+        }
+
+        statistics.elapsedSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+        statistics.imagesPerSecond = statistics.elapsedSeconds > 0.0 ? statistics.imageCount / statistics.elapsedSeconds : 0.0;
+        statistics.p50LatencyMs = Percentile(latencies, 50.0);
+        statistics.p99LatencyMs = Percentile(latencies, 99.0);
+
+        return statistics;
+    }
+
+    void BatchProcessor::PrintStatistics(const BatchStatistics& statistics)
+    {
+        std::cout << "\nClassified " << statistics.imageCount << " images in " << statistics.batchCount << " batches ("
+                  << std::fixed << std::setprecision(2) << statistics.elapsedSeconds << " s)";
+        if (statistics.failedImageCount > 0)
+        {
+            std::cout << ", " << statistics.failedImageCount << " images failed to load";
+        }
+        std::cout << "\n"
+                  << "Throughput         : " << statistics.imagesPerSecond << " images/sec\n"
+                  << "Per-image latency  : p50 " << statistics.p50LatencyMs << " ms, p99 " << statistics.p99LatencyMs << " ms"
+                  << std::defaultfloat << std::endl;
+    }
+
+} // namespace Shared
+} // namespace WindowsML
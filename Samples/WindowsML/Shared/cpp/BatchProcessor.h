@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+#include <winml/onnxruntime_cxx_api.h>
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include "ArgumentParser.h"
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Throughput and per-image latency of a batch run
+    /// </summary>
+    struct BatchStatistics
+    {
+        size_t imageCount = 0;       // Images that were classified
+        size_t failedImageCount = 0; // Images that could not be loaded, which are not in the latencies
+        size_t batchCount = 0;
+        double elapsedSeconds = 0.0;
+        double imagesPerSecond = 0.0;
+        double p50LatencyMs = 0.0; // From the start of an image's preprocessing to the end of its batch
+        double p99LatencyMs = 0.0;
+    };
+
+    /// <summary>
+    /// Called with the raw model output for each image that was classified
+    /// </summary>
+    using BatchResultCallback = std::function<void(const std::filesystem::path& imagePath, const std::vector<float>& results)>;
+
+    /// <summary>
+    /// Multi-image classification: images are packed into one NCHW tensor per session.Run, and the
+    /// next batch is preprocessed on the thread pool while the current batch runs
+    /// </summary>
+    class BatchProcessor
+    {
+    public:
+        /// <summary>
+        /// Collect the images named by --image_dir or --image_list
+        /// </summary>
+        static std::vector<std::filesystem::path> CollectImagePaths(const CommandLineOptions& options);
+
+        /// <summary>
+        /// Determine the batch size: a dynamic batch dimension takes the requested size, a fixed one is kept
+        /// </summary>
+        static int64_t DetermineBatchSize(const std::vector<int64_t>& modelInputShape, int64_t requestedBatchSize);
+
+        /// <summary>
+        /// Classify the images in batches, calling onResult for each image in order
+        /// </summary>
+        static BatchStatistics RunBatches(
+            Ort::Session& session,
+            const char* inputName,
+            const char* outputName,
+            const std::vector<int64_t>& modelInputShape,
+            const std::vector<std::filesystem::path>& imagePaths,
+            int64_t batchSize,
+            const BatchResultCallback& onResult);
+
+        /// <summary>
+        /// Print throughput and latency percentiles
+        /// </summary>
+        static void PrintStatistics(const BatchStatistics& statistics);
+    };
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,257 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "ClassificationPostprocessor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CLASSIFICATION_POSTPROCESSOR_USE_SSE2
+#endif
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+#ifdef CLASSIFICATION_POSTPROCESSOR_USE_SSE2
+        // exp(x) for x <= 0, from the Cephes single-precision polynomial: x = n ln2 + r, exp(r) by a
+        // polynomial, and 2^n built directly in the exponent bits. Relative error is within 2 ulp. Inputs
+        // are clamped at -87.3 so 2^n stays a normal float; those terms are negligible next to exp(0).
+        __m128 ExpNonPositive(__m128 x)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+
+            x = _mm_max_ps(x, _mm_set1_ps(-87.3365f));
+
+            // n = floor(x / ln2 + 0.5)
+            __m128 n = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+            __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(n));
+            n = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, n), one));
+
+            // r = x - n ln2, with ln2 split in two for precision
+            x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+            x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+            __m128 y = _mm_set1_ps(1.9875691500e-4f);
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+            y = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, x), x), _mm_add_ps(x, one));
+
+            __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+            return _mm_mul_ps(y, _mm_castsi128_ps(exponent));
+        }
+
+        float HorizontalSum(__m128 value)
+        {
+            value = _mm_add_ps(value, _mm_movehl_ps(value, value));
+            value = _mm_add_ss(value, _mm_shuffle_ps(value, value, 1));
+            return _mm_cvtss_f32(value);
+        }
+
+        float HorizontalMax(__m128 value)
+        {
+            value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+            value = _mm_max_ss(value, _mm_shuffle_ps(value, value, 1));
+            return _mm_cvtss_f32(value);
+        }
+#endif
+
+        float MaxValue(const float* values, size_t count)
+        {
+            float maxValue = -std::numeric_limits<float>::infinity();
+            size_t i = 0;
+
+#ifdef CLASSIFICATION_POSTPROCESSOR_USE_SSE2
+            // Two accumulators hide the latency of the max instruction
+            __m128 max0 = _mm_set1_ps(maxValue);
+            __m128 max1 = max0;
+            for (; i + 8 <= count; i += 8)
+            {
+                max0 = _mm_max_ps(max0, _mm_loadu_ps(values + i));
+                max1 = _mm_max_ps(max1, _mm_loadu_ps(values + i + 4));
+            }
+            maxValue = HorizontalMax(_mm_max_ps(max0, max1));
+#endif
+
+            for (; i < count; ++i)
+            {
+                maxValue = std::max(maxValue, values[i]);
+            }
+            return maxValue;
+        }
+
+        // Sum exp(value - maxValue) over values, also storing each term to output unless it is null.
+        // output may be the same array as values.
+        float ExpAndSum(const float* values, float* output, size_t count, float maxValue)
+        {
+            float sum = 0.0f;
+            size_t i = 0;
+
+#ifdef CLASSIFICATION_POSTPROCESSOR_USE_SSE2
+            const __m128 max = _mm_set1_ps(maxValue);
+            __m128 sum0 = _mm_setzero_ps();
+            __m128 sum1 = _mm_setzero_ps();
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128 exp0 = ExpNonPositive(_mm_sub_ps(_mm_loadu_ps(values + i), max));
+                __m128 exp1 = ExpNonPositive(_mm_sub_ps(_mm_loadu_ps(values + i + 4), max));
+                if (output)
+                {
+                    _mm_storeu_ps(output + i, exp0);
+                    _mm_storeu_ps(output + i + 4, exp1);
+                }
+                sum0 = _mm_add_ps(sum0, exp0);
+                sum1 = _mm_add_ps(sum1, exp1);
+            }
+            sum = HorizontalSum(_mm_add_ps(sum0, sum1));
+#endif
+
+            for (; i < count; ++i)
+            {
+                float term = std::exp(values[i] - maxValue);
+                if (output)
+                {
+                    output[i] = term;
+                }
+                sum += term;
+            }
+            return sum;
+        }
+
+        void Scale(float* values, size_t count, float scale)
+        {
+            size_t i = 0;
+
+#ifdef CLASSIFICATION_POSTPROCESSOR_USE_SSE2
+            const __m128 factor = _mm_set1_ps(scale);
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), factor));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                values[i] *= scale;
+            }
+        }
+
+        // Softmax is undefined when the largest logit is infinite, since subtracting it makes every
+        // term NaN. Its limit is used instead: the classes at +inf share the probability equally, and
+        // when every logit is -inf, all of the classes are equally likely.
+        float InfiniteMaxProbability(float logit, float maxLogit, size_t maxCount)
+        {
+            return logit == maxLogit ? 1.0f / static_cast<float>(maxCount) : 0.0f;
+        }
+
+        // Whether a ranks above b: higher score, or the same score and a lower index
+        bool RanksAbove(const std::pair<int, float>& a, const std::pair<int, float>& b)
+        {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        }
+    } // namespace
+
+    void ClassificationPostprocessor::Softmax(std::span<float> values)
+    {
+        Softmax(values, values);
+    }
+
+    void ClassificationPostprocessor::Softmax(std::span<const float> logits, std::span<float> probabilities)
+    {
+        if (probabilities.size() != logits.size())
+        {
+            throw std::invalid_argument("Softmax output size does not match the input size.");
+        }
+        if (logits.empty())
+        {
+            return;
+        }
+
+        // Subtracting the max keeps every exponent at or below zero, so nothing overflows
+        float maxLogit = MaxValue(logits.data(), logits.size());
+        if (std::isinf(maxLogit))
+        {
+            size_t maxCount = std::count(logits.begin(), logits.end(), maxLogit);
+            std::transform(logits.begin(), logits.end(), probabilities.begin(), [&](float logit) {
+                return InfiniteMaxProbability(logit, maxLogit, maxCount);
+            });
+            return;
+        }
+
+        float sum = ExpAndSum(logits.data(), probabilities.data(), logits.size(), maxLogit);
+        Scale(probabilities.data(), probabilities.size(), 1.0f / sum);
+    }
+
+    std::vector<std::pair<int, float>> ClassificationPostprocessor::TopK(std::span<const float> scores, size_t k)
+    {
+        k = std::min(k, scores.size());
+
+        std::vector<std::pair<int, float>> topScores;
+        topScores.reserve(k);
+        if (k == 0)
+        {
+            return topScores;
+        }
+
+        for (size_t i = 0; i < k; ++i)
+        {
+            topScores.emplace_back(static_cast<int>(i), scores[i]);
+        }
+
+        // With RanksAbove as the ordering, the heap's front is the lowest-ranked candidate kept so far
+        std::make_heap(topScores.begin(), topScores.end(), RanksAbove);
+
+        for (size_t i = k; i < scores.size(); ++i)
+        {
+            // Indices only increase, so a score equal to the lowest kept one never displaces it
+            if (scores[i] > topScores.front().second)
+            {
+                std::pop_heap(topScores.begin(), topScores.end(), RanksAbove);
+                topScores.back() = {static_cast<int>(i), scores[i]};
+                std::push_heap(topScores.begin(), topScores.end(), RanksAbove);
+            }
+        }
+
+        std::sort_heap(topScores.begin(), topScores.end(), RanksAbove);
+        return topScores;
+    }
+
+    std::vector<std::pair<int, float>> ClassificationPostprocessor::TopKSoftmax(std::span<const float> logits, size_t k)
+    {
+        if (logits.empty() || k == 0)
+        {
+            return {};
+        }
+
+        // Softmax preserves order, so the top logits are the top probabilities
+        std::vector<std::pair<int, float>> topClasses = TopK(logits, k);
+
+        float maxLogit = topClasses.front().second;
+        if (std::isinf(maxLogit))
+        {
+            size_t maxCount = std::count(logits.begin(), logits.end(), maxLogit);
+            for (auto& topClass : topClasses)
+            {
+                topClass.second = InfiniteMaxProbability(topClass.second, maxLogit, maxCount);
+            }
+            return topClasses;
+        }
+
+        float inverseSum = 1.0f / ExpAndSum(logits.data(), nullptr, logits.size(), maxLogit);
+        for (auto& topClass : topClasses)
+        {
+            topClass.second = std::exp(topClass.second - maxLogit) * inverseSum;
+        }
+        return topClasses;
+    }
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+// This header is platform-neutral, so post-processing can be built and measured without Windows
+// or ONNX Runtime headers.
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Softmax and top-k selection over classifier output. Softmax runs in one max pass and one fused
+    /// exp/sum pass, vectorized where SSE2 is available; top-k keeps a heap of k candidates instead of
+    /// sorting every class.
+    /// </summary>
+    class ClassificationPostprocessor
+    {
+    public:
+        /// <summary>
+        /// Replace logits with softmax probabilities in place
+        /// </summary>
+        static void Softmax(std::span<float> values);
+
+        /// <summary>
+        /// Write softmax probabilities of logits to probabilities, which must be the same size
+        /// </summary>
+        static void Softmax(std::span<const float> logits, std::span<float> probabilities);
+
+        /// <summary>
+        /// The k highest scores as (index, score), highest first; equal scores keep the lower index first
+        /// </summary>
+        static std::vector<std::pair<int, float>> TopK(std::span<const float> scores, size_t k);
+
+        /// <summary>
+        /// The k most likely classes as (index, probability), highest first. Only the k selected
+        /// probabilities are computed, so no array of probabilities is allocated.
+        /// </summary>
+        static std::vector<std::pair<int, float>> TopKSoftmax(std::span<const float> logits, size_t k);
+    };
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,490 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "CompiledModelCache.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+        constexpr char MANIFEST_NAME[] = "manifest.txt";
+        constexpr char MANIFEST_HEADER[] = "# CompiledModelCache v2";
+        constexpr char ENTRY_RECORD[] = "entry";
+        constexpr char SOURCE_RECORD[] = "source";
+        constexpr char STAGING_SUFFIX[] = ".tmp";
+
+        constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+        constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+        /// <summary>
+        /// FNV-1a over 64-bit words in four interleaved lanes, which keeps hashing a large model
+        /// file close to disk speed
+        /// </summary>
+        class ContentHasher
+        {
+        public:
+            void Update(const uint8_t* data, size_t size)
+            {
+                m_length += size;
+
+                // Finish a word left incomplete by the previous call
+                while (m_pendingSize != 0 && m_pendingSize < sizeof(m_pending) && size != 0)
+                {
+                    m_pending[m_pendingSize++] = *data++;
+                    --size;
+                }
+                if (m_pendingSize == sizeof(m_pending))
+                {
+                    AddWord(LoadWord(m_pending.data()));
+                    m_pendingSize = 0;
+                }
+
+                for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t))
+                {
+                    AddWord(LoadWord(data));
+                }
+
+                std::memcpy(m_pending.data() + m_pendingSize, data, size);
+                m_pendingSize += size;
+            }
+
+            uint64_t Finish()
+            {
+                uint64_t hash = FNV_OFFSET_BASIS;
+                for (size_t i = 0; i < m_pendingSize; ++i)
+                {
+                    hash = (hash ^ m_pending[i]) * FNV_PRIME;
+                }
+                for (uint64_t lane : m_lanes)
+                {
+                    hash = (hash ^ lane) * FNV_PRIME;
+                }
+                return (hash ^ m_length) * FNV_PRIME;
+            }
+
+        private:
+            static uint64_t LoadWord(const uint8_t* data)
+            {
+                uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                return word;
+            }
+
+            void AddWord(uint64_t word)
+            {
+                uint64_t& lane = m_lanes[m_wordCount++ % m_lanes.size()];
+                lane = (lane ^ word) * FNV_PRIME;
+            }
+
+            std::array<uint64_t, 4> m_lanes = {FNV_OFFSET_BASIS, FNV_OFFSET_BASIS ^ 1, FNV_OFFSET_BASIS ^ 2, FNV_OFFSET_BASIS ^ 3};
+            std::array<uint8_t, sizeof(uint64_t)> m_pending = {};
+            size_t m_pendingSize = 0;
+            uint64_t m_wordCount = 0;
+            uint64_t m_length = 0;
+        };
+
+        void HashFileInto(const std::filesystem::path& path, ContentHasher& hasher)
+        {
+            std::ifstream file{path, std::ios::binary};
+            if (!file)
+            {
+                throw std::runtime_error("Unable to read " + path.string());
+            }
+
+            std::vector<char> buffer(1 << 20);
+            while (file)
+            {
+                file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                hasher.Update(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(file.gcount()));
+            }
+        }
+
+        std::string ToHex(uint64_t value)
+        {
+            std::ostringstream stream;
+            stream << std::hex;
+            stream.width(16);
+            stream.fill('0');
+            stream << value;
+            return stream.str();
+        }
+
+        // Manifest fields are tab separated, so keep tabs and line breaks out of key strings
+        std::string SanitizeField(std::string value)
+        {
+            std::replace_if(value.begin(), value.end(), [](char ch) { return ch == '\t' || ch == '\r' || ch == '\n'; }, ' ');
+            return value;
+        }
+
+        uint64_t GetFolderSize(const std::filesystem::path& folder)
+        {
+            uint64_t size = 0;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(folder, error))
+            {
+                if (entry.is_regular_file(error))
+                {
+                    size += entry.file_size(error);
+                }
+            }
+            return size;
+        }
+
+        int64_t GetWriteTime(const std::filesystem::path& path, std::error_code& error)
+        {
+            return std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        }
+
+        std::string ToManifestPath(const std::filesystem::path& path)
+        {
+            std::error_code error;
+            std::filesystem::path absolutePath = std::filesystem::absolute(path, error);
+            std::u8string text = (error ? path : absolutePath).lexically_normal().u8string();
+            return std::string(text.begin(), text.end());
+        }
+
+        bool IsStale(const std::filesystem::path& folder)
+        {
+            std::error_code error;
+            const auto writeTime = std::filesystem::last_write_time(folder, error);
+            return !error && std::filesystem::file_time_type::clock::now() - writeTime > CompiledModelCache::STALE_FOLDER_AGE;
+        }
+
+        int64_t Now()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    } // namespace
+
+    CompiledModelCache::CompiledModelCache(std::filesystem::path cacheFolder, uint64_t maxSizeBytes) :
+        m_cacheFolder(std::move(cacheFolder)), m_maxSizeBytes(maxSizeBytes)
+    {
+        std::filesystem::create_directories(m_cacheFolder);
+        LoadManifest();
+    }
+
+    CompiledModelKey CompiledModelCache::CreateKey(
+        const std::filesystem::path& modelPath, std::string executionProvider, std::string deviceType, std::string runtimeVersion)
+    {
+        std::string modelHash = GetSourceHash(modelPath);
+
+        std::filesystem::path externalDataPath = modelPath;
+        externalDataPath += ".data";
+        if (std::filesystem::exists(externalDataPath))
+        {
+            // Combine the two files' hashes, so each can be remembered on its own
+            const std::string combined = modelHash + GetSourceHash(externalDataPath);
+            ContentHasher hasher;
+            hasher.Update(reinterpret_cast<const uint8_t*>(combined.data()), combined.size());
+            modelHash = ToHex(hasher.Finish());
+        }
+
+        return {
+            std::move(modelHash),
+            SanitizeField(std::move(executionProvider)),
+            SanitizeField(std::move(deviceType)),
+            SanitizeField(std::move(runtimeVersion))};
+    }
+
+    std::string CompiledModelCache::HashFile(const std::filesystem::path& path)
+    {
+        ContentHasher hasher;
+        HashFileInto(path, hasher);
+        return ToHex(hasher.Finish());
+    }
+
+    std::optional<std::filesystem::path> CompiledModelCache::Find(const CompiledModelKey& key)
+    {
+        const std::string id = GetEntryId(key);
+        auto it = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) { return entry.id == id; });
+        if (it == m_entries.end())
+        {
+            return std::nullopt;
+        }
+
+        if (!IsValid(*it))
+        {
+            std::cout << "Discarding invalid compiled model cache entry " << id << std::endl;
+            RemoveEntry(static_cast<size_t>(it - m_entries.begin()));
+            SaveManifest();
+            return std::nullopt;
+        }
+
+        it->lastUsed = Now();
+        std::filesystem::path artifactPath = m_cacheFolder / it->id / it->artifactName;
+        SaveManifest();
+        return artifactPath;
+    }
+
+    std::optional<std::filesystem::path> CompiledModelCache::GetOrCompile(
+        const std::filesystem::path& modelPath, const CompiledModelKey& key, const ModelCompiler& compiler)
+    {
+        if (auto cachedPath = Find(key))
+        {
+            return cachedPath;
+        }
+
+        // Compile into a staging folder and move it into place only once complete, so an interrupted
+        // compile never looks like a cache entry. Each compile gets its own staging folder, so
+        // processes compiling the same model at once don't remove each other's files.
+        const std::string id = GetEntryId(key);
+        const std::filesystem::path entryFolder = m_cacheFolder / id;
+        const std::filesystem::path stagingFolder = m_cacheFolder / (id + "." + ToHex(std::random_device{}()) + STAGING_SUFFIX);
+        std::error_code error;
+        std::filesystem::create_directories(stagingFolder);
+
+        std::filesystem::path artifactName = modelPath.stem();
+        artifactName += "_ctx.onnx";
+
+        if (!compiler(modelPath, stagingFolder / artifactName) || !std::filesystem::exists(stagingFolder / artifactName))
+        {
+            std::filesystem::remove_all(stagingFolder, error);
+            return std::nullopt;
+        }
+
+        // Another process may have moved its own compile of the same key into place first. The
+        // rename then fails rather than replacing a folder that process may be using, and its entry
+        // is used instead.
+        std::filesystem::rename(stagingFolder, entryFolder, error);
+        if (error)
+        {
+            std::filesystem::remove_all(stagingFolder, error);
+            if (!std::filesystem::exists(entryFolder / artifactName, error))
+            {
+                return std::nullopt;
+            }
+        }
+
+        Entry entry;
+        entry.id = id;
+        entry.key = key;
+        entry.artifactName = artifactName.string();
+        entry.artifactSize = std::filesystem::file_size(entryFolder / artifactName);
+        entry.artifactWriteTime = GetWriteTime(entryFolder / artifactName, error);
+        entry.totalSize = GetFolderSize(entryFolder);
+        entry.lastUsed = Now();
+        m_entries.push_back(std::move(entry));
+
+        EvictToLimit(id);
+        SaveManifest();
+        return entryFolder / artifactName;
+    }
+
+    uint64_t CompiledModelCache::GetTotalSize() const
+    {
+        uint64_t totalSize = 0;
+        for (const Entry& entry : m_entries)
+        {
+            totalSize += entry.totalSize;
+        }
+        return totalSize;
+    }
+
+    std::string CompiledModelCache::GetEntryId(const CompiledModelKey& key)
+    {
+        ContentHasher hasher;
+        for (const std::string* field : {&key.modelHash, &key.executionProvider, &key.deviceType, &key.runtimeVersion})
+        {
+            // Include the terminator so adjacent fields can't run together
+            hasher.Update(reinterpret_cast<const uint8_t*>(field->c_str()), field->size() + 1);
+        }
+        return ToHex(hasher.Finish());
+    }
+
+    std::string CompiledModelCache::GetSourceHash(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(path, error);
+        const int64_t writeTime = GetWriteTime(path, error);
+        if (error)
+        {
+            throw std::runtime_error("Unable to read " + path.string());
+        }
+
+        const std::string manifestPath = SanitizeField(ToManifestPath(path));
+        auto it = std::find_if(
+            m_sourceHashes.begin(), m_sourceHashes.end(), [&](const SourceHash& source) { return source.path == manifestPath; });
+        if (it != m_sourceHashes.end() && it->size == size && it->writeTime == writeTime)
+        {
+            return it->hash;
+        }
+
+        SourceHash source{manifestPath, size, writeTime, HashFile(path)};
+        if (it != m_sourceHashes.end())
+        {
+            *it = source;
+        }
+        else
+        {
+            m_sourceHashes.push_back(source);
+        }
+        SaveManifest();
+        return source.hash;
+    }
+
+    void CompiledModelCache::LoadManifest()
+    {
+        // A missing manifest, or one from another version, leaves the cache empty
+        std::ifstream manifest{m_cacheFolder / MANIFEST_NAME};
+        std::string line;
+        if (std::getline(manifest, line) && line == MANIFEST_HEADER)
+        {
+            while (std::getline(manifest, line))
+            {
+                std::istringstream fields{line};
+                std::string record;
+                std::getline(fields, record, '\t');
+
+                if (record == ENTRY_RECORD)
+                {
+                    Entry entry;
+                    std::string artifactSize, artifactWriteTime, totalSize, lastUsed;
+                    if (std::getline(fields, entry.id, '\t') && std::getline(fields, entry.key.modelHash, '\t') &&
+                        std::getline(fields, entry.key.executionProvider, '\t') && std::getline(fields, entry.key.deviceType, '\t') &&
+                        std::getline(fields, entry.key.runtimeVersion, '\t') && std::getline(fields, entry.artifactName, '\t') &&
+                        std::getline(fields, artifactSize, '\t') && std::getline(fields, artifactWriteTime, '\t') &&
+                        std::getline(fields, totalSize, '\t') && std::getline(fields, lastUsed) && entry.id == GetEntryId(entry.key))
+                    {
+                        entry.artifactSize = std::strtoull(artifactSize.c_str(), nullptr, 10);
+                        entry.artifactWriteTime = std::strtoll(artifactWriteTime.c_str(), nullptr, 10);
+                        entry.totalSize = std::strtoull(totalSize.c_str(), nullptr, 10);
+                        entry.lastUsed = std::strtoll(lastUsed.c_str(), nullptr, 10);
+                        m_entries.push_back(std::move(entry));
+                    }
+                }
+                else if (record == SOURCE_RECORD)
+                {
+                    SourceHash source;
+                    std::string size, writeTime;
+                    if (std::getline(fields, source.path, '\t') && std::getline(fields, size, '\t') &&
+                        std::getline(fields, writeTime, '\t') && std::getline(fields, source.hash))
+                    {
+                        source.size = std::strtoull(size.c_str(), nullptr, 10);
+                        source.writeTime = std::strtoll(writeTime.c_str(), nullptr, 10);
+                        m_sourceHashes.push_back(std::move(source));
+                    }
+                }
+            }
+        }
+
+        // Remove folders the manifest doesn't describe, such as staging folders from interrupted
+        // compiles, and manifests that were never renamed into place. Recent ones may belong to
+        // another process that is still compiling or saving, or that has finished but not yet saved
+        // its manifest, so only stale ones are removed.
+        std::error_code error;
+        for (const auto& item : std::filesystem::directory_iterator(m_cacheFolder, error))
+        {
+            const std::string name = item.path().filename().string();
+            const bool isUnknownFolder =
+                item.is_directory(error) &&
+                std::none_of(m_entries.begin(), m_entries.end(), [&](const Entry& entry) { return name == entry.id; });
+            const bool isUnsavedManifest = !item.is_directory(error) && name.starts_with(std::string{MANIFEST_NAME} + ".") &&
+                                           name.ends_with(STAGING_SUFFIX);
+            if ((isUnknownFolder || isUnsavedManifest) && IsStale(item.path()))
+            {
+                std::filesystem::remove_all(item.path(), error);
+            }
+        }
+    }
+
+    void CompiledModelCache::SaveManifest() const
+    {
+        // Write a new manifest under a name of its own and rename it over the old one, which replaces
+        // it atomically, so a crash never leaves a partial manifest. Processes sharing the cache don't
+        // merge their manifests: the last one saved wins, and entries only the others knew about are
+        // left as folders the manifest doesn't describe until they are stale.
+        const std::filesystem::path manifestPath = m_cacheFolder / MANIFEST_NAME;
+        std::filesystem::path temporaryPath = manifestPath;
+        temporaryPath += "." + ToHex(std::random_device{}()) + STAGING_SUFFIX;
+
+        {
+            std::ofstream manifest{temporaryPath, std::ios::trunc};
+            manifest << MANIFEST_HEADER << '\n';
+            for (const Entry& entry : m_entries)
+            {
+                manifest << ENTRY_RECORD << '\t' << entry.id << '\t' << entry.key.modelHash << '\t' << entry.key.executionProvider << '\t'
+                         << entry.key.deviceType << '\t' << entry.key.runtimeVersion << '\t' << entry.artifactName << '\t'
+                         << entry.artifactSize << '\t' << entry.artifactWriteTime << '\t' << entry.totalSize << '\t' << entry.lastUsed << '\n';
+            }
+            for (const SourceHash& source : m_sourceHashes)
+            {
+                manifest << SOURCE_RECORD << '\t' << source.path << '\t' << source.size << '\t' << source.writeTime << '\t' << source.hash
+                         << '\n';
+            }
+            manifest.close();
+            if (!manifest)
+            {
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, manifestPath, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+        }
+    }
+
+    bool CompiledModelCache::IsValid(const Entry& entry) const
+    {
+        // A truncated or rewritten artifact changes its size or last write time; comparing those
+        // avoids reading a large compiled model on every start
+        const std::filesystem::path artifactPath = m_cacheFolder / entry.id / entry.artifactName;
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(artifactPath, error);
+        if (error)
+        {
+            return false;
+        }
+        const int64_t writeTime = GetWriteTime(artifactPath, error);
+        return !error && size == entry.artifactSize && writeTime == entry.artifactWriteTime;
+    }
+
+    void CompiledModelCache::RemoveEntry(size_t index)
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_cacheFolder / m_entries[index].id, error);
+        m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    void CompiledModelCache::EvictToLimit(const std::string& keepId)
+    {
+        while (GetTotalSize() > m_maxSizeBytes)
+        {
+            auto oldest = m_entries.end();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+            {
+                if (it->id != keepId && (oldest == m_entries.end() || it->lastUsed < oldest->lastUsed))
+                {
+                    oldest = it;
+                }
+            }
+
+            if (oldest == m_entries.end())
+            {
+                return; // Only the entry just added remains; keep it even if it alone exceeds the limit
+            }
+
+            std::cout << "Evicting compiled model cache entry " << oldest->id << std::endl;
+            RemoveEntry(static_cast<size_t>(oldest - m_entries.begin()));
+        }
+    }
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+// This header is platform-neutral; compilation is supplied by the caller, so the cache can be
+// exercised with the CPU execution provider or a stand-in compiler.
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Everything a compiled model depends on. An artifact is only reused when all of it matches.
+    /// </summary>
+    struct CompiledModelKey
+    {
+        std::string modelHash;         // Content hash of the source model and its external data
+        std::string executionProvider; // EP name, or the EP selection policy
+        std::string deviceType;        // Empty when the EP chooses
+        std::string runtimeVersion;    // ONNX Runtime version that compiled the model
+    };
+
+    /// <summary>
+    /// Compiles modelPath to compiledModelPath, returning whether it succeeded
+    /// </summary>
+    using ModelCompiler = std::function<bool(const std::filesystem::path& modelPath, const std::filesystem::path& compiledModelPath)>;
+
+    /// <summary>
+    /// Cache of compiled (EPContext) models. Each entry lives in its own folder, so files an EP writes
+    /// next to the compiled model are kept and evicted with it. A manifest records each entry's key,
+    /// artifact size and last write time, and last use; entries are validated before reuse and the
+    /// least recently used are evicted once the cache exceeds its size limit. The manifest also
+    /// remembers the hash of each source model by path, size and last write time, so an unchanged
+    /// model is not read again to build its key.
+    /// </summary>
+    class CompiledModelCache
+    {
+    public:
+        static constexpr uint64_t DEFAULT_MAX_SIZE_BYTES = 2ull * 1024 * 1024 * 1024;
+
+        // Folders the manifest doesn't describe are left alone until they are this old, since another
+        // process may still be compiling into them
+        static constexpr std::chrono::hours STALE_FOLDER_AGE{24};
+
+        explicit CompiledModelCache(std::filesystem::path cacheFolder, uint64_t maxSizeBytes = DEFAULT_MAX_SIZE_BYTES);
+
+        /// <summary>
+        /// Build a key for modelPath. The model is hashed together with "<model>.data" if present,
+        /// the usual name of its external weights. Files whose size and last write time match the
+        /// manifest are not hashed again.
+        /// </summary>
+        CompiledModelKey CreateKey(
+            const std::filesystem::path& modelPath, std::string executionProvider, std::string deviceType, std::string runtimeVersion);
+
+        /// <summary>
+        /// Hash a file's contents, as 16 hex digits
+        /// </summary>
+        static std::string HashFile(const std::filesystem::path& path);
+
+        /// <summary>
+        /// The compiled model for key, if a valid one is cached. Invalid entries are removed.
+        /// </summary>
+        std::optional<std::filesystem::path> Find(const CompiledModelKey& key);
+
+        /// <summary>
+        /// Find the compiled model for key, or compile modelPath into the cache. Returns no path if
+        /// compilation fails.
+        /// </summary>
+        std::optional<std::filesystem::path> GetOrCompile(const std::filesystem::path& modelPath, const CompiledModelKey& key, const ModelCompiler& compiler);
+
+        /// <summary>
+        /// Total size of all cached entries in bytes
+        /// </summary>
+        uint64_t GetTotalSize() const;
+
+    private:
+        struct Entry
+        {
+            std::string id; // Folder name, derived from the key
+            CompiledModelKey key;
+            std::string artifactName;
+            uint64_t artifactSize = 0;
+            int64_t artifactWriteTime = 0;
+            uint64_t totalSize = 0; // All files in the entry's folder
+            int64_t lastUsed = 0;
+        };
+
+        /// <summary>
+        /// Hash of a source model file, valid while its size and last write time are unchanged
+        /// </summary>
+        struct SourceHash
+        {
+            std::string path;
+            uint64_t size = 0;
+            int64_t writeTime = 0;
+            std::string hash;
+        };
+
+        static std::string GetEntryId(const CompiledModelKey& key);
+
+        std::string GetSourceHash(const std::filesystem::path& path);
+
+        void LoadManifest();
+        void SaveManifest() const;
+        bool IsValid(const Entry& entry) const;
+        void RemoveEntry(size_t index);
+        void EvictToLimit(const std::string& keepId);
+
+        std::filesystem::path m_cacheFolder;
+        uint64_t m_maxSizeBytes;
+        std::vector<Entry> m_entries;
+        std::vector<SourceHash> m_sourceHashes;
+    };
+
+} // namespace Shared
+} // namespace WindowsML
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 #include "ImageProcessor.h"
+#include "TensorPreprocessor.h"
 #include <MemoryBuffer.h>
 #include <winrt/Windows.Storage.h>
 #include <winrt/Windows.Storage.Streams.h>
@@ -31,23 +32,20 @@ namespace Shared
 
     std::vector<float> ImageProcessor::BindVideoFrameAsTensor(const VideoFrame& frame)
     {
-        SoftwareBitmap bitmap = frame.SoftwareBitmap();
-        SoftwareBitmap bitmapBgra8 = SoftwareBitmap::Convert(bitmap, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
-
-        InMemoryRandomAccessStream stream = InMemoryRandomAccessStream();
-
-        BitmapEncoder encoder = BitmapEncoder::CreateAsync(BitmapEncoder::BmpEncoderId(), stream).get();
-        encoder.SetSoftwareBitmap(bitmapBgra8);
-        encoder.BitmapTransform().ScaledWidth(IMAGE_SIZE);
-        encoder.BitmapTransform().ScaledHeight(IMAGE_SIZE);
-        encoder.BitmapTransform().InterpolationMode(BitmapInterpolationMode::Fant);
-        encoder.FlushAsync().get();
+        std::vector<float> tensorData(CHANNELS * IMAGE_SIZE * IMAGE_SIZE);
+        BindVideoFrameAsTensor(frame, tensorData.data());
+        return tensorData;
+    }
 
-        stream.Seek(0);
-        BitmapDecoder decoder = BitmapDecoder::CreateAsync(stream).get();
-        SoftwareBitmap resizedBitmap = decoder.GetSoftwareBitmapAsync(BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore).get();
+    void ImageProcessor::BindVideoFrameAsTensor(const VideoFrame& frame, float* tensorData)
+    {
+        SoftwareBitmap bitmap = frame.SoftwareBitmap();
+        SoftwareBitmap bitmapBgra8 = (bitmap.BitmapPixelFormat() == BitmapPixelFormat::Bgra8)
+                                         ? bitmap
+                                         : SoftwareBitmap::Convert(bitmap, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
 
-        BitmapBuffer bitmapBuffer = resizedBitmap.LockBuffer(BitmapBufferAccessMode::Read);
+        BitmapBuffer bitmapBuffer = bitmapBgra8.LockBuffer(BitmapBufferAccessMode::Read);
+        BitmapPlaneDescription plane = bitmapBuffer.GetPlaneDescription(0);
 
         IMemoryBufferReference reference = bitmapBuffer.CreateReference();
 
@@ -55,31 +53,22 @@ namespace Shared
         uint8_t* pixelData = nullptr;
         uint32_t pixelDataCapacity = 0;
 
-        spByteAccess->GetBuffer(&pixelData, &pixelDataCapacity);
-
-        std::vector<float> tensorData(CHANNELS * IMAGE_SIZE * IMAGE_SIZE);
-
-        for (int y = 0; y < IMAGE_SIZE; ++y)
-        {
-            for (int x = 0; x < IMAGE_SIZE; ++x)
-            {
-                int idx = (y * IMAGE_SIZE + x) * 4; // BGRA stride
-                int offset = y * IMAGE_SIZE + x;
+        winrt::check_hresult(spByteAccess->GetBuffer(&pixelData, &pixelDataCapacity));
 
-                // The required input size is (3x224x224),
-                // normalized using mean=[0.485, 0.456, 0.406]
-                // and std=[0.229, 0.224, 0.225]
-                float r = static_cast<float>(pixelData[idx + 2]) / 255.0f;
-                float g = static_cast<float>(pixelData[idx + 1]) / 255.0f;
-                float b = static_cast<float>(pixelData[idx + 0]) / 255.0f;
+        BgraImageView image;
+        image.pixels = pixelData + plane.StartIndex;
+        image.width = static_cast<uint32_t>(plane.Width);
+        image.height = static_cast<uint32_t>(plane.Height);
+        image.stride = static_cast<uint32_t>(plane.Stride);
 
-                tensorData[0 * IMAGE_SIZE * IMAGE_SIZE + offset] = (r - MEAN_R) / STD_R;
-                tensorData[1 * IMAGE_SIZE * IMAGE_SIZE + offset] = (g - MEAN_G) / STD_G;
-                tensorData[2 * IMAGE_SIZE * IMAGE_SIZE + offset] = (b - MEAN_B) / STD_B;
-            }
-        }
+        // The required input size is (3x224x224),
+        // normalized using mean=[0.485, 0.456, 0.406]
+        // and std=[0.229, 0.224, 0.225].
+        // Resizing, BGRA to planar RGB conversion, and normalization happen in one pass over the
+        // pixels, instead of encoding a resized copy of the image and decoding it again.
+        constexpr ChannelNormalization normalization = {{MEAN_R, MEAN_G, MEAN_B}, {STD_R, STD_G, STD_B}};
 
-        return tensorData;
+        TensorPreprocessor::ConvertBgraToTensor(image, IMAGE_SIZE, IMAGE_SIZE, normalization, tensorData);
     }
 
 } // namespace Shared
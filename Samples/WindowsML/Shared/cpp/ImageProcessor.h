@@ -17,6 +17,9 @@ namespace Shared
     class ImageProcessor
     {
     public:
+        static constexpr int IMAGE_SIZE = 224;
+        static constexpr int CHANNELS = 3;
+
         /// <summary>
         /// Load an image file asynchronously and return as VideoFrame
         /// </summary>
@@ -27,10 +30,13 @@ namespace Shared
         /// </summary>
         static std::vector<float> BindVideoFrameAsTensor(const winrt::Windows::Media::VideoFrame& frame);
 
-    private:
-        static constexpr int IMAGE_SIZE = 224;
-        static constexpr int CHANNELS = 3;
+        /// <summary>
+        /// Convert VideoFrame to normalized tensor data, writing CHANNELS x IMAGE_SIZE x IMAGE_SIZE
+        /// values to tensorData (for example, one image's slice of a batch tensor)
+        /// </summary>
+        static void BindVideoFrameAsTensor(const winrt::Windows::Media::VideoFrame& frame, float* tensorData);
 
+    private:
         // ImageNet normalization constants
         static constexpr float MEAN_R = 0.485f;
         static constexpr float MEAN_G = 0.456f;
@@ -0,0 +1,140 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "InferenceBenchmark.h"
+#include "InferenceContext.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr int WARMUP_RUNS = 10;
+
+        /// <summary>
+        /// Allocations and latencies of one way of running inference
+        /// </summary>
+        struct BenchmarkResult
+        {
+            uint64_t allocationCount = 0;
+            std::vector<double> latenciesMs;
+        };
+
+        template <typename InferenceFunction>
+        BenchmarkResult Measure(int runCount, const AllocationCounter& countAllocations, InferenceFunction&& runInference)
+        {
+            for (int i = 0; i < WARMUP_RUNS; ++i)
+            {
+                runInference();
+            }
+
+            BenchmarkResult result;
+            result.latenciesMs.reserve(static_cast<size_t>(runCount));
+
+            const uint64_t allocationsBefore = countAllocations ? countAllocations() : 0;
+            for (int i = 0; i < runCount; ++i)
+            {
+                const Clock::time_point start = Clock::now();
+                runInference();
+                result.latenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            if (countAllocations)
+            {
+                result.allocationCount = countAllocations() - allocationsBefore;
+            }
+
+            return result;
+        }
+
+        double Percentile(const std::vector<double>& sortedValues, double percentile)
+        {
+            // Nearest-rank percentile
+            size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sortedValues.size()));
+            return sortedValues[std::clamp<size_t>(rank, 1, sortedValues.size()) - 1];
+        }
+
+        void PrintResult(const char* name, BenchmarkResult& result, int runCount, bool isCountingAllocations)
+        {
+            std::vector<double>& latencies = result.latenciesMs;
+            std::sort(latencies.begin(), latencies.end());
+            double mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+
+            std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1) << std::setw(12);
+            if (isCountingAllocations)
+            {
+                std::cout << static_cast<double>(result.allocationCount) / runCount;
+            }
+            else
+            {
+                std::cout << "-";
+            }
+            std::cout << std::setprecision(3) << std::setw(10) << mean
+                      << std::setw(10) << Percentile(latencies, 50.0) << std::setw(10) << Percentile(latencies, 90.0) << std::setw(10)
+                      << Percentile(latencies, 99.0) << std::setw(10) << latencies.back() << std::defaultfloat << "\n";
+        }
+    } // namespace
+
+    void InferenceBenchmark::Run(
+        Ort::Session& session,
+        const char* inputName,
+        const char* outputName,
+        const std::vector<int64_t>& inputShape,
+        std::span<const float> inputData,
+        int runCount,
+        const AllocationCounter& countAllocations)
+    {
+        if (runCount < 1)
+        {
+            return;
+        }
+
+        InferenceContext inferenceContext(session, inputName, outputName, inputShape);
+        if (inferenceContext.GetInputData().size() != inputData.size())
+        {
+            throw std::runtime_error("Benchmark input does not match the model input shape.");
+        }
+
+        std::cout << "\nBenchmarking " << runCount << " inferences (" << WARMUP_RUNS << " warm-up runs each)..." << std::endl;
+
+        // Per-call tensors: the preprocessing output, input tensor, and result vector are created for every inference
+        const char* inputNames[] = {inputName};
+        const char* outputNames[] = {outputName};
+        // (as InferenceEngine::CreateInputTensor and ExtractResults do)
+        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        BenchmarkResult perCallResult = Measure(runCount, countAllocations, [&]() {
+            std::vector<float> inputTensorValues(inputData.begin(), inputData.end());
+            Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+                memoryInfo, inputTensorValues.data(), inputTensorValues.size(), inputShape.data(), inputShape.size());
+            auto outputTensors = session.Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
+            const float* outputData = outputTensors[0].GetTensorData<float>();
+            std::vector<float> results(outputData, outputData + outputTensors[0].GetTensorTypeAndShapeInfo().GetElementCount());
+        });
+
+        // Reused binding: preprocessing writes into the bound input and results are read in place
+        BenchmarkResult reusedResult = Measure(runCount, countAllocations, [&]() {
+            std::copy(inputData.begin(), inputData.end(), inferenceContext.GetInputData().begin());
+            inferenceContext.Run();
+        });
+
+        std::cout << "-----------------------------------------------------------------------------------\n";
+        std::cout << std::left << std::setw(22) << "" << std::right << std::setw(12) << "Allocs/run" << std::setw(10) << "Mean ms"
+                  << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "Max ms"
+                  << "\n";
+        std::cout << "-----------------------------------------------------------------------------------\n";
+        PrintResult("Per-call tensors", perCallResult, runCount, static_cast<bool>(countAllocations));
+        PrintResult("Reused I/O binding", reusedResult, runCount, static_cast<bool>(countAllocations));
+        std::cout << "-----------------------------------------------------------------------------------" << std::endl;
+    }
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+#include <winml/onnxruntime_cxx_api.h>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Returns the number of heap allocations made so far
+    /// </summary>
+    using AllocationCounter = std::function<uint64_t()>;
+
+    /// <summary>
+    /// Repeated-inference benchmark comparing per-call tensors with a reused InferenceContext
+    /// </summary>
+    class InferenceBenchmark
+    {
+    public:
+        /// <summary>
+        /// Run inference runCount times each way on the same input and print the latency distribution.
+        /// Heap allocations per inference are printed too when countAllocations is given; the
+        /// InferenceBenchmark target in cpp-cmake counts them by replacing operator new, so only those
+        /// made by that executable are included, not those inside onnxruntime.dll.
+        /// </summary>
+        static void Run(
+            Ort::Session& session,
+            const char* inputName,
+            const char* outputName,
+            const std::vector<int64_t>& inputShape,
+            std::span<const float> inputData,
+            int runCount,
+            const AllocationCounter& countAllocations = {});
+    };
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "InferenceContext.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+        size_t GetElementCount(const std::vector<int64_t>& shape)
+        {
+            return std::accumulate(shape.begin(), shape.end(), size_t{1}, [](size_t count, int64_t dimension) {
+                return count * static_cast<size_t>(dimension);
+            });
+        }
+
+        /// <summary>
+        /// Index of the named model input or output, which need not be the first
+        /// </summary>
+        template <typename GetName>
+        size_t FindByName(size_t count, const char* name, GetName&& getName)
+        {
+            Ort::AllocatorWithDefaultOptions allocator;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (strcmp(getName(i, allocator).get(), name) == 0)
+                {
+                    return i;
+                }
+            }
+            throw std::runtime_error(std::string("Model has no tensor named ") + name);
+        }
+
+        void CheckIsFloatTensor(const Ort::TypeInfo& typeInfo, const char* name)
+        {
+            if (typeInfo.GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT)
+            {
+                throw std::runtime_error(std::string("InferenceContext only supports float tensors, but ") + name + " is not");
+            }
+        }
+    } // namespace
+
+    InferenceContext::InferenceContext(Ort::Session& session, const char* inputName, const char* outputName, const std::vector<int64_t>& inputShape) :
+        m_session(session), m_binding(session)
+    {
+        // The buffers are float, so check that the model's tensors are too
+        const size_t inputIndex = FindByName(session.GetInputCount(), inputName, [&](size_t i, Ort::AllocatorWithDefaultOptions& allocator) {
+            return session.GetInputNameAllocated(i, allocator);
+        });
+        const size_t outputIndex = FindByName(session.GetOutputCount(), outputName, [&](size_t i, Ort::AllocatorWithDefaultOptions& allocator) {
+            return session.GetOutputNameAllocated(i, allocator);
+        });
+        CheckIsFloatTensor(session.GetInputTypeInfo(inputIndex), inputName);
+        const Ort::TypeInfo outputTypeInfo = session.GetOutputTypeInfo(outputIndex);
+        CheckIsFloatTensor(outputTypeInfo, outputName);
+
+        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+        m_inputBuffer.resize(GetElementCount(inputShape));
+        m_inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, m_inputBuffer.data(), m_inputBuffer.size(), inputShape.data(), inputShape.size());
+        m_binding.BindInput(inputName, m_inputTensor);
+
+        // The output batch dimension follows the input; any other dynamic dimension is only known after
+        // a run, in which case ONNX Runtime allocates the output instead
+        std::vector<int64_t> outputShape = outputTypeInfo.GetTensorTypeAndShapeInfo().GetShape();
+        if (!outputShape.empty() && outputShape[0] == -1 && !inputShape.empty())
+        {
+            outputShape[0] = inputShape[0];
+        }
+
+        if (std::find(outputShape.begin(), outputShape.end(), -1) == outputShape.end())
+        {
+            m_outputBuffer.resize(GetElementCount(outputShape));
+            m_outputTensor =
+                Ort::Value::CreateTensor<float>(memoryInfo, m_outputBuffer.data(), m_outputBuffer.size(), outputShape.data(), outputShape.size());
+            m_binding.BindOutput(outputName, m_outputTensor);
+        }
+        else
+        {
+            m_binding.BindOutput(outputName, memoryInfo);
+        }
+    }
+
+    std::span<float> InferenceContext::GetInputData() noexcept
+    {
+        return m_inputBuffer;
+    }
+
+    std::span<const float> InferenceContext::Run()
+    {
+        m_binding.SynchronizeInputs();
+        m_session.Run(Ort::RunOptions{nullptr}, m_binding);
+        m_binding.SynchronizeOutputs();
+
+        if (!m_outputBuffer.empty())
+        {
+            return m_outputBuffer;
+        }
+
+        m_outputTensor = std::move(m_binding.GetOutputValues()[0]);
+        return {m_outputTensor.GetTensorData<float>(), m_outputTensor.GetTensorTypeAndShapeInfo().GetElementCount()};
+    }
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+#include <winml/onnxruntime_cxx_api.h>
+#include <span>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Input and output tensors allocated once per session and bound with Ort::IoBinding, so repeated
+    /// inference runs without allocating or copying tensor data
+    /// </summary>
+    class InferenceContext
+    {
+    public:
+        InferenceContext(Ort::Session& session, const char* inputName, const char* outputName, const std::vector<int64_t>& inputShape);
+
+        InferenceContext(const InferenceContext&) = delete;
+        InferenceContext& operator=(const InferenceContext&) = delete;
+
+        /// <summary>
+        /// The bound input tensor; preprocessing writes here directly
+        /// </summary>
+        std::span<float> GetInputData() noexcept;
+
+        /// <summary>
+        /// Run inference on the bound input and return the output tensor in place
+        /// </summary>
+        std::span<const float> Run();
+
+    private:
+        Ort::Session& m_session;
+        Ort::IoBinding m_binding;
+        std::vector<float> m_inputBuffer;
+        std::vector<float> m_outputBuffer; // Empty when the output shape is only known after a run
+        Ort::Value m_inputTensor{nullptr};
+        Ort::Value m_outputTensor{nullptr};
+    };
+
+} // namespace Shared
+} // namespace WindowsML
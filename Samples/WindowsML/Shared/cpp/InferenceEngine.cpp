@@ -1,6 +1,7 @@
 ﻿// Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 #include "InferenceEngine.h"
+#include "CompiledModelCache.h"
 #include "ExecutionProviderManager.h"
 #include "ModelManager.h"
 #include <iostream>
@@ -34,9 +35,51 @@ namespace Shared
         const CommandLineOptions& options,
         const std::filesystem::path& modelPath,
         const std::filesystem::path& compiledModelPath,
+        const std::filesystem::path& compiledModelCacheFolder,
         Ort::SessionOptions& sessionOptions,
         Ort::Env& env)
     {
+        if (options.output_path.empty())
+        {
+            // A compiled model is only valid for the model, EP and runtime that produced it
+            std::string executionProvider = options.ep_policy.has_value()
+                                                ? "policy:" + ArgumentParser::ToString(options.ep_policy.value())
+                                                : winrt::to_string(options.ep_name);
+            std::string deviceType = options.device_type.has_value() ? winrt::to_string(options.device_type.value()) : std::string{};
+
+            CompiledModelCache cache(compiledModelCacheFolder);
+            CompiledModelKey key =
+                cache.CreateKey(modelPath, std::move(executionProvider), std::move(deviceType), Ort::GetVersionString());
+
+            std::optional<std::filesystem::path> cachedModelPath;
+            if (options.compile_model)
+            {
+                cachedModelPath = cache.GetOrCompile(modelPath, key, [&](const std::filesystem::path& sourcePath, const std::filesystem::path& targetPath) {
+                    const OrtApi& ortApi = Ort::GetApi();
+                    OrtStatus* status = ModelManager::CompileModel(ortApi, env, sessionOptions, sourcePath, targetPath);
+                    if (status != nullptr)
+                    {
+                        ortApi.ReleaseStatus(status);
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            else
+            {
+                cachedModelPath = cache.Find(key);
+            }
+
+            if (cachedModelPath.has_value())
+            {
+                std::cout << "Using cached compiled model: " << cachedModelPath.value() << std::endl;
+                return cachedModelPath.value();
+            }
+
+            std::cout << "Using original model: " << modelPath << std::endl;
+            return modelPath;
+        }
+
         std::filesystem::path actualModelPath;
         bool isCompiledModelAvailable = std::filesystem::exists(compiledModelPath);
 
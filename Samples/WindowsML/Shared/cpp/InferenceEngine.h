@@ -24,12 +24,16 @@ namespace Shared
         static Ort::SessionOptions CreateSessionOptions(const CommandLineOptions& options, Ort::Env& env);
 
         /// <summary>
-        /// Determine which model to use (compiled vs original) and create session
+        /// Determine which model to use (compiled vs original), compiling it if requested. Compiled
+        /// models go to compiledModelPath when --compiled_output is given, and otherwise to a cache in
+        /// compiledModelCacheFolder keyed by the model's contents, the EP configuration and the ONNX
+        /// Runtime version.
         /// </summary>
         static std::filesystem::path DetermineModelPath(
             const CommandLineOptions& options,
             const std::filesystem::path& modelPath,
             const std::filesystem::path& compiledModelPath,
+            const std::filesystem::path& compiledModelCacheFolder,
             Ort::SessionOptions& sessionOptions,
             Ort::Env& env);
 
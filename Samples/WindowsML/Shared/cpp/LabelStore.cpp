@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "LabelStore.h"
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LABEL_STORE_USE_SSE2
+#endif
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+        // Call onLine(begin, end) for each line of data, without the line break. The newline scan
+        // compares 16 bytes at a time where SSE2 is available.
+        template <typename LineHandler>
+        void ForEachLine(const char* data, size_t size, LineHandler&& onLine)
+        {
+            size_t lineStart = 0;
+            size_t i = 0;
+
+#ifdef LABEL_STORE_USE_SSE2
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+                while (mask != 0)
+                {
+                    size_t lineEnd = i + static_cast<size_t>(std::countr_zero(mask));
+                    onLine(lineStart, lineEnd);
+                    lineStart = lineEnd + 1;
+                    mask &= mask - 1;
+                }
+            }
+#endif
+
+            while (const void* found = std::memchr(data + i, '\n', size - i))
+            {
+                size_t lineEnd = static_cast<size_t>(static_cast<const char*>(found) - data);
+                onLine(lineStart, lineEnd);
+                lineStart = i = lineEnd + 1;
+            }
+
+            if (lineStart < size)
+            {
+                onLine(lineStart, size);
+            }
+        }
+
+        // Parse "digits," at the start of a line, returning the index and the position after the comma
+        bool TryParseIndex(const char* data, size_t begin, size_t end, size_t& index, size_t& labelStart)
+        {
+            size_t value = 0;
+            size_t i = begin;
+            for (; i < end && data[i] >= '0' && data[i] <= '9'; ++i)
+            {
+                value = value * 10 + static_cast<size_t>(data[i] - '0');
+                if (value > (std::numeric_limits<uint32_t>::max)())
+                {
+                    return false;
+                }
+            }
+
+            if (i == begin || i == end || data[i] != ',')
+            {
+                return false;
+            }
+
+            index = value;
+            labelStart = i + 1;
+            return true;
+        }
+    } // namespace
+
+    LabelStore::LabelStore(const std::filesystem::path& labelsPath)
+    {
+#ifdef _WIN32
+        HANDLE file = ::CreateFileW(labelsPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Unable to load labels file.");
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!::GetFileSizeEx(file, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) > (std::numeric_limits<uint32_t>::max)())
+        {
+            ::CloseHandle(file);
+            throw std::runtime_error("Unable to load labels file.");
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+
+        // An empty file can't be mapped, and has no labels anyway
+        if (m_size != 0)
+        {
+            m_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping != nullptr)
+            {
+                m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+        }
+        ::CloseHandle(file);
+
+        if (m_size != 0 && m_data == nullptr)
+        {
+            Unmap();
+            throw std::runtime_error("Unable to map labels file.");
+        }
+#else
+        int file = ::open(labelsPath.c_str(), O_RDONLY);
+        struct stat fileStatus{};
+        if (file < 0 || ::fstat(file, &fileStatus) != 0 || static_cast<uint64_t>(fileStatus.st_size) > (std::numeric_limits<uint32_t>::max)())
+        {
+            if (file >= 0)
+            {
+                ::close(file);
+            }
+            throw std::runtime_error("Unable to load labels file.");
+        }
+        m_size = static_cast<size_t>(fileStatus.st_size);
+
+        if (m_size != 0)
+        {
+            void* view = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+            m_data = view == MAP_FAILED ? nullptr : static_cast<const char*>(view);
+        }
+        ::close(file);
+
+        if (m_size != 0 && m_data == nullptr)
+        {
+            throw std::runtime_error("Unable to map labels file.");
+        }
+#endif
+
+        IndexLabels();
+    }
+
+    LabelStore::~LabelStore()
+    {
+        Unmap();
+    }
+
+    LabelStore::LabelStore(LabelStore&& other) noexcept :
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_mapping(std::exchange(other.m_mapping, nullptr)),
+        m_labels(std::move(other.m_labels))
+    {
+    }
+
+    LabelStore& LabelStore::operator=(LabelStore&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_labels = std::move(other.m_labels);
+        }
+        return *this;
+    }
+
+    size_t LabelStore::GetCount() const noexcept
+    {
+        return m_labels.size();
+    }
+
+    std::string_view LabelStore::GetLabel(size_t index) const noexcept
+    {
+        if (index >= m_labels.size())
+        {
+            return {};
+        }
+
+        const LabelRange& range = m_labels[index];
+        return {m_data + range.offset, range.length};
+    }
+
+    void LabelStore::Unmap() noexcept
+    {
+#ifdef _WIN32
+        if (m_data != nullptr)
+        {
+            ::UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr)
+        {
+            ::CloseHandle(m_mapping);
+        }
+#else
+        if (m_data != nullptr)
+        {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_size = 0;
+        m_labels.clear();
+    }
+
+    void LabelStore::IndexLabels()
+    {
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        // Skip a UTF-8 byte order mark
+        size_t start = 0;
+        if (m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+        {
+            start = 3;
+        }
+
+        // The first line decides the format
+        size_t firstLineEnd = start;
+        while (firstLineEnd < m_size && m_data[firstLineEnd] != '\n')
+        {
+            ++firstLineEnd;
+        }
+        size_t index = 0;
+        size_t labelStart = 0;
+        const bool isIndexed = TryParseIndex(m_data, start, firstLineEnd, index, labelStart);
+
+        // Guess the label count from the size of a typical label line, to avoid most regrowth
+        m_labels.reserve((m_size - start) / 16);
+
+        ForEachLine(m_data + start, m_size - start, [&](size_t begin, size_t end) {
+            begin += start;
+            end += start;
+            if (end > begin && m_data[end - 1] == '\r')
+            {
+                --end;
+            }
+
+            if (!isIndexed)
+            {
+                m_labels.push_back({static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)});
+                return;
+            }
+
+            // Malformed lines are skipped. No file has more labels than bytes, which bounds the table.
+            if (!TryParseIndex(m_data, begin, end, index, labelStart) || index >= m_size)
+            {
+                return;
+            }
+            if (index >= m_labels.size())
+            {
+                m_labels.resize(index + 1);
+            }
+            m_labels[index] = {static_cast<uint32_t>(labelStart), static_cast<uint32_t>(end - labelStart)};
+        });
+
+        m_labels.shrink_to_fit();
+    }
+
+} // namespace Shared
+} // namespace WindowsML
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+// This header is platform-neutral, so label loading can be built and measured without Windows
+// headers.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// Class labels read from a memory-mapped text file. The file is indexed in one pass and labels
+    /// are returned as views into the mapping, so no string is allocated per label. Two formats are
+    /// recognized from the first line:
+    ///   "index,label" lines, e.g. "0,tench", where the index need not be in order; or
+    ///   one label per line, where the line number is the index.
+    /// </summary>
+    class LabelStore
+    {
+    public:
+        LabelStore() = default;
+        explicit LabelStore(const std::filesystem::path& labelsPath);
+        ~LabelStore();
+
+        LabelStore(LabelStore&& other) noexcept;
+        LabelStore& operator=(LabelStore&& other) noexcept;
+        LabelStore(const LabelStore&) = delete;
+        LabelStore& operator=(const LabelStore&) = delete;
+
+        /// <summary>
+        /// One more than the highest label index
+        /// </summary>
+        size_t GetCount() const noexcept;
+
+        /// <summary>
+        /// The label for a class index; empty if the file has none. Valid while the store exists.
+        /// </summary>
+        std::string_view GetLabel(size_t index) const noexcept;
+
+        std::string_view operator[](size_t index) const noexcept
+        {
+            return GetLabel(index);
+        }
+
+    private:
+        struct LabelRange
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        void Unmap() noexcept;
+        void IndexLabels();
+
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_mapping = nullptr; // Platform mapping handle, if any
+        std::vector<LabelRange> m_labels;
+    };
+
+} // namespace Shared
+} // namespace WindowsML
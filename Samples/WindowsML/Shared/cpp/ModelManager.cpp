@@ -109,27 +109,9 @@ namespace Shared
         return GetModulePath(nullptr);
     }
 
-    std::vector<std::string> ModelManager::LoadLabels(const std::filesystem::path& labelsPath)
+    LabelStore ModelManager::LoadLabels(const std::filesystem::path& labelsPath)
     {
-        std::ifstream labelFile{labelsPath, std::ifstream::in};
-        if (labelFile.fail())
-        {
-            throw std::runtime_error("Unable to load labels file.");
-        }
-
-        std::vector<std::string> labels(1000);
-        for (std::string s; std::getline(labelFile, s, ',');)
-        {
-            int labelValue = stoi(s);
-            if (labelValue >= labels.size())
-            {
-                labels.resize(labelValue + 1);
-            }
-            std::getline(labelFile, s);
-            labels[labelValue] = s;
-        }
-
-        return labels;
+        return LabelStore{labelsPath};
     }
 
     void ModelManager::SetDefaultPaths(
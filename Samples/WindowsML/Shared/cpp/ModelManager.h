@@ -8,6 +8,7 @@
 #include <string>
 #include <windows.h>
 #include "ArgumentParser.h"
+#include "LabelStore.h"
 
 namespace WindowsML
 {
@@ -41,9 +42,9 @@ namespace Shared
         static std::filesystem::path GetExecutablePath();
 
         /// <summary>
-        /// Load labels from text file
+        /// Load labels from text file, memory-mapped; see LabelStore for the formats
         /// </summary>
-        static std::vector<std::string> LoadLabels(const std::filesystem::path& labelsPath);
+        static LabelStore LoadLabels(const std::filesystem::path& labelsPath);
 
         /// <summary>
         /// Set default model paths based on executable location
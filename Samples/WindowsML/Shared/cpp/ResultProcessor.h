@@ -2,8 +2,10 @@
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 #pragma once
 
+#include <span>
 #include <vector>
 #include <string>
+#include "LabelStore.h"
 
 namespace WindowsML
 {
@@ -19,20 +21,20 @@ namespace Shared
         /// <summary>
         /// Apply softmax to results and print top predictions
         /// </summary>
-        static void PrintResults(const std::vector<std::string>& labels, const std::vector<float>& results);
+        static void PrintResults(const LabelStore& labels, std::span<const float> results);
 
         /// <summary>
         /// Apply softmax normalization to raw results
         /// </summary>
-        static std::vector<float> ApplySoftmax(const std::vector<float>& results);
+        static std::vector<float> ApplySoftmax(std::span<const float> results);
 
         /// <summary>
         /// Get top N predictions with confidence scores
         /// </summary>
-        static std::vector<std::pair<int, float>> GetTopPredictions(const std::vector<float>& softmaxResults, int topN = 5);
+        static std::vector<std::pair<int, float>> GetTopPredictions(std::span<const float> softmaxResults, int topN = 5);
 
     private:
-        static void PrintPredictionTable(const std::vector<std::string>& labels, const std::vector<std::pair<int, float>>& topPredictions);
+        static void PrintPredictionTable(const LabelStore& labels, const std::vector<std::pair<int, float>>& topPredictions);
     };
 
 } // namespace Shared
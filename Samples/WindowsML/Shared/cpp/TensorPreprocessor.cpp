@@ -0,0 +1,406 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "TensorPreprocessor.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// TENSOR_PREPROCESSOR_NO_SIMD selects the scalar path and TENSOR_PREPROCESSOR_NO_AVX2 the SSE2 path
+// everywhere, so that each path can be built and compared on one machine.
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && !defined(TENSOR_PREPROCESSOR_NO_SIMD)
+#include <immintrin.h>
+#define TENSOR_PREPROCESSOR_USE_SSE2
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TENSOR_PREPROCESSOR_TARGET_AVX2
+#else
+#define TENSOR_PREPROCESSOR_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
+#endif
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    namespace
+    {
+#ifdef TENSOR_PREPROCESSOR_USE_SSE2
+        bool IsAvx2Supported()
+        {
+#if defined(TENSOR_PREPROCESSOR_NO_AVX2)
+            return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+
+            // AVX2 needs OS support for saving the YMM registers; F16C and FMA come with it in practice.
+            __cpuid(info, 1);
+            constexpr int fmaBit = 1 << 12;
+            constexpr int osxsaveBit = 1 << 27;
+            constexpr int f16cBit = 1 << 29;
+            if ((info[2] & (fmaBit | osxsaveBit | f16cBit)) != (fmaBit | osxsaveBit | f16cBit) || (_xgetbv(0) & 6) != 6)
+            {
+                return false;
+            }
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#endif
+        }
+
+        const bool g_isAvx2Supported = IsAvx2Supported();
+#endif
+
+        // Sum weighted source rows into one row of floats, four per pixel. This is the vertical half
+        // of the resampling and touches every source byte, so it has the widest vector paths.
+#ifndef TENSOR_PREPROCESSOR_USE_SSE2
+        void AccumulateRowsScalar(const uint8_t* const* rows, const float* weights, uint32_t rowCount, size_t length, float* output)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                output[i] = rows[0][i] * weights[0];
+            }
+
+            for (uint32_t k = 1; k < rowCount; ++k)
+            {
+                for (size_t i = 0; i < length; ++i)
+                {
+                    output[i] += rows[k][i] * weights[k];
+                }
+            }
+        }
+#else
+        void AccumulateRowsSse2(const uint8_t* const* rows, const float* weights, uint32_t rowCount, size_t length, float* output)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const size_t vectorLength = length & ~size_t{15};
+
+            for (uint32_t k = 0; k < rowCount; ++k)
+            {
+                const uint8_t* row = rows[k];
+                const __m128 weight = _mm_set1_ps(weights[k]);
+
+                for (size_t i = 0; i < vectorLength; i += 16)
+                {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                    __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                    __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+                    __m128 values[4] = {
+                        _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)),
+                        _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)),
+                        _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)),
+                        _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero))};
+
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        __m128 product = _mm_mul_ps(values[j], weight);
+                        if (k != 0)
+                        {
+                            product = _mm_add_ps(product, _mm_loadu_ps(output + i + j * 4));
+                        }
+                        _mm_storeu_ps(output + i + j * 4, product);
+                    }
+                }
+
+                for (size_t i = vectorLength; i < length; ++i)
+                {
+                    output[i] = (k != 0 ? output[i] : 0.0f) + row[i] * weights[k];
+                }
+            }
+        }
+
+        TENSOR_PREPROCESSOR_TARGET_AVX2
+        void AccumulateRowsAvx2(const uint8_t* const* rows, const float* weights, uint32_t rowCount, size_t length, float* output)
+        {
+            const size_t vectorLength = length & ~size_t{31};
+
+            for (uint32_t k = 0; k < rowCount; ++k)
+            {
+                const uint8_t* row = rows[k];
+                const __m256 weight = _mm256_set1_ps(weights[k]);
+
+                for (size_t i = 0; i < vectorLength; i += 32)
+                {
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + i + j * 8));
+                        __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+
+                        float* target = output + i + j * 8;
+                        __m256 sum = (k != 0) ? _mm256_fmadd_ps(values, weight, _mm256_loadu_ps(target)) : _mm256_mul_ps(values, weight);
+                        _mm256_storeu_ps(target, sum);
+                    }
+                }
+
+                for (size_t i = vectorLength; i < length; ++i)
+                {
+                    output[i] = (k != 0 ? output[i] : 0.0f) + row[i] * weights[k];
+                }
+            }
+        }
+
+        TENSOR_PREPROCESSOR_TARGET_AVX2
+        void ConvertFloatsToHalvesAvx2(const float* input, size_t count, uint16_t* output)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), halves);
+            }
+
+            for (; i < count; ++i)
+            {
+                output[i] = TensorPreprocessor::FloatToHalf(input[i]);
+            }
+        }
+#endif
+
+        void AccumulateRows(const uint8_t* const* rows, const float* weights, uint32_t rowCount, size_t length, float* output)
+        {
+#ifdef TENSOR_PREPROCESSOR_USE_SSE2
+            if (g_isAvx2Supported)
+            {
+                AccumulateRowsAvx2(rows, weights, rowCount, length, output);
+            }
+            else
+            {
+                AccumulateRowsSse2(rows, weights, rowCount, length, output);
+            }
+#else
+            AccumulateRowsScalar(rows, weights, rowCount, length, output);
+#endif
+        }
+
+        void ConvertFloatsToHalves(const float* input, size_t count, uint16_t* output)
+        {
+#ifdef TENSOR_PREPROCESSOR_USE_SSE2
+            if (g_isAvx2Supported)
+            {
+                ConvertFloatsToHalvesAvx2(input, count, output);
+                return;
+            }
+#endif
+            for (size_t i = 0; i < count; ++i)
+            {
+                output[i] = TensorPreprocessor::FloatToHalf(input[i]);
+            }
+        }
+    } // namespace
+
+    TensorPreprocessor::ResampleFilter TensorPreprocessor::CreateResampleFilter(uint32_t sourceSize, uint32_t targetSize)
+    {
+        ResampleFilter filter;
+        filter.firstSource.resize(targetSize);
+        filter.sourceCount.resize(targetSize);
+        filter.firstWeight.resize(targetSize);
+
+        const double scale = static_cast<double>(sourceSize) / targetSize;
+
+        for (uint32_t i = 0; i < targetSize; ++i)
+        {
+            filter.firstWeight[i] = static_cast<uint32_t>(filter.weights.size());
+
+            if (scale >= 1.0)
+            {
+                // Average the source pixels covered by [start, end), weighting the partially covered ones.
+                const double start = i * scale;
+                const double end = std::min((i + 1) * scale, static_cast<double>(sourceSize));
+                const uint32_t first = static_cast<uint32_t>(start);
+                const uint32_t last = std::min(static_cast<uint32_t>(std::ceil(end)), sourceSize);
+
+                filter.firstSource[i] = first;
+                filter.sourceCount[i] = last - first;
+                for (uint32_t j = first; j < last; ++j)
+                {
+                    const double covered = std::min(end, j + 1.0) - std::max(start, static_cast<double>(j));
+                    filter.weights.push_back(static_cast<float>(covered / scale));
+                }
+            }
+            else
+            {
+                // Interpolate between the two source pixels nearest the target pixel's center.
+                const double center = (i + 0.5) * scale - 0.5;
+                const double floor = std::floor(center);
+                const float fraction = static_cast<float>(center - floor);
+                const int64_t first = static_cast<int64_t>(floor);
+
+                if (first < 0 || first + 1 >= sourceSize)
+                {
+                    filter.firstSource[i] = static_cast<uint32_t>(std::clamp<int64_t>(first < 0 ? 0 : first + 1, 0, sourceSize - 1));
+                    filter.sourceCount[i] = 1;
+                    filter.weights.push_back(1.0f);
+                }
+                else
+                {
+                    filter.firstSource[i] = static_cast<uint32_t>(first);
+                    filter.sourceCount[i] = 2;
+                    filter.weights.push_back(1.0f - fraction);
+                    filter.weights.push_back(fraction);
+                }
+            }
+        }
+
+        return filter;
+    }
+
+    template <typename Store>
+    void TensorPreprocessor::ConvertBgraRows(
+        const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, Store&& storeRow)
+    {
+        if (image.pixels == nullptr || image.width == 0 || image.height == 0 || image.stride / 4 < image.width || width == 0 || height == 0)
+        {
+            throw std::invalid_argument("Invalid image or tensor size");
+        }
+
+        const ResampleFilter columns = CreateResampleFilter(image.width, width);
+        const ResampleFilter rows = CreateResampleFilter(image.height, height);
+
+        // Fold the division by 255, the mean, and the standard deviation into one multiply-add per
+        // channel, in the B, G, R, A order of the pixels.
+        float scale[4] = {};
+        float bias[4] = {};
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            scale[2 - channel] = 1.0f / (255.0f * normalization.std[channel]);
+            bias[2 - channel] = -normalization.mean[channel] / normalization.std[channel];
+        }
+
+        const size_t rowLength = static_cast<size_t>(image.width) * 4;
+        std::vector<float> rowSum(rowLength);
+        std::vector<float> planes(static_cast<size_t>(width) * 3);
+        std::vector<const uint8_t*> sourceRows;
+
+        float* r = planes.data();
+        float* g = r + width;
+        float* b = g + width;
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            sourceRows.clear();
+            for (uint32_t k = 0; k < rows.sourceCount[y]; ++k)
+            {
+                sourceRows.push_back(image.pixels + static_cast<size_t>(rows.firstSource[y] + k) * image.stride);
+            }
+
+            AccumulateRows(sourceRows.data(), &rows.weights[rows.firstWeight[y]], rows.sourceCount[y], rowLength, rowSum.data());
+
+            // Horizontal half of the resampling, with one pixel's four channels in each vector.
+#ifdef TENSOR_PREPROCESSOR_USE_SSE2
+            const __m128 scaleVector = _mm_loadu_ps(scale);
+            const __m128 biasVector = _mm_loadu_ps(bias);
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const float* source = rowSum.data() + static_cast<size_t>(columns.firstSource[x]) * 4;
+                const float* weights = &columns.weights[columns.firstWeight[x]];
+
+                __m128 sum = _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(weights[0]));
+                for (uint32_t k = 1; k < columns.sourceCount[x]; ++k)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + k * 4), _mm_set1_ps(weights[k])));
+                }
+
+                alignas(16) float pixel[4];
+                _mm_store_ps(pixel, _mm_add_ps(_mm_mul_ps(sum, scaleVector), biasVector));
+                b[x] = pixel[0];
+                g[x] = pixel[1];
+                r[x] = pixel[2];
+            }
+#else
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const float* source = rowSum.data() + static_cast<size_t>(columns.firstSource[x]) * 4;
+                const float* weights = &columns.weights[columns.firstWeight[x]];
+
+                float pixel[3] = {};
+                for (uint32_t k = 0; k < columns.sourceCount[x]; ++k)
+                {
+                    for (int channel = 0; channel < 3; ++channel)
+                    {
+                        pixel[channel] += source[k * 4 + channel] * weights[k];
+                    }
+                }
+
+                b[x] = pixel[0] * scale[0] + bias[0];
+                g[x] = pixel[1] * scale[1] + bias[1];
+                r[x] = pixel[2] * scale[2] + bias[2];
+            }
+#endif
+
+            storeRow(y, planes.data());
+        }
+    }
+
+    void TensorPreprocessor::ConvertBgraToTensor(
+        const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, float* tensorData)
+    {
+        const size_t planeSize = static_cast<size_t>(width) * height;
+
+        ConvertBgraRows(image, width, height, normalization, [&](uint32_t y, const float* planes) {
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                memcpy(tensorData + channel * planeSize + static_cast<size_t>(y) * width, planes + channel * width, width * sizeof(float));
+            }
+        });
+    }
+
+    void TensorPreprocessor::ConvertBgraToTensor(
+        const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, uint16_t* tensorData)
+    {
+        const size_t planeSize = static_cast<size_t>(width) * height;
+
+        ConvertBgraRows(image, width, height, normalization, [&](uint32_t y, const float* planes) {
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                ConvertFloatsToHalves(planes + channel * width, width, tensorData + channel * planeSize + static_cast<size_t>(y) * width);
+            }
+        });
+    }
+
+    uint16_t TensorPreprocessor::FloatToHalf(float value)
+    {
+        constexpr uint32_t infinity = 255u << 23;
+        constexpr uint32_t halfOverflow = (127u + 16) << 23; // 65536, which rounds to infinity
+        constexpr uint32_t subnormalMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        const uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint32_t half;
+        if (bits >= halfOverflow)
+        {
+            half = (bits > infinity) ? 0x7E00 : 0x7C00; // NaN or infinity
+        }
+        else if (bits < (113u << 23))
+        {
+            // Subnormal or zero: adding the magic number lets the FPU do the rounding.
+            const float sum = std::bit_cast<float>(bits) + std::bit_cast<float>(subnormalMagic);
+            half = std::bit_cast<uint32_t>(sum) - subnormalMagic;
+        }
+        else
+        {
+            // Rebias the exponent and round the mantissa to nearest even.
+            const uint32_t mantissaOdd = (bits >> 13) & 1;
+            bits += ((15u - 127u) << 23) + 0xFFF;
+            bits += mantissaOdd;
+            half = bits >> 13;
+        }
+
+        return static_cast<uint16_t>(half | (sign >> 16));
+    }
+
+} // namespace Shared
+} // namespace WindowsML
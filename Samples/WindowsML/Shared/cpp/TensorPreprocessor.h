@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#pragma once
+
+// This header is platform-neutral, so preprocessing can be built and measured on raw BGRA buffers
+// without Windows imaging APIs.
+#include <cstdint>
+#include <vector>
+
+namespace WindowsML
+{
+namespace Shared
+{
+
+    /// <summary>
+    /// A 32-bit BGRA image in memory
+    /// </summary>
+    struct BgraImageView
+    {
+        const uint8_t* pixels = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0; // Bytes from the start of one row to the next
+    };
+
+    /// <summary>
+    /// Per-channel normalization of pixel values scaled to 0-1: (value - mean) / std
+    /// </summary>
+    struct ChannelNormalization
+    {
+        float mean[3]; // R, G, B
+        float std[3];  // R, G, B
+    };
+
+    /// <summary>
+    /// Converts BGRA images to normalized planar RGB (CHW) tensors in one pass. Resizing, channel
+    /// reordering, and normalization are fused, so no intermediate image is encoded or stored.
+    /// </summary>
+    class TensorPreprocessor
+    {
+    public:
+        /// <summary>
+        /// Resize an image and write it as a normalized 3 x height x width float tensor. Downscaling
+        /// averages the source pixels each output pixel covers, like the Fant interpolation mode;
+        /// upscaling is bilinear.
+        /// </summary>
+        static void ConvertBgraToTensor(
+            const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, float* tensorData);
+
+        /// <summary>
+        /// Same as above, writing IEEE half-precision values for models with float16 inputs
+        /// </summary>
+        static void ConvertBgraToTensor(
+            const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, uint16_t* tensorData);
+
+        /// <summary>
+        /// Convert a single-precision value to half precision, rounding to nearest even
+        /// </summary>
+        static uint16_t FloatToHalf(float value);
+
+    private:
+        /// <summary>
+        /// Source pixels and weights that contribute to each output row or column
+        /// </summary>
+        struct ResampleFilter
+        {
+            std::vector<uint32_t> firstSource;
+            std::vector<uint32_t> sourceCount;
+            std::vector<uint32_t> firstWeight;
+            std::vector<float> weights;
+        };
+
+        static ResampleFilter CreateResampleFilter(uint32_t sourceSize, uint32_t targetSize);
+
+        template <typename Store>
+        static void ConvertBgraRows(
+            const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization, Store&& storeRow);
+    };
+
+} // namespace Shared
+} // namespace WindowsML
@@ -7,6 +7,13 @@
 #include "ArgumentParser.h"
 #include "ExecutionProviderManager.h"
 #include "ImageProcessor.h"
+#include "TensorPreprocessor.h"
 #include "ModelManager.h"
+#include "CompiledModelCache.h"
+#include "LabelStore.h"
 #include "InferenceEngine.h"
+#include "InferenceContext.h"
+#include "InferenceBenchmark.h"
 #include "ResultProcessor.h"
+#include "ClassificationPostprocessor.h"
+#include "BatchProcessor.h"
@@ -0,0 +1,339 @@
+#include "CompiledModelCache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+using WindowsML::Shared::CompiledModelCache;
+using WindowsML::Shared::CompiledModelKey;
+using WindowsML::Shared::ModelCompiler;
+
+namespace
+{
+int g_failureCount = 0;
+
+void Check(bool condition, std::string_view testName, std::string_view what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << testName << ": " << what << "\n";
+        ++g_failureCount;
+    }
+}
+
+void WriteFile(const std::filesystem::path& path, std::string_view contents)
+{
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+// Number of staging folders and unsaved manifests left in the cache folder
+size_t CountTemporaryItems(const std::filesystem::path& cacheFolder)
+{
+    size_t count = 0;
+    for (const auto& item : std::filesystem::directory_iterator(cacheFolder))
+    {
+        count += item.path().extension() == ".tmp" ? 1 : 0;
+    }
+    return count;
+}
+
+/// <summary>
+/// A stand-in for compiling with an execution provider: writes the artifact, and a file an EP might
+/// write next to it, and counts its calls
+/// </summary>
+struct FakeCompiler
+{
+    size_t callCount = 0;
+    size_t artifactSize = 100;
+    bool succeeds = true;
+    bool writesArtifact = true;
+
+    ModelCompiler Get()
+    {
+        return [this](const std::filesystem::path& modelPath, const std::filesystem::path& compiledModelPath) {
+            ++callCount;
+            if (writesArtifact)
+            {
+                WriteFile(compiledModelPath, std::string(artifactSize, 'c') + ReadFile(modelPath));
+                WriteFile(compiledModelPath.parent_path() / "ep_context.bin", "context");
+            }
+            return succeeds;
+        };
+    }
+};
+
+/// <summary>
+/// A cache folder and a source model in a fresh temporary folder, removed afterwards
+/// </summary>
+class TestFolder
+{
+public:
+    explicit TestFolder(std::string_view name) :
+        m_folder(std::filesystem::temp_directory_path() / ("CompiledModelCacheTest." + std::string{name}))
+    {
+        std::filesystem::remove_all(m_folder);
+        std::filesystem::create_directories(m_folder);
+        WriteModel("model", "weights");
+    }
+
+    ~TestFolder()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_folder, error);
+    }
+
+    std::filesystem::path GetCacheFolder() const
+    {
+        return m_folder / "cache";
+    }
+
+    std::filesystem::path WriteModel(std::string_view name, std::string_view contents) const
+    {
+        const std::filesystem::path path = m_folder / (std::string{name} + ".onnx");
+        WriteFile(path, contents);
+        return path;
+    }
+
+    std::filesystem::path GetModel() const
+    {
+        return m_folder / "model.onnx";
+    }
+
+private:
+    std::filesystem::path m_folder;
+};
+
+CompiledModelKey CreateKey(CompiledModelCache& cache, const std::filesystem::path& modelPath, std::string executionProvider = "CPU")
+{
+    return cache.CreateKey(modelPath, std::move(executionProvider), "", "1.22.0");
+}
+
+// The microsecond use times must differ for the least recently used entry to be well defined
+void WaitForNextUse()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+void CheckHitAndMiss()
+{
+    constexpr std::string_view name = "hit and miss";
+    TestFolder folder{name};
+    FakeCompiler compiler;
+
+    std::optional<std::filesystem::path> compiledPath;
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        const CompiledModelKey key = CreateKey(cache, folder.GetModel());
+        Check(!cache.Find(key), name, "an empty cache has no entry");
+
+        compiledPath = cache.GetOrCompile(folder.GetModel(), key, compiler.Get());
+        Check(compiledPath && compiler.callCount == 1, name, "a miss compiles the model");
+        Check(compiledPath && compiledPath->filename() == "model_ctx.onnx" && std::filesystem::exists(*compiledPath), name,
+              "the artifact is named after the model");
+        Check(compiledPath && std::filesystem::exists(compiledPath->parent_path() / "ep_context.bin"), name,
+              "files written next to the artifact are kept");
+        Check(CountTemporaryItems(folder.GetCacheFolder()) == 0, name, "no staging folder is left");
+
+        Check(cache.GetOrCompile(folder.GetModel(), key, compiler.Get()) == compiledPath && compiler.callCount == 1, name,
+              "a hit doesn't compile again");
+        Check(cache.GetTotalSize() == 100 + std::string_view{"weights"}.size() + std::string_view{"context"}.size(), name,
+              "the total size counts every file in the entry");
+
+        // Every part of the key selects a separate entry
+        const CompiledModelKey otherProvider = CreateKey(cache, folder.GetModel(), "DML");
+        Check(!cache.Find(otherProvider), name, "the execution provider is part of the key");
+        CompiledModelKey otherRuntime = key;
+        otherRuntime.runtimeVersion = "1.23.0";
+        Check(!cache.Find(otherRuntime), name, "the runtime version is part of the key");
+    }
+
+    // A new cache object reads the entry from the manifest, and a changed model gets a new key
+    CompiledModelCache cache{folder.GetCacheFolder()};
+    const CompiledModelKey key = CreateKey(cache, folder.GetModel());
+    Check(cache.GetOrCompile(folder.GetModel(), key, compiler.Get()) == compiledPath && compiler.callCount == 1, name,
+          "the manifest keeps entries across instances");
+
+    folder.WriteModel("model", "new weights");
+    const CompiledModelKey changedKey = CreateKey(cache, folder.GetModel());
+    Check(changedKey.modelHash != key.modelHash, name, "a changed model is hashed again");
+    Check(!cache.Find(changedKey), name, "a changed model misses");
+}
+
+void CheckStaleManifest()
+{
+    constexpr std::string_view name = "stale manifest";
+    TestFolder folder{name};
+    FakeCompiler compiler;
+
+    CompiledModelKey key;
+    std::filesystem::path compiledPath;
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        key = CreateKey(cache, folder.GetModel());
+        compiledPath = cache.GetOrCompile(folder.GetModel(), key, compiler.Get()).value_or("");
+    }
+
+    // An artifact changed behind the manifest's back is discarded and compiled again
+    WriteFile(compiledPath, "truncated");
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        Check(!cache.Find(key), name, "a changed artifact is not reused");
+        Check(!std::filesystem::exists(compiledPath), name, "a changed artifact is removed");
+        Check(cache.GetOrCompile(folder.GetModel(), key, compiler.Get()) == compiledPath && compiler.callCount == 2, name,
+              "a changed artifact is compiled again");
+    }
+
+    // So is an entry whose folder is gone
+    std::filesystem::remove_all(compiledPath.parent_path());
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        Check(cache.GetOrCompile(folder.GetModel(), key, compiler.Get()) == compiledPath && compiler.callCount == 3, name,
+              "a missing entry is compiled again");
+    }
+
+    // A manifest from another version is ignored
+    WriteFile(folder.GetCacheFolder() / "manifest.txt", "# CompiledModelCache v1\n");
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        Check(!cache.Find(key) && cache.GetTotalSize() == 0, name, "a manifest of another version leaves the cache empty");
+    }
+
+    // Only stale folders and unsaved manifests the manifest doesn't describe are removed, since recent
+    // ones may belong to another process
+    const std::filesystem::path staleStaging = folder.GetCacheFolder() / "0123456789abcdef.00000001.tmp";
+    const std::filesystem::path recentStaging = folder.GetCacheFolder() / "0123456789abcdef.00000002.tmp";
+    const std::filesystem::path staleManifest = folder.GetCacheFolder() / "manifest.txt.00000003.tmp";
+    std::filesystem::create_directories(staleStaging);
+    std::filesystem::create_directories(recentStaging);
+    WriteFile(staleManifest, "partial");
+    const auto staleTime = std::filesystem::file_time_type::clock::now() - CompiledModelCache::STALE_FOLDER_AGE - std::chrono::hours(1);
+    std::filesystem::last_write_time(staleStaging, staleTime);
+    std::filesystem::last_write_time(staleManifest, staleTime);
+    {
+        CompiledModelCache cache{folder.GetCacheFolder()};
+        Check(!std::filesystem::exists(staleStaging), name, "a stale staging folder is removed");
+        Check(!std::filesystem::exists(staleManifest), name, "a stale unsaved manifest is removed");
+        Check(std::filesystem::exists(recentStaging), name, "a recent staging folder is kept");
+    }
+}
+
+void CheckEviction()
+{
+    constexpr std::string_view name = "LRU eviction";
+    TestFolder folder{name};
+    FakeCompiler compiler;
+
+    // Each entry holds the artifact (100 bytes and the model) and the 7-byte EP file, about 110
+    // bytes, so two fit and a third evicts one
+    CompiledModelCache cache{folder.GetCacheFolder(), 250};
+    const auto modelA = folder.WriteModel("a", "a");
+    const auto modelB = folder.WriteModel("b", "b");
+    const auto modelC = folder.WriteModel("c", "c");
+    const CompiledModelKey keyA = CreateKey(cache, modelA);
+    const CompiledModelKey keyB = CreateKey(cache, modelB);
+    const CompiledModelKey keyC = CreateKey(cache, modelC);
+
+    const auto pathA = cache.GetOrCompile(modelA, keyA, compiler.Get());
+    WaitForNextUse();
+    const auto pathB = cache.GetOrCompile(modelB, keyB, compiler.Get());
+    WaitForNextUse();
+
+    // Using A makes B the least recently used entry, which C replaces
+    Check(cache.Find(keyA) == pathA, name, "A is cached");
+    WaitForNextUse();
+    const auto pathC = cache.GetOrCompile(modelC, keyC, compiler.Get());
+    Check(pathA && pathB && pathC && compiler.callCount == 3, name, "each model is compiled once");
+    Check(cache.Find(keyA) && cache.Find(keyC), name, "recently used A and the new C are kept");
+    Check(!cache.Find(keyB) && pathB && !std::filesystem::exists(pathB->parent_path()), name,
+          "least recently used B is evicted with its folder");
+    Check(cache.GetTotalSize() <= 250, name, "the cache is within its limit");
+
+    // An entry larger than the limit by itself is still kept, so it can be used
+    compiler.artifactSize = 1000;
+    const auto modelD = folder.WriteModel("d", "d");
+    const CompiledModelKey keyD = CreateKey(cache, modelD);
+    const auto pathD = cache.GetOrCompile(modelD, keyD, compiler.Get());
+    Check(pathD && std::filesystem::exists(*pathD), name, "an entry over the limit by itself is kept");
+    Check(!cache.Find(keyA) && !cache.Find(keyC), name, "every other entry is evicted for it");
+}
+
+void CheckFailedCompile()
+{
+    constexpr std::string_view name = "failed compile";
+    TestFolder folder{name};
+    FakeCompiler compiler;
+
+    CompiledModelCache cache{folder.GetCacheFolder()};
+    const CompiledModelKey key = CreateKey(cache, folder.GetModel());
+
+    compiler.succeeds = false;
+    Check(!cache.GetOrCompile(folder.GetModel(), key, compiler.Get()), name, "a failed compile returns no path");
+    Check(CountTemporaryItems(folder.GetCacheFolder()) == 0 && cache.GetTotalSize() == 0, name,
+          "a failed compile leaves no staging folder or entry");
+
+    compiler.succeeds = true;
+    compiler.writesArtifact = false;
+    Check(!cache.GetOrCompile(folder.GetModel(), key, compiler.Get()), name, "a compile that writes no artifact returns no path");
+    Check(CountTemporaryItems(folder.GetCacheFolder()) == 0, name, "a compile that writes no artifact leaves no staging folder");
+
+    compiler.writesArtifact = true;
+    Check(cache.GetOrCompile(folder.GetModel(), key, compiler.Get()) && compiler.callCount == 3, name,
+          "a failed compile is tried again next time");
+}
+
+void CheckConcurrentCompile()
+{
+    constexpr std::string_view name = "concurrent compile";
+    TestFolder folder{name};
+    FakeCompiler compiler;
+
+    // Both caches load the manifest before either compiles, as two processes starting at once would
+    CompiledModelCache first{folder.GetCacheFolder()};
+    CompiledModelCache second{folder.GetCacheFolder()};
+    const CompiledModelKey key = CreateKey(first, folder.GetModel());
+
+    const auto firstPath = first.GetOrCompile(folder.GetModel(), key, compiler.Get());
+    const std::string firstArtifact = firstPath ? ReadFile(*firstPath) : std::string{};
+
+    // The second compile finds the first one's entry in place when it moves its own there
+    compiler.artifactSize = 200;
+    const auto secondPath = second.GetOrCompile(folder.GetModel(), key, compiler.Get());
+    Check(secondPath && secondPath == firstPath && compiler.callCount == 2, name, "the second compile uses the entry already in place");
+    Check(firstPath && ReadFile(*firstPath) == firstArtifact, name, "the entry in place is not replaced");
+    Check(CountTemporaryItems(folder.GetCacheFolder()) == 0, name, "the second compile's staging folder is removed");
+    Check(second.Find(key) == firstPath, name, "the entry in place is added to the second cache");
+}
+} // namespace
+
+int main()
+{
+    CheckHitAndMiss();
+    CheckStaleManifest();
+    CheckEviction();
+    CheckFailedCompile();
+    CheckConcurrentCompile();
+
+    if (g_failureCount != 0)
+    {
+        std::cerr << g_failureCount << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "All checks passed.\n";
+    return 0;
+}
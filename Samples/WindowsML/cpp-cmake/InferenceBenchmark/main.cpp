@@ -0,0 +1,98 @@
+#include "ResNetModelHelper.hpp"
+#include "InferenceBenchmark.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cwchar>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <vector>
+#include <winrt/base.h>
+#include <winml/onnxruntime_cxx_api.h>
+#include <winml/Runtime.h>
+
+namespace
+{
+std::atomic<uint64_t> g_allocationCount{0};
+}
+
+// Count every heap allocation made through operator new in this executable, which exists only to
+// run the benchmark. The array and nothrow forms call this one.
+void* operator new(size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Usage: InferenceBenchmark [runs]
+int wmain(int argc, wchar_t* argv[]) noexcept
+{
+    const int runCount = argc > 1 ? static_cast<int>(std::wcstol(argv[1], nullptr, 10)) : 1000;
+    if (runCount < 1)
+    {
+        std::cerr << "Usage: InferenceBenchmark [runs]\n";
+        return -1;
+    }
+
+    try
+    {
+        // Initialize WinML runtime first. This will add the necessary package dependencies to the process, and initialize the OnnxRuntime.
+        Microsoft::Windows::AI::MachineLearning::WinMLRuntime winmlRuntime;
+        if (FAILED(winmlRuntime.GetHResult()))
+        {
+            std::cerr << "Failed to initialize WinML runtime: " << std::hex << winmlRuntime.GetHResult() << std::endl;
+            return -1;
+        }
+
+        winrt::init_apartment();
+        Ort::Env env(ORT_LOGGING_LEVEL_ERROR, "InferenceBenchmark");
+
+        // Only the CPU execution provider, so the runs are comparable across machines
+        Ort::SessionOptions sessionOptions;
+        sessionOptions.SetEpSelectionPolicy(OrtExecutionProviderDevicePolicy_PREFER_CPU);
+
+        const std::filesystem::path executableFolder = ResNetModelHelper::GetExecutablePath().parent_path();
+        Ort::Session session(env, (executableFolder / L"model.onnx").c_str(), sessionOptions);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto inputName = session.GetInputNameAllocated(0, allocator);
+        auto outputName = session.GetOutputNameAllocated(0, allocator);
+
+        std::vector<int64_t> inputShape = session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if (!inputShape.empty() && inputShape[0] == -1)
+        {
+            inputShape[0] = 1;
+        }
+
+        auto inputBitmap = ResNetModelHelper::LoadImageFileAsync(winrt::hstring{(executableFolder / L"dog.jpg").c_str()}).get();
+        std::vector<float> inputData = ResNetModelHelper::BindSoftwareBitmapAsTensor(inputBitmap);
+
+        WindowsML::Shared::InferenceBenchmark::Run(
+            session, inputName.get(), outputName.get(), inputShape, inputData, runCount, []() {
+                return g_allocationCount.load(std::memory_order_relaxed);
+            });
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return -1;
+    }
+
+    return 0;
+}
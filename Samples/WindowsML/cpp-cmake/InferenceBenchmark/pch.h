@@ -0,0 +1,24 @@
+#pragma once
+
+// clang-format off
+#include <unknwn.h>
+#include <windows.h>
+#include <winrt/base.h>
+#include <wil/win32_helpers.h>
+// clang-format on
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <MemoryBuffer.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <winrt/Microsoft.Windows.AI.MachineLearning.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Graphics.Imaging.h>
+#include <winrt/Windows.Media.h>
+#include <winrt/Windows.Storage.h>
+#include <winrt/Windows.Storage.Streams.h>
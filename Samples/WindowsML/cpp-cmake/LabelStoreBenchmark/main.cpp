@@ -0,0 +1,121 @@
+#include "LabelStore.h"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using WindowsML::Shared::LabelStore;
+
+namespace
+{
+constexpr size_t LabelCount = 1'000'000;
+
+void WriteLabelFile(const std::filesystem::path& path, bool isIndexed)
+{
+    std::ofstream file{path, std::ios::binary};
+    for (size_t i = 0; i < LabelCount; ++i)
+    {
+        if (isIndexed)
+        {
+            file << i << ',';
+        }
+        file << "label number " << i << " of the benchmark set\n";
+    }
+}
+
+// The previous "index,label" loader: getline and stoi into a growing vector of strings
+std::vector<std::string> LoadIndexedWithStreams(const std::filesystem::path& path)
+{
+    std::ifstream labelFile{path};
+    std::vector<std::string> labels(1000);
+    for (std::string s; std::getline(labelFile, s, ',');)
+    {
+        size_t labelValue = static_cast<size_t>(std::stoi(s));
+        if (labelValue >= labels.size())
+        {
+            labels.resize(labelValue + 1);
+        }
+        std::getline(labelFile, s);
+        labels[labelValue] = s;
+    }
+    return labels;
+}
+
+// The previous line-per-label loader
+std::vector<std::string> LoadLinesWithStreams(const std::filesystem::path& path)
+{
+    std::ifstream labelFile{path};
+    std::vector<std::string> labels;
+    for (std::string line; std::getline(labelFile, line);)
+    {
+        labels.push_back(line);
+    }
+    return labels;
+}
+
+// Best of five runs, in milliseconds. Each run loads the file and reads every label's length.
+double MeasureMilliseconds(const std::function<size_t()>& loadLabels)
+{
+    double best = 0.0;
+    for (int run = 0; run < 5; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (loadLabels() == 0)
+        {
+            std::cerr << "No labels were loaded\n";
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+} // namespace
+
+int main()
+{
+    const std::filesystem::path folder = std::filesystem::temp_directory_path();
+    const std::filesystem::path indexedPath = folder / L"LabelStoreBenchmark.indexed.txt";
+    const std::filesystem::path linesPath = folder / L"LabelStoreBenchmark.lines.txt";
+    WriteLabelFile(indexedPath, true);
+    WriteLabelFile(linesPath, false);
+
+    auto sumLengths = [](const auto& labels, size_t count) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += labels[i].size();
+        }
+        return total;
+    };
+
+    std::cout << "Loading " << LabelCount << " labels, best of 5 runs (ms)\n\n";
+    std::cout << std::setw(14) << "Format" << std::setw(16) << "Stream + stoi" << std::setw(14) << "LabelStore" << std::setw(10) << "Speedup\n";
+
+    for (bool isIndexed : {true, false})
+    {
+        const std::filesystem::path& path = isIndexed ? indexedPath : linesPath;
+
+        double streams = MeasureMilliseconds([&]() {
+            std::vector<std::string> labels = isIndexed ? LoadIndexedWithStreams(path) : LoadLinesWithStreams(path);
+            return sumLengths(labels, labels.size());
+        });
+
+        double labelStore = MeasureMilliseconds([&]() {
+            LabelStore labels{path};
+            return sumLengths(labels, labels.GetCount());
+        });
+
+        std::cout << std::setw(14) << (isIndexed ? "index,label" : "line per label") << std::fixed << std::setprecision(1)
+                  << std::setw(16) << streams << std::setw(14) << labelStore << std::setw(9) << streams / labelStore << "x\n";
+    }
+
+    std::filesystem::remove(indexedPath);
+    std::filesystem::remove(linesPath);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "LabelStore.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using WindowsML::Shared::LabelStore;
+
+namespace
+{
+int g_failureCount = 0;
+
+void Check(bool condition, std::string_view testName, std::string_view what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << testName << ": " << what << "\n";
+        ++g_failureCount;
+    }
+}
+
+std::filesystem::path WriteLabelFile(std::string_view contents)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / L"LabelStoreTest.txt";
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return path;
+}
+
+// Loads contents and checks every label against expected, where an empty string is a missing label
+void CheckLabels(std::string_view testName, std::string_view contents, const std::vector<std::string>& expected)
+{
+    const std::filesystem::path path = WriteLabelFile(contents);
+    {
+        LabelStore labels{path};
+        Check(labels.GetCount() == expected.size(), testName, "label count");
+        for (size_t i = 0; i < expected.size() && i < labels.GetCount(); ++i)
+        {
+            if (labels[i] != expected[i])
+            {
+                Check(false, testName, "label " + std::to_string(i) + " is \"" + std::string{labels[i]} + "\", expected \"" + expected[i] + "\"");
+            }
+        }
+        Check(labels[expected.size()].empty(), testName, "labels past the end are empty");
+    }
+    std::filesystem::remove(path);
+}
+
+// Labels long and short enough that line breaks fall at every position of the 16-byte newline scan
+std::vector<std::string> CreateManyLabels()
+{
+    std::vector<std::string> labels;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        labels.push_back("label " + std::string(i % 37, static_cast<char>('a' + i % 26)));
+    }
+    return labels;
+}
+
+std::string JoinLabels(const std::vector<std::string>& labels, bool isIndexed, std::string_view lineBreak)
+{
+    std::string contents;
+    for (size_t i = 0; i < labels.size(); ++i)
+    {
+        if (isIndexed)
+        {
+            contents += std::to_string(i) + ",";
+        }
+        contents += labels[i];
+        contents += lineBreak;
+    }
+    return contents;
+}
+} // namespace
+
+int main()
+{
+    const std::string bom = "\xEF\xBB\xBF";
+
+    // "index,label" lines
+    CheckLabels("indexed", "0,tench\n1,goldfish\n2,great white shark\n", {"tench", "goldfish", "great white shark"});
+    CheckLabels("indexed, CRLF", "0,tench\r\n1,goldfish\r\n2,great white shark\r\n", {"tench", "goldfish", "great white shark"});
+    CheckLabels("indexed, BOM", bom + "0,tench\n1,goldfish\n", {"tench", "goldfish"});
+    CheckLabels("indexed, BOM and CRLF", bom + "0,tench\r\n1,goldfish\r\n", {"tench", "goldfish"});
+    CheckLabels("indexed, no final line break", "0,tench\n1,goldfish", {"tench", "goldfish"});
+    CheckLabels("indexed, out of order with gaps", "3,three\n0,zero\n1,one\n", {"zero", "one", "", "three"});
+    CheckLabels("indexed, commas in labels", "0,crane, bird\n1,crane, machine\n", {"crane, bird", "crane, machine"});
+    CheckLabels("indexed, malformed lines skipped", "0,zero\nnot a label\n,empty index\n\n2,two\n99999,beyond the file size\n", {"zero", "", "two"});
+
+    // One label per line
+    CheckLabels("lines", "tench\ngoldfish\ngreat white shark\n", {"tench", "goldfish", "great white shark"});
+    CheckLabels("lines, CRLF", "tench\r\ngoldfish\r\n", {"tench", "goldfish"});
+    CheckLabels("lines, BOM", bom + "tench\ngoldfish\n", {"tench", "goldfish"});
+    CheckLabels("lines, BOM and CRLF", bom + "tench\r\ngoldfish\r\n", {"tench", "goldfish"});
+    CheckLabels("lines, no final line break", "tench\ngoldfish", {"tench", "goldfish"});
+    CheckLabels("lines, empty lines keep their index", "tench\n\r\n\ngoldfish\n", {"tench", "", "", "goldfish"});
+    CheckLabels("lines, commas in labels", "crane, bird\n1,2\n", {"crane, bird", "1,2"});
+
+    // Files long enough to exercise the vector newline scan, in every combination
+    const std::vector<std::string> manyLabels = CreateManyLabels();
+    for (bool isIndexed : {true, false})
+    {
+        for (std::string_view lineBreak : {std::string_view{"\n"}, std::string_view{"\r\n"}})
+        {
+            for (bool hasBom : {false, true})
+            {
+                const std::string name = std::string{"many labels"} + (isIndexed ? ", indexed" : ", lines") +
+                                         (lineBreak.size() == 2 ? ", CRLF" : ", LF") + (hasBom ? ", BOM" : "");
+                CheckLabels(name, (hasBom ? bom : std::string{}) + JoinLabels(manyLabels, isIndexed, lineBreak), manyLabels);
+            }
+        }
+    }
+
+    // Empty files have no labels
+    CheckLabels("empty", "", {});
+    CheckLabels("BOM only", bom, {});
+
+    // A moved store keeps its labels, and a missing file throws
+    {
+        const std::filesystem::path path = WriteLabelFile("0,tench\n1,goldfish\n");
+        LabelStore labels{path};
+        LabelStore moved{std::move(labels)};
+        Check(moved.GetCount() == 2 && moved[1] == "goldfish", "move", "moved store keeps its labels");
+        Check(labels.GetCount() == 0 && labels[0].empty(), "move", "moved-from store is empty");
+
+        LabelStore assigned;
+        assigned = std::move(moved);
+        Check(assigned.GetCount() == 2 && assigned[0] == "tench", "move", "assigned store keeps its labels");
+        std::filesystem::remove(path);
+
+        bool threw = false;
+        try
+        {
+            LabelStore missing{std::filesystem::temp_directory_path() / L"LabelStoreTest.missing.txt"};
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        Check(threw, "missing file", "throws");
+    }
+
+    if (g_failureCount != 0)
+    {
+        std::cerr << g_failureCount << " checks failed.\n";
+        return 1;
+    }
+
+    std::cout << "All checks passed.\n";
+    return 0;
+}
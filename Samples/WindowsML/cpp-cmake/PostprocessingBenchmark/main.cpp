@@ -0,0 +1,225 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE.md in the repo root for license information.
+#include "ClassificationPostprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using WindowsML::Shared::ClassificationPostprocessor;
+
+namespace
+{
+constexpr size_t TopCount = 5;
+
+// The previous approach: softmax into new vectors, then sort every (probability, index) pair
+std::vector<std::pair<float, int>> SortAllClasses(std::span<const float> logits)
+{
+    const float maxLogit = *std::ranges::max_element(logits);
+    std::vector<float> exps;
+    float sum = 0.0f;
+    for (float logit : logits)
+    {
+        exps.push_back(std::exp(logit - maxLogit));
+        sum += exps.back();
+    }
+
+    std::vector<std::pair<float, int>> results;
+    for (size_t i = 0; i < exps.size(); ++i)
+    {
+        results.emplace_back(exps[i] / sum, static_cast<int>(i));
+    }
+    std::sort(results.begin(), results.end(), std::greater<>());
+    results.resize(TopCount);
+    return results;
+}
+
+// Whether the top classes match SortAllClasses: the same classes in the same order, with
+// probabilities within the error of the vectorized exp and of summing in a different order. Classes
+// whose logits are nearly equal may come in either order.
+bool MatchesSortAllClasses(std::span<const float> logits, const std::vector<std::pair<int, float>>& topClasses, std::string_view name)
+{
+    const std::vector<std::pair<float, int>> expected = SortAllClasses(logits);
+    bool passed = topClasses.size() == expected.size();
+    for (size_t i = 0; passed && i < expected.size(); ++i)
+    {
+        const auto [index, probability] = topClasses[i];
+        const auto [expectedProbability, expectedIndex] = expected[i];
+        const bool isNearTie = std::fabs(logits[index] - logits[expectedIndex]) <= 1e-5f * std::fabs(logits[expectedIndex]);
+        passed = (index == expectedIndex || isNearTie) &&
+                 std::fabs(probability - expectedProbability) <= 1e-7f + 1e-4f * expectedProbability;
+        if (!passed)
+        {
+            std::cerr << name << " rank " << i << " is class " << index << " with " << probability << ", expected class " << expectedIndex
+                      << " with " << expectedProbability << "\n";
+        }
+    }
+    return passed;
+}
+
+// Checks the outputs that the timings don't: every logit -inf, where subtracting the max would make
+// every probability NaN, and logits of +inf, which take all of the probability.
+bool CheckInfiniteLogits()
+{
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    bool passed = true;
+
+    // Sizes with and without a remainder after the vector loops
+    for (size_t classCount : {size_t{7}, size_t{1000}})
+    {
+        const std::vector<float> logits(classCount, -infinity);
+        std::vector<float> probabilities(classCount);
+        ClassificationPostprocessor::Softmax(logits, probabilities);
+        const float uniform = 1.0f / static_cast<float>(classCount);
+        passed &= std::ranges::all_of(probabilities, [&](float probability) { return probability == uniform; });
+
+        const auto topClasses = ClassificationPostprocessor::TopKSoftmax(logits, TopCount);
+        for (size_t i = 0; i < topClasses.size(); ++i)
+        {
+            passed &= topClasses[i] == std::pair<int, float>{static_cast<int>(i), uniform};
+        }
+    }
+
+    std::vector<float> logits(1000, -infinity);
+    logits[10] = 1.0f;
+    logits[20] = infinity;
+    logits[30] = infinity;
+    std::vector<float> probabilities(logits.size());
+    ClassificationPostprocessor::Softmax(logits, probabilities);
+    for (size_t i = 0; i < probabilities.size(); ++i)
+    {
+        passed &= probabilities[i] == ((i == 20 || i == 30) ? 0.5f : 0.0f);
+    }
+
+    const auto topClasses = ClassificationPostprocessor::TopKSoftmax(logits, 3);
+    passed &= topClasses == std::vector<std::pair<int, float>>{{20, 0.5f}, {30, 0.5f}, {10, 0.0f}};
+
+    if (!passed)
+    {
+        std::cerr << "Softmax of infinite logits is not its limit\n";
+    }
+    return passed;
+}
+
+// Microseconds per batch, repeating the batch until at least 200 ms have been measured
+double MeasureMicroseconds(const std::function<void()>& processBatch)
+{
+    using Clock = std::chrono::steady_clock;
+
+    processBatch();
+
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    while (elapsed < std::chrono::milliseconds(200))
+    {
+        processBatch();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    }
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // --quick skips the timings, for a fast correctness check.
+    const bool quick = (argc > 1) && (std::string_view{argv[1]} == "--quick");
+
+    std::mt19937 random(42);
+    std::normal_distribution<float> logitDistribution(0.0f, 4.0f);
+
+    struct Case
+    {
+        size_t classCount;
+        size_t batchSize;
+        std::vector<float> logits;
+    };
+    std::vector<Case> cases;
+    for (size_t classCount : {size_t{1000}, size_t{32000}})
+    {
+        for (size_t batchSize : {size_t{1}, size_t{4}, size_t{16}, size_t{64}})
+        {
+            std::vector<float> logits(classCount * batchSize);
+            std::ranges::generate(logits, [&]() { return logitDistribution(random); });
+            cases.push_back({classCount, batchSize, std::move(logits)});
+        }
+    }
+
+    // Check every row against the previous approach before timing anything
+    bool passed = CheckInfiniteLogits();
+    for (const auto& [classCount, batchSize, logits] : cases)
+    {
+        std::vector<float> probabilities(classCount);
+        for (size_t row = 0; row < batchSize; ++row)
+        {
+            const auto rowLogits = std::span<const float>{logits}.subspan(row * classCount, classCount);
+            ClassificationPostprocessor::Softmax(rowLogits, probabilities);
+            passed &= MatchesSortAllClasses(rowLogits, ClassificationPostprocessor::TopK(probabilities, TopCount), "Softmax+TopK");
+            passed &= MatchesSortAllClasses(rowLogits, ClassificationPostprocessor::TopKSoftmax(rowLogits, TopCount), "TopKSoftmax");
+        }
+    }
+
+    if (!passed)
+    {
+        return 1;
+    }
+    std::cout << "Softmax+TopK and TopKSoftmax match sorting every class.\n";
+    if (quick)
+    {
+        return 0;
+    }
+
+    std::cout << "\nTop-" << TopCount << " classification post-processing, microseconds per batch\n\n";
+    std::cout << std::setw(8) << "Classes" << std::setw(7) << "Batch" << std::setw(14) << "Sort all" << std::setw(16) << "Softmax+TopK"
+              << std::setw(14) << "TopKSoftmax" << std::setw(10) << "Speedup" << "\n";
+
+    size_t checksum = 0;
+    for (const auto& [classCount, batchSize, logits] : cases)
+    {
+        std::vector<float> probabilities(logits.size());
+
+        auto rows = [&](auto&& processRow) {
+            for (size_t row = 0; row < batchSize; ++row)
+            {
+                processRow(std::span<const float>{logits}.subspan(row * classCount, classCount), row);
+            }
+        };
+
+        double sortAll = MeasureMicroseconds([&]() {
+            rows([&](std::span<const float> rowLogits, size_t) { checksum += SortAllClasses(rowLogits).front().second; });
+        });
+
+        double softmaxTopK = MeasureMicroseconds([&]() {
+            rows([&](std::span<const float> rowLogits, size_t row) {
+                std::span<float> rowProbabilities = std::span<float>{probabilities}.subspan(row * classCount, classCount);
+                ClassificationPostprocessor::Softmax(rowLogits, rowProbabilities);
+                checksum += ClassificationPostprocessor::TopK(rowProbabilities, TopCount).front().first;
+            });
+        });
+
+        double topKSoftmax = MeasureMicroseconds([&]() {
+            rows([&](std::span<const float> rowLogits, size_t) {
+                checksum += ClassificationPostprocessor::TopKSoftmax(rowLogits, TopCount).front().first;
+            });
+        });
+
+        std::cout << std::setw(8) << classCount << std::setw(7) << batchSize << std::fixed << std::setprecision(2) << std::setw(14) << sortAll
+                  << std::setw(16) << softmaxTopK << std::setw(14) << topKSoftmax << std::setw(9) << sortAll / topKSoftmax << "x\n";
+    }
+
+    // Keep the results observable so the measured work is not optimized away
+    std::cout << "\n(checksum " << checksum << ")\n";
+    return 0;
+}
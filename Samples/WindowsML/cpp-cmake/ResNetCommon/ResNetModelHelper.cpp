@@ -1,4 +1,6 @@
 #include "ResNetModelHelper.hpp"
+#include "ClassificationPostprocessor.h"
+#include "TensorPreprocessor.h"
 
 // clang-format off
 #include <winrt/base.h>
@@ -86,24 +88,17 @@ IAsyncOperation<SoftwareBitmap> LoadImageFileAsync(winrt::hstring filePath)
     co_return softwareBitmap;
 }
 
-std::vector<float> BindSoftwareBitmapAsTensor(SoftwareBitmap const& bitmap)
+namespace
 {
-    SoftwareBitmap bitmapBgra8 = SoftwareBitmap::Convert(bitmap, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
-
-    winrt::Windows::Storage::Streams::InMemoryRandomAccessStream stream = InMemoryRandomAccessStream();
-
-    BitmapEncoder encoder = BitmapEncoder::CreateAsync(BitmapEncoder::BmpEncoderId(), stream).get();
-    encoder.SetSoftwareBitmap(bitmapBgra8);
-    encoder.BitmapTransform().ScaledWidth(224);
-    encoder.BitmapTransform().ScaledHeight(224);
-    encoder.BitmapTransform().InterpolationMode(BitmapInterpolationMode::Fant);
-    encoder.FlushAsync().get();
-
-    stream.Seek(0);
-    BitmapDecoder decoder = BitmapDecoder::CreateAsync(stream).get();
-    SoftwareBitmap resizedBitmap = decoder.GetSoftwareBitmapAsync(BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore).get();
+template <typename T>
+std::vector<T> ConvertSoftwareBitmapToTensor(SoftwareBitmap const& bitmap)
+{
+    SoftwareBitmap bitmapBgra8 = bitmap.BitmapPixelFormat() == BitmapPixelFormat::Bgra8
+                                     ? bitmap
+                                     : SoftwareBitmap::Convert(bitmap, BitmapPixelFormat::Bgra8, BitmapAlphaMode::Ignore);
 
-    BitmapBuffer bitmapBuffer = resizedBitmap.LockBuffer(BitmapBufferAccessMode::Read);
+    BitmapBuffer bitmapBuffer = bitmapBgra8.LockBuffer(BitmapBufferAccessMode::Read);
+    BitmapPlaneDescription plane = bitmapBuffer.GetPlaneDescription(0);
 
     IMemoryBufferReference reference = bitmapBuffer.CreateReference();
 
@@ -111,70 +106,49 @@ std::vector<float> BindSoftwareBitmapAsTensor(SoftwareBitmap const& bitmap)
     uint8_t* pixelData = nullptr;
     uint32_t pixelDataCapacity = 0;
 
-    spByteAccess->GetBuffer(&pixelData, &pixelDataCapacity);
+    winrt::check_hresult(spByteAccess->GetBuffer(&pixelData, &pixelDataCapacity));
+
+    WindowsML::Shared::BgraImageView image;
+    image.pixels = pixelData + plane.StartIndex;
+    image.width = static_cast<uint32_t>(plane.Width);
+    image.height = static_cast<uint32_t>(plane.Height);
+    image.stride = static_cast<uint32_t>(plane.Stride);
 
     const int64_t channels = 3; // RGB
     const int64_t height = 224;
     const int64_t width = 224;
 
-    std::vector<int64_t> tensorShape = {1, channels, height, width};
-    std::vector<float> tensorData(channels * height * width);
+    // Resize, reorder BGRA to planar RGB, and normalize using mean=[0.485, 0.456, 0.406] and
+    // std=[0.229, 0.224, 0.225] in a single pass over the pixels
+    constexpr WindowsML::Shared::ChannelNormalization normalization{{0.485f, 0.456f, 0.406f}, {0.229f, 0.224f, 0.225f}};
 
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
-        {
-            int idx = (y * width + x) * 4; // BGRA stride
-            int offset = y * width + x;
-
-            // Normalize using mean=[0.485, 0.456, 0.406] and std=[0.229, 0.224, 0.225]
-            float r = static_cast<float>(pixelData[idx + 2]) / 255.0f;
-            float g = static_cast<float>(pixelData[idx + 1]) / 255.0f;
-            float b = static_cast<float>(pixelData[idx + 0]) / 255.0f;
-
-            tensorData[0 * height * width + offset] = (r - 0.485f) / 0.229f;
-            tensorData[1 * height * width + offset] = (g - 0.456f) / 0.224f;
-            tensorData[2 * height * width + offset] = (b - 0.406f) / 0.225f;
-        }
-    }
+    std::vector<T> tensorData(channels * height * width);
+    WindowsML::Shared::TensorPreprocessor::ConvertBgraToTensor(
+        image, static_cast<uint32_t>(width), static_cast<uint32_t>(height), normalization, tensorData.data());
     return tensorData;
 }
+} // namespace
 
-std::vector<std::string> LoadLabels(const std::filesystem::path& labelsPath)
+std::vector<float> BindSoftwareBitmapAsTensor(SoftwareBitmap const& bitmap)
 {
-    std::ifstream labelFile{labelsPath, std::ifstream::in};
-    if (labelFile.fail())
-    {
-        throw std::runtime_error("Unable to load file.");
-    }
+    return ConvertSoftwareBitmapToTensor<float>(bitmap);
+}
 
-    std::vector<std::string> labels;
-    for (std::string line; std::getline(labelFile, line);)
-    {
-        labels.push_back(line);
-    }
+std::vector<uint16_t> BindSoftwareBitmapAsFloat16Tensor(SoftwareBitmap const& bitmap)
+{
+    return ConvertSoftwareBitmapToTensor<uint16_t>(bitmap);
+}
 
-    return labels;
+WindowsML::Shared::LabelStore LoadLabels(const std::filesystem::path& labelsPath)
+{
+    return WindowsML::Shared::LabelStore{labelsPath};
 }
 
 std::vector<float> Softmax(std::span<const float> logits)
 {
-    std::vector<float> exps(logits.size());
-    const float maxLogit = *std::ranges::max_element(logits);
-
-    float sum = 0.0f;
-    for (size_t i = 0; i < logits.size(); ++i)
-    {
-        exps[i] = std::exp(logits[i] - maxLogit); // stability trick
-        sum += exps[i];
-    }
-
-    for (float& val : exps)
-    {
-        val /= sum;
-    }
-
-    return exps;
+    std::vector<float> probabilities(logits.size());
+    WindowsML::Shared::ClassificationPostprocessor::Softmax(logits, probabilities);
+    return probabilities;
 }
 /* Simple IEEE 754 half-precision (float16) conversion utility in C/C++. Can be replaced with half.hpp or other FP16
  * libraries if available. */
@@ -241,23 +215,14 @@ std::vector<float> ConvertFloat16ToFloat32(std::span<const uint16_t> float16Data
     return float32Data;
 }
 
-void PrintResults(const std::vector<std::string>& labels, const std::vector<float>& results)
+void PrintResults(const WindowsML::Shared::LabelStore& labels, const std::vector<float>& results)
 {
-    // Use softmax to convert logits to probabilities
-    std::vector<float> probabilities = Softmax(results);
-
-    // Sort the results
-    std::vector<std::pair<float, int>> topResults;
-    for (size_t i = 0; i < probabilities.size(); ++i)
-    {
-        topResults.emplace_back(probabilities[i], static_cast<int>(i));
-    }
-    std::sort(topResults.begin(), topResults.end(), std::greater<>());
+    // Select the top 5 classes and convert only their logits to probabilities
+    const auto topResults = WindowsML::Shared::ClassificationPostprocessor::TopKSoftmax(results, 5);
 
     // Print the top 5 results
-    for (size_t i = 0; i < std::min<size_t>(5, topResults.size()); ++i)
+    for (const auto& [index, probability] : topResults)
     {
-        const auto& [probability, index] = topResults[i];
         std::cout << labels[index] << " with confidence of " << probability << "\n";
     }
 }
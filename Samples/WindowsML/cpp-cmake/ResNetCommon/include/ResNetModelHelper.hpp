@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 
+#include "LabelStore.h"
+
 namespace ResNetModelHelper
 {
 std::wostream& operator<<(std::wostream& outputStream, const winrt::Microsoft::Windows::AI::MachineLearning::ExecutionProviderReadyResultState& readyResultState);
@@ -21,7 +23,9 @@ winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Graphics::Imaging::S
 
 std::vector<float> BindSoftwareBitmapAsTensor(const winrt::Windows::Graphics::Imaging::SoftwareBitmap& bitmap);
 
-std::vector<std::string> LoadLabels(const std::filesystem::path& labelsPath);
+std::vector<uint16_t> BindSoftwareBitmapAsFloat16Tensor(const winrt::Windows::Graphics::Imaging::SoftwareBitmap& bitmap);
+
+WindowsML::Shared::LabelStore LoadLabels(const std::filesystem::path& labelsPath);
 
 std::vector<float> Softmax(std::span<const float> logits);
 
@@ -29,5 +33,5 @@ std::vector<uint16_t> ConvertFloat32ToFloat16(std::span<const float> float32Data
 
 std::vector<float> ConvertFloat16ToFloat32(std::span<const uint16_t> float16Data);
 
-void PrintResults(const std::vector<std::string>& labels, const std::vector<float>& results);
+void PrintResults(const WindowsML::Shared::LabelStore& labels, const std::vector<float>& results);
 } // namespace ResNetModelHelper
@@ -1,10 +1,12 @@
 #include "ResNetModelHelper.hpp"
+#include "CompiledModelCache.h"
 
 #include <ranges>
 #include <winml/onnxruntime_c_api.h>
 #include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <winrt/base.h>
@@ -74,37 +76,43 @@ int wmain(int argc, wchar_t* argv[]) noexcept
         const std::filesystem::path modelPath = executableFolder / L"model.onnx";
         const std::filesystem::path labelsPath = executableFolder / L"model.Labels.txt";
         const std::filesystem::path inputImagePath = executableFolder / L"dog.jpg";
-        const std::filesystem::path compiledModelPath = executableFolder / L"model_ctx.onnx";
 
-        bool isCompiledModelAvailable = std::filesystem::exists(compiledModelPath);
-        if (isCompiledModelAvailable)
+        // Compiled models are cached by model contents, EP policy and ONNX Runtime version, so a stale
+        // compiled model is never loaded
+        WindowsML::Shared::CompiledModelCache compiledModelCache(executableFolder / L"CompiledModels");
+        const WindowsML::Shared::CompiledModelKey compiledModelKey =
+            compiledModelCache.CreateKey(modelPath, "policy:PREFER_CPU", {}, Ort::GetVersionString());
+
+        const std::optional<std::filesystem::path> compiledModelPath = compiledModelCache.GetOrCompile(
+            modelPath, compiledModelKey, [&](const std::filesystem::path& sourcePath, const std::filesystem::path& targetPath) {
+                std::wcout << L"No compiled model found, attempting to create compiled model at " << targetPath.wstring() << L'\n';
+
+                Ort::ModelCompilationOptions compile_options(env, sessionOptions);
+                compile_options.SetInputModelPath(sourcePath.c_str());
+                compile_options.SetOutputModelPath(targetPath.c_str());
+
+                std::wcout << L"Starting compile, this may take a few moments...\n";
+                Ort::Status compileStatus = Ort::CompileModel(env, compile_options);
+                if (!compileStatus.IsOK())
+                {
+                    std::cerr << "Failed to compile model: " << compileStatus.GetErrorCode() << ", "
+                              << compileStatus.GetErrorMessage() << std::endl;
+                    return false;
+                }
+
+                std::wcout << L"Model compiled successfully!\n";
+                return true;
+            });
+
+        if (compiledModelPath.has_value())
         {
-            std::wcout << L"Using compiled model: " << compiledModelPath.wstring() << L'\n';
+            std::wcout << L"Using compiled model: " << compiledModelPath->wstring() << L'\n';
         }
         else
         {
-            std::wcout << L"No compiled model found, attempting to create compiled model at " << compiledModelPath.wstring() << L'\n';
-
-            Ort::ModelCompilationOptions compile_options(env, sessionOptions);
-            compile_options.SetInputModelPath(modelPath.c_str());
-            compile_options.SetOutputModelPath(compiledModelPath.c_str());
-
-            std::wcout << L"Starting compile, this may take a few moments...\n";
-            Ort::Status compileStatus = Ort::CompileModel(env, compile_options);
-            if (compileStatus.IsOK())
-            {
-                // Calculate the duration in minutes / seconds / milliseconds
-                std::wcout << L"Model compiled successfully!\n";
-                isCompiledModelAvailable = std::filesystem::exists(compiledModelPath);
-            }
-            else
-            {
-                std::cerr << "Failed to compile model: " << compileStatus.GetErrorCode() << ", "
-                          << compileStatus.GetErrorMessage() << std::endl;
-                std::wcerr << "Falling back to uncompiled model\n";
-            }
+            std::wcerr << "Falling back to uncompiled model\n";
         }
-        std::filesystem::path modelPathToUse = isCompiledModelAvailable ? compiledModelPath : modelPath;
+        std::filesystem::path modelPathToUse = compiledModelPath.value_or(modelPath);
 
         // Create the session and load the model
         Ort::Session session(env, modelPathToUse.c_str(), sessionOptions);
@@ -116,7 +124,7 @@ int wmain(int argc, wchar_t* argv[]) noexcept
         auto inputType = inputInfo.GetElementType();
 
         auto imageFrameResult = ResNetModelHelper::LoadImageFileAsync(imagePath);
-        auto inputTensorData = ResNetModelHelper::BindSoftwareBitmapAsTensor(imageFrameResult.get());
+        auto inputBitmap = imageFrameResult.get();
 
         auto inputShape = std::array<int64_t, 4>{1, 3, 224, 224};
         auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
@@ -124,13 +132,15 @@ int wmain(int argc, wchar_t* argv[]) noexcept
 
         if (inputType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16)
         {
-            auto converted = ResNetModelHelper::ConvertFloat32ToFloat16(inputTensorData);
+            // Preprocess straight to float16, rather than converting a float32 tensor afterwards
+            auto converted = ResNetModelHelper::BindSoftwareBitmapAsFloat16Tensor(inputBitmap);
             rawInputBytes.assign(
                 reinterpret_cast<uint8_t*>(converted.data()),
                 reinterpret_cast<uint8_t*>(converted.data()) + converted.size() * sizeof(uint16_t));
         }
         else
         {
+            auto inputTensorData = ResNetModelHelper::BindSoftwareBitmapAsTensor(inputBitmap);
             rawInputBytes.assign(
                 reinterpret_cast<uint8_t*>(inputTensorData.data()),
                 reinterpret_cast<uint8_t*>(inputTensorData.data()) + inputTensorData.size() * sizeof(float));
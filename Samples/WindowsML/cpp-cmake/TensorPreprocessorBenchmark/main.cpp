@@ -0,0 +1,427 @@
+#include "TensorPreprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+using WindowsML::Shared::BgraImageView;
+using WindowsML::Shared::ChannelNormalization;
+using WindowsML::Shared::TensorPreprocessor;
+
+namespace
+{
+// The ImageNet normalization used by the ResNet samples
+constexpr ChannelNormalization ImageNet = {{0.485f, 0.456f, 0.406f}, {0.229f, 0.224f, 0.225f}};
+
+struct BgraImage
+{
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+
+    BgraImageView View() const
+    {
+        return {pixels.data(), width, height, stride};
+    }
+};
+
+// A smooth gradient with noise, so both the resampling weights and the individual bytes matter.
+// Rows are padded past the last pixel to check that the stride is honored.
+BgraImage CreateImage(uint32_t width, uint32_t height, std::mt19937& random)
+{
+    std::uniform_int_distribution<int> noise(-24, 24);
+
+    BgraImage image{{}, width, height, width * 4 + 12};
+    image.pixels.resize(static_cast<size_t>(image.stride) * height, 0xCD);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* pixel = &image.pixels[static_cast<size_t>(y) * image.stride + static_cast<size_t>(x) * 4];
+            const int gradient[3] = {
+                static_cast<int>(255 * x / std::max(width, 1u)),
+                static_cast<int>(255 * y / std::max(height, 1u)),
+                static_cast<int>(255 * (x + y) / std::max(width + height, 1u))};
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                pixel[channel] = static_cast<uint8_t>(std::clamp(gradient[channel] + noise(random), 0, 255));
+            }
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// One output pixel's source pixels and weights along one axis, computed in double precision
+// straight from the definition: downscaling averages the source area the output pixel covers,
+// and upscaling interpolates between the two source pixels nearest its center.
+std::vector<std::pair<uint32_t, double>> ReferenceWeights(uint32_t sourceSize, uint32_t targetSize, uint32_t i)
+{
+    const double scale = static_cast<double>(sourceSize) / targetSize;
+    std::vector<std::pair<uint32_t, double>> weights;
+    if (scale >= 1.0)
+    {
+        const double start = i * scale;
+        const double end = std::min((i + 1) * scale, static_cast<double>(sourceSize));
+        for (uint32_t j = static_cast<uint32_t>(start); j < sourceSize && j < end; ++j)
+        {
+            const double covered = std::min(end, j + 1.0) - std::max(start, static_cast<double>(j));
+            if (covered > 0.0)
+            {
+                weights.emplace_back(j, covered / scale);
+            }
+        }
+    }
+    else
+    {
+        const double center = std::clamp((i + 0.5) * scale - 0.5, 0.0, sourceSize - 1.0);
+        const auto first = static_cast<uint32_t>(center);
+        const double fraction = center - first;
+        weights.emplace_back(first, 1.0 - fraction);
+        if (first + 1 < sourceSize)
+        {
+            weights.emplace_back(first + 1, fraction);
+        }
+    }
+    return weights;
+}
+
+// The previous approach in double precision, as the reference for the accuracy checks: resize into
+// a separate image first, then normalize each pixel with divisions.
+std::vector<float> ConvertInTwoPasses(const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization)
+{
+    std::vector<double> resized(static_cast<size_t>(width) * height * 3);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const auto rowWeights = ReferenceWeights(image.height, height, y);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const auto columnWeights = ReferenceWeights(image.width, width, x);
+            double* pixel = &resized[(static_cast<size_t>(y) * width + x) * 3];
+            for (const auto& [sourceY, rowWeight] : rowWeights)
+            {
+                for (const auto& [sourceX, columnWeight] : columnWeights)
+                {
+                    const uint8_t* source = image.pixels + static_cast<size_t>(sourceY) * image.stride + static_cast<size_t>(sourceX) * 4;
+                    for (int channel = 0; channel < 3; ++channel)
+                    {
+                        pixel[channel] += source[2 - channel] * rowWeight * columnWeight; // BGRA to RGB
+                    }
+                }
+            }
+        }
+    }
+
+    const size_t planeSize = static_cast<size_t>(width) * height;
+    std::vector<float> tensor(planeSize * 3);
+    for (size_t i = 0; i < planeSize; ++i)
+    {
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            tensor[channel * planeSize + i] =
+                static_cast<float>((resized[i * 3 + channel] / 255.0 - normalization.mean[channel]) / normalization.std[channel]);
+        }
+    }
+    return tensor;
+}
+
+// The previous approach as the samples ran it, and the baseline for the timings: resize into a
+// separate BGRA image first (as the BMP encoder did, with the weights computed up front), then
+// normalize each pixel with the single-precision divisions of the old loop.
+std::vector<float> ConvertInTwoPassesFloat(const BgraImageView& image, uint32_t width, uint32_t height, const ChannelNormalization& normalization)
+{
+    std::vector<std::vector<std::pair<uint32_t, float>>> rowWeights(height);
+    std::vector<std::vector<std::pair<uint32_t, float>>> columnWeights(width);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (const auto& [sourceY, weight] : ReferenceWeights(image.height, height, y))
+        {
+            rowWeights[y].emplace_back(sourceY, static_cast<float>(weight));
+        }
+    }
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        for (const auto& [sourceX, weight] : ReferenceWeights(image.width, width, x))
+        {
+            columnWeights[x].emplace_back(sourceX, static_cast<float>(weight));
+        }
+    }
+
+    std::vector<uint8_t> resized(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float sums[3] = {};
+            for (const auto& [sourceY, rowWeight] : rowWeights[y])
+            {
+                for (const auto& [sourceX, columnWeight] : columnWeights[x])
+                {
+                    const uint8_t* source = image.pixels + static_cast<size_t>(sourceY) * image.stride + static_cast<size_t>(sourceX) * 4;
+                    for (int channel = 0; channel < 3; ++channel)
+                    {
+                        sums[channel] += source[channel] * rowWeight * columnWeight;
+                    }
+                }
+            }
+
+            uint8_t* pixel = &resized[(static_cast<size_t>(y) * width + x) * 4];
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                pixel[channel] = static_cast<uint8_t>(std::clamp(sums[channel] + 0.5f, 0.0f, 255.0f));
+            }
+            pixel[3] = 255;
+        }
+    }
+
+    const size_t planeSize = static_cast<size_t>(width) * height;
+    std::vector<float> tensor(planeSize * 3);
+    for (size_t i = 0; i < planeSize; ++i)
+    {
+        const size_t index = i * 4; // BGRA stride
+        const float r = static_cast<float>(resized[index + 2]) / 255.0f;
+        const float g = static_cast<float>(resized[index + 1]) / 255.0f;
+        const float b = static_cast<float>(resized[index + 0]) / 255.0f;
+
+        tensor[0 * planeSize + i] = (r - normalization.mean[0]) / normalization.std[0];
+        tensor[1 * planeSize + i] = (g - normalization.mean[1]) / normalization.std[1];
+        tensor[2 * planeSize + i] = (b - normalization.mean[2]) / normalization.std[2];
+    }
+    return tensor;
+}
+
+// IEEE half precision by rounding the scaled value to an integer, to check the bit manipulation in
+// TensorPreprocessor::FloatToHalf.
+uint16_t ReferenceFloatToHalf(float value)
+{
+    const uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+    const double magnitude = std::fabs(static_cast<double>(value));
+    if (std::isnan(value))
+    {
+        return sign | 0x7E00;
+    }
+    if (magnitude >= 65520.0)
+    {
+        return sign | 0x7C00;
+    }
+
+    int exponent;
+    std::frexp(magnitude, &exponent);
+    exponent -= 1; // magnitude is in [2^exponent, 2^(exponent + 1))
+    if (magnitude == 0.0 || exponent < -14)
+    {
+        // Subnormal, in units of 2^-24. Rounding up to 1024 gives the smallest normal value.
+        return sign | static_cast<uint16_t>(std::nearbyint(std::ldexp(magnitude, 24)));
+    }
+
+    auto mantissa = static_cast<uint32_t>(std::nearbyint(std::ldexp(magnitude, 10 - exponent)));
+    if (mantissa == 2048)
+    {
+        mantissa = 1024;
+        ++exponent;
+    }
+    return sign | static_cast<uint16_t>(((exponent + 15) << 10) | (mantissa - 1024));
+}
+
+// Microseconds per call, repeating the call until at least 200 ms have been measured
+double MeasureMicroseconds(const std::function<void()>& convert)
+{
+    using Clock = std::chrono::steady_clock;
+
+    convert();
+
+    size_t iterations = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    while (elapsed < std::chrono::milliseconds(200))
+    {
+        convert();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    }
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+}
+
+// Checks that ConvertBgraToTensor matches the two-pass reference, and that its float16 overload
+// writes exactly the float results converted by FloatToHalf.
+bool CheckConversion(const BgraImage& image, uint32_t width, uint32_t height, double& maxError)
+{
+    const size_t tensorSize = static_cast<size_t>(width) * height * 3;
+    std::vector<float> tensor(tensorSize);
+    std::vector<uint16_t> halfTensor(tensorSize);
+    TensorPreprocessor::ConvertBgraToTensor(image.View(), width, height, ImageNet, tensor.data());
+    TensorPreprocessor::ConvertBgraToTensor(image.View(), width, height, ImageNet, halfTensor.data());
+    const std::vector<float> expected = ConvertInTwoPasses(image.View(), width, height, ImageNet);
+
+    bool passed = true;
+    for (size_t i = 0; i < tensorSize; ++i)
+    {
+        maxError = std::max(maxError, static_cast<double>(std::fabs(tensor[i] - expected[i])));
+        passed &= halfTensor[i] == TensorPreprocessor::FloatToHalf(tensor[i]);
+    }
+
+    if (!passed)
+    {
+        std::cerr << "The float16 tensor for " << image.width << "x" << image.height << " to " << width << "x" << height
+                  << " differs from the float tensor\n";
+    }
+    return passed;
+}
+
+bool CheckFloatToHalf()
+{
+    bool passed = true;
+    auto check = [&](float value) {
+        if (TensorPreprocessor::FloatToHalf(value) != ReferenceFloatToHalf(value))
+        {
+            std::cerr << "FloatToHalf(" << value << ") is " << TensorPreprocessor::FloatToHalf(value) << ", expected "
+                      << ReferenceFloatToHalf(value) << "\n";
+            passed = false;
+        }
+    };
+
+    for (float value : {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65519.0f, 65520.0f, 6.1035156e-05f, 5.9604645e-08f, 2.9802322e-08f,
+                        2.9802326e-08f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min()})
+    {
+        check(value);
+    }
+
+    // Every 97th bit pattern covers every exponent and both directions of rounding.
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFull && passed; bits += 97)
+    {
+        float value;
+        const auto pattern = static_cast<uint32_t>(bits);
+        static_assert(sizeof(value) == sizeof(pattern));
+        std::memcpy(&value, &pattern, sizeof(value));
+        check(value);
+    }
+    return passed;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // --quick skips the timings, for a fast correctness check.
+    const bool quick = (argc > 1) && (std::string_view{argv[1]} == "--quick");
+
+    std::mt19937 random(42);
+    bool passed = CheckFloatToHalf();
+
+    // Sizes that leave a remainder after each vector loop, upscaling, and a 1x1 image
+    struct Size
+    {
+        uint32_t width;
+        uint32_t height;
+    };
+    const std::pair<Size, Size> conversions[] = {
+        {{640, 480}, {224, 224}},
+        {{333, 251}, {224, 224}},
+        {{224, 224}, {224, 224}},
+        {{112, 75}, {224, 224}},
+        {{37, 5}, {19, 3}},
+        {{1, 1}, {4, 4}},
+        {{7, 3}, {1, 1}},
+    };
+
+    double maxError = 0.0;
+    double maxBaselineError = 0.0;
+    for (const auto& [source, target] : conversions)
+    {
+        const BgraImage image = CreateImage(source.width, source.height, random);
+        passed &= CheckConversion(image, target.width, target.height, maxError);
+
+        const std::vector<float> baseline = ConvertInTwoPassesFloat(image.View(), target.width, target.height, ImageNet);
+        const std::vector<float> expected = ConvertInTwoPasses(image.View(), target.width, target.height, ImageNet);
+        for (size_t i = 0; i < baseline.size(); ++i)
+        {
+            maxBaselineError = std::max(maxBaselineError, static_cast<double>(std::fabs(baseline[i] - expected[i])));
+        }
+    }
+
+    // The weights and sums are single precision, so the results differ from the reference by a few
+    // units in the last place of values between about -2.1 and 2.7.
+    if (maxError > 1e-5)
+    {
+        std::cerr << "The tensor differs from the two-pass reference by up to " << maxError << "\n";
+        passed = false;
+    }
+
+    // The baseline rounds the resized image to bytes, so it can be off by half a level divided by
+    // the smallest standard deviation, about 0.0088.
+    if (maxBaselineError > 0.01)
+    {
+        std::cerr << "The single-precision baseline differs from the two-pass reference by up to " << maxBaselineError << "\n";
+        passed = false;
+    }
+
+    bool threw = false;
+    try
+    {
+        float unused = 0.0f;
+        TensorPreprocessor::ConvertBgraToTensor(BgraImageView{}, 1, 1, ImageNet, &unused);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    if (!threw)
+    {
+        std::cerr << "An empty image was not rejected\n";
+        passed = false;
+    }
+
+    std::cout << "Largest difference from the two-pass reference: " << maxError << ", and of the single-precision baseline: " << maxBaselineError
+              << "\n";
+    if (!passed)
+    {
+        return 1;
+    }
+
+    if (!quick)
+    {
+#if defined(TENSOR_PREPROCESSOR_NO_SIMD)
+        std::cout << "\nScalar path";
+#elif defined(TENSOR_PREPROCESSOR_NO_AVX2)
+        std::cout << "\nSSE2 path";
+#else
+        std::cout << "\nAVX2 path where supported";
+#endif
+        std::cout << ", milliseconds per image to a 224x224 tensor\n\n";
+        std::cout << std::setw(12) << "Source" << std::setw(12) << "Two-pass" << std::setw(10) << "Float" << std::setw(10) << "Float16"
+                  << std::setw(10) << "Speedup" << "\n";
+
+        for (Size source : {Size{640, 480}, Size{1920, 1080}, Size{4032, 3024}})
+        {
+            const BgraImage image = CreateImage(source.width, source.height, random);
+            std::vector<float> tensor(224 * 224 * 3);
+            std::vector<uint16_t> halfTensor(tensor.size());
+
+            double twoPass = MeasureMicroseconds([&]() { tensor = ConvertInTwoPassesFloat(image.View(), 224, 224, ImageNet); }) / 1000;
+            double fused =
+                MeasureMicroseconds([&]() { TensorPreprocessor::ConvertBgraToTensor(image.View(), 224, 224, ImageNet, tensor.data()); }) / 1000;
+            double fusedHalf =
+                MeasureMicroseconds([&]() { TensorPreprocessor::ConvertBgraToTensor(image.View(), 224, 224, ImageNet, halfTensor.data()); }) /
+                1000;
+
+            std::cout << std::setw(6) << source.width << "x" << std::setw(5) << std::left << source.height << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << twoPass << std::setw(10) << fused << std::setw(10) << fusedHalf
+                      << std::setw(9) << twoPass / fused << "x\n";
+        }
+    }
+
+    return 0;
+}
@@ -2,7 +2,9 @@
 // Licensed under the MIT License.
 
 #include <csignal>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "timing.h"
 #include <exception>
@@ -63,10 +65,187 @@ void InitializeProviders(bool allowDownload)
     }
 }
 
-void CXX_API(const char* model_path)
+// Buffers decoded text so the console is written a line or a few tokens at a time rather than
+// flushed after every token.
+class TextOutputBuffer
+{
+public:
+    void Append(const char* text)
+    {
+        buffer_ += text;
+        if (buffer_.size() >= FLUSH_THRESHOLD || buffer_.find('\n') != std::string::npos)
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        std::cout.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        std::cout.flush();
+        buffer_.clear();
+    }
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD = 32;
+    std::string buffer_;
+};
+
+const char* const SYSTEM_PROMPT = "You are a helpful AI assistant.";
+
+std::string MakeMessages(const std::string& text)
+{
+    std::string messages = R"(
+      [
+        {
+          "role": "system",
+          "content": ")" + std::string(SYSTEM_PROMPT) + R"("
+        })";
+    if (!text.empty())
+    {
+        messages += R"(,
+        {
+          "role": "user",
+          "content": ")" + text + R"("
+        })";
+    }
+    return messages + R"(
+      ]
+    )";
+}
+
+// Generates until the generator is done or Ctrl+C is pressed, writing the decoded text as it
+// goes. The prompt must already be appended; timing's start timestamp is recorded by the caller
+// before that, so prefill is included.
+void GenerateResponse(OgaGenerator& generator, OgaTokenizerStream& tokenizer_stream, Timing& timing)
+{
+    std::cout << "Generating response..." << std::endl;
+
+    bool is_first_token = true;
+    TextOutputBuffer output;
+    try
+    {
+        while (!generator.IsDone())
+        {
+            generator.GenerateNextToken();
+
+            if (is_first_token)
+            {
+                timing.RecordFirstTokenTimestamp();
+                is_first_token = false;
+            }
+
+            const auto num_tokens = generator.GetSequenceCount(0);
+            const auto new_token = generator.GetSequenceData(0)[num_tokens - 1];
+            output.Append(tokenizer_stream.Decode(new_token));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        output.Flush();
+        std::cout << "\n\033[31mTerminating generation: " << e.what() << "\033[0m" << std::endl;
+    }
+    output.Flush();
+
+    if (is_first_token)
+    {
+        timing.RecordFirstTokenTimestamp();
+    }
+    timing.RecordEndTimestamp();
+}
+
+// Session mode keeps one generator for the whole conversation. The system prompt is prefilled once
+// and its KV cache is kept: each prompt rewinds the generator to the end of the system prompt and
+// encodes only the new user turn, so the system prompt is never recomputed. As in the default mode,
+// earlier turns are not part of the context.
+class ChatSession
+{
+public:
+    ChatSession(OgaModel& model, OgaTokenizer& tokenizer) : tokenizer_(tokenizer)
+    {
+        auto params = OgaGeneratorParams::Create(model);
+        params->SetSearchOption("max_length", 1024);
+        generator_ = OgaGenerator::Create(model, *params);
+
+        // A template without a generation prompt ends where the user turn begins
+        system_text_ = std::string(tokenizer_.ApplyChatTemplate("", MakeMessages("").c_str(), "", false));
+
+        const auto start = Clock::now();
+        auto sequences = OgaSequences::Create();
+        tokenizer_.Encode(system_text_.c_str(), *sequences);
+        generator_->AppendTokenSequences(*sequences);
+        prefix_length_ = generator_->GetSequenceCount(0);
+        const Duration prefill_time = Clock::now() - start;
+
+        // Tokens the tokenizer adds to any text, such as BOS. The user turn continues the prompt, so
+        // they are not encoded again.
+        auto empty_sequences = OgaSequences::Create();
+        tokenizer_.Encode("", *empty_sequences);
+        leading_tokens_.assign(empty_sequences->SequenceData(0), empty_sequences->SequenceData(0) + empty_sequences->SequenceCount(0));
+
+        std::cout << "Cached " << prefix_length_ << " system prompt tokens in " << prefill_time.count() << "s" << std::endl;
+    }
+
+    void Respond(const std::string& text, OgaTokenizerStream& tokenizer_stream)
+    {
+        const std::string prompt = std::string(tokenizer_.ApplyChatTemplate("", MakeMessages(text).c_str(), "", true));
+
+        // The cached prefix can only be reused if the full prompt starts with the same text. If the
+        // template doesn't allow that, fall back to encoding every prompt in full.
+        if (prefix_length_ != 0 && prompt.compare(0, system_text_.size(), system_text_) != 0)
+        {
+            std::cout << "The chat template doesn't keep the system prompt as a prefix; encoding full prompts." << std::endl;
+            prefix_length_ = 0;
+        }
+
+        Timing timing;
+        timing.RecordStartTimestamp();
+
+        auto sequences = OgaSequences::Create();
+        tokenizer_.Encode(prefix_length_ != 0 ? prompt.c_str() + system_text_.size() : prompt.c_str(), *sequences);
+        const int32_t* tokens = sequences->SequenceData(0);
+        size_t token_count = sequences->SequenceCount(0);
+        if (prefix_length_ != 0 && token_count >= leading_tokens_.size() &&
+            std::equal(leading_tokens_.begin(), leading_tokens_.end(), tokens))
+        {
+            tokens += leading_tokens_.size();
+            token_count -= leading_tokens_.size();
+        }
+
+        generator_->RewindTo(prefix_length_);
+        generator_->AppendTokens(tokens, token_count);
+
+        g_generator = generator_.get(); // Store the current generator for termination
+        GenerateResponse(*generator_, tokenizer_stream, timing);
+        g_generator = nullptr;
+
+        // A terminated generator stays usable once the option is cleared
+        generator_->SetRuntimeOption("terminate_session", "0");
+
+        const int new_tokens_length = static_cast<int>(generator_->GetSequenceCount(0) - prefix_length_ - token_count);
+        timing.Log(static_cast<int>(token_count), static_cast<int>(prefix_length_), new_tokens_length);
+    }
+
+private:
+    OgaTokenizer& tokenizer_;
+    std::unique_ptr<OgaGenerator> generator_;
+    std::string system_text_;
+    size_t prefix_length_ = 0;
+    std::vector<int32_t> leading_tokens_;
+};
+
+void CXX_API(const char* model_path, const std::string& ep, bool session_mode)
 {
     std::cout << "Creating config..." << std::endl;
     auto config = OgaConfig::Create(model_path);
+    if (ep != "follow_config")
+    {
+        config->ClearProviders();
+        if (ep != "cpu")
+        {
+            config->AppendProvider(ep.c_str());
+        }
+    }
 
     std::cout << "Creating model..." << std::endl;
     auto model = OgaModel::Create(*config);
@@ -75,6 +254,13 @@ void CXX_API(const char* model_path)
     auto tokenizer = OgaTokenizer::Create(*model);
     auto tokenizer_stream = OgaTokenizerStream::Create(*tokenizer);
 
+    std::unique_ptr<ChatSession> session;
+    if (session_mode)
+    {
+        std::cout << "Creating session..." << std::endl;
+        session = std::make_unique<ChatSession>(*model, *tokenizer);
+    }
+
     while (true)
     {
         std::string text;
@@ -95,79 +281,52 @@ void CXX_API(const char* model_path)
 
         signal(SIGINT, TerminateGeneration);
 
-        const std::string messages = R"(
-      [
+        if (session)
         {
-          "role": "system",
-          "content": "You are a helpful AI assistant."
-        },
-        {
-          "role": "user",
-          "content": ")" + text + R"("
+            session->Respond(text, *tokenizer_stream);
         }
-      ]
-    )";
-        const std::string prompt = std::string(tokenizer->ApplyChatTemplate("", messages.c_str(), "", true));
+        else
+        {
+            const std::string prompt = std::string(tokenizer->ApplyChatTemplate("", MakeMessages(text).c_str(), "", true));
 
-        bool is_first_token = true;
-        Timing timing;
-        timing.RecordStartTimestamp();
+            Timing timing;
+            timing.RecordStartTimestamp();
 
-        auto sequences = OgaSequences::Create();
-        tokenizer->Encode(prompt.c_str(), *sequences);
+            auto sequences = OgaSequences::Create();
+            tokenizer->Encode(prompt.c_str(), *sequences);
 
-        std::cout << "Generating response..." << std::endl;
+            auto params = OgaGeneratorParams::Create(*model);
+            params->SetSearchOption("max_length", 1024);
+            auto generator = OgaGenerator::Create(*model, *params);
+            g_generator = generator.get(); // Store the current generator for termination
+            generator->AppendTokenSequences(*sequences);
 
-        auto params = OgaGeneratorParams::Create(*model);
-        params->SetSearchOption("max_length", 1024);
-        auto generator = OgaGenerator::Create(*model, *params);
-        g_generator = generator.get(); // Store the current generator for termination
-        generator->AppendTokenSequences(*sequences);
-
-        try
-        {
-            while (!generator->IsDone())
-            {
-                generator->GenerateNextToken();
+            GenerateResponse(*generator, *tokenizer_stream, timing);
 
-                if (is_first_token)
-                {
-                    timing.RecordFirstTokenTimestamp();
-                    is_first_token = false;
-                }
+            const int prompt_tokens_length = static_cast<int>(sequences->SequenceCount(0));
+            const int new_tokens_length = static_cast<int>(generator->GetSequenceCount(0) - prompt_tokens_length);
+            timing.Log(prompt_tokens_length, 0, new_tokens_length);
 
-                const auto num_tokens = generator->GetSequenceCount(0);
-                const auto new_token = generator->GetSequenceData(0)[num_tokens - 1];
-                std::cout << tokenizer_stream->Decode(new_token) << std::flush;
-            }
-        }
-        catch (const std::exception& e)
-        {
-            std::cout << "\n\033[31mTerminating generation: " << e.what() << "\033[0m" << std::endl;
+            g_generator = nullptr; // Clear the generator after use
         }
 
-        timing.RecordEndTimestamp();
-        const int prompt_tokens_length = static_cast<int>(sequences->SequenceCount(0));
-        const int new_tokens_length = static_cast<int>(generator->GetSequenceCount(0) - prompt_tokens_length);
-        timing.Log(prompt_tokens_length, new_tokens_length);
-
         for (int i = 0; i < 3; ++i)
             std::cout << std::endl;
-
-        g_generator = nullptr; // Clear the generator after use
     }
 }
 
 static void print_usage(int /*argc*/, char** argv)
 {
-    std::cerr << "usage: " << argv[0] << " <model_path> <execution_provider>" << std::endl;
+    std::cerr << "usage: " << argv[0] << " <model_path> [execution_provider] [--session]" << std::endl;
     std::cerr << "  model_path: [required] Path to the folder containing onnx models, genai_config.json, etc." << std::endl;
     std::cerr << "  execution_provider: [optional] Force use of a particular execution provider (e.g. \"cpu\")" << std::endl;
     std::cerr << "                      If not specified, EP / provider options specified in genai_config.json will be used."
               << std::endl;
+    std::cerr << "  --session: [optional] Keep the generator between prompts and reuse the system prompt's KV cache," << std::endl;
+    std::cerr << "             so only the new user turn is prefilled." << std::endl;
 }
 
-bool parse_args(int argc, char** argv, std::string& model_path)
+bool parse_args(int argc, char** argv, std::string& model_path, std::string& ep, bool& session_mode)
 {
     if (argc < 2)
     {
@@ -176,6 +335,30 @@ bool parse_args(int argc, char** argv, std::string& model_path)
     }
 
     model_path = argv[1];
+    ep = "follow_config";
+    session_mode = false;
+    bool ep_given = false;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--session")
+        {
+            session_mode = true;
+        }
+        else if (arg.starts_with("-") || ep_given)
+        {
+            // A mistyped flag would otherwise be taken as the execution provider
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argc, argv);
+            return false;
+        }
+        else
+        {
+            ep = arg;
+            ep_given = true;
+        }
+    }
 
     return true;
 }
@@ -186,7 +369,9 @@ int main(int argc, char** argv)
     InitializeProviders(allowDownload);
 
     std::string model_path;
-    if (!parse_args(argc, argv, model_path))
+    std::string ep;
+    bool session_mode = false;
+    if (!parse_args(argc, argv, model_path, ep, session_mode))
     {
         return -1;
     }
@@ -200,7 +385,7 @@ int main(int argc, char** argv)
     {
         // Responsible for cleaning up the library during shutdown
         OgaHandle handle;
-        CXX_API(model_path.c_str());
+        CXX_API(model_path.c_str(), ep, session_mode);
     }
     catch (const std::exception& e)
     {
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "timing.h"
+#include <algorithm>
 #include <cassert>
 
 void Timing::RecordStartTimestamp()
@@ -22,22 +23,25 @@ void Timing::RecordEndTimestamp()
     end_timestamp_ = Clock::now();
 }
 
-void Timing::Log(const int prompt_tokens_length, const int new_tokens_length)
+void Timing::Log(const int prefill_tokens_length, const int reused_tokens_length, const int new_tokens_length)
 {
     assert(start_timestamp_.time_since_epoch().count() != 0);
     assert(first_token_timestamp_.time_since_epoch().count() != 0);
     assert(end_timestamp_.time_since_epoch().count() != 0);
 
-    Duration prompt_time = (first_token_timestamp_ - start_timestamp_);
-    Duration run_time = (end_timestamp_ - first_token_timestamp_);
+    Duration prefill_time = (first_token_timestamp_ - start_timestamp_);
+    Duration decode_time = (end_timestamp_ - first_token_timestamp_);
+    const int decode_tokens_length = std::max(new_tokens_length - 1, 0);
 
     const auto default_precision{std::cout.precision()};
     std::cout << std::endl;
     std::cout << "-------------" << std::endl;
-    std::cout << std::fixed << std::showpoint << std::setprecision(2) << "Prompt length: " << prompt_tokens_length
-              << ", New tokens: " << new_tokens_length << ", Time to first: " << prompt_time.count() << "s"
-              << ", Prompt tokens per second: " << prompt_tokens_length / prompt_time.count() << " tps"
-              << ", New tokens per second: " << new_tokens_length / run_time.count() << " tps"
+    std::cout << std::fixed << std::showpoint << std::setprecision(2) << "Prompt length: " << prefill_tokens_length + reused_tokens_length
+              << " (" << reused_tokens_length << " reused from cache), New tokens: " << new_tokens_length
+              << ", Time to first: " << prefill_time.count() << "s" << std::endl;
+    std::cout << "Prefill: " << prefill_tokens_length << " tokens, " << prefill_tokens_length / prefill_time.count() << " tps"
+              << ", Decode: " << decode_tokens_length << " tokens, "
+              << (decode_time.count() > 0 ? decode_tokens_length / decode_time.count() : 0.0) << " tps"
               << std::setprecision(default_precision) << std::endl;
     std::cout << "-------------" << std::endl;
 }
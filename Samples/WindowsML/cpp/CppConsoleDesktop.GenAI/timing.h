@@ -28,7 +28,10 @@ public:
     void RecordStartTimestamp();
     void RecordFirstTokenTimestamp();
     void RecordEndTimestamp();
-    void Log(const int prompt_tokens_length, const int new_tokens_length);
+    // prefill_tokens_length counts the prompt tokens run for this response; reused_tokens_length counts
+    // the prompt tokens whose KV cache was kept from an earlier turn. The first new token is produced
+    // by the prefill, so decode throughput is measured over the rest.
+    void Log(const int prefill_tokens_length, const int reused_tokens_length, const int new_tokens_length);
 
 private:
     TimePoint start_timestamp_;
@@ -43,4 +46,4 @@ std::string Trim(const std::string& str);
 // Returns true if model_path & ep were able to be set from user cmd-line args.
 // Returns false if insufficient cmd-line arguments were passed.
 // Note: ep will be set to "follow_config" if user only gives model_path
-bool parse_args(int /*argc*/, char** argv, std::string& model_path);
+bool parse_args(int argc, char** argv, std::string& model_path, std::string& ep, bool& session_mode);
@@ -2,6 +2,8 @@
 // Licensed under the MIT License. See LICENSE.md in the repo root for license information.
 
 #include <iostream>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <filesystem>
@@ -107,17 +109,17 @@ IAsyncAction RunInferenceAsync(const CommandLineOptions& options)
         }
 
         // Load labels
-        std::vector<std::string> labels = ModelManager::LoadLabels(labelsPath);
+        LabelStore labels = ModelManager::LoadLabels(labelsPath);
 
-        std::filesystem::path outputPath =
-            options.output_path.empty() ? executableFolder / L"SqueezeNet_ctx.onnx" : std::filesystem::path(options.output_path);
+        std::filesystem::path outputPath{options.output_path};
+        std::filesystem::path compiledModelCacheFolder = executableFolder / L"CompiledModels";
 
         std::filesystem::path imagePath =
             options.image_path.empty() ? executableFolder / L"image.png" : std::filesystem::path(options.image_path);
 
         // Determine the actual model to use
         std::filesystem::path actualModelPath =
-            InferenceEngine::DetermineModelPath(options, modelPath, outputPath, sessionOptions, env);
+            InferenceEngine::DetermineModelPath(options, modelPath, outputPath, compiledModelCacheFolder, sessionOptions, env);
 
         // Create session
         std::wcout << L"Loading model: " << actualModelPath.wstring().c_str() << std::endl;
@@ -132,31 +134,60 @@ IAsyncAction RunInferenceAsync(const CommandLineOptions& options)
         auto inputTensorInfo = inputTypeInfo.GetTensorTypeAndShapeInfo();
         std::vector<int64_t> inputShape = InferenceEngine::PrepareInputShape(inputTensorInfo.GetShape());
 
-        // Load and process image
+        if (!options.image_directory.empty() || !options.image_list_path.empty())
+        {
+            // Batch mode: classify many images, packing several into each inference
+            std::vector<std::filesystem::path> imagePaths = BatchProcessor::CollectImagePaths(options);
+            int64_t batchSize = BatchProcessor::DetermineBatchSize(inputTensorInfo.GetShape(), options.batch_size);
+            std::wcout << L"Classifying " << imagePaths.size() << L" images in batches of " << batchSize << std::endl;
+
+            BatchStatistics statistics = BatchProcessor::RunBatches(
+                session,
+                inputName.get(),
+                outputName.get(),
+                inputTensorInfo.GetShape(),
+                imagePaths,
+                batchSize,
+                [&labels](const std::filesystem::path& imagePath, const std::vector<float>& results) {
+                    auto topPrediction = ClassificationPostprocessor::TopKSoftmax(results, 1).front();
+                    std::string_view label = labels[topPrediction.first];
+
+                    std::wcout << imagePath.filename().wstring() << L": ";
+                    std::cout << (label.empty() ? "Class " + std::to_string(topPrediction.first) : std::string{label}) << " (" << topPrediction.second * 100.0f << "%)" << std::endl;
+                });
+
+            BatchProcessor::PrintStatistics(statistics);
+            co_return;
+        }
+
+        // Allocate the input and output tensors once and bind them to the session
+        InferenceContext inferenceContext(session, inputName.get(), outputName.get(), inputShape);
+        std::span<float> inputData = inferenceContext.GetInputData();
+        if (inputData.size() != static_cast<size_t>(ImageProcessor::CHANNELS * ImageProcessor::IMAGE_SIZE * ImageProcessor::IMAGE_SIZE))
+        {
+            throw std::runtime_error("Model input shape does not match the preprocessed image size.");
+        }
+
+        // Load and process image straight into the bound input tensor
         ImageProcessor imageProcessor;
         auto videoFrame = co_await imageProcessor.LoadImageFileAsync(winrt::hstring{imagePath.wstring()});
-        std::vector<float> inputTensorValues = imageProcessor.BindVideoFrameAsTensor(videoFrame);
+        imageProcessor.BindVideoFrameAsTensor(videoFrame, inputData.data());
 
-        // Create input tensor
-        auto inputTensor = InferenceEngine::CreateInputTensor(inputTensorValues, inputShape);
-
-        // Run inference
+        // Run inference; results are read in place from the bound output tensor
         std::wcout << L"Running inference..." << std::endl;
-        auto outputTensors = InferenceEngine::RunInference(session, inputName.get(), outputName.get(), inputTensor);
-
-        // Extract results
-        std::vector<float> results = InferenceEngine::ExtractResults(outputTensors);
+        std::span<const float> results = inferenceContext.Run();
 
-        if (labels.empty())
+        if (labels.GetCount() == 0)
         {
             std::wcout << L"Warning: Could not load labels. Using generic labels.\n";
-            for (size_t i = 0; i < results.size() && i < 10; ++i)
-            {
-                labels.push_back("Class " + std::to_string(i));
-            }
         }
 
         ResultProcessor::PrintResults(labels, results);
+
+        if (options.benchmark_runs > 0)
+        {
+            InferenceBenchmark::Run(session, inputName.get(), outputName.get(), inputShape, inputData, options.benchmark_runs);
+        }
     }
     catch (std::exception const& ex)
     {